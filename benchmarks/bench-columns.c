@@ -0,0 +1,148 @@
+/**
+ * Aggregation of metrics of many targets: sums, maxima and the top of targets by CPU usage over Process_stat
+ * structures against Target_columns. Every tick updates all targets, then aggregates them: structures calculate their
+ * own rates during the update, as a single Process_stat does, with columns the update only stores counters of every
+ * target (Counters_only, as Target_list does) and rates are calculated by columns. Targets are synthetic, so '/proc'
+ * is not read.
+ *
+ * Usage: process-watcher-bench-columns [TARGETS] [TICKS] [TOP]
+ */
+#include "bench-common.h"
+#include "columns.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_TARGETS 100000
+#define DEFAULT_TICKS 100
+#define DEFAULT_TOP 10
+
+// aggregation over structures: sums and maxima of metrics, the top by the insertion into the sorted array
+static double aggregate_structures(Process_stat* const* stats, const bool* alive, size_t count, size_t n, size_t* top)
+{
+  double sums[TARGET_COLUMNS_COUNT] = {0.0}, maxima[TARGET_COLUMNS_COUNT] = {0.0};
+  size_t size = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (!alive[i])
+      continue;
+    const Process_stat* stat = stats[i];
+    double values[TARGET_COLUMNS_COUNT] = {
+        stat->Cpu_usage, stat->Memory_usage, stat->Disk_read_mb_usage, stat->Disk_write_mb_usage};
+    for (int column = 0; column < TARGET_COLUMNS_COUNT; ++column) {
+      sums[column] += values[column];
+      maxima[column] = values[column] > maxima[column] ? values[column] : maxima[column];
+    }
+    if (size < n || stat->Cpu_usage > stats[top[size - 1]]->Cpu_usage) {
+      size_t j = size < n ? size++ : size - 1;
+      for (; j > 0 && stats[top[j - 1]]->Cpu_usage < stat->Cpu_usage; --j)
+        top[j] = top[j - 1];
+      top[j] = i;
+    }
+  }
+  return sums[TARGET_COLUMN_CPU] + maxima[TARGET_COLUMN_CPU] + (double) size;
+}
+
+// the synthetic update of targets: counters and memory usage change as Process_stat_update_files reads them, rates
+// and peaks of structures are calculated as Process_stat does, targets stored into columns keep only counters
+static void update_targets(Process_stat* const* stats,
+                           const bool* alive,
+                           size_t count,
+                           const Process_tick* tick,
+                           unsigned long long seed,
+                           Target_columns* columns)
+{
+  for (size_t i = 0; i < count; ++i) {
+    Process_stat* stat = stats[i];
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned long long delta = (seed >> 33) % 1000;
+    unsigned long long utime = stat->__last_utime + delta, stime = stat->__last_stime + delta / 3;
+    unsigned long long rbytes = stat->__last_read_bytes + delta * 4096;
+    unsigned long long wbytes = stat->__last_written_bytes + delta * 1024;
+    stat->Memory_usage = (double) (i % 4096);
+    stat->Memory_peak_usage = MAX(stat->Memory_peak_usage, stat->Memory_usage);
+    if (!columns) {
+      double cpu_total = (double) (tick->Cpu_total - stat->__last_total),
+             period_s = (double) (tick->Monotime_ms - stat->__last_monotime) / 1000.0;
+      unsigned long long cpu_time = utime - stat->__last_utime + stime - stat->__last_stime;
+      stat->Cpu_usage = cpu_total > 0.0 ? 100.0 * (double) cpu_time / cpu_total : 0.0;
+      stat->Disk_read_mb_usage = period_s > 0.0 ? (double) (rbytes - stat->__last_read_bytes) / 1e6 / period_s : 0.0;
+      stat->Disk_write_mb_usage =
+          period_s > 0.0 ? (double) (wbytes - stat->__last_written_bytes) / 1e6 / period_s : 0.0;
+      stat->Cpu_peak_usage = MAX(stat->Cpu_peak_usage, stat->Cpu_usage);
+      stat->Disk_read_mb_peak_usage = MAX(stat->Disk_read_mb_peak_usage, stat->Disk_read_mb_usage);
+      stat->Disk_write_mb_peak_usage = MAX(stat->Disk_write_mb_peak_usage, stat->Disk_write_mb_usage);
+    }
+    stat->__last_utime = utime;
+    stat->__last_stime = stime;
+    stat->__last_read_bytes = rbytes;
+    stat->__last_written_bytes = wbytes;
+    stat->__last_total = tick->Cpu_total;
+    stat->__last_monotime = tick->Monotime_ms;
+    if (columns && alive[i])
+      Target_columns_store(columns, i, stat);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_TARGETS;
+  int ticks = argc > 2 ? atoi(argv[2]) : DEFAULT_TICKS;
+  size_t n = argc > 3 ? strtoul(argv[3], NULL, 10) : DEFAULT_TOP;
+  if (count == 0 || ticks <= 0 || n == 0) {
+    fprintf(stderr, "Usage: %s [TARGETS] [TICKS] [TOP]\n", argv[0]);
+    return 1;
+  }
+
+  Process_stat** stats = malloc(sizeof(Process_stat*) * count);
+  bool* alive = malloc(sizeof(bool) * count);
+  size_t* top = malloc(sizeof(size_t) * n);
+  if (!stats || !alive || !top)
+    return 1;
+  for (size_t i = 0; i < count; ++i) {
+    stats[i] = Process_stat_init();
+    alive[i] = i % 17 != 0;
+  }
+
+  Target_columns* columns = Target_columns_init();
+  Process_tick tick = {0, 0, 0, 0};
+  // milliseconds of updates and aggregations of structures and columns
+  double update_ms[2] = {0.0, 0.0}, aggregate_ms[2] = {0.0, 0.0}, checksum = 0.0;
+  for (int t = 0; t < ticks; ++t) {
+    tick.Cpu_total += 100000;
+    tick.Monotime_ms += 1000;
+
+    double start = bench_monotime_ms();
+    update_targets(stats, alive, count, &tick, (unsigned long long) t, NULL);
+    double middle = bench_monotime_ms();
+    checksum += aggregate_structures(stats, alive, count, n, top);
+    update_ms[0] += middle - start;
+    aggregate_ms[0] += bench_monotime_ms() - middle;
+
+    start = bench_monotime_ms();
+    Target_columns_begin(columns, count, &tick);
+    update_targets(stats, alive, count, &tick, (unsigned long long) t, columns);
+    middle = bench_monotime_ms();
+    Target_columns_finish(columns);
+    checksum += (double) Target_columns_top(columns, TARGET_COLUMN_CPU, true, n, top);
+    update_ms[1] += middle - start;
+    aggregate_ms[1] += bench_monotime_ms() - middle;
+  }
+
+  printf("targets: %zu, ticks: %d, top: %zu (checksum %.0f)\n", count, ticks, n, checksum);
+  printf("%12s %12s %14s %14s\n", "storage", "update, ms", "aggregate, ms", "ns/target");
+  const char* names[2] = {"structures", "columns"};
+  for (int i = 0; i < 2; ++i)
+    printf("%12s %12.3f %14.3f %14.2f\n",
+           names[i],
+           update_ms[i] / ticks,
+           aggregate_ms[i] / ticks,
+           (update_ms[i] + aggregate_ms[i]) * 1e6 / ticks / (double) count);
+
+  Target_columns_free(columns);
+  for (size_t i = 0; i < count; ++i)
+    Process_stat_free(stats[i]);
+  free(stats);
+  free(alive);
+  free(top);
+  return 0;
+}
@@ -0,0 +1,33 @@
+#include "bench-common.h"
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <time.h>
+
+double bench_monotime_ms()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double) now.tv_sec * 1000.0 + (double) now.tv_nsec / 1000000.0;
+}
+
+void bench_fill_targets(Target_list* list, size_t count)
+{
+  char* errormsg = NULL;
+  while (list->Count < count) {
+    size_t added = list->Count;
+    DIR* proc = opendir("/proc");
+    if (!proc)
+      break;
+    struct dirent* entry;
+    while ((entry = readdir(proc)) != NULL && list->Count < count)
+      if (entry->d_name[0] >= '1' && entry->d_name[0] <= '9' && !Target_list_add(list, entry->d_name, &errormsg)) {
+        free(errormsg);
+        errormsg = NULL; // the process has exited or is not readable
+      }
+    closedir(proc);
+    if (added == list->Count)
+      break;
+  }
+  free(errormsg);
+}
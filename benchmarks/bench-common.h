@@ -0,0 +1,21 @@
+#ifndef __BENCH_COMMON_H
+#define __BENCH_COMMON_H
+
+#include "targets.h"
+#include <stddef.h>
+
+/**
+ * @brief bench_monotime_ms
+ * Returns the monotonic time with the precision of nanoseconds.
+ * @return The time in milliseconds
+ */
+double bench_monotime_ms();
+/**
+ * @brief bench_fill_targets
+ * Adds readable processes of the system to the list, a process is repeated, if there are not enough processes.
+ * @param list The pointer to the list
+ * @param count Number of targets
+ */
+void bench_fill_targets(Target_list* list, size_t count);
+
+#endif // __BENCH_COMMON_H
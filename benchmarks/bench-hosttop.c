@@ -0,0 +1,108 @@
+/**
+ * The cost of the host-wide top ('-top N') by the number of processes of the host. Idle children are forked to make the
+ * host larger, then every tick lists and reads all processes of the host. The selection of the top by the bounded heap
+ * is compared with sorting of all processes.
+ *
+ * Usage: process-watcher-bench-hosttop [CHILDREN] [TICKS] [TOP]
+ */
+#include "bench-common.h"
+#include "hosttop.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define DEFAULT_CHILDREN 2000
+#define DEFAULT_TICKS 10
+#define DEFAULT_TOP 20
+
+static const double* Sorted_values; // values of the sorting of all processes
+
+static int compare_values(const void* a, const void* b)
+{
+  double x = Sorted_values[*(const size_t*) a], y = Sorted_values[*(const size_t*) b];
+  return (x < y) - (x > y);
+}
+
+int main(int argc, char** argv)
+{
+  long children = argc > 1 ? atol(argv[1]) : DEFAULT_CHILDREN;
+  int ticks = argc > 2 ? atoi(argv[2]) : DEFAULT_TICKS;
+  size_t n = argc > 3 ? strtoul(argv[3], NULL, 10) : DEFAULT_TOP;
+  if (children < 0 || ticks <= 0 || n == 0) {
+    fprintf(stderr, "Usage: %s [CHILDREN] [TICKS] [TOP]\n", argv[0]);
+    return 1;
+  }
+
+  pid_t* pids = malloc(sizeof(pid_t) * (size_t) (children ? children : 1));
+  if (!pids)
+    return 1;
+  long forked = 0;
+  for (; forked < children; ++forked) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      pause();
+      _exit(0);
+    }
+    if (pid < 0)
+      break; // the limit of processes
+    pids[forked] = pid;
+  }
+
+  char* errormsg = NULL;
+  Host_top* top = Host_top_init(n);
+  Host_top_update(top, &errormsg); // the first tick has no rates and is not measured
+  double update_ms = 0.0, heap_ms = 0.0, sort_ms = 0.0;
+  unsigned long long syscalls = 0;
+  size_t* order = NULL;
+  for (int tick = 0; tick < ticks && !errormsg; ++tick) {
+    double start = bench_monotime_ms();
+    Host_top_update(top, &errormsg);
+    update_ms += bench_monotime_ms() - start;
+    syscalls += top->Syscalls;
+
+    start = bench_monotime_ms();
+    Host_top_sort(top, TARGET_COLUMN_CPU);
+    heap_ms += bench_monotime_ms() - start;
+
+    // all processes are sorted instead of the selection
+    start = bench_monotime_ms();
+    order = realloc(order, sizeof(size_t) * (top->Count ? top->Count : 1));
+    double* values = malloc(sizeof(double) * (top->Count ? top->Count : 1));
+    if (!order || !values)
+      return 1;
+    for (size_t i = 0; i < top->Count; ++i) {
+      order[i] = i;
+      values[i] = top->Processes[i].Values[TARGET_COLUMN_CPU];
+    }
+    Sorted_values = values;
+    qsort(order, top->Count, sizeof(size_t), compare_values);
+    free(values);
+    sort_ms += bench_monotime_ms() - start;
+  }
+
+  if (errormsg)
+    fprintf(stderr, "%s\n", errormsg);
+  double count = (double) (top->Count ? top->Count : 1);
+  printf("processes: %zu (forked %ld), ticks: %d, top: %zu\n", top->Count, forked, ticks, n);
+  printf("%12s %12s %14s %14s\n", "", "ms/tick", "us/process", "syscalls/tick");
+  printf("%12s %12.3f %14.3f %14llu\n",
+         "update",
+         update_ms / ticks,
+         update_ms * 1000.0 / ticks / count,
+         syscalls / (unsigned long long) ticks);
+  printf("%12s %12.3f %14.3f\n", "top by heap", heap_ms / ticks, heap_ms * 1000.0 / ticks / count);
+  printf("%12s %12.3f %14.3f\n", "sort all", sort_ms / ticks, sort_ms * 1000.0 / ticks / count);
+
+  for (long i = 0; i < forked; ++i)
+    kill(pids[i], SIGKILL);
+  for (long i = 0; i < forked; ++i)
+    waitpid(pids[i], NULL, 0);
+  Host_top_free(top);
+  free(order);
+  free(pids);
+  free(errormsg);
+  return 0;
+}
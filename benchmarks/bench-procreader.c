@@ -0,0 +1,77 @@
+/**
+ * The cost of reading files of many targets per tick: opening files by every update, 'pread' of opened files and
+ * batches of io_uring. Thousands of targets are made from readable processes of the system (a process is repeated, if
+ * there are not enough processes), then every backend samples the same list. The CPU time includes kernel workers of
+ * io_uring, because they belong to the process.
+ *
+ * Usage: process-watcher-bench-procreader [TARGETS] [TICKS]
+ */
+#include "bench-common.h"
+#include "procreader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_TARGETS 2000
+#define DEFAULT_TICKS 20
+
+static double cputime_ms()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return (double) now.tv_sec * 1000.0 + (double) now.tv_nsec / 1000000.0;
+}
+
+int main(int argc, char** argv)
+{
+  size_t targets_count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_TARGETS;
+  int ticks = argc > 2 ? atoi(argv[2]) : DEFAULT_TICKS;
+  if (targets_count == 0 || ticks <= 0) {
+    fprintf(stderr, "Usage: %s [TARGETS] [TICKS]\n", argv[0]);
+    return 1;
+  }
+
+  Target_list* list = Target_list_init();
+  bench_fill_targets(list, targets_count);
+  printf("targets: %zu, ticks: %d\n", list->Count, ticks);
+  printf("%10s %12s %12s %14s %10s\n", "backend", "ms/tick", "cpu ms/tick", "syscalls/tick", "alive");
+
+  char* errormsg = NULL;
+  const char* names[] = {"open", "pread", "io_uring"};
+  for (int mode = 0; mode < 3; ++mode) {
+    if (list->Reader) {
+      Proc_reader_free(list->Reader);
+      list->Reader = NULL;
+    }
+    if (mode > 0) {
+      list->Reader = Proc_reader_init(mode == 1 ? PROC_READER_PREAD : PROC_READER_IO_URING);
+      if (mode == 2 && list->Reader->Backend != PROC_READER_IO_URING) {
+        printf("%10s %12s\n", names[mode], "unavailable");
+        continue;
+      }
+    }
+    for (size_t i = 0; i < list->Count; ++i)
+      list->Alive[i] = true; // the same targets for every backend
+    Target_list_update(list, &errormsg); // files are opened by the first tick, it is not measured
+
+    size_t alive = 0;
+    unsigned long long syscalls = 0;
+    double start = bench_monotime_ms(), cpu_start = cputime_ms();
+    for (int tick = 0; tick < ticks; ++tick) {
+      alive = Target_list_update(list, &errormsg);
+      syscalls += list->Reader ? list->Reader->Syscalls : 0;
+    }
+    double tick_ms = (bench_monotime_ms() - start) / ticks, cpu_ms = (cputime_ms() - cpu_start) / ticks;
+    if (list->Reader)
+      printf("%10s %12.2f %12.2f %14llu %10zu\n", names[mode], tick_ms, cpu_ms, syscalls / (unsigned) ticks, alive);
+    else
+      printf("%10s %12.2f %12.2f %14s %10zu\n", names[mode], tick_ms, cpu_ms, "-", alive);
+  }
+  if (errormsg) {
+    fprintf(stderr, "%s\n", errormsg);
+    free(errormsg);
+  }
+  Target_list_free(list);
+  return 0;
+}
@@ -0,0 +1,61 @@
+/**
+ * The throughput of Sampler_pool by the number of workers. Thousands of targets are made from readable processes of
+ * the system (a process is repeated, if there are not enough processes), then every pool samples the same list.
+ *
+ * Usage: process-watcher-bench-samplerpool [TARGETS] [TICKS] [MAX_WORKERS]
+ */
+#include "bench-common.h"
+#include "samplerpool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define DEFAULT_TARGETS 5000
+#define DEFAULT_TICKS 10
+
+int main(int argc, char** argv)
+{
+  size_t targets_count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_TARGETS;
+  int ticks = argc > 2 ? atoi(argv[2]) : DEFAULT_TICKS;
+  long cores = sysconf(_SC_NPROCESSORS_ONLN), max_workers = argc > 3 ? atol(argv[3]) : cores;
+  if (targets_count == 0 || ticks <= 0 || max_workers <= 0) {
+    fprintf(stderr, "Usage: %s [TARGETS] [TICKS] [MAX_WORKERS]\n", argv[0]);
+    return 1;
+  }
+
+  Target_list* list = Target_list_init();
+  bench_fill_targets(list, targets_count);
+  printf("targets: %zu, ticks: %d, cores: %ld\n", list->Count, ticks, cores);
+  printf("%8s %12s %14s %8s %10s\n", "workers", "ms/tick", "targets/s", "speedup", "stolen");
+
+  char* errormsg = NULL;
+  double single_ms = 0.0;
+  for (size_t workers = 1; workers <= (size_t) max_workers; workers *= 2) {
+    Sampler_pool* pool = Sampler_pool_init(workers);
+    Sampler_pool_update(pool, list, &errormsg); // the first sample of new targets is not measured
+    unsigned long long stolen = 0;
+    double start = bench_monotime_ms();
+    for (int tick = 0; tick < ticks; ++tick) {
+      Sampler_pool_update(pool, list, &errormsg);
+      for (size_t i = 0; i < pool->Workers_count; ++i)
+        stolen += pool->Workers[i].Stolen_count;
+    }
+    double tick_ms = (bench_monotime_ms() - start) / ticks;
+    if (workers == 1)
+      single_ms = tick_ms;
+    printf("%8zu %12.2f %14.0f %8.2f %10llu\n",
+           workers,
+           tick_ms,
+           (double) list->Count * 1000.0 / tick_ms,
+           single_ms / tick_ms,
+           stolen / (unsigned long long) ticks);
+    Sampler_pool_free(pool);
+  }
+  if (errormsg) {
+    fprintf(stderr, "%s\n", errormsg);
+    free(errormsg);
+  }
+  Target_list_free(list);
+  return 0;
+}
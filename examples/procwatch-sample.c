@@ -0,0 +1,66 @@
+// The example of the embedded sampling engine. Watches processes by PIDs or names and prints samples of all of them
+// once per interval:
+//   process-watcher-procwatch-sample 1 sshd bash
+//   process-watcher-procwatch-sample $(pgrep -d ' ' nginx)
+
+#include "procwatch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const int SAMPLES_TO_PRINT = 10;
+static const long INTERVAL_MS = 1000;
+
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    printf("Usage: %s PID|NAME...\n", argv[0]);
+    return 1;
+  }
+
+  Procwatch_error error;
+  Procwatch* pw = Procwatch_open((size_t) argc - 1, &error);
+  if (!pw) {
+    printf("%s\n", Procwatch_error_string(error));
+    return 1;
+  }
+  for (int i = 1; i < argc; ++i) {
+    char* end;
+    int pid = (int) strtol(argv[i], &end, 10);
+    if (*end != '\0' && (error = Procwatch_find(pw, argv[i], &pid)) != PROCWATCH_OK)
+      printf("%s: %s\n", argv[i], Procwatch_error_string(error));
+    else if ((error = Procwatch_watch(pw, pid)) != PROCWATCH_OK)
+      printf("%s: %s\n", argv[i], Procwatch_error_string(error));
+  }
+
+  // the array is owned by the caller, sampling does not allocate memory
+  Procwatch_sample* samples = malloc(sizeof(Procwatch_sample) * (size_t) (argc - 1));
+  struct timespec interval = {INTERVAL_MS / 1000, (INTERVAL_MS % 1000) * 1000000};
+  for (int i = 0; samples && i < SAMPLES_TO_PRINT && Procwatch_count(pw); ++i) {
+    nanosleep(&interval, NULL);
+    size_t count;
+    if ((error = Procwatch_sample_all(pw, samples, (size_t) argc - 1, &count)) != PROCWATCH_OK) {
+      printf("%s\n", Procwatch_error_string(error));
+      break;
+    }
+    for (size_t j = 0; j < count; ++j) {
+      const Procwatch_sample* sample = &samples[j];
+      if (sample->Error == PROCWATCH_OK)
+        printf("%7d %-15s %c cpu %6.2f %% memory %9.2f MB read %8.2f MB/s write %8.2f MB/s\n",
+               sample->Pid,
+               sample->Name,
+               sample->State,
+               sample->Cpu_usage,
+               sample->Memory_usage,
+               sample->Disk_read_mb_usage,
+               sample->Disk_write_mb_usage);
+      else
+        printf("%7d %s\n", sample->Pid, Procwatch_error_string(sample->Error));
+    }
+  }
+
+  free(samples);
+  Procwatch_close(pw);
+  return 0;
+}
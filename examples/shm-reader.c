@@ -0,0 +1,71 @@
+// The example reader of the shared memory snapshot. Prints the latest sample of the publisher once per interval and
+// the history ring on start:
+//   process-watcher -batch csv -output /dev/null -shm watcher -shm-history 60 my-process
+//   process-watcher-shm-reader watcher 100
+
+#include "shmsnapshot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const int SAMPLES_TO_PRINT = 10;
+
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    printf("Usage: %s NAME [INTERVAL_MS]\n", argv[0]);
+    return 1;
+  }
+  long interval_ms = argc > 2 ? strtol(argv[2], NULL, 10) : 1000;
+  if (interval_ms <= 0)
+    interval_ms = 1000;
+
+  char* errormsg = NULL;
+  Shm_reader* reader = Shm_reader_open(argv[1], &errormsg);
+  if (!reader) {
+    printf("%s\n", errormsg);
+    free(errormsg);
+    return 1;
+  }
+
+  const Shm_layout* layout = reader->Layout;
+  int cpu = Shm_reader_metric(reader, "cpu_usage"), memory = Shm_reader_metric(reader, "memory_usage");
+  printf("%s (PID %d), %u metrics, history of %u points\n",
+         layout->Process_name,
+         layout->Pid,
+         layout->Metrics_count,
+         layout->History_capacity);
+
+  if (layout->History_capacity) {
+    Shm_point* points = malloc(sizeof(Shm_point) * layout->History_capacity);
+    size_t count = points ? Shm_reader_history(reader, points, layout->History_capacity) : 0;
+    for (size_t i = 0; i < count; ++i)
+      printf("history %lld: cpu %.2f %%, memory %.2f MB\n",
+             (long long) points[i].Time_ms,
+             cpu >= 0 ? points[i].Values[cpu] : 0.0,
+             memory >= 0 ? points[i].Values[memory] : 0.0);
+    free(points);
+  }
+
+  // reading does not call the system, only the sleep between samples does
+  struct timespec interval = {interval_ms / 1000, (interval_ms % 1000) * 1000000};
+  for (int i = 0; i < SAMPLES_TO_PRINT; ++i) {
+    Shm_sample sample;
+    if (Shm_reader_read(reader, &sample))
+      printf("sample %llu at %lld: cpu %.2f %% (p95 %.2f), memory %.2f MB (peak %.2f)\n",
+             (unsigned long long) sample.Samples_count,
+             (long long) sample.Time_ms,
+             cpu >= 0 ? sample.Values[cpu] : 0.0,
+             sample.Percentiles[0][1],
+             memory >= 0 ? sample.Values[memory] : 0.0,
+             sample.Peaks[1]);
+    else
+      printf("the publisher does not finish the update\n");
+    nanosleep(&interval, NULL);
+  }
+
+  Shm_reader_close(reader);
+  return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef __FDINFO_H
+#define __FDINFO_H
+
+#include "props.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Fd_entry
+ * Stores the information about one open file descriptor of the running process from '/proc/[pid]/fd' and
+ * '/proc/[pid]/fdinfo' directories. Contains the descriptor number, the target of descriptor, the current file offset
+ * and the speed of changing this offset.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  int Fd;                  //! Descriptor number
+  char* Target;            //! Target of descriptor (file path, 'socket:[inode]', 'pipe:[inode]', ...)
+  unsigned long long Pos;  //! Current file offset in bytes
+  int Flags;               //! Open flags (O_RDONLY, O_WRONLY, ...)
+  unsigned long long Size; //! File size in bytes (only for files opened read-only, otherwise 0)
+  double Rate_mb_usage;    //! Speed of changing the file offset in MB/s
+  long long Eta_sec;       //! Estimated time to the end of file in seconds or -1, if unknown
+
+  // private fields
+  unsigned long long __last_pos; // file offset from the previous update
+} Fd_entry;
+
+/**
+ * @brief Fd_list
+ * Stores the list of open file descriptors of the running process. Entries are sorted by the descriptor number.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  Fd_entry* Entries; //! Array of entries
+  size_t Count;      //! Number of entries
+
+  // private fields
+  Fd_entry* __prev;          // entries from the previous update
+  size_t __prev_count;       // number of entries from the previous update
+  size_t __capacity;         // capacity of both arrays
+  void* __dir;               // directory reader (reused between updates)
+  long long __last_monotime; // monotime in ms
+} Fd_list;
+
+/**
+ * @brief Fd_list_init
+ * Initializes the new Fd_list structure with default values.
+ * @return The pointer to the new structure
+ */
+EXTERNFUNC DECLFUNC Fd_list* Fd_list_init() ATTR(warn_unused_result);
+/**
+ * @brief Fd_list_update
+ * Reads the list of open file descriptors of the process with the passed PID. The offset of every descriptor is read
+ * from '/proc/[pid]/fdinfo/[fd]'. The speed of changing offsets is calculated between two calls of this function. If
+ * any error occurs during the update, stores the error message in the 'errormsg' parameter.
+ * @param list The pointer to the structure
+ * @param pid PID of the process
+ * @param errormsg Pointer to char array.
+ * @return Result of updating
+ */
+EXTERNFUNC DECLFUNC bool Fd_list_update(Fd_list* list, int pid, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Fd_list_find
+ * Searches for the entry by the descriptor number.
+ * @param list The pointer to the structure
+ * @param fd Descriptor number
+ * @return The pointer to the entry or NULL, if not found
+ */
+EXTERNFUNC DECLFUNC const Fd_entry* Fd_list_find(const Fd_list* list, int fd) ATTR(nonnull(1));
+/**
+ * @brief Fd_list_free
+ * Deletes the Fd_list structure.
+ * @param list The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Fd_list_free(Fd_list* list) ATTR(nonnull(1));
+
+#endif // __FDINFO_H
@@ -2,6 +2,8 @@
 #define __IOUTILS_H
 
 #include "props.h"
+#include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @brief SAFE_PASS_VARGS
@@ -139,4 +141,110 @@ EXTERNFUNC DECLFUNC void ftostr(double n, char** dst);
  * @param dst The array to store number
  */
 EXTERNFUNC DECLFUNC void ulltostr(unsigned long long n, char** dst);
+/**
+ * @brief monotime_ms
+ * Returns the current value of the monotonic clock in milliseconds. This value is not affected by changes of the system
+ * time and can be used only to calculate intervals.
+ * @return The monotonic time in milliseconds
+ */
+EXTERNFUNC DECLFUNC long long monotime_ms();
+/**
+ * @brief realtime_ms
+ * Returns the current system time in milliseconds since the Unix epoch.
+ * @return The system time in milliseconds
+ */
+EXTERNFUNC DECLFUNC long long realtime_ms();
+
+/**
+ * @brief Line_handler
+ * The pointer to the handler of lines. The handler returns false to stop reading.
+ */
+typedef bool (*Line_handler)(char* line, void* arg);
+/**
+ * @brief fdreadlines
+ * Reads the file by the passed descriptor line by line using the passed buffer, so the file is never read into memory
+ * completely and no memory is allocated. Every line without the trailing newline character is passed to the handler.
+ * Lines longer than the buffer are skipped.
+ *
+ * @code
+ * char buffer[4096];
+ * int fd = open("filename.txt", O_RDONLY);
+ * fdreadlines(fd, buffer, sizeof(buffer), handler, NULL);
+ * close(fd);
+ * @endcode
+ *
+ * @param fd The file descriptor
+ * @param buf The buffer
+ * @param size The buffer size
+ * @param handler The handler of lines
+ * @param arg The argument passed to the handler
+ * @return Number of bytes read or -1 if an error occurs
+ */
+EXTERNFUNC DECLFUNC long long fdreadlines(int fd, char* buf, size_t size, Line_handler handler, void* arg)
+    ATTR(nonnull(2, 4));
+
+#ifdef __linux__
+/**
+ * @brief Dir_reader
+ * Reads entries of a directory using the 'getdents64' system call. The buffer for directory entries is allocated once
+ * and reused for every directory opened with this reader, so walking large directories (for example '/proc/[pid]/fd'
+ * with thousands of descriptors) does not allocate memory.
+ *
+ * @code
+ * Dir_reader* reader = Dir_reader_init();
+ * if (Dir_reader_open(reader, "/proc/self/fd")) {
+ *   const char* name;
+ *   while ((name = Dir_reader_next(reader)) != NULL) {
+ *     // use name
+ *   }
+ *   Dir_reader_close(reader);
+ * }
+ * Dir_reader_free(reader);
+ * @endcode
+ */
+typedef struct
+{
+  int Fd; //! Descriptor of the opened directory or -1
+  // private fields
+  char* __buf;      // buffer for directory entries
+  size_t __bufsize; // buffer size
+  size_t __pos;     // position of the next entry in buffer
+  size_t __len;     // number of bytes in buffer
+} Dir_reader;
+
+/**
+ * @brief Dir_reader_init
+ * Initializes the new Dir_reader structure with default values.
+ * @return The pointer to the new structure
+ */
+EXTERNFUNC DECLFUNC Dir_reader* Dir_reader_init() ATTR(warn_unused_result);
+/**
+ * @brief Dir_reader_open
+ * Opens the directory for reading. If other directory is already opened by this reader, it will be closed.
+ * @param reader The pointer to the structure
+ * @param path The directory path
+ * @return Result of opening
+ */
+EXTERNFUNC DECLFUNC bool Dir_reader_open(Dir_reader* reader, const char* path) ATTR(nonnull(1, 2));
+/**
+ * @brief Dir_reader_next
+ * Returns the name of the next directory entry. The entries '.' and '..' are skipped. The returned pointer is valid
+ * until the next call of this function.
+ * @param reader The pointer to the structure
+ * @return The name of entry or NULL, if no more entries
+ */
+EXTERNFUNC DECLFUNC const char* Dir_reader_next(Dir_reader* reader) ATTR(nonnull(1));
+/**
+ * @brief Dir_reader_close
+ * Closes the opened directory. The buffer is not freed.
+ * @param reader The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Dir_reader_close(Dir_reader* reader) ATTR(nonnull(1));
+/**
+ * @brief Dir_reader_free
+ * Closes the opened directory and deletes the Dir_reader structure.
+ * @param reader The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Dir_reader_free(Dir_reader* reader) ATTR(nonnull(1));
+#endif
 #endif // __IOUTILS_H
@@ -0,0 +1,97 @@
+#ifndef __METRICS_H
+#define __METRICS_H
+
+#include "props.h"
+#include "process.h"
+
+/**
+ * @brief Metric_id
+ * Identifiers of numeric metrics of the process. These metrics are stored in the history, written to recordings and
+ * exported. Metrics with the 'self' prefix are the own cost of the watcher in the last finished tick, see Overhead.
+ */
+typedef enum
+{
+  METRIC_CPU_USAGE,
+  METRIC_MEMORY_USAGE,
+  METRIC_DISK_READ_MB_USAGE,
+  METRIC_DISK_WRITE_MB_USAGE,
+  METRIC_DISK_READ_KB,
+  METRIC_DISK_WRITTEN_KB,
+  METRIC_PRIORITY,
+  METRIC_OPEN_FDS,
+  METRIC_SOCKETS,
+  METRIC_SOCKET_RECV_QUEUE,
+  METRIC_SOCKET_SEND_QUEUE,
+  METRIC_NUMA_REMOTE_USAGE,
+  METRIC_THP_USAGE,
+  METRIC_SELF_CPU_MS,
+  METRIC_SELF_SYSCALLS,
+  METRIC_SELF_READ_BYTES,
+  METRIC_SELF_ALLOCATIONS,
+  METRIC_SELF_PROCESS_CPU_MS,
+  METRIC_SELF_FDS_CPU_MS,
+  METRIC_SELF_SOCKETS_CPU_MS,
+  METRIC_SELF_NUMA_CPU_MS,
+  METRIC_SELF_HISTORY_CPU_MS,
+  METRIC_SELF_RENDER_CPU_MS,
+  METRIC_SELF_OUTPUTS_CPU_MS,
+  METRIC_COUNT
+} Metric_id;
+
+/**
+ * @brief Metric_type
+ * Type of the metric. The value of a gauge can go up and down, the value of a counter only increases.
+ */
+typedef enum
+{
+  METRIC_GAUGE,
+  METRIC_COUNTER
+} Metric_type;
+
+/**
+ * @brief Metric_info
+ * Description of the metric.
+ */
+typedef struct
+{
+  const char* Name; //! Name in snake case (for example 'cpu_usage')
+  const char* Unit; //! Unit ('%', 'MB', 'MB/s', ...)
+  const char* Help; //! Short description
+  Metric_type Type; //! Type
+} Metric_info;
+
+/**
+ * @brief Metric_get_info
+ * Returns the description of the metric.
+ * @param id Identifier of the metric
+ * @return The pointer to the description or NULL, if the identifier is invalid
+ */
+EXTERNFUNC DECLFUNC const Metric_info* Metric_get_info(Metric_id id);
+/**
+ * @brief Metric_value
+ * Returns the current value of the metric from the Process_stat structure. Metrics of collectors, which are not
+ * initialized in this structure, are zeros.
+ * @param stat The pointer to the structure
+ * @param id Identifier of the metric
+ * @return The value
+ */
+EXTERNFUNC DECLFUNC double Metric_value(const Process_stat* stat, Metric_id id) ATTR(nonnull(1));
+/**
+ * @brief Metric_values
+ * Stores current values of all metrics to the array.
+ * @param stat The pointer to the structure
+ * @param values Array with METRIC_COUNT elements
+ */
+EXTERNFUNC DECLFUNC void Metric_values(const Process_stat* stat, double* values) ATTR(nonnull(1, 2));
+/**
+ * @brief Metric_set_value
+ * Sets the value of the metric in the Process_stat structure, for example from the recording. Metrics of collectors
+ * are not set, because these collectors are not restored from values.
+ * @param stat The pointer to the structure
+ * @param id Identifier of the metric
+ * @param value The value
+ * @return false, if this metric cannot be set
+ */
+EXTERNFUNC DECLFUNC bool Metric_set_value(Process_stat* stat, Metric_id id, double value) ATTR(nonnull(1));
+
+#endif // __METRICS_H
@@ -0,0 +1,70 @@
+#ifndef __NUMA_H
+#define __NUMA_H
+
+#include "props.h"
+#include <stdbool.h>
+
+#define NUMA_MAX_NODES 64
+#define NUMA_MAX_CPUS 4096
+
+/**
+ * @brief Numa_stat
+ * Stores the placement of the process memory on NUMA nodes from '/proc/[pid]/numa_maps' and the usage of transparent
+ * huge pages from '/proc/[pid]/smaps_rollup'. Nodes of CPUs, where threads of the process ran last time, are local
+ * nodes, other nodes are remote.
+ *
+ * Reading 'numa_maps' is expensive for processes with large heaps, so this structure is updated with its own interval.
+ * The cost of the last read is stored in this structure. If NUMA is not available in the system, all memory is placed
+ * on the single node.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  bool Numa_available;                          //! NUMA is available, otherwise single node view is used
+  int Nodes_count;                              //! Number of nodes
+  unsigned long long Node_memory_kb[NUMA_MAX_NODES]; //! Memory of the process on every node in KB
+  bool Node_local[NUMA_MAX_NODES];              //! The node is local for CPUs of the process
+  unsigned long long Total_memory_kb;           //! Total memory on all nodes in KB
+  double Remote_usage;                          //! Share of memory on remote nodes in percent
+  unsigned long long Anon_kb;                   //! Anonymous memory in KB
+  unsigned long long Anon_huge_pages_kb;        //! Anonymous memory backed by transparent huge pages in KB
+  double Thp_usage;                             //! Share of anonymous memory backed by huge pages in percent
+  long int Interval_ms;                         //! Interval between updates
+  double Read_cost_ms;                          //! Duration of the last read in ms
+  unsigned long long Read_bytes;                //! Number of bytes read during the last update
+  unsigned long long Updates;                   //! Number of updates
+
+  // private fields
+  int __cpu_node[NUMA_MAX_CPUS];       // node of every CPU
+  int __cpus_count;                    // number of CPUs in the map
+  long long __next_update_ms;          // monotime of the next update
+  char* __buf;                         // buffer for reading files
+  void* __dir;                         // directory reader for '/proc/[pid]/task'
+} Numa_stat;
+
+/**
+ * @brief Numa_stat_init
+ * Initializes the new Numa_stat structure. Reads the topology of NUMA nodes from '/sys/devices/system/node'.
+ * @param interval_ms Interval between updates in milliseconds
+ * @return The pointer to the new structure
+ */
+EXTERNFUNC DECLFUNC Numa_stat* Numa_stat_init(long int interval_ms) ATTR(warn_unused_result);
+/**
+ * @brief Numa_stat_update
+ * Updates the placement of memory of the process with the passed PID, if the interval since the last update is over.
+ * Otherwise does nothing. If any error occurs during the update, stores the error message in the 'errormsg'
+ * parameter.
+ * @param stat The pointer to the structure
+ * @param pid PID of the process
+ * @param errormsg Pointer to char array.
+ * @return Result of updating
+ */
+EXTERNFUNC DECLFUNC bool Numa_stat_update(Numa_stat* stat, int pid, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Numa_stat_free
+ * Deletes the Numa_stat structure.
+ * @param stat The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Numa_stat_free(Numa_stat* stat) ATTR(nonnull(1));
+
+#endif // __NUMA_H
@@ -0,0 +1,120 @@
+#ifndef __OVERHEAD_H
+#define __OVERHEAD_H
+
+#include "props.h"
+#include <stdbool.h>
+
+/**
+ * @brief Overhead_probe
+ * Measured parts of one tick of the watcher: collectors of Process_stat, drawing of the interface and outputs.
+ */
+typedef enum
+{
+  OVERHEAD_PROCESS, //! '/proc/[pid]/stat', 'status' and 'io'
+  OVERHEAD_FDS,     //! Open file descriptors
+  OVERHEAD_SOCKETS, //! Sockets
+  OVERHEAD_NUMA,    //! NUMA memory placement
+  OVERHEAD_HISTORY, //! History and sketches
+  OVERHEAD_RENDER,  //! Drawing of the interface
+  OVERHEAD_OUTPUTS, //! Recording, exporters and the batch writer
+  OVERHEAD_PROBES_COUNT
+} Overhead_probe;
+
+/**
+ * @brief Overhead_cost
+ * Resources spent by the calling thread.
+ */
+typedef struct
+{
+  double Cpu_ms;                 //! CPU time of the thread (CLOCK_THREAD_CPUTIME_ID)
+  double Wall_ms;                //! Elapsed time
+  unsigned long long Syscalls;   //! Read and write system calls ('syscr' and 'syscw' of '/proc/thread-self/io')
+  unsigned long long Read_bytes; //! Read bytes ('rchar' of '/proc/thread-self/io')
+  long long Allocations;         //! Heap allocations, see Overhead_allocations
+} Overhead_cost;
+
+/**
+ * @brief Overhead
+ * Measures the cost of the watcher itself per tick, so the perturbation of the watched process can be proved. Costs are
+ * differences of counters of the calling thread around every probe. The own reading of counters is calibrated once and
+ * subtracted. All probes must be used by the thread, which has created the structure.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ *
+ * @code
+ * Overhead_begin_tick(overhead);
+ * Overhead_begin(overhead, OVERHEAD_RENDER);
+ * draw();
+ * Overhead_end(overhead, OVERHEAD_RENDER);
+ * Overhead_end_tick(overhead);
+ * printf("%.3f ms\n", overhead->Tick.Cpu_ms);
+ * @endcode
+ */
+typedef struct
+{
+  unsigned long long Ticks_count;              //! Number of measured ticks
+  Overhead_cost Tick;                          //! Cost of the last tick
+  Overhead_cost Probes[OVERHEAD_PROBES_COUNT]; //! Costs of probes of the last tick
+
+  // private fields
+  Overhead_cost __tick_begin;                         // counters at the beginning of the tick
+  Overhead_cost __probe_begin[OVERHEAD_PROBES_COUNT]; // counters at the beginning of probes
+  Overhead_cost __current[OVERHEAD_PROBES_COUNT];     // costs of probes of the current tick
+  Overhead_cost __calibration;                        // cost of one reading of counters
+  int __readings;                                     // number of readings of counters in the current tick
+  int __io_fd;                                        // '/proc/thread-self/io' of the thread or -1
+} Overhead;
+
+/**
+ * @brief Overhead_init
+ * Initializes the new Overhead structure for the calling thread.
+ * @return The pointer to the new structure
+ */
+EXTERNFUNC DECLFUNC Overhead* Overhead_init() ATTR(warn_unused_result);
+/**
+ * @brief Overhead_begin_tick
+ * Starts the new tick, costs of probes of the previous tick stay in 'Probes' until Overhead_end_tick.
+ * @param overhead The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Overhead_begin_tick(Overhead* overhead) ATTR(nonnull(1));
+/**
+ * @brief Overhead_begin
+ * Starts the probe. Probes must not be nested.
+ * @param overhead The pointer to the structure
+ * @param probe The probe
+ */
+EXTERNFUNC DECLFUNC void Overhead_begin(Overhead* overhead, Overhead_probe probe) ATTR(nonnull(1));
+/**
+ * @brief Overhead_end
+ * Finishes the probe and adds its cost to the current tick.
+ * @param overhead The pointer to the structure
+ * @param probe The probe
+ */
+EXTERNFUNC DECLFUNC void Overhead_end(Overhead* overhead, Overhead_probe probe) ATTR(nonnull(1));
+/**
+ * @brief Overhead_end_tick
+ * Finishes the tick and publishes costs of the tick and its probes.
+ * @param overhead The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Overhead_end_tick(Overhead* overhead) ATTR(nonnull(1));
+/**
+ * @brief Overhead_probe_name
+ * Returns the name of the probe.
+ * @param probe The probe
+ * @return The static name
+ */
+EXTERNFUNC DECLFUNC const char* Overhead_probe_name(Overhead_probe probe);
+/**
+ * @brief Overhead_allocations
+ * Returns the number of heap allocations made by the calling thread. Allocations are counted, if the binary is linked
+ * with '-Wl,--wrap=malloc' (also calloc and realloc) and OVERHEAD_COUNT_ALLOCATIONS is defined.
+ * @return The number of allocations or -1, if allocations are not counted
+ */
+EXTERNFUNC DECLFUNC long long Overhead_allocations();
+/**
+ * @brief Overhead_free
+ * Deletes the Overhead structure.
+ * @param overhead The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Overhead_free(Overhead* overhead) ATTR(nonnull(1));
+
+#endif // __OVERHEAD_H
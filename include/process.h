@@ -2,6 +2,12 @@
 #define __PROCESS_H
 
 #include "props.h"
+#include "fdinfo.h"
+#include "sockets.h"
+#include "numa.h"
+#include "timeseries.h"
+#include "sketch.h"
+#include "overhead.h"
 #include <stdbool.h>
 
 /**
@@ -13,6 +19,31 @@
  * @return Return PID or -1
  */
 EXTERNFUNC DECLFUNC int pid_by_name(const char* name);
+/**
+ * @brief Process_tick
+ * System-wide data of one sampling tick shared by all watched processes: '/proc/stat' is read once per tick and every
+ * process is updated with the same timestamps.
+ */
+typedef struct
+{
+  unsigned long long Cpu_total; //! Sum of CPU times of the system
+  unsigned long long Boot_time; //! Boot time of the system in seconds since the epoch (only on Linux)
+  long long Monotime_ms;        //! Monotonic time of the tick
+  long long Realtime_ms;        //! Real time of the tick
+} Process_tick;
+
+/**
+ * @brief Process_files
+ * Contents of '/proc/[pid]' files of one process read by the caller, for example, by one batch of reads for many
+ * processes. The file, which cannot be read, is NULL.
+ */
+typedef struct
+{
+  const char* Stat; //! Contents of '/proc/[pid]/stat'
+  const char* Io;   //! Contents of '/proc/[pid]/io'
+  int Uid;          //! Owner of the process or -1
+} Process_files;
+
 /**
  * @brief Process_stat
  * Stores the information about the running process from '/proc/[pid]' directory. Contains PID, the process name, state,
@@ -45,6 +76,16 @@ typedef struct
   double Disk_write_mb_peak_usage;    //! Disk write usage
   unsigned long long Disk_read_kb;    //! Disk read kb
   unsigned long long Disk_written_kb; //! Disk written kb
+  Fd_list* Fds;                       //! Open file descriptors (NULL, if not collected)
+  Socket_list* Sockets;               //! Sockets (NULL, if not collected)
+  Numa_stat* Numa;                    //! NUMA memory placement (NULL, if not collected)
+  Timeseries* History;                //! History of metrics by the monotonic time (NULL, if not collected)
+  Sketch* Cpu_sketch;                 //! Quantiles of CPU usage (NULL, if not collected)
+  Sketch* Memory_sketch;              //! Quantiles of memory usage (NULL, if not collected)
+  Sketch* Disk_read_sketch;           //! Quantiles of disk read usage (NULL, if not collected)
+  Sketch* Disk_write_sketch;          //! Quantiles of disk write usage (NULL, if not collected)
+  Overhead* Overhead;                 //! Own cost of collectors (NULL, if not measured, it is not deleted)
+  bool Counters_only;                 //! CPU and disk rates are not calculated, the caller calculates them by counters
 
   // private fields
   unsigned long long __last_utime;     // user time
@@ -81,6 +122,24 @@ EXTERNFUNC DECLFUNC Process_stat* Process_stat_init() ATTR(warn_unused_result);
  */
 EXTERNFUNC DECLFUNC bool Process_stat_set_pid(Process_stat* stat, const char* processname, char** errormsg)
     ATTR(nonnull(1, 2));
+/**
+ * @brief Process_stat_attach
+ * Stores the PID of the running process to the passed Process_stat structure, the process name is read from
+ * '/proc/[pid]/comm'. If the process not found, stores the error message in the 'errormsg' parameter.
+ * @param stat The pointer to the structure
+ * @param pid PID of the process
+ * @param errormsg Pointer to char array.
+ * @return Result of searching for the process
+ */
+EXTERNFUNC DECLFUNC bool Process_stat_attach(Process_stat* stat, int pid, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Process_tick_read
+ * Reads system-wide data of the new tick. If any error occurs, stores the error message in the 'errormsg' parameter.
+ * @param tick The pointer to the structure
+ * @param errormsg Pointer to char array.
+ * @return Result of reading.
+ */
+EXTERNFUNC DECLFUNC bool Process_tick_read(Process_tick* tick, char** errormsg) ATTR(nonnull(1));
 /**
  * @brief Process_stat_update
  * Updates all public fields in the Process_stat structure. If any error occurs during the update, stores the error
@@ -90,6 +149,32 @@ EXTERNFUNC DECLFUNC bool Process_stat_set_pid(Process_stat* stat, const char* pr
  * @return Result of updating.
  */
 EXTERNFUNC DECLFUNC bool Process_stat_update(Process_stat* pstat, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Process_stat_update_tick
+ * Updates all public fields in the Process_stat structure with system-wide data of the tick, so many processes are
+ * updated with one reading of '/proc/stat' and one coherent timestamp. If any error occurs during the update, stores
+ * the error message in the 'errormsg' parameter.
+ * @param stat The pointer to the structure
+ * @param tick The pointer to data of the tick, see Process_tick_read
+ * @param errormsg Pointer to char array.
+ * @return Result of updating.
+ */
+EXTERNFUNC DECLFUNC bool Process_stat_update_tick(Process_stat* pstat, const Process_tick* tick, char** errormsg)
+    ATTR(nonnull(1, 2));
+/**
+ * @brief Process_stat_update_files
+ * Same as Process_stat_update_tick, but '/proc/[pid]/stat' and '/proc/[pid]/io' are not read, their contents are
+ * passed by the caller. If 'files' is NULL, files are read as usual. Only on Linux, files are ignored on other systems.
+ * @param stat The pointer to the structure
+ * @param tick The pointer to data of the tick, see Process_tick_read
+ * @param files The pointer to contents of files or NULL
+ * @param errormsg Pointer to char array.
+ * @return Result of updating.
+ */
+EXTERNFUNC DECLFUNC bool Process_stat_update_files(Process_stat* pstat,
+                                                   const Process_tick* tick,
+                                                   const Process_files* files,
+                                                   char** errormsg) ATTR(nonnull(1, 2));
 /**
  * @brief Process_stat_kill
  * Kills the current process by PID. If any error occurs during the destruction process, stores the error
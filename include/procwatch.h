@@ -0,0 +1,162 @@
+#ifndef __PROCWATCH_H
+#define __PROCWATCH_H
+
+#include "props.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PROCWATCH_NAME_SIZE 16 // size of the process name with the null character, see 'comm' in proc(5)
+
+/**
+ * @brief PROCWATCH_EXPORT
+ * Marks a function as the part of the shared library interface. Other symbols of the library are hidden.
+ */
+#if defined __GNUC__ || defined __MINGW32__
+#define PROCWATCH_EXPORT __attribute__((visibility("default")))
+#else
+#define PROCWATCH_EXPORT
+#endif
+
+/**
+ * @brief Procwatch_error
+ * Error codes of the library. Functions never allocate error messages, use Procwatch_error_string to get the static
+ * description of the code.
+ */
+typedef enum
+{
+  PROCWATCH_OK = 0,                 //! No error
+  PROCWATCH_ERROR_INVALID_ARGUMENT, //! Invalid argument or the array is too small
+  PROCWATCH_ERROR_NO_MEMORY,        //! Memory allocation failed
+  PROCWATCH_ERROR_NOT_FOUND,        //! The process does not exist or has exited
+  PROCWATCH_ERROR_ACCESS,           //! Access to the process information is denied
+  PROCWATCH_ERROR_IO,               //! Reading of the process information failed
+  PROCWATCH_ERROR_FORMAT,           //! The process information has an unexpected format
+  PROCWATCH_ERROR_FULL,             //! The handle has no free slots for targets
+  PROCWATCH_ERROR_EXISTS,           //! The process is already watched
+  PROCWATCH_ERROR_UNSUPPORTED,      //! The platform is not supported
+  PROCWATCH_ERRORS_COUNT
+} Procwatch_error;
+
+/**
+ * @brief Procwatch_sample
+ * One sample of the watched process. Rates are calculated since the previous sample of this process by the same
+ * handle, the first sample is calculated since Procwatch_watch. Other fields are valid only if 'Error' is
+ * PROCWATCH_OK.
+ */
+typedef struct
+{
+  int Pid;                            //! PID of the process
+  Procwatch_error Error;              //! Result of sampling of this process
+  char Name[PROCWATCH_NAME_SIZE];     //! The process name (the executable name truncated to 15 characters)
+  char State;                         //! State, see proc(5)
+  int Priority;                       //! Priority
+  int Threads;                        //! Number of threads
+  int Uid;                            //! Uid of the owner
+  double Cpu_usage;                   //! CPU usage in percent of all CPUs
+  double Memory_usage;                //! Resident memory in MB
+  double Disk_read_mb_usage;          //! Read rate in MB/s
+  double Disk_write_mb_usage;         //! Write rate in MB/s
+  unsigned long long Disk_read_kb;    //! Read KB
+  unsigned long long Disk_written_kb; //! Written KB
+  long long Time_ms;                  //! System time of the sample in milliseconds since the Unix epoch
+} Procwatch_sample;
+
+struct __Procwatch; // Forward declaration
+/**
+ * @brief Procwatch
+ * The handle of the sampling engine. The handle owns the fixed set of targets and descriptors of their '/proc' files,
+ * which are kept open between samples, so sampling of one target reads two files without opening them. The memory is
+ * allocated once by Procwatch_open.
+ *
+ * Handles do not share any state, so different handles can be used by different threads at the same time. One handle
+ * must not be used by several threads at the same time.
+ *
+ * @code
+ * Procwatch_error error;
+ * Procwatch* pw = Procwatch_open(64, &error);
+ * Procwatch_watch(pw, pid);
+ * Procwatch_sample samples[64];
+ * size_t count;
+ * if (Procwatch_sample_all(pw, samples, 64, &count) == PROCWATCH_OK)
+ *   for (size_t i = 0; i < count; ++i)
+ *     if (samples[i].Error == PROCWATCH_OK)
+ *       printf("%d %.2f\n", samples[i].Pid, samples[i].Cpu_usage);
+ * Procwatch_close(pw);
+ * @endcode
+ */
+typedef struct __Procwatch Procwatch;
+
+/**
+ * @brief Procwatch_open
+ * Creates the new handle with the passed number of target slots. Every target keeps two descriptors open.
+ * @param capacity Maximal number of watched processes
+ * @param error The pointer to the error code or NULL
+ * @return The pointer to the new handle or NULL
+ */
+EXTERNFUNC PROCWATCH_EXPORT DECLFUNC Procwatch* Procwatch_open(size_t capacity, Procwatch_error* error)
+    ATTR(warn_unused_result);
+/**
+ * @brief Procwatch_watch
+ * Adds the process to the targets of the handle and reads its first values.
+ * @param pw The pointer to the handle
+ * @param pid PID of the process
+ * @return The error code
+ */
+EXTERNFUNC PROCWATCH_EXPORT DECLFUNC Procwatch_error Procwatch_watch(Procwatch* pw, int pid) ATTR(nonnull(1));
+/**
+ * @brief Procwatch_unwatch
+ * Removes the process from the targets of the handle and closes its descriptors.
+ * @param pw The pointer to the handle
+ * @param pid PID of the process
+ * @return The error code
+ */
+EXTERNFUNC PROCWATCH_EXPORT DECLFUNC Procwatch_error Procwatch_unwatch(Procwatch* pw, int pid) ATTR(nonnull(1));
+/**
+ * @brief Procwatch_count
+ * Returns the number of watched processes.
+ * @param pw The pointer to the handle
+ * @return Number of targets
+ */
+EXTERNFUNC PROCWATCH_EXPORT DECLFUNC size_t Procwatch_count(const Procwatch* pw) ATTR(nonnull(1));
+/**
+ * @brief Procwatch_sample_all
+ * Samples all watched processes into the caller-owned array in the order of watching. The system CPU time is read once
+ * for all targets. Errors of single processes are stored in their samples, exited processes stay watched with the
+ * PROCWATCH_ERROR_NOT_FOUND code until Procwatch_unwatch. If the array is too small, nothing is sampled, the required
+ * size is stored in 'count' and PROCWATCH_ERROR_INVALID_ARGUMENT is returned.
+ * @param pw The pointer to the handle
+ * @param samples The array of samples
+ * @param capacity Size of the array
+ * @param count The pointer to the number of stored samples
+ * @return The error code
+ */
+EXTERNFUNC PROCWATCH_EXPORT DECLFUNC Procwatch_error Procwatch_sample_all(Procwatch* pw,
+                                                                         Procwatch_sample* samples,
+                                                                         size_t capacity,
+                                                                         size_t* count) ATTR(nonnull(1, 4));
+/**
+ * @brief Procwatch_find
+ * Searches for the PID of the running process by his name. The name is compared with the executable name from
+ * '/proc/[pid]/cmdline' and with '/proc/[pid]/comm'.
+ * @param pw The pointer to the handle
+ * @param name Process name
+ * @param pid The pointer to the found PID
+ * @return The error code
+ */
+EXTERNFUNC PROCWATCH_EXPORT DECLFUNC Procwatch_error Procwatch_find(Procwatch* pw, const char* name, int* pid)
+    ATTR(nonnull(1, 2, 3));
+/**
+ * @brief Procwatch_close
+ * Closes descriptors of all targets and deletes the handle.
+ * @param pw The pointer to the handle
+ */
+EXTERNFUNC PROCWATCH_EXPORT DECLFUNC void Procwatch_close(Procwatch* pw) ATTR(nonnull(1));
+/**
+ * @brief Procwatch_error_string
+ * Returns the static description of the error code.
+ * @param error The error code
+ * @return The description, it must not be freed
+ */
+EXTERNFUNC PROCWATCH_EXPORT DECLFUNC const char* Procwatch_error_string(Procwatch_error error);
+
+#endif // __PROCWATCH_H
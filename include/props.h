@@ -40,6 +40,16 @@
  * Macro makes the variable unused.
  */
 #define UNUSED(__var) (void) __var;
+/**
+ * @brief MIN, MAX
+ * The minimum and the maximum of two values. Arguments are evaluated twice.
+ */
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
 /**
  * @brief ASSERT
  * Prints the file and the line where the assertion failed.
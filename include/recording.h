@@ -0,0 +1,174 @@
+#ifndef __RECORDING_H
+#define __RECORDING_H
+
+#include "props.h"
+#include "metrics.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define RECORDING_BLOCK_SAMPLES 64 // samples in one block, the block is written to the file when it is full
+
+/**
+ * @brief Recording_writer
+ * Writes samples of metrics to the recording file. The file starts with the header, which contains the process name,
+ * PID, names and types of metrics and the offset of the real time. Samples are keyed by the monotonic time, so a step
+ * of the real time (NTP) does not reorder them, and the reader adds the offset to get the real time. Samples are
+ * grouped into blocks, every block starts with the fixed-size header with the number of samples and the time range of
+ * these samples, so the file can be range-queried without decoding all blocks. Blocks are appended to the file, when
+ * they are full, and on close.
+ *
+ * Inside the block, times are stored as varint-encoded delta-of-deltas, values of counters are stored as
+ * varint-encoded deltas and values of gauges are XORed with the previous value, only the meaningful bytes of the
+ * result are stored.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  unsigned long long Samples_count; //! Number of appended samples
+  unsigned long long Bytes_written; //! Number of bytes written to the file
+
+  // private fields
+  FILE* __file;                  // the recording file
+  unsigned char* __block;        // the current block, with the header
+  size_t __block_size;           // size of the current block
+  unsigned int __block_samples;  // number of samples in the current block
+  long long __first_time_ms;     // time of the first sample in the block
+  long long __last_time_ms;      // time of the last sample
+  long long __last_delta_ms;     // delta between the last two samples
+  double __last[METRIC_COUNT];   // values of the last sample
+} Recording_writer;
+
+/**
+ * @brief Recording_block
+ * The index entry of one block. Do not use it directly.
+ */
+typedef struct
+{
+  size_t Offset;         // offset of the block payload in the file
+  size_t Size;           // size of the payload
+  unsigned int Samples;  // number of samples
+  long long First_time;  // time of the first sample
+  long long Last_time;   // time of the last sample
+} Recording_block;
+
+/**
+ * @brief Recording_reader
+ * Reads samples from the recording file. The file is mapped to memory, blocks are indexed on open, so seeking to any
+ * time takes a binary search over blocks and decoding of one block. Samples are decoded sequentially, after seeking
+ * or from the begin of the file. The truncated last block is ignored.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  char* Process_name;               //! The recorded process name
+  int Pid;                          //! PID of the recorded process
+  size_t Metrics_count;             //! Number of metrics in the file
+  char** Metric_names;              //! Names of metrics
+  Metric_type* Metric_types;        //! Types of metrics
+  unsigned long long Samples_count; //! Number of samples
+  long long First_time_ms;          //! Time of the first sample
+  long long Last_time_ms;           //! Time of the last sample
+  long long Realtime_offset_ms;     //! Added to stored times of samples, all times of the reader are real times
+
+  // private fields
+  const unsigned char* __data;      // mapped file
+  size_t __size;                    // size of the file
+  Recording_block* __blocks;        // index of blocks
+  size_t __blocks_count;            // number of blocks
+  size_t __block;                   // index of the current block
+  unsigned int __sample;            // index of the next sample in the current block
+  size_t __pos;                     // position of the next sample in the current block
+  long long __time_ms;              // time of the last decoded sample
+  long long __delta_ms;             // delta between the last two decoded samples
+  double* __values;                 // values of the last decoded sample
+  bool __pending;                   // the last decoded sample is returned by the next call
+  void* __handle;                   // handle of the mapping (windows)
+} Recording_reader;
+
+/**
+ * @brief Recording_writer_open
+ * Creates the recording file and writes the header. The existing file is truncated. If any error occurs, stores the
+ * error message in the 'errormsg' parameter.
+ * @param path Path to the file
+ * @param process_name The process name
+ * @param pid PID of the process
+ * @param realtime_offset_ms Difference between the real time and times of samples (0, if times are real)
+ * @param errormsg Pointer to char array.
+ * @return The pointer to the new structure or NULL
+ */
+EXTERNFUNC DECLFUNC Recording_writer* Recording_writer_open(
+    const char* path, const char* process_name, int pid, long long realtime_offset_ms, char** errormsg)
+    ATTR(nonnull(1, 2));
+/**
+ * @brief Recording_writer_append
+ * Appends the sample of all metrics from the metrics catalogue. The block is written to the file, when it is full.
+ * If any error occurs, stores the error message in the 'errormsg' parameter.
+ * @param writer The pointer to the structure
+ * @param time_ms Time of the sample in milliseconds (the monotonic time), the decreased time is replaced by the time
+ * of the previous sample
+ * @param values Values of all metrics, see Metric_values
+ * @param errormsg Pointer to char array.
+ * @return Result of writing
+ */
+EXTERNFUNC DECLFUNC bool Recording_writer_append(
+    Recording_writer* writer, long long time_ms, const double* values, char** errormsg) ATTR(nonnull(1, 3));
+/**
+ * @brief Recording_writer_flush
+ * Writes the current block to the file, even if it is not full. If any error occurs, stores the error message in the
+ * 'errormsg' parameter.
+ * @param writer The pointer to the structure
+ * @param errormsg Pointer to char array.
+ * @return Result of writing
+ */
+EXTERNFUNC DECLFUNC bool Recording_writer_flush(Recording_writer* writer, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Recording_writer_close
+ * Writes the current block, closes the file and deletes the Recording_writer structure.
+ * @param writer The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Recording_writer_close(Recording_writer* writer) ATTR(nonnull(1));
+
+/**
+ * @brief Recording_reader_open
+ * Maps the recording file to memory, reads the header and indexes blocks. If any error occurs, stores the error
+ * message in the 'errormsg' parameter.
+ * @param path Path to the file
+ * @param errormsg Pointer to char array.
+ * @return The pointer to the new structure or NULL
+ */
+EXTERNFUNC DECLFUNC Recording_reader* Recording_reader_open(const char* path, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Recording_reader_seek
+ * Moves the reader to the first sample with the time greater than or equal to the passed time.
+ * @param reader The pointer to the structure
+ * @param time_ms The time in milliseconds
+ * @return false, if there are no samples after this time
+ */
+EXTERNFUNC DECLFUNC bool Recording_reader_seek(Recording_reader* reader, long long time_ms) ATTR(nonnull(1));
+/**
+ * @brief Recording_reader_next
+ * Decodes the next sample.
+ * @param reader The pointer to the structure
+ * @param time_ms The pointer to store the time of the sample
+ * @param values Array to store values of all metrics in the file, see Metrics_count
+ * @return false, if there are no more samples
+ */
+EXTERNFUNC DECLFUNC bool Recording_reader_next(Recording_reader* reader, long long* time_ms, double* values)
+    ATTR(nonnull(1, 2, 3));
+/**
+ * @brief Recording_reader_metric
+ * Returns index of the metric in the file by its name.
+ * @param reader The pointer to the structure
+ * @param name The metric name
+ * @return Index of the metric or -1
+ */
+EXTERNFUNC DECLFUNC int Recording_reader_metric(const Recording_reader* reader, const char* name) ATTR(nonnull(1, 2));
+/**
+ * @brief Recording_reader_close
+ * Unmaps the file and deletes the Recording_reader structure.
+ * @param reader The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Recording_reader_close(Recording_reader* reader) ATTR(nonnull(1));
+
+#endif // __RECORDING_H
@@ -0,0 +1,169 @@
+#ifndef __SHMSNAPSHOT_H
+#define __SHMSNAPSHOT_H
+
+#include "props.h"
+#include "process.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHM_SNAPSHOT_MAGIC 0x534D5750u // 'PWMS'
+#define SHM_SNAPSHOT_VERSION 1
+#define SHM_METRICS_MAX 32          // the layout does not change, when metrics are added to the catalogue
+#define SHM_METRIC_NAME_SIZE 32     // maximal length of the metric name with '\0'
+#define SHM_PROCESS_NAME_SIZE 256   // maximal length of the process name with '\0'
+#define SHM_PEAKS_COUNT 4           // CPU, memory, disk read and disk write
+#define SHM_PERCENTILES_COUNT 4     // p50, p95, p99 and max of the windowed view
+#define SHM_READ_ATTEMPTS 1000      // the reader gives up, if the writer does not finish the update
+
+/**
+ * @brief Shm_sample
+ * The latest sample. Values are stored by indexes of the catalogue, names of metrics are in the layout header.
+ */
+typedef struct
+{
+  int64_t Time_ms;                                            //! Real time of the sample
+  uint64_t Samples_count;                                     //! Number of published samples
+  double Values[SHM_METRICS_MAX];                             //! Values of metrics
+  double Peaks[SHM_PEAKS_COUNT];                              //! Peaks of CPU, memory, disk read and disk write
+  double Percentiles[SHM_PEAKS_COUNT][SHM_PERCENTILES_COUNT]; //! p50, p95, p99 and max of the same metrics
+} Shm_sample;
+
+/**
+ * @brief Shm_point
+ * The point of the history ring.
+ */
+typedef struct
+{
+  int64_t Time_ms;                //! Real time of the sample
+  double Values[SHM_METRICS_MAX]; //! Values of metrics
+} Shm_point;
+
+/**
+ * @brief Shm_layout
+ * The fixed layout of the shared memory object. The header is written once by the publisher. The sample and the
+ * history ring are guarded by the sequence counter (seqlock): the counter is odd while the publisher updates data,
+ * readers copy data and retry, if the counter is odd or has changed during the copy. Readers must check the magic and
+ * the version before using other fields.
+ */
+typedef struct
+{
+  uint32_t Magic;                                              //! SHM_SNAPSHOT_MAGIC
+  uint32_t Version;                                            //! SHM_SNAPSHOT_VERSION
+  uint64_t Size;                                               //! Size of the whole object
+  uint32_t Metrics_count;                                      //! Number of used metrics
+  uint32_t History_capacity;                                   //! Number of points in the history ring
+  int32_t Pid;                                                 //! PID of the watched process
+  char Process_name[SHM_PROCESS_NAME_SIZE];                    //! The watched process name
+  char Metric_names[SHM_METRICS_MAX][SHM_METRIC_NAME_SIZE];    //! Names of metrics
+  uint8_t Metric_types[SHM_METRICS_MAX];                       //! Types of metrics (Metric_type)
+
+  _Alignas(64)
+#ifdef _MSC_VER // TODO: support atomic
+      volatile
+#elif defined __GNUC__ || defined __MINGW32__
+      _Atomic
+#endif
+      uint64_t Sequence;                                       //! The seqlock counter
+  _Alignas(64) Shm_sample Sample;                              //! The latest sample
+  uint64_t History_count;                                      //! Number of points written to the ring
+  Shm_point History[];                                         //! The history ring
+} Shm_layout;
+
+/**
+ * @brief Shm_publisher
+ * Creates the shared memory object (/dev/shm/NAME) and publishes samples into it. Readers are other processes, so
+ * the history ring is a part of the object, it is filled from raw points of the history of the process
+ * (Process_stat.History) or from published samples, if the history is not collected.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  Shm_layout* Layout; //! The mapped object
+
+  // private fields
+  char* __name;                 // name of the object
+  unsigned long long __samples; // samples of the history of the process copied to the ring
+} Shm_publisher;
+
+/**
+ * @brief Shm_reader
+ * Maps the shared memory object of the publisher read-only. Reading does not call the system.
+ */
+typedef struct
+{
+  const Shm_layout* Layout; //! The mapped object
+} Shm_reader;
+
+/**
+ * @brief Shm_publisher_open
+ * Creates the shared memory object and writes the header. The existing object with the same name is replaced. If any
+ * error occurs, stores the error message in the 'errormsg' parameter.
+ * @param name Name of the object without '/'
+ * @param process_name The process name
+ * @param pid PID of the process
+ * @param history_capacity Number of points in the history ring (0 - without the history)
+ * @param errormsg Pointer to char array.
+ * @return The pointer to the new structure or NULL
+ */
+EXTERNFUNC DECLFUNC Shm_publisher* Shm_publisher_open(
+    const char* name, const char* process_name, int pid, size_t history_capacity, char** errormsg) ATTR(nonnull(1, 2));
+/**
+ * @brief Shm_publisher_publish
+ * Publishes metrics of the structure as the latest sample and appends new points of its history (or the sample, if
+ * the history is not collected) to the history ring.
+ * @param publisher The pointer to the publisher
+ * @param stat The pointer to the Process_stat structure
+ * @param time_ms Real time of the sample in milliseconds
+ */
+EXTERNFUNC DECLFUNC void Shm_publisher_publish(Shm_publisher* publisher, const Process_stat* stat, long long time_ms)
+    ATTR(nonnull(1, 2));
+/**
+ * @brief Shm_publisher_close
+ * Unmaps and removes the object (readers keep their mappings) and deletes the Shm_publisher structure.
+ * @param publisher The pointer to the publisher
+ */
+EXTERNFUNC DECLFUNC void Shm_publisher_close(Shm_publisher* publisher) ATTR(nonnull(1));
+/**
+ * @brief Shm_reader_open
+ * Maps the shared memory object and checks its magic and version. If any error occurs, stores the error message in
+ * the 'errormsg' parameter.
+ * @param name Name of the object without '/'
+ * @param errormsg Pointer to char array.
+ * @return The pointer to the new structure or NULL
+ */
+EXTERNFUNC DECLFUNC Shm_reader* Shm_reader_open(const char* name, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Shm_reader_metric
+ * Finds the metric by the name.
+ * @param reader The pointer to the reader
+ * @param name The metric name
+ * @return Index of the metric in values or -1
+ */
+EXTERNFUNC DECLFUNC int Shm_reader_metric(const Shm_reader* reader, const char* name) ATTR(nonnull(1, 2));
+/**
+ * @brief Shm_reader_read
+ * Copies the consistent latest sample.
+ * @param reader The pointer to the reader
+ * @param sample The pointer to store the sample
+ * @return false, if the publisher does not finish the update after SHM_READ_ATTEMPTS attempts
+ */
+EXTERNFUNC DECLFUNC bool Shm_reader_read(const Shm_reader* reader, Shm_sample* sample) ATTR(nonnull(1, 2));
+/**
+ * @brief Shm_reader_history
+ * Copies the consistent latest points of the history ring, the oldest point is the first.
+ * @param reader The pointer to the reader
+ * @param points Array to store points
+ * @param count Size of the array
+ * @return Number of copied points, or 0 if the publisher does not finish the update
+ */
+EXTERNFUNC DECLFUNC size_t Shm_reader_history(const Shm_reader* reader, Shm_point* points, size_t count)
+    ATTR(nonnull(1, 2));
+/**
+ * @brief Shm_reader_close
+ * Unmaps the object and deletes the Shm_reader structure.
+ * @param reader The pointer to the reader
+ */
+EXTERNFUNC DECLFUNC void Shm_reader_close(Shm_reader* reader) ATTR(nonnull(1));
+
+#endif // __SHMSNAPSHOT_H
@@ -0,0 +1,101 @@
+#ifndef __SKETCH_H
+#define __SKETCH_H
+
+#include "props.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SKETCH_SUB_BUCKETS 32   // buckets in every power of two, the relative error is less than 1/64
+#define SKETCH_MIN_EXPONENT -10 // values less than 2^-10 are counted as zeros
+#define SKETCH_MAX_EXPONENT 40  // values greater than 2^40 are counted in the last bucket
+#define SKETCH_BUCKETS_COUNT (1 + (SKETCH_MAX_EXPONENT - SKETCH_MIN_EXPONENT) * SKETCH_SUB_BUCKETS)
+#define SKETCH_WINDOW_SLOTS 10 // the windowed view moves with the step of 1/10 of the window
+
+/**
+ * @brief Sketch_histogram
+ * Log-linear histogram of values. Every power of two is split into the fixed number of linear buckets, so the memory
+ * footprint does not depend on the number of values and the relative error of quantiles is bounded.
+ */
+typedef struct
+{
+  unsigned long long Count;               //! Number of values
+  double Max;                             //! Exact maximum value
+  uint32_t Buckets[SKETCH_BUCKETS_COUNT]; //! Number of values in every bucket
+} Sketch_histogram;
+
+/**
+ * @brief Sketch_summary
+ * Quantiles of values in the histogram.
+ */
+typedef struct
+{
+  unsigned long long Count; //! Number of values
+  double P50;               //! Median
+  double P95;               //! 95th percentile
+  double P99;               //! 99th percentile
+  double Max;               //! Maximum value
+} Sketch_summary;
+
+/**
+ * @brief Sketch
+ * Streaming quantile sketch of one metric. Contains the lifetime view of all values and the windowed view of values
+ * added during the last 'Window_ms' milliseconds. Adding a value takes constant time. The windowed view is split into
+ * slots, the oldest slot is subtracted from the window when the window moves.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  long long Window_ms;       //! Duration of the windowed view
+  Sketch_histogram Lifetime; //! All values
+  Sketch_histogram Window;   //! Values of the last window
+
+  // private fields
+  Sketch_histogram __slots[SKETCH_WINDOW_SLOTS]; // parts of the window
+  int __slot;                                    // index of the current slot
+  long long __slot_end_ms;                       // end time of the current slot
+} Sketch;
+
+/**
+ * @brief Sketch_init
+ * Initializes the new Sketch structure.
+ * @param window_ms Duration of the windowed view in milliseconds
+ * @return The pointer to the new structure
+ */
+EXTERNFUNC DECLFUNC Sketch* Sketch_init(long long window_ms) ATTR(warn_unused_result);
+/**
+ * @brief Sketch_add
+ * Adds the value to the lifetime and windowed views. Negative values are counted as zeros.
+ * @param sketch The pointer to the structure
+ * @param time_ms Monotonic time of the value in milliseconds, must not decrease
+ * @param value The value
+ */
+EXTERNFUNC DECLFUNC void Sketch_add(Sketch* sketch, long long time_ms, double value) ATTR(nonnull(1));
+/**
+ * @brief Sketch_quantile
+ * Returns the approximate quantile of values in the histogram.
+ * @param hist The pointer to the histogram
+ * @param q The quantile from 0.0 to 1.0
+ * @return The quantile, or 0.0 if the histogram is empty
+ */
+EXTERNFUNC DECLFUNC double Sketch_quantile(const Sketch_histogram* hist, double q) ATTR(nonnull(1));
+/**
+ * @brief Sketch_summarize
+ * Calculates p50, p95, p99 and max of the histogram in one pass.
+ * @param hist The pointer to the histogram
+ * @param summary The pointer to store the result
+ */
+EXTERNFUNC DECLFUNC void Sketch_summarize(const Sketch_histogram* hist, Sketch_summary* summary) ATTR(nonnull(1, 2));
+/**
+ * @brief Sketch_reset
+ * Removes all values from the lifetime and windowed views.
+ * @param sketch The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Sketch_reset(Sketch* sketch) ATTR(nonnull(1));
+/**
+ * @brief Sketch_free
+ * Deletes the Sketch structure.
+ * @param sketch The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Sketch_free(Sketch* sketch) ATTR(nonnull(1));
+
+#endif // __SKETCH_H
@@ -0,0 +1,121 @@
+#ifndef __SOCKETS_H
+#define __SOCKETS_H
+
+#include "props.h"
+#include "fdinfo.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SOCKET_ADDRESS_SIZE 72
+#define SOCKET_TCP_STATES_COUNT 12
+
+/**
+ * @brief Socket_proto
+ * Protocol of the socket. Each protocol is read from its own file in the '/proc/[pid]/net' directory.
+ */
+typedef enum
+{
+  SOCKET_TCP,
+  SOCKET_TCP6,
+  SOCKET_UDP,
+  SOCKET_UDP6,
+  SOCKET_UNIX,
+  SOCKET_PROTO_COUNT
+} Socket_proto;
+
+/**
+ * @brief Socket_entry
+ * Stores the information about one socket of the running process. Contains the inode of the socket, the protocol,
+ * the state, addresses and the depth of the receive and send queues.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  unsigned long Inode;                //! Inode of the socket
+  Socket_proto Proto;                 //! Protocol
+  int State;                          //! State (for TCP, see the 'Socket_state_name' function)
+  unsigned long Recv_queue;           //! Bytes in the receive queue (Recv-Q)
+  unsigned long Send_queue;           //! Bytes in the send queue (Send-Q)
+  char Local[SOCKET_ADDRESS_SIZE];    //! Local address (path for UNIX sockets)
+  char Remote[SOCKET_ADDRESS_SIZE];   //! Remote address
+
+  // private fields
+  unsigned int __generation; // the last update, when this socket was seen in '/proc/[pid]/fd'
+  bool __found;              // the socket was found in '/proc/[pid]/net' files
+} Socket_entry;
+
+/**
+ * @brief Socket_list
+ * Stores sockets of the running process. Sockets are found by inodes from '/proc/[pid]/fd' and their information is
+ * read from '/proc/[pid]/net/{tcp,tcp6,udp,udp6,unix}'. The table inode -> socket is kept between updates and changed
+ * only for opened or closed sockets.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  Socket_entry* Entries;                                //! Array of sockets
+  size_t Count;                                         //! Number of sockets
+  unsigned int Proto_counts[SOCKET_PROTO_COUNT];        //! Number of sockets by protocol
+  unsigned int Tcp_state_counts[SOCKET_TCP_STATES_COUNT]; //! Number of TCP connections by state
+  unsigned long long Recv_queue_total;                  //! Total bytes in receive queues
+  unsigned long long Send_queue_total;                  //! Total bytes in send queues
+
+  // private fields
+  size_t __capacity;          // capacity of the entries array
+  long* __table;              // hash table inode -> index in the entries array (-1 = empty)
+  size_t __table_size;        // size of the hash table (power of two)
+  unsigned int __generation;  // update counter
+  char* __buf;                // buffer for reading files (reused between updates)
+  void* __dir;                // directory reader (reused between updates)
+} Socket_list;
+
+/**
+ * @brief Socket_list_init
+ * Initializes the new Socket_list structure with default values.
+ * @return The pointer to the new structure
+ */
+EXTERNFUNC DECLFUNC Socket_list* Socket_list_init() ATTR(warn_unused_result);
+/**
+ * @brief Socket_list_update
+ * Updates sockets of the process with the passed PID. If the passed Fd_list is not NULL, it must be already updated for
+ * this PID and its targets are used instead of reading '/proc/[pid]/fd' again. If any error occurs during the update,
+ * stores the error message in the 'errormsg' parameter.
+ * @param list The pointer to the structure
+ * @param pid PID of the process
+ * @param fds The pointer to the updated Fd_list or NULL
+ * @param errormsg Pointer to char array.
+ * @return Result of updating
+ */
+EXTERNFUNC DECLFUNC bool Socket_list_update(Socket_list* list, int pid, const Fd_list* fds, char** errormsg)
+    ATTR(nonnull(1));
+/**
+ * @brief Socket_list_find
+ * Searches for the socket by inode.
+ * @param list The pointer to the structure
+ * @param inode Inode of the socket
+ * @return The pointer to the socket or NULL, if not found
+ */
+EXTERNFUNC DECLFUNC const Socket_entry* Socket_list_find(const Socket_list* list, unsigned long inode)
+    ATTR(nonnull(1));
+/**
+ * @brief Socket_state_name
+ * Returns the name of the TCP state ('ESTABLISHED', 'LISTEN', ...).
+ * @param state The state
+ * @return The name of state
+ */
+EXTERNFUNC DECLFUNC const char* Socket_state_name(int state);
+/**
+ * @brief Socket_proto_name
+ * Returns the name of the protocol ('TCP', 'UDP6', ...).
+ * @param proto The protocol
+ * @return The name of protocol
+ */
+EXTERNFUNC DECLFUNC const char* Socket_proto_name(Socket_proto proto);
+/**
+ * @brief Socket_list_free
+ * Deletes the Socket_list structure.
+ * @param list The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Socket_list_free(Socket_list* list) ATTR(nonnull(1));
+
+#endif // __SOCKETS_H
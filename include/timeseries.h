@@ -0,0 +1,141 @@
+#ifndef __TIMESERIES_H
+#define __TIMESERIES_H
+
+#include "props.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Timeseries_resolution
+ * Resolution of points in the time series. The raw resolution stores every appended sample, other resolutions store
+ * min/max/avg of samples aggregated over 1 second, 10 seconds and 1 minute.
+ */
+typedef enum
+{
+  TIMESERIES_RAW,
+  TIMESERIES_1S,
+  TIMESERIES_10S,
+  TIMESERIES_1MIN,
+  TIMESERIES_RESOLUTIONS_COUNT
+} Timeseries_resolution;
+
+/**
+ * @brief Timeseries_point
+ * One point of the time series. For the raw resolution min, max and avg are equal to the sample value.
+ */
+typedef struct
+{
+  long long Time_ms;  //! Time of the sample or the begin of the aggregation period
+  double Min;         //! Minimum value
+  double Max;         //! Maximum value
+  double Avg;         //! Average value
+  unsigned int Count; //! Number of aggregated samples
+} Timeseries_point;
+
+/**
+ * @brief Timeseries_ring
+ * Ring of points for one resolution. Values of every metric are stored in the contiguous arrays.
+ * Do not use it directly.
+ */
+typedef struct
+{
+  long long Period_ms;  // aggregation period (0 for the raw resolution)
+  size_t Head;          // index of the newest point
+  size_t Count;         // number of stored points
+  long long* Times;     // times of points
+  double* Min;          // [metric * capacity + index]
+  double* Max;          // [metric * capacity + index]
+  double* Sum;          // [metric * capacity + index]
+  unsigned int* Counts; // number of samples in points
+} Timeseries_ring;
+
+/**
+ * @brief Timeseries
+ * Stores the history of metrics in memory. Every metric has a fixed-size ring for each resolution, so the memory
+ * footprint is bounded and does not change after initialization. All metrics are sampled together, so they share
+ * times of points. Times must not decrease, so the sampler keys points by the monotonic time and stores the offset
+ * of the real time for display.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  size_t Metrics_count;             //! Number of metrics
+  size_t Capacity;                  //! Number of points in each resolution
+  long long Realtime_offset_ms;     //! Added to times of points to get the real time (0, if times are real)
+  unsigned long long Samples_count; //! Number of samples appended since the initialization or the reset
+
+  // private fields
+  Timeseries_ring __rings[TIMESERIES_RESOLUTIONS_COUNT];
+} Timeseries;
+
+/**
+ * @brief Timeseries_init
+ * Initializes the new Timeseries structure. Memory for all points is allocated here.
+ * @param metrics_count Number of metrics
+ * @param capacity Number of points in each resolution
+ * @return The pointer to the new structure
+ */
+EXTERNFUNC DECLFUNC Timeseries* Timeseries_init(size_t metrics_count, size_t capacity) ATTR(warn_unused_result);
+/**
+ * @brief Timeseries_append
+ * Appends the sample of all metrics and updates aggregations of all resolutions. The oldest points are overwritten,
+ * when rings are full.
+ * @param ts The pointer to the structure
+ * @param time_ms Time of the sample in milliseconds, must not decrease
+ * @param values Array of values of all metrics
+ */
+EXTERNFUNC DECLFUNC void Timeseries_append(Timeseries* ts, long long time_ms, const double* values)
+    ATTR(nonnull(1, 3));
+/**
+ * @brief Timeseries_size
+ * Returns number of stored points of the resolution.
+ * @param ts The pointer to the structure
+ * @param res The resolution
+ * @return Number of points
+ */
+EXTERNFUNC DECLFUNC size_t Timeseries_size(const Timeseries* ts, Timeseries_resolution res) ATTR(nonnull(1));
+/**
+ * @brief Timeseries_get
+ * Gets the point of the metric by age. The age 0 is the newest point.
+ * @param ts The pointer to the structure
+ * @param metric Index of the metric
+ * @param res The resolution
+ * @param age Age of the point
+ * @param point The pointer to store the point
+ * @return false, if the point does not exist
+ */
+EXTERNFUNC DECLFUNC bool Timeseries_get(
+    const Timeseries* ts, size_t metric, Timeseries_resolution res, size_t age, Timeseries_point* point)
+    ATTR(nonnull(1, 5));
+/**
+ * @brief Timeseries_at
+ * Gets the point of the metric at the passed time. The finest resolution, which still contains this time, is used.
+ * @param ts The pointer to the structure
+ * @param metric Index of the metric
+ * @param time_ms The time in milliseconds
+ * @param point The pointer to store the point
+ * @return false, if the time is older than all stored points
+ */
+EXTERNFUNC DECLFUNC bool Timeseries_at(const Timeseries* ts, size_t metric, long long time_ms, Timeseries_point* point)
+    ATTR(nonnull(1, 4));
+/**
+ * @brief Timeseries_memory_size
+ * Returns number of bytes allocated for points.
+ * @param ts The pointer to the structure
+ * @return Number of bytes
+ */
+EXTERNFUNC DECLFUNC size_t Timeseries_memory_size(const Timeseries* ts) ATTR(nonnull(1));
+/**
+ * @brief Timeseries_reset
+ * Removes all points. Allocated memory is kept.
+ * @param ts The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Timeseries_reset(Timeseries* ts) ATTR(nonnull(1));
+/**
+ * @brief Timeseries_free
+ * Deletes the Timeseries structure.
+ * @param ts The pointer to the structure
+ */
+EXTERNFUNC DECLFUNC void Timeseries_free(Timeseries* ts) ATTR(nonnull(1));
+
+#endif // __TIMESERIES_H
@@ -0,0 +1,44 @@
+#include "adaptive.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+Adaptive_rate* Adaptive_rate_init(long int min_interval_ms, long int max_interval_ms, long int interval_ms)
+{
+  Adaptive_rate* rate = malloc(sizeof(Adaptive_rate));
+  ASSERT(rate != NULL, "rate (Adaptive_rate*) != NULL; malloc(...) returns NULL.");
+  rate->Min_interval_ms = min_interval_ms > 0 ? min_interval_ms : 1;
+  rate->Max_interval_ms = MAX(max_interval_ms, rate->Min_interval_ms);
+  rate->Interval_ms = MIN(MAX(interval_ms, rate->Min_interval_ms), rate->Max_interval_ms);
+  rate->Cpu_threshold = ADAPTIVE_CPU_THRESHOLD;
+  rate->Disk_threshold = ADAPTIVE_DISK_THRESHOLD;
+  rate->Memory_threshold = ADAPTIVE_MEMORY_THRESHOLD;
+  rate->__has_last = false;
+  rate->__last_cpu = 0.0;
+  rate->__last_disk = 0.0;
+  rate->__last_memory = 0.0;
+  return rate;
+}
+
+long int Adaptive_rate_update(Adaptive_rate* rate, const Process_stat* stat)
+{
+  double disk = stat->Disk_read_mb_usage + stat->Disk_write_mb_usage;
+  bool active = rate->__has_last && (fabs(stat->Cpu_usage - rate->__last_cpu) > rate->Cpu_threshold ||
+                                     fabs(disk - rate->__last_disk) > rate->Disk_threshold ||
+                                     fabs(stat->Memory_usage - rate->__last_memory) > rate->Memory_threshold);
+  rate->__has_last = true;
+  rate->__last_cpu = stat->Cpu_usage;
+  rate->__last_disk = disk;
+  rate->__last_memory = stat->Memory_usage;
+
+  if (active)
+    rate->Interval_ms = rate->Min_interval_ms;
+  else if (rate->Interval_ms < rate->Max_interval_ms) // exponential back off
+    rate->Interval_ms = MIN(rate->Interval_ms * 2, rate->Max_interval_ms);
+  return rate->Interval_ms;
+}
+
+void Adaptive_rate_free(Adaptive_rate* rate)
+{
+  free(rate);
+}
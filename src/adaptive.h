@@ -0,0 +1,61 @@
+#ifndef __ADAPTIVE_H
+#define __ADAPTIVE_H
+
+#include "../include/process.h"
+#include <stdbool.h>
+
+#define ADAPTIVE_CPU_THRESHOLD 5.0    // default threshold of the CPU usage change, in percent
+#define ADAPTIVE_DISK_THRESHOLD 1.0   // default threshold of the disk read and write rates change, in MB/s
+#define ADAPTIVE_MEMORY_THRESHOLD 1.0 // default threshold of the resident memory change, in MB
+
+/**
+ * @brief Adaptive_rate
+ * Chooses the sampling interval by the activity of the process. If the change of the CPU usage, disk rates or the
+ * resident memory since the previous sample exceeds its threshold, the interval falls to the minimum at once, so bursts
+ * are sampled with the highest rate. While the process is quiet, the interval is doubled up to the maximum. Rates of
+ * Process_stat are calculated by the real time between samples, so they stay correct for any interval.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  long int Min_interval_ms; //! The minimal interval
+  long int Max_interval_ms; //! The maximal interval
+  long int Interval_ms;     //! The current interval
+  double Cpu_threshold;     //! Threshold of the CPU usage change
+  double Disk_threshold;    //! Threshold of the sum of disk rates change
+  double Memory_threshold;  //! Threshold of the resident memory change
+
+  // private fields
+  bool __has_last;      // the previous sample exists
+  double __last_cpu;    // the CPU usage of the previous sample
+  double __last_disk;   // the sum of disk rates of the previous sample
+  double __last_memory; // the resident memory of the previous sample
+} Adaptive_rate;
+
+/**
+ * @brief Adaptive_rate_init
+ * Initializes the new Adaptive_rate structure with default thresholds. The first interval is the passed one limited
+ * by bounds.
+ * @param min_interval_ms The minimal interval
+ * @param max_interval_ms The maximal interval
+ * @param interval_ms The first interval
+ * @return The pointer to the structure
+ */
+DECLFUNC Adaptive_rate* Adaptive_rate_init(long int min_interval_ms, long int max_interval_ms, long int interval_ms)
+    ATTR(warn_unused_result);
+/**
+ * @brief Adaptive_rate_update
+ * Compares the new sample with the previous one and calculates the next interval.
+ * @param rate The pointer to the structure
+ * @param stat The pointer to the Process_stat structure with the new sample
+ * @return The next interval in milliseconds
+ */
+DECLFUNC long int Adaptive_rate_update(Adaptive_rate* rate, const Process_stat* stat) ATTR(nonnull(1, 2));
+/**
+ * @brief Adaptive_rate_free
+ * Deletes the Adaptive_rate structure.
+ * @param rate The pointer to the structure
+ */
+DECLFUNC void Adaptive_rate_free(Adaptive_rate* rate) ATTR(nonnull(1));
+
+#endif // __ADAPTIVE_H
@@ -0,0 +1,150 @@
+#include "batch.h"
+#include "ioutils.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const double MAX_FIXED_VALUE = 1e15; // greater values are formatted by printf
+
+static char Stdout_buffer[BATCH_BUFFER_SIZE]; // stdout can be flushed at exit, so its buffer is never freed
+
+// writes digits of the number, returns the length
+static size_t format_integer(char* dst, unsigned long long value)
+{
+  char digits[24];
+  size_t count = 0;
+  do {
+    digits[count++] = (char) ('0' + value % 10);
+    value /= 10;
+  } while (value);
+  for (size_t i = 0; i < count; ++i)
+    dst[i] = digits[count - 1 - i];
+  return count;
+}
+
+// writes the number with up to 3 digits after the point, returns the length
+static size_t format_value(char* dst, double value, Batch_format format)
+{
+  if (!isfinite(value)) {
+    if (format == BATCH_NDJSON) {
+      memcpy(dst, "null", 4);
+      return 4;
+    }
+    return 0; // empty field
+  }
+  if (fabs(value) >= MAX_FIXED_VALUE)
+    return (size_t) snprintf(dst, 32, "%.17g", value);
+
+  size_t length = 0;
+  unsigned long long scaled = (unsigned long long) llround(fabs(value) * 1000.0);
+  if (value < 0.0 && scaled)
+    dst[length++] = '-';
+  length += format_integer(dst + length, scaled / 1000);
+  unsigned int fraction = (unsigned int) (scaled % 1000);
+  if (fraction) {
+    dst[length++] = '.';
+    dst[length++] = (char) ('0' + fraction / 100);
+    fraction %= 100;
+    if (fraction) {
+      dst[length++] = (char) ('0' + fraction / 10);
+      fraction %= 10;
+      if (fraction)
+        dst[length++] = (char) ('0' + fraction);
+    }
+  }
+  return length;
+}
+
+Batch_format Batch_format_parse(const char* name)
+{
+  if (strcmp(name, "csv") == 0)
+    return BATCH_CSV;
+  if (strcmp(name, "json") == 0 || strcmp(name, "ndjson") == 0)
+    return BATCH_NDJSON;
+  return BATCH_NONE;
+}
+
+Batch_writer* Batch_writer_open(const char* path, Batch_format format, char** errormsg)
+{
+  FILE* file = stdout;
+  if (path && (file = fopen(path, "w")) == NULL) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Cannot open the file '", path, "': ", strerror(errno)));
+    return NULL;
+  }
+
+  Batch_writer* writer = malloc(sizeof(Batch_writer));
+  ASSERT(writer != NULL, "writer (Batch_writer*) != NULL; malloc(...) returns NULL.");
+  writer->Format = format;
+  writer->Samples_count = 0;
+  writer->__file = file;
+  writer->__close = path != NULL;
+  writer->__buffer = NULL;
+  if (writer->__close) {
+    writer->__buffer = malloc(BATCH_BUFFER_SIZE);
+    ASSERT(writer->__buffer != NULL, "writer->__buffer (char*) != NULL; malloc(...) returns NULL.");
+  }
+  setvbuf(file, writer->__buffer ? writer->__buffer : Stdout_buffer, _IOFBF, BATCH_BUFFER_SIZE);
+  writer->__last_flush_ms = monotime_ms();
+
+  for (int id = 0; id < METRIC_COUNT; ++id) {
+    const char* name = Metric_get_info((Metric_id) id)->Name;
+    int length = format == BATCH_NDJSON ? snprintf(writer->__keys[id], sizeof(writer->__keys[id]), ",\"%s\":", name)
+                                        : snprintf(writer->__keys[id], sizeof(writer->__keys[id]), ",");
+    writer->__keys_length[id] = (size_t) length;
+  }
+
+  if (format == BATCH_CSV) {
+    fputs("time_ms", file);
+    for (int id = 0; id < METRIC_COUNT; ++id)
+      fprintf(file, ",%s", Metric_get_info((Metric_id) id)->Name);
+    fputc('\n', file);
+  }
+  return writer;
+}
+
+bool Batch_writer_write(Batch_writer* writer, long long time_ms, const double* values, char** errormsg)
+{
+  char* line = writer->__line;
+  size_t length = 0;
+  if (writer->Format == BATCH_NDJSON) {
+    memcpy(line, "{\"time_ms\":", 11);
+    length = 11;
+  }
+  length += format_integer(line + length, (unsigned long long) (time_ms > 0 ? time_ms : 0));
+  for (int id = 0; id < METRIC_COUNT; ++id) {
+    memcpy(line + length, writer->__keys[id], writer->__keys_length[id]);
+    length += writer->__keys_length[id];
+    length += format_value(line + length, values[id], writer->Format);
+  }
+  if (writer->Format == BATCH_NDJSON)
+    line[length++] = '}';
+  line[length++] = '\n';
+
+  if (fwrite(line, 1, length, writer->__file) != length) {
+    strconcat(errormsg, 2, SAFE_PASS_VARGS("Cannot write the sample: ", strerror(errno)));
+    return false;
+  }
+  writer->Samples_count++;
+
+  // readers of the pipe see lines at least once per second
+  long long now = monotime_ms();
+  if (now - writer->__last_flush_ms >= BATCH_FLUSH_INTERVAL_MS) {
+    writer->__last_flush_ms = now;
+    if (fflush(writer->__file) != 0) {
+      strconcat(errormsg, 2, SAFE_PASS_VARGS("Cannot write the sample: ", strerror(errno)));
+      return false;
+    }
+  }
+  return true;
+}
+
+void Batch_writer_close(Batch_writer* writer)
+{
+  fflush(writer->__file);
+  if (writer->__close)
+    fclose(writer->__file);
+  free(writer->__buffer);
+  free(writer);
+}
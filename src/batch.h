@@ -0,0 +1,82 @@
+#ifndef __BATCH_H
+#define __BATCH_H
+
+#include "../include/process.h"
+#include "../include/metrics.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+#define BATCH_LINE_SIZE 4096      // maximal size of one line
+#define BATCH_BUFFER_SIZE 65536   // size of the output buffer
+#define BATCH_FLUSH_INTERVAL_MS 1000 // the buffer is flushed at least once per this interval
+
+/**
+ * @brief Batch_format
+ * Formats of the batch output.
+ */
+typedef enum
+{
+  BATCH_NONE,   // the batch mode is off
+  BATCH_CSV,    // comma-separated values with the header line
+  BATCH_NDJSON  // one JSON object per line
+} Batch_format;
+
+/**
+ * @brief Batch_writer
+ * Writes one line per sample in the CSV or NDJSON format without curses. Keys and the header are formatted once on
+ * opening, numbers are formatted into the line buffer of the structure, so writing a sample does not allocate memory.
+ * Lines are collected in the output buffer, which is flushed when it is full or once per second.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  Batch_format Format;              //! The output format
+  unsigned long long Samples_count; //! Number of written samples
+
+  // private fields
+  FILE* __file;                                  // the output file
+  bool __close;                                  // the file is closed by the writer
+  char* __buffer;                                // the output buffer (NULL for stdout)
+  char __keys[METRIC_COUNT][64];                 // preformatted prefixes of values
+  size_t __keys_length[METRIC_COUNT];            // lengths of prefixes
+  char __line[BATCH_LINE_SIZE];                  // the current line
+  long long __last_flush_ms;                     // monotime of the last flush
+} Batch_writer;
+
+/**
+ * @brief Batch_format_parse
+ * Returns the format by the name ('csv' or 'json').
+ * @param name The name of the format
+ * @return The format or BATCH_NONE, if the name is unknown
+ */
+DECLFUNC Batch_format Batch_format_parse(const char* name) ATTR(nonnull(1));
+/**
+ * @brief Batch_writer_open
+ * Opens the output file and writes the CSV header. If any error occurs, stores the error message in the 'errormsg'
+ * parameter.
+ * @param path Path to the output file or NULL for stdout
+ * @param format The output format
+ * @param errormsg Pointer to char array.
+ * @return The pointer to the new structure or NULL
+ */
+DECLFUNC Batch_writer* Batch_writer_open(const char* path, Batch_format format, char** errormsg);
+/**
+ * @brief Batch_writer_write
+ * Writes the line with the time and metrics of the sample. Values are written with 3 digits after the point. If any
+ * error occurs (for example, the reader of the pipe is closed), stores the error message in the 'errormsg' parameter.
+ * @param writer The pointer to the structure
+ * @param time_ms Real time of the sample in milliseconds
+ * @param values Values of all metrics of the catalogue
+ * @param errormsg Pointer to char array.
+ * @return true if the line is written
+ */
+DECLFUNC bool Batch_writer_write(Batch_writer* writer, long long time_ms, const double* values, char** errormsg)
+    ATTR(nonnull(1, 3));
+/**
+ * @brief Batch_writer_close
+ * Flushes the buffer, closes the output file and deletes the Batch_writer structure.
+ * @param writer The pointer to the structure
+ */
+DECLFUNC void Batch_writer_close(Batch_writer* writer) ATTR(nonnull(1));
+
+#endif // __BATCH_H
@@ -1,5 +1,6 @@
 #include "cmdargs.h"
 #include "ioutils.h"
+#include "statsd.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -7,6 +8,100 @@
 
 static const int DEFAULT_REFRESH_TIMEOUT_MS = 1000; // default refresh timeout
 static const int INCORRECT_REFRESH_TIMEOUT_MS = -1;
+static const int DEFAULT_ADAPTIVE_MIN_MS = 100;    // default minimal interval of the adaptive sampling
+static const int DEFAULT_ADAPTIVE_MAX_MS = 5000;   // default maximal interval of the adaptive sampling
+static const int DEFAULT_WORKERS = 1;              // default number of threads to sample many targets
+static const int DEFAULT_NUMA_INTERVAL_MS = 10000; // default interval to read '/proc/[pid]/numa_maps'
+static const int DEFAULT_HISTORY_SIZE = 3600;      // default number of points in the history of every resolution
+static const int DEFAULT_QUANTILE_WINDOW_MIN = 5;  // default duration of the windowed view of quantiles
+static const int DEFAULT_STATSD_INTERVAL_MS = 10000; // default interval to push metrics to statsd
+static const int DEFAULT_STATSD_MTU = 1432;          // default maximal size of statsd datagrams
+static const char* DEFAULT_STATSD_PREFIX = "process_watcher";
+
+// reads the string after the option, if this string is missing, stores the error message
+static bool read_string(Cmd_args* cmdargs, int argc, char** argv, int* i, char** dst)
+{
+  const char* option = argv[*i];
+  if (*i + 1 >= argc) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg, 3, SAFE_PASS_VARGS("No the value after '", option, "' option."));
+    return false;
+  }
+
+  const char* value = argv[++(*i)];
+  free(*dst);
+  *dst = malloc(sizeof(char) * strlen(value) + 1);
+  ASSERT(*dst != NULL, "dst (char*) != NULL; malloc(...) returns NULL.");
+  strcpy(*dst, value);
+  return true;
+}
+
+// reads the positive number after the option, if this number is missing or incorrect, stores the error message
+static bool read_positive_number(Cmd_args* cmdargs, int argc, char** argv, int* i, long int* dst)
+{
+  const char* option = argv[*i];
+  if (*i + 1 >= argc) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg, 3, SAFE_PASS_VARGS("No the value after '", option, "' option."));
+    return false;
+  }
+
+  long int value = strtol(argv[++(*i)], NULL, 10);
+  if (value <= 0) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg, 3, SAFE_PASS_VARGS("Incorrect the value after '", option, "' option."));
+    return false;
+  }
+  *dst = value;
+  return true;
+}
+
+// adds the target (the process name or PID), the first target is the process name
+static void add_target(Cmd_args* cmdargs, const char* target, size_t length)
+{
+  cmdargs->Targets = realloc(cmdargs->Targets, sizeof(char*) * (size_t) (cmdargs->Targets_count + 1));
+  ASSERT(cmdargs->Targets != NULL, "cmdargs->Targets (char**) != NULL; realloc(...) returns NULL.");
+  char* copy = malloc(sizeof(char) * length + 1);
+  ASSERT(copy != NULL, "copy (char*) != NULL; malloc(...) returns NULL.");
+  memcpy(copy, target, length);
+  copy[length] = '\0';
+  cmdargs->Targets[cmdargs->Targets_count++] = copy;
+
+  if (!cmdargs->Process_name) {
+    cmdargs->Process_name = malloc(sizeof(char) * length + 1);
+    ASSERT(cmdargs->Process_name != NULL, "cmdargs->Process_name (char*) != NULL; malloc(...) returns NULL.");
+    strcpy(cmdargs->Process_name, copy);
+  }
+}
+
+// adds targets from the file: one name or PID per line, empty lines and lines starting with '#' are skipped
+static bool read_watch_list(Cmd_args* cmdargs)
+{
+  char* content = NULL;
+  if (fgetall(cmdargs->Watch_list_path, &content) == -1) {
+    cmdargs->Valid = false;
+    strconcat(
+        &cmdargs->Errormsg, 3, SAFE_PASS_VARGS("Unable to read the watch list '", cmdargs->Watch_list_path, "'."));
+    free(content);
+    return false;
+  }
+
+  for (const char* line = content; *line != '\0';) {
+    size_t length = strcspn(line, "\r\n");
+    const char *begin = line, *end = line + length;
+    while (begin < end && (*begin == ' ' || *begin == '\t'))
+      ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t'))
+      --end;
+    if (begin < end && *begin != '#')
+      add_target(cmdargs, begin, (size_t) (end - begin));
+
+    line += length;
+    line += strspn(line, "\r\n");
+  }
+  free(content);
+  return true;
+}
 
 Cmd_args* Cmd_args_init(int argc, char** argv)
 {
@@ -14,8 +109,32 @@ Cmd_args* Cmd_args_init(int argc, char** argv)
   ASSERT(cmdargs != NULL, "cmdargs (CmdArgs*) != NULL; malloc(...) returns NULL.");
   cmdargs->Valid = argc > 1;
   cmdargs->Process_name = NULL;
+  cmdargs->Targets = NULL;
+  cmdargs->Targets_count = 0;
+  cmdargs->Watch_list_path = NULL;
+  cmdargs->Top = 0;
+  cmdargs->Workers = DEFAULT_WORKERS;
+  cmdargs->Batched_reads = false;
+  cmdargs->Reader_backend = PROC_READER_PREAD;
   cmdargs->Errormsg = NULL;
   cmdargs->Refresh_timeout_ms = INCORRECT_REFRESH_TIMEOUT_MS;
+  cmdargs->Adaptive = false;
+  cmdargs->Adaptive_min_ms = DEFAULT_ADAPTIVE_MIN_MS;
+  cmdargs->Adaptive_max_ms = DEFAULT_ADAPTIVE_MAX_MS;
+  cmdargs->Numa_interval_ms = DEFAULT_NUMA_INTERVAL_MS;
+  cmdargs->History_size = DEFAULT_HISTORY_SIZE;
+  cmdargs->Quantile_window_min = DEFAULT_QUANTILE_WINDOW_MIN;
+  cmdargs->Record_path = NULL;
+  cmdargs->Replay_path = NULL;
+  cmdargs->Batch = BATCH_NONE;
+  cmdargs->Output_path = NULL;
+  cmdargs->Prometheus_address = NULL;
+  cmdargs->Shm_name = NULL;
+  cmdargs->Shm_history_size = 0;
+  cmdargs->Statsd_address = NULL;
+  cmdargs->Statsd_prefix = NULL;
+  cmdargs->Statsd_interval_ms = DEFAULT_STATSD_INTERVAL_MS;
+  cmdargs->Statsd_mtu = DEFAULT_STATSD_MTU;
 
   if (!cmdargs->Valid) {
     print_help();
@@ -41,18 +160,161 @@ Cmd_args* Cmd_args_init(int argc, char** argv)
 
           break;
         }
+      } else if (strcmp(arg, "-adaptive") == 0) {
+        cmdargs->Adaptive = true;
+      } else if (strcmp(arg, "-adaptive-min-ms") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->Adaptive_min_ms))
+          break;
+      } else if (strcmp(arg, "-adaptive-max-ms") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->Adaptive_max_ms))
+          break;
+      } else if (strcmp(arg, "-numa-interval-ms") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->Numa_interval_ms))
+          break;
+      } else if (strcmp(arg, "-history-size") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->History_size))
+          break;
+      } else if (strcmp(arg, "-quantile-window-min") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->Quantile_window_min))
+          break;
+      } else if (strcmp(arg, "-watch-list") == 0) {
+        if (!read_string(cmdargs, argc, argv, &i, &cmdargs->Watch_list_path))
+          break;
+      } else if (strcmp(arg, "-top") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->Top))
+          break;
+      } else if (strcmp(arg, "-workers") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->Workers))
+          break;
+      } else if (strcmp(arg, "-proc-reader") == 0) {
+        char* backend = NULL;
+        if (!read_string(cmdargs, argc, argv, &i, &backend))
+          break;
+        cmdargs->Batched_reads = true;
+        if (strcmp(backend, Proc_reader_backend_name(PROC_READER_IO_URING)) == 0)
+          cmdargs->Reader_backend = PROC_READER_IO_URING;
+        else if (strcmp(backend, Proc_reader_backend_name(PROC_READER_PREAD)) != 0)
+          cmdargs->Valid = false;
+        free(backend);
+        if (!cmdargs->Valid) {
+          strconcat(&cmdargs->Errormsg, 1, SAFE_PASS_VARGS("Incorrect the value after '-proc-reader' option."));
+          break;
+        }
+      } else if (strcmp(arg, "-record") == 0) {
+        if (!read_string(cmdargs, argc, argv, &i, &cmdargs->Record_path))
+          break;
+      } else if (strcmp(arg, "-replay") == 0) {
+        if (!read_string(cmdargs, argc, argv, &i, &cmdargs->Replay_path))
+          break;
+      } else if (strcmp(arg, "-batch") == 0) {
+        char* format = NULL;
+        if (!read_string(cmdargs, argc, argv, &i, &format))
+          break;
+        cmdargs->Batch = Batch_format_parse(format);
+        free(format);
+        if (cmdargs->Batch == BATCH_NONE) {
+          cmdargs->Valid = false;
+          strconcat(&cmdargs->Errormsg, 1, SAFE_PASS_VARGS("Incorrect the value after '-batch' option."));
+          break;
+        }
+      } else if (strcmp(arg, "-output") == 0) {
+        if (!read_string(cmdargs, argc, argv, &i, &cmdargs->Output_path))
+          break;
+      } else if (strcmp(arg, "-prometheus") == 0) {
+        if (!read_string(cmdargs, argc, argv, &i, &cmdargs->Prometheus_address))
+          break;
+      } else if (strcmp(arg, "-shm") == 0) {
+        if (!read_string(cmdargs, argc, argv, &i, &cmdargs->Shm_name))
+          break;
+      } else if (strcmp(arg, "-shm-history") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->Shm_history_size))
+          break;
+      } else if (strcmp(arg, "-statsd") == 0) {
+        if (!read_string(cmdargs, argc, argv, &i, &cmdargs->Statsd_address))
+          break;
+      } else if (strcmp(arg, "-statsd-prefix") == 0) {
+        if (!read_string(cmdargs, argc, argv, &i, &cmdargs->Statsd_prefix))
+          break;
+      } else if (strcmp(arg, "-statsd-interval-ms") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->Statsd_interval_ms))
+          break;
+      } else if (strcmp(arg, "-statsd-mtu") == 0) {
+        if (!read_positive_number(cmdargs, argc, argv, &i, &cmdargs->Statsd_mtu))
+          break;
+        if (cmdargs->Statsd_mtu < STATSD_MAX_LINE_SIZE) {
+          cmdargs->Valid = false;
+          strconcat(&cmdargs->Errormsg, 1, SAFE_PASS_VARGS("The '-statsd-mtu' value is less than 512 bytes."));
+          break;
+        }
       } else {
-        cmdargs->Process_name = malloc(sizeof(char) * strlen(arg) + 1);
-        strcpy(cmdargs->Process_name, arg);
+        add_target(cmdargs, arg, strlen(arg));
       }
     }
   }
 
-  if (cmdargs->Valid && cmdargs->Process_name == NULL) {
+  if (cmdargs->Valid && cmdargs->Watch_list_path)
+    read_watch_list(cmdargs);
+
+  if (cmdargs->Valid && cmdargs->Replay_path && (cmdargs->Process_name || cmdargs->Record_path)) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg,
+              1,
+              SAFE_PASS_VARGS("The process name and '-record' option cannot be used with '-replay' option."));
+  }
+
+  if (cmdargs->Valid && cmdargs->Batch != BATCH_NONE && cmdargs->Replay_path) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg, 1, SAFE_PASS_VARGS("The '-batch' option cannot be used with '-replay' option."));
+  }
+
+  if (cmdargs->Valid && cmdargs->Adaptive && cmdargs->Replay_path) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg, 1, SAFE_PASS_VARGS("The '-adaptive' option cannot be used with '-replay' option."));
+  }
+
+  if (cmdargs->Valid && cmdargs->Adaptive_min_ms > cmdargs->Adaptive_max_ms) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg,
+              1,
+              SAFE_PASS_VARGS("The '-adaptive-min-ms' value is greater than the '-adaptive-max-ms' value."));
+  }
+
+  if (cmdargs->Valid && cmdargs->Targets_count > 1 &&
+      (cmdargs->Record_path || cmdargs->Batch != BATCH_NONE || cmdargs->Prometheus_address || cmdargs->Shm_name ||
+       cmdargs->Statsd_address || cmdargs->Adaptive)) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg,
+              1,
+              SAFE_PASS_VARGS("Many targets cannot be used with '-record', '-batch', '-prometheus', '-shm', '-statsd' "
+                              "and '-adaptive' options."));
+  }
+
+  if (cmdargs->Valid && cmdargs->Top > 0 &&
+      (cmdargs->Process_name || cmdargs->Replay_path || cmdargs->Record_path || cmdargs->Batch != BATCH_NONE ||
+       cmdargs->Prometheus_address || cmdargs->Shm_name || cmdargs->Statsd_address || cmdargs->Adaptive)) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg,
+              1,
+              SAFE_PASS_VARGS("The '-top' option cannot be used with process names, '-watch-list', '-replay', "
+                              "'-record', '-batch', '-prometheus', '-shm', '-statsd' and '-adaptive' options."));
+  }
+
+  if (cmdargs->Valid && cmdargs->Output_path && cmdargs->Batch == BATCH_NONE) {
+    cmdargs->Valid = false;
+    strconcat(&cmdargs->Errormsg, 1, SAFE_PASS_VARGS("The '-output' option requires '-batch' option."));
+  }
+
+  if (cmdargs->Valid && cmdargs->Process_name == NULL && cmdargs->Replay_path == NULL && cmdargs->Top == 0) {
     cmdargs->Valid = false;
     strconcat(&cmdargs->Errormsg, 1, SAFE_PASS_VARGS("Incorrect process name for watching..."));
   }
 
+  if (cmdargs->Valid && cmdargs->Statsd_prefix == NULL) {
+    cmdargs->Statsd_prefix = malloc(strlen(DEFAULT_STATSD_PREFIX) + 1);
+    ASSERT(cmdargs->Statsd_prefix != NULL, "cmdargs->Statsd_prefix (char*) != NULL; malloc(...) returns NULL.");
+    strcpy(cmdargs->Statsd_prefix, DEFAULT_STATSD_PREFIX);
+  }
+
   if (cmdargs->Valid && cmdargs->Refresh_timeout_ms <= 0)
     cmdargs->Refresh_timeout_ms = DEFAULT_REFRESH_TIMEOUT_MS;
 
@@ -62,6 +324,17 @@ Cmd_args* Cmd_args_init(int argc, char** argv)
 void Cmd_args_free(Cmd_args* args)
 {
   free(args->Process_name);
+  for (int i = 0; i < args->Targets_count; ++i)
+    free(args->Targets[i]);
+  free(args->Targets);
+  free(args->Watch_list_path);
+  free(args->Record_path);
+  free(args->Replay_path);
+  free(args->Output_path);
+  free(args->Prometheus_address);
+  free(args->Shm_name);
+  free(args->Statsd_address);
+  free(args->Statsd_prefix);
   free(args->Errormsg);
 
   free(args);
@@ -72,10 +345,38 @@ void print_help()
   // clang-format off
   char * helpmsg = NULL;
   strconcat(&helpmsg, (unsigned short)-1 /* any string length */ , SAFE_PASS_VARGS(
-    "Usage: ", __BINARY_NAME, " OPTIONS... process-name \n",
-    "Show information about the specified process.\n",
+    "Usage: ", __BINARY_NAME, " OPTIONS... process-name|PID... \n",
+    "       ", __BINARY_NAME, " OPTIONS... -watch-list FILE \n",
+    "       ", __BINARY_NAME, " OPTIONS... -replay FILE \n",
+    "       ", __BINARY_NAME, " OPTIONS... -top N \n",
+    "Show information about the specified process. Many processes are shown in the sortable table.\n",
     "Arguments. \n",
-    "\t-refresh-timeout-ms N                  Timeout to refresh the information about the specified process.",
+    "\t-refresh-timeout-ms N                  Timeout to refresh the information about the specified process.\n",
+    "\t-adaptive                              Sample faster, when CPU, disk or memory usage changes, and back off,\n",
+    "\t                                       when the process is quiet.\n",
+    "\t-adaptive-min-ms N                     Minimal interval of the adaptive sampling (default 100 ms).\n",
+    "\t-adaptive-max-ms N                     Maximal interval of the adaptive sampling (default 5000 ms).\n",
+    "\t-watch-list FILE                       Watch processes from the file: one name or PID per line, '#' comments.\n",
+    "\t-top N                                 Show N processes of the host with the largest CPU usage, F2 - next\n",
+    "\t                                       column, Up/Down - select, Enter - watch the selected process.\n",
+    "\t-workers N                             Number of threads to sample many targets (default 1).\n",
+    "\t-proc-reader pread|io_uring            Keep files of many targets opened and read them by one batch per tick,\n",
+    "\t                                       'io_uring' falls back to 'pread', if it is not available.\n",
+    "\t-numa-interval-ms N                    Interval to read the NUMA memory placement (default 10000 ms).\n",
+    "\t-history-size N                        Number of points in the history of every resolution (default 3600).\n",
+    "\t-quantile-window-min N                 Duration of the windowed view of percentiles (default 5 minutes).\n",
+    "\t-record FILE                           Record samples of metrics to the file.\n",
+    "\t-replay FILE                           Replay the recording: Space - pause, 1/2/3 - speed 1x/10x/100x,\n",
+    "\t                                       Left/Right - seek 1 minute, PgUp/PgDn - seek 1 hour, Home/End.\n",
+    "\t-batch csv|json                        Write one line per sample in CSV or NDJSON without the interface.\n",
+    "\t-output FILE                           Write lines of the batch mode to the file instead of stdout.\n",
+    "\t-prometheus PORT|HOST:PORT|unix:PATH   Serve metrics for Prometheus on '/metrics' (PORT binds 127.0.0.1).\n",
+    "\t-shm NAME                              Publish the latest sample to the shared memory '/dev/shm/NAME'.\n",
+    "\t-shm-history N                         Number of points in the history ring of the shared memory (default 0).\n",
+    "\t-statsd HOST[:PORT]                    Push metrics to the statsd agent over UDP (default port 8125).\n",
+    "\t-statsd-prefix PREFIX                  Prefix of statsd metric names (default 'process_watcher').\n",
+    "\t-statsd-interval-ms N                  Interval to push metrics to statsd (default 10000 ms).\n",
+    "\t-statsd-mtu N                          Maximal size of statsd datagrams (default 1432, at least 512 bytes).",
     "\n"
   ));
   // clang-format on
@@ -2,18 +2,46 @@
 #define __CMDARGS_H
 
 #include "props.h"
+#include "batch.h"
+#include "procreader.h"
 #include <stdbool.h>
 
 /**
  @brief Cmd_args
  * Stores arguments from command line. Contains the process name, error message (if an error occurred), the timeout to
- refresh the process information.
+ refresh the process information and options of collecting, recording and exporting the data. Many targets (names or
+ PIDs) can be passed by arguments and by the watch-list file, 'Process_name' is the first of them. With '-top N', no
+ target is passed: all processes of the host are watched.
  */
 typedef struct
 {
   bool Valid;
   char* Process_name;
+  char** Targets;
+  int Targets_count;
+  char* Watch_list_path;
+  long int Top;
+  long int Workers;
+  bool Batched_reads;
+  Proc_reader_backend Reader_backend;
   long int Refresh_timeout_ms;
+  bool Adaptive;
+  long int Adaptive_min_ms;
+  long int Adaptive_max_ms;
+  long int Numa_interval_ms;
+  long int History_size;
+  long int Quantile_window_min;
+  char* Record_path;
+  char* Replay_path;
+  Batch_format Batch;
+  char* Output_path;
+  char* Prometheus_address;
+  char* Shm_name;
+  long int Shm_history_size;
+  char* Statsd_address;
+  char* Statsd_prefix;
+  long int Statsd_interval_ms;
+  long int Statsd_mtu;
   char* Errormsg;
 } Cmd_args;
 
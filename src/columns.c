@@ -0,0 +1,219 @@
+#include "columns.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+Target_columns* Target_columns_init()
+{
+  Target_columns* columns = malloc(sizeof(Target_columns));
+  ASSERT(columns != NULL, "columns (Target_columns*) != NULL; malloc(...) returns NULL.");
+  memset(columns, 0, sizeof(Target_columns));
+  return columns;
+}
+
+// grows arrays, new elements are zeros
+static double* grow(double* array, size_t capacity, size_t new_capacity)
+{
+  array = realloc(array, sizeof(double) * new_capacity);
+  ASSERT(array != NULL, "array (double*) != NULL; realloc(...) returns NULL.");
+  memset(array + capacity, 0, sizeof(double) * (new_capacity - capacity));
+  return array;
+}
+
+static void reserve(Target_columns* columns, size_t count)
+{
+  if (count <= columns->__capacity)
+    return;
+  size_t capacity = MAX(count, columns->__capacity * 2);
+  for (int i = 0; i < TARGET_COLUMNS_COUNT; ++i)
+    columns->Values[i] = grow(columns->Values[i], columns->__capacity, capacity);
+  for (int i = 0; i < 2; ++i) {
+    columns->__cpu_time[i] = grow(columns->__cpu_time[i], columns->__capacity, capacity);
+    columns->__read_bytes[i] = grow(columns->__read_bytes[i], columns->__capacity, capacity);
+    columns->__written_bytes[i] = grow(columns->__written_bytes[i], columns->__capacity, capacity);
+    columns->__alive[i] = grow(columns->__alive[i], columns->__capacity, capacity);
+  }
+  columns->__capacity = capacity;
+}
+
+static void swap(double** pair)
+{
+  double* first = pair[0];
+  pair[0] = pair[1];
+  pair[1] = first;
+}
+
+void Target_columns_begin(Target_columns* columns, size_t count, const Process_tick* tick)
+{
+  reserve(columns, count);
+  // the current tick becomes the previous one
+  swap(columns->__cpu_time);
+  swap(columns->__read_bytes);
+  swap(columns->__written_bytes);
+  swap(columns->__alive);
+  columns->__cpu_total[1] = columns->__cpu_total[0];
+  columns->__monotime[1] = columns->__monotime[0];
+  columns->__cpu_total[0] = (double) tick->Cpu_total;
+  columns->__monotime[0] = tick->Monotime_ms;
+
+  for (size_t i = columns->Count; i < count; ++i)
+    columns->__alive[1][i] = 0.0; // new targets have no previous tick
+  memset(columns->__alive[0], 0, sizeof(double) * count);
+  memset(columns->Values[TARGET_COLUMN_MEMORY], 0, sizeof(double) * count);
+  columns->Count = count;
+}
+
+void Target_columns_store(Target_columns* columns, size_t index, const Process_stat* stat)
+{
+  columns->__alive[0][index] = 1.0;
+  columns->__cpu_time[0][index] = (double) (stat->__last_utime + stat->__last_stime);
+  columns->__read_bytes[0][index] = (double) stat->__last_read_bytes;
+  columns->__written_bytes[0][index] = (double) stat->__last_written_bytes;
+  columns->Values[TARGET_COLUMN_MEMORY][index] = stat->Memory_usage;
+}
+
+// rates of counters, targets without the previous value have zeros
+static double rate(double current, double previous, double scale, double valid)
+{
+  return (current - previous) * scale * valid;
+}
+
+void Target_columns_finish(Target_columns* columns)
+{
+  size_t count = columns->Count;
+  const double *restrict live = columns->__alive[0], *restrict last_live = columns->__alive[1];
+  const double *restrict cpu = columns->__cpu_time[0], *restrict last_cpu = columns->__cpu_time[1];
+  const double *restrict read = columns->__read_bytes[0], *restrict last_read = columns->__read_bytes[1];
+  const double *restrict written = columns->__written_bytes[0], *restrict last_written = columns->__written_bytes[1];
+  const double* restrict memory = columns->Values[TARGET_COLUMN_MEMORY];
+  double* restrict cpu_rate = columns->Values[TARGET_COLUMN_CPU];
+  double* restrict read_rate = columns->Values[TARGET_COLUMN_DISK_READ];
+  double* restrict write_rate = columns->Values[TARGET_COLUMN_DISK_WRITE];
+
+  double cpu_total = columns->__cpu_total[0] - columns->__cpu_total[1],
+         period_s = (double) (columns->__monotime[0] - columns->__monotime[1]) / 1000.0;
+  double cpu_scale = cpu_total > 0.0 ? 100.0 / cpu_total : 0.0,
+         disk_scale = period_s > 0.0 ? 1.0 / (1000.0 * 1000.0 * period_s) : 0.0;
+  // one pass over all arrays: every array is read from memory once, sums and maxima are independent chains
+  double sums[TARGET_COLUMNS_COUNT] = {0.0}, maxima[TARGET_COLUMNS_COUNT] = {0.0}, alive = 0.0;
+  for (size_t i = 0; i < count; ++i) {
+    double valid = live[i] * last_live[i];
+    double values[TARGET_COLUMNS_COUNT] = {rate(cpu[i], last_cpu[i], cpu_scale, valid),
+                                           memory[i],
+                                           rate(read[i], last_read[i], disk_scale, valid),
+                                           rate(written[i], last_written[i], disk_scale, valid)};
+    cpu_rate[i] = values[TARGET_COLUMN_CPU];
+    read_rate[i] = values[TARGET_COLUMN_DISK_READ];
+    write_rate[i] = values[TARGET_COLUMN_DISK_WRITE];
+    for (int column = 0; column < TARGET_COLUMNS_COUNT; ++column) {
+      sums[column] += values[column];
+      maxima[column] = MAX(maxima[column], values[column]);
+    }
+    alive += live[i];
+  }
+  memcpy(columns->Sums, sums, sizeof(sums));
+  memcpy(columns->Maxima, maxima, sizeof(maxima));
+  columns->Alive = (size_t) alive;
+}
+
+void Target_columns_update(Target_columns* columns,
+                           Process_stat* const* stats,
+                           const bool* alive,
+                           size_t count,
+                           const Process_tick* tick)
+{
+  Target_columns_begin(columns, count, tick);
+  for (size_t i = 0; i < count; ++i)
+    if (alive[i])
+      Target_columns_store(columns, i, stats[i]);
+  Target_columns_finish(columns);
+}
+
+// returns true, if the element 'a' is selected after 'b': the smaller value multiplied by the sign or the same value
+// and the larger index
+static bool less(const double* values, double sign, size_t a, size_t b)
+{
+  return sign * values[a] < sign * values[b] || (values[a] == values[b] && a > b);
+}
+
+static void sift_down(const double* values, double sign, size_t* heap, size_t size, size_t i)
+{
+  for (;;) {
+    size_t smallest = i, left = 2 * i + 1, right = left + 1;
+    if (left < size && less(values, sign, heap[left], heap[smallest]))
+      smallest = left;
+    if (right < size && less(values, sign, heap[right], heap[smallest]))
+      smallest = right;
+    if (smallest == i)
+      return;
+    size_t index = heap[i];
+    heap[i] = heap[smallest];
+    heap[smallest] = index;
+    i = smallest;
+  }
+}
+
+static void sift_up(const double* values, double sign, size_t* heap, size_t i)
+{
+  for (size_t parent; i > 0 && less(values, sign, heap[i], heap[parent = (i - 1) / 2]); i = parent) {
+    size_t index = heap[i];
+    heap[i] = heap[parent];
+    heap[parent] = index;
+  }
+}
+
+// selects elements with the largest values multiplied by the sign, so the sign -1 selects the smallest values
+static size_t select_top(
+    const double* values, double sign, const double* live, size_t count, size_t n, size_t* indices)
+{
+  // the minimal selected element is the root of the heap, elements are scanned in the ascending order of indices, so
+  // the element equal to the root is less than it and only the value is compared with the bound of the full heap
+  size_t size = 0;
+  double bound = 0.0;
+  for (size_t i = 0; i < count && n > 0; ++i) {
+    if ((live && live[i] == 0.0) || (size == n && sign * values[i] <= bound))
+      continue;
+    if (size < n) {
+      indices[size] = i;
+      sift_up(values, sign, indices, size++);
+    } else {
+      indices[0] = i;
+      sift_down(values, sign, indices, size, 0);
+    }
+    bound = sign * values[indices[0]];
+  }
+  // the heap sort moves minimal elements to the end
+  for (size_t end = size; end > 1; --end) {
+    size_t index = indices[0];
+    indices[0] = indices[end - 1];
+    indices[end - 1] = index;
+    sift_down(values, sign, indices, end - 1, 0);
+  }
+  return size;
+}
+
+size_t Columns_top(const double* values, const double* live, size_t count, size_t n, size_t* indices)
+{
+  return select_top(values, 1.0, live, count, n, indices);
+}
+
+size_t Target_columns_top(
+    const Target_columns* columns, Target_column column, bool descending, size_t n, size_t* indices)
+{
+  if (column < 0 || column >= TARGET_COLUMNS_COUNT)
+    return 0;
+  return select_top(columns->Values[column], descending ? 1.0 : -1.0, columns->__alive[0], columns->Count, n, indices);
+}
+
+void Target_columns_free(Target_columns* columns)
+{
+  for (int i = 0; i < TARGET_COLUMNS_COUNT; ++i)
+    free(columns->Values[i]);
+  for (int i = 0; i < 2; ++i) {
+    free(columns->__cpu_time[i]);
+    free(columns->__read_bytes[i]);
+    free(columns->__written_bytes[i]);
+    free(columns->__alive[i]);
+  }
+  free(columns);
+}
@@ -0,0 +1,136 @@
+#ifndef __COLUMNS_H
+#define __COLUMNS_H
+
+#include "../include/process.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Target_column
+ * Metrics of targets stored in columns.
+ */
+typedef enum
+{
+  TARGET_COLUMN_CPU,        //! CPU usage, %
+  TARGET_COLUMN_MEMORY,     //! Resident memory, MB
+  TARGET_COLUMN_DISK_READ,  //! Disk read rate, MB/s
+  TARGET_COLUMN_DISK_WRITE, //! Disk write rate, MB/s
+  TARGET_COLUMNS_COUNT
+} Target_column;
+
+/**
+ * @brief Target_columns
+ * Stores counters and metrics of many targets as contiguous arrays, one array per counter or metric, so aggregation
+ * over thousands of targets reads only the needed values instead of whole Process_stat structures. Every updated
+ * target stores its counters into columns at once, while its structure is in the cache, then deltas, rates, sums and
+ * maxima of the tick are calculated by one branchless pass over arrays, so every array is read from memory once.
+ * Arrays of the previous tick are swapped with arrays of the current tick, so they are not copied. A target has rates,
+ * if it is alive in both ticks, otherwise its rates are 0. Metrics of not alive targets are 0. Targets of Target_list
+ * do not calculate their rates (Counters_only), so columns are the only source of their metrics.
+ *
+ * @code
+ * Target_columns_begin(columns, count, &tick);
+ * for (size_t i = 0; i < count; ++i)
+ *   if (Process_stat_update_tick(stats[i], &tick, &errormsg))
+ *     Target_columns_store(columns, i, stats[i]);
+ * Target_columns_finish(columns);
+ * @endcode
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  size_t Count;                          //! Number of targets
+  size_t Alive;                          //! Number of alive targets
+  double* Values[TARGET_COLUMNS_COUNT];  //! Metrics of targets in the last tick
+  double Sums[TARGET_COLUMNS_COUNT];     //! Sums of metrics
+  double Maxima[TARGET_COLUMNS_COUNT];   //! Maxima of metrics
+
+  // private fields
+  double* __cpu_time[2];      // utime + stime in clock ticks, the current and the previous tick
+  double* __read_bytes[2];    // read bytes
+  double* __written_bytes[2]; // written bytes
+  double* __alive[2];         // 1, if the target is alive, otherwise 0
+  double __cpu_total[2];      // sum of CPU times of the system
+  long long __monotime[2];    // monotonic time of the tick
+  size_t __capacity;          // capacity of arrays
+} Target_columns;
+
+/**
+ * @brief Target_columns_init
+ * Initializes the new empty columns.
+ * @return The pointer to the new structure
+ */
+DECLFUNC Target_columns* Target_columns_init() ATTR(warn_unused_result);
+/**
+ * @brief Target_columns_begin
+ * Starts the new tick: all targets are not alive, until they are stored. Indices of targets must not change between
+ * ticks, new targets are added to the end.
+ * @param columns The pointer to the structure
+ * @param count Number of targets
+ * @param tick The pointer to system-wide data of the tick
+ */
+DECLFUNC void Target_columns_begin(Target_columns* columns, size_t count, const Process_tick* tick)
+    ATTR(nonnull(1, 3));
+/**
+ * @brief Target_columns_store
+ * Stores counters of the updated alive target. Different targets can be stored from different threads at the same
+ * time.
+ * @param columns The pointer to the structure
+ * @param index Index of the target, it is less than the number of targets of the tick
+ * @param stat The pointer to the updated target
+ */
+DECLFUNC void Target_columns_store(Target_columns* columns, size_t index, const Process_stat* stat) ATTR(nonnull(1, 3));
+/**
+ * @brief Target_columns_finish
+ * Calculates metrics, sums and maxima of the tick by stored counters.
+ * @param columns The pointer to the structure
+ */
+DECLFUNC void Target_columns_finish(Target_columns* columns) ATTR(nonnull(1));
+/**
+ * @brief Target_columns_update
+ * Starts the tick, stores all alive targets and finishes the tick.
+ * @param columns The pointer to the structure
+ * @param stats Targets
+ * @param alive Alive targets
+ * @param count Number of targets
+ * @param tick The pointer to system-wide data of the tick
+ */
+DECLFUNC void Target_columns_update(Target_columns* columns,
+                                    Process_stat* const* stats,
+                                    const bool* alive,
+                                    size_t count,
+                                    const Process_tick* tick) ATTR(nonnull(1, 5));
+/**
+ * @brief Target_columns_top
+ * Selects alive targets with the largest (or the smallest) values of the metric by the bounded heap, see Columns_top.
+ * @param columns The pointer to the structure
+ * @param column The metric
+ * @param descending Targets with the largest values are selected in the descending order, otherwise targets with the
+ * smallest values are selected in the ascending order
+ * @param n Maximal number of selected targets
+ * @param indices Indices of selected targets, at least 'n' elements
+ * @return Number of selected targets
+ */
+DECLFUNC size_t Target_columns_top(
+    const Target_columns* columns, Target_column column, bool descending, size_t n, size_t* indices) ATTR(nonnull(1));
+/**
+ * @brief Columns_top
+ * Selects elements with the largest values by the bounded heap, so the cost is O(count * log(n)) and only 'n' indices
+ * are stored. Equal values are selected in the ascending order of indices.
+ * @param values Values of elements
+ * @param live 1, if the element is selected, otherwise 0 (NULL, all elements are selected)
+ * @param count Number of elements
+ * @param n Maximal number of selected elements
+ * @param indices Indices of selected elements in the descending order of values, at least 'n' elements
+ * @return Number of selected elements
+ */
+DECLFUNC size_t Columns_top(const double* values, const double* live, size_t count, size_t n, size_t* indices)
+    ATTR(nonnull(1));
+/**
+ * @brief Target_columns_free
+ * Deletes the structure.
+ * @param columns The pointer to the structure
+ */
+DECLFUNC void Target_columns_free(Target_columns* columns) ATTR(nonnull(1));
+
+#endif // __COLUMNS_H
@@ -0,0 +1,243 @@
+#include "eventloop.h"
+#include "ioutils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#elif _WIN32
+#include <Windows.h>
+#endif
+
+#ifdef __linux__
+#define MAX_EVENTS 4 // input, timer, signals and pidfd
+
+// adds the descriptor to epoll, the descriptor itself is the data of the event
+static bool add_fd(int epfd, int fd)
+{
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+static long long monotime_ns()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// arms the timer at the absolute deadline
+static bool arm_timer(Event_loop* loop)
+{
+  struct itimerspec spec;
+  memset(&spec, 0, sizeof(spec)); // one-shot, the next deadline is armed after the tick
+  spec.it_value.tv_sec = (time_t) (loop->__deadline_ns / 1000000000LL);
+  spec.it_value.tv_nsec = (long) (loop->__deadline_ns % 1000000000LL);
+  return timerfd_settime(loop->__timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == 0;
+}
+
+// stores the lateness of the tick and moves the deadline past the current time
+static void on_tick(Event_loop* loop)
+{
+  long long interval_ns = (long long) loop->__interval_ms * 1000000LL,
+            lateness_ns = monotime_ns() - loop->__deadline_ns;
+  if (lateness_ns < 0)
+    lateness_ns = 0;
+  long long missed = lateness_ns / interval_ns;
+  loop->Ticks_count++;
+  loop->Missed_ticks += (unsigned long long) missed;
+  loop->__deadline_ns += (missed + 1) * interval_ns;
+
+  long long lateness_us = lateness_ns / 1000;
+  int bucket = 0;
+  while (lateness_us >> bucket && bucket < EVENT_LOOP_LATENESS_BUCKETS - 1)
+    ++bucket;
+  loop->Lateness_us[bucket]++;
+  if (lateness_us > loop->Max_lateness_us)
+    loop->Max_lateness_us = lateness_us;
+}
+
+// closes all opened descriptors of the loop
+static void close_fds(Event_loop* loop)
+{
+  int fds[] = {loop->__epfd, loop->__timer_fd, loop->__signal_fd, loop->__pid_fd};
+  for (size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); ++i)
+    if (fds[i] != -1)
+      close(fds[i]);
+}
+#endif
+
+Event_loop* Event_loop_init(int input_fd, long int interval_ms, char** errormsg)
+{
+  Event_loop* loop = malloc(sizeof(Event_loop));
+  ASSERT(loop != NULL, "loop (Event_loop*) != NULL; malloc(...) returns NULL.");
+  loop->Wakeups_count = 0;
+  loop->Ticks_count = 0;
+  loop->Missed_ticks = 0;
+  memset(loop->Lateness_us, 0, sizeof(loop->Lateness_us));
+  loop->Max_lateness_us = 0;
+  loop->__epfd = -1;
+  loop->__input_fd = input_fd;
+  loop->__timer_fd = -1;
+  loop->__signal_fd = -1;
+  loop->__pid_fd = -1;
+  loop->__interval_ms = interval_ms;
+  loop->__deadline_ns = 0;
+  loop->__old_mask = NULL;
+#ifdef __linux__
+  loop->__old_mask = malloc(sizeof(sigset_t));
+  ASSERT(loop->__old_mask != NULL, "loop->__old_mask (sigset_t*) != NULL; malloc(...) returns NULL.");
+
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGWINCH);
+  pthread_sigmask(SIG_BLOCK, &mask, (sigset_t*) loop->__old_mask); // signals are read from signalfd only
+
+  bool good = (loop->__epfd = epoll_create1(EPOLL_CLOEXEC)) != -1 &&
+              (loop->__signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC)) != -1 &&
+              (loop->__timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) != -1 &&
+              add_fd(loop->__epfd, loop->__signal_fd) && add_fd(loop->__epfd, loop->__timer_fd) &&
+              (input_fd == -1 || add_fd(loop->__epfd, input_fd));
+  if (good && interval_ms > 0) {
+    loop->__deadline_ns = monotime_ns() + (long long) interval_ms * 1000000LL;
+    good = arm_timer(loop);
+  }
+  if (!good) {
+    strconcat(errormsg, 2, SAFE_PASS_VARGS("Cannot create the event loop: ", strerror(errno)));
+    Event_loop_free(loop);
+    return NULL;
+  }
+#else
+  UNUSED(errormsg);
+#endif
+  return loop;
+}
+
+bool Event_loop_watch_pid(Event_loop* loop, int pid)
+{
+#if defined __linux__ && defined SYS_pidfd_open
+  if (loop->__pid_fd != -1)
+    return false;
+  loop->__pid_fd = (int) syscall(SYS_pidfd_open, pid, 0);
+  if (loop->__pid_fd == -1)
+    return false;
+  if (!add_fd(loop->__epfd, loop->__pid_fd)) {
+    close(loop->__pid_fd);
+    loop->__pid_fd = -1;
+    return false;
+  }
+  return true;
+#else
+  UNUSED(loop);
+  UNUSED(pid);
+  return false;
+#endif
+}
+
+void Event_loop_set_interval(Event_loop* loop, long int interval_ms)
+{
+  if (interval_ms <= 0 || interval_ms == loop->__interval_ms)
+    return;
+#ifdef __linux__
+  if (loop->__interval_ms > 0)
+    loop->__deadline_ns += (long long) (interval_ms - loop->__interval_ms) * 1000000LL;
+  else
+    loop->__deadline_ns = monotime_ns() + (long long) interval_ms * 1000000LL;
+  loop->__interval_ms = interval_ms;
+  arm_timer(loop);
+#else
+  loop->__interval_ms = interval_ms;
+#endif
+}
+
+long int Event_loop_interval(const Event_loop* loop)
+{
+  return loop->__interval_ms;
+}
+
+int Event_loop_wait(Event_loop* loop)
+{
+  int events = 0;
+#ifdef __linux__
+  struct epoll_event ready[MAX_EVENTS];
+  int count;
+  while ((count = epoll_wait(loop->__epfd, ready, MAX_EVENTS, -1)) == -1 && errno == EINTR)
+    ;
+  for (int i = 0; i < count; ++i) {
+    int fd = ready[i].data.fd;
+    if (fd == loop->__input_fd)
+      events |= EVENT_LOOP_INPUT;
+    else if (fd == loop->__timer_fd) {
+      unsigned long long expirations = 0;
+      if (read(fd, &expirations, sizeof(expirations)) == (ssize_t) sizeof(expirations) && expirations > 0) {
+        on_tick(loop);
+        arm_timer(loop);
+        events |= EVENT_LOOP_TICK;
+      }
+    } else if (fd == loop->__signal_fd) {
+      struct signalfd_siginfo info;
+      while (read(fd, &info, sizeof(info)) == (ssize_t) sizeof(info))
+        events |= info.ssi_signo == SIGWINCH ? EVENT_LOOP_RESIZE : EVENT_LOOP_EXIT;
+    } else if (fd == loop->__pid_fd) {
+      // the pidfd stays readable after the exit, so it is removed to report the exit once
+      epoll_ctl(loop->__epfd, EPOLL_CTL_DEL, fd, NULL);
+      close(fd);
+      loop->__pid_fd = -1;
+      events |= EVENT_LOOP_PROCESS_EXIT;
+    }
+  }
+#elif _WIN32
+  // the console input handle is signaled by keys, signals are handled by the caller
+  HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+  DWORD timeout = loop->__interval_ms > 0 ? (DWORD) loop->__interval_ms : INFINITE;
+  if (loop->__input_fd != -1 && WaitForSingleObject(input, timeout) == WAIT_OBJECT_0)
+    events |= EVENT_LOOP_INPUT;
+  else {
+    if (loop->__input_fd == -1)
+      Sleep(timeout);
+    loop->Ticks_count++;
+    events |= EVENT_LOOP_TICK;
+  }
+#endif
+  loop->Wakeups_count++;
+  return events;
+}
+
+long long Event_loop_lateness_us(const Event_loop* loop, double quantile)
+{
+  unsigned long long total = 0, count = 0;
+  for (int i = 0; i < EVENT_LOOP_LATENESS_BUCKETS; ++i)
+    total += loop->Lateness_us[i];
+  if (total == 0)
+    return 0;
+  unsigned long long rank = (unsigned long long) (quantile * (double) total);
+  for (int i = 0; i < EVENT_LOOP_LATENESS_BUCKETS - 1; ++i)
+    if ((count += loop->Lateness_us[i]) > rank)
+      return 1LL << i;
+  return loop->Max_lateness_us; // the last bucket is not bounded
+}
+
+void Event_loop_free(Event_loop* loop)
+{
+#ifdef __linux__
+  close_fds(loop);
+  if (loop->__old_mask)
+    pthread_sigmask(SIG_SETMASK, (sigset_t*) loop->__old_mask, NULL);
+#endif
+  free(loop->__old_mask);
+  free(loop);
+}
@@ -0,0 +1,112 @@
+#ifndef __EVENTLOOP_H
+#define __EVENTLOOP_H
+
+#include "../include/props.h"
+#include <stdbool.h>
+
+#define EVENT_LOOP_LATENESS_BUCKETS 24 // buckets of the lateness histogram, the last one is about 4 seconds and more
+
+/**
+ * @brief Event_loop_events
+ * Flags of events returned by Event_loop_wait.
+ */
+typedef enum
+{
+  EVENT_LOOP_INPUT = 1 << 0,        //! The input has data
+  EVENT_LOOP_TICK = 1 << 1,         //! The sampling interval is expired
+  EVENT_LOOP_EXIT = 1 << 2,         //! SIGINT or SIGTERM is received
+  EVENT_LOOP_RESIZE = 1 << 3,       //! SIGWINCH is received
+  EVENT_LOOP_PROCESS_EXIT = 1 << 4  //! The watched process has exited
+} Event_loop_events;
+
+/**
+ * @brief Event_loop
+ * The single-threaded event loop of the main thread. On Linux, one epoll descriptor multiplexes the input, the timerfd
+ * of sampling ticks, the signalfd of SIGINT, SIGTERM and SIGWINCH, and the pidfd of the watched process, so the thread
+ * sleeps until something happens. These signals are blocked for the calling thread, so the loop must be created
+ * before other threads, which inherit the mask.
+ *
+ * Ticks fire at absolute CLOCK_MONOTONIC deadlines 'start + N * interval', so the period does not include the work
+ * time and does not follow steps of the system clock. If the loop is late for more than one interval, passed deadlines
+ * are counted as missed and the next deadline in the future is used. The lateness of every tick is stored in the
+ * histogram: bucket 0 counts ticks late by less than 1 us, bucket 'i' counts ticks late by [2^(i-1), 2^i) us.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  unsigned long long Wakeups_count;                           //! Number of returns from Event_loop_wait
+  unsigned long long Ticks_count;                             //! Number of ticks
+  unsigned long long Missed_ticks;                            //! Number of deadlines passed without the tick
+  unsigned long long Lateness_us[EVENT_LOOP_LATENESS_BUCKETS]; //! Histogram of the tick lateness
+  long long Max_lateness_us;                                  //! Maximal lateness of the tick
+
+  // private fields
+  int __epfd;              // epoll descriptor
+  int __input_fd;          // the input or -1
+  int __timer_fd;          // timerfd of ticks
+  int __signal_fd;         // signalfd of handled signals
+  int __pid_fd;            // pidfd of the watched process or -1
+  long int __interval_ms;  // the sampling interval
+  long long __deadline_ns; // the next deadline of CLOCK_MONOTONIC
+  void* __old_mask;        // the signal mask before the loop (sigset_t)
+} Event_loop;
+
+/**
+ * @brief Event_loop_init
+ * Creates the new event loop with the ticks interval. If any error occurs, stores the error message in the 'errormsg'
+ * parameter.
+ * @param input_fd The input descriptor or -1
+ * @param interval_ms Interval of ticks in milliseconds, ticks are disabled if it is not positive
+ * @param errormsg The pointer to the error message
+ * @return The pointer to the new loop or NULL
+ */
+DECLFUNC Event_loop* Event_loop_init(int input_fd, long int interval_ms, char** errormsg)
+    ATTR(warn_unused_result) ATTR(nonnull(3));
+/**
+ * @brief Event_loop_watch_pid
+ * Watches the exit of the process by its pidfd. Kernels without 'pidfd_open' (before 5.3) are not supported, exits
+ * are found by sampling on ticks then.
+ * @param loop The pointer to the loop
+ * @param pid PID of the process
+ * @return true, if the process is watched
+ */
+DECLFUNC bool Event_loop_watch_pid(Event_loop* loop, int pid) ATTR(nonnull(1));
+/**
+ * @brief Event_loop_set_interval
+ * Changes the interval of ticks. The next deadline is moved to the previous deadline plus the new interval, if this
+ * time is passed, the tick fires at once.
+ * @param loop The pointer to the loop
+ * @param interval_ms The new interval in milliseconds, it must be positive
+ */
+DECLFUNC void Event_loop_set_interval(Event_loop* loop, long int interval_ms) ATTR(nonnull(1));
+/**
+ * @brief Event_loop_interval
+ * Returns the current interval of ticks.
+ * @param loop The pointer to the loop
+ * @return The interval in milliseconds
+ */
+DECLFUNC long int Event_loop_interval(const Event_loop* loop) ATTR(nonnull(1));
+/**
+ * @brief Event_loop_wait
+ * Blocks until at least one event occurs and returns flags of all ready events. Expirations of the timer and received
+ * signals are consumed. The process exit is reported once.
+ * @param loop The pointer to the loop
+ * @return Flags of Event_loop_events
+ */
+DECLFUNC int Event_loop_wait(Event_loop* loop) ATTR(nonnull(1));
+/**
+ * @brief Event_loop_lateness_us
+ * Returns the upper bound of the tick lateness quantile from the histogram.
+ * @param loop The pointer to the loop
+ * @param quantile The quantile from 0 to 1
+ * @return The lateness in microseconds or 0, if there are no ticks
+ */
+DECLFUNC long long Event_loop_lateness_us(const Event_loop* loop, double quantile) ATTR(nonnull(1));
+/**
+ * @brief Event_loop_free
+ * Closes descriptors, restores the signal mask and deletes the loop.
+ * @param loop The pointer to the loop
+ */
+DECLFUNC void Event_loop_free(Event_loop* loop) ATTR(nonnull(1));
+
+#endif // __EVENTLOOP_H
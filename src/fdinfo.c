@@ -0,0 +1,211 @@
+#include "fdinfo.h"
+
+#include "ioutils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <linux/limits.h>
+#include <sys/stat.h>
+#endif
+
+#define FDINFO_BUFFER_SIZE 256
+#define PROC_PATH_SIZE 64
+
+static int compare_entries(const void* a, const void* b)
+{
+  int fa = ((const Fd_entry*) a)->Fd, fb = ((const Fd_entry*) b)->Fd;
+  return (fa > fb) - (fa < fb);
+}
+
+Fd_list* Fd_list_init()
+{
+  Fd_list* list = malloc(sizeof(Fd_list));
+  ASSERT(list != NULL, "list (Fd_list*) != NULL; malloc(...) returns NULL.");
+  list->Entries = NULL;
+  list->Count = 0;
+
+  list->__prev = NULL;
+  list->__prev_count = 0;
+  list->__capacity = 0;
+#ifdef __linux__
+  list->__dir = Dir_reader_init();
+#else
+  list->__dir = NULL;
+#endif
+  list->__last_monotime = monotime_ms();
+  return list;
+}
+
+const Fd_entry* Fd_list_find(const Fd_list* list, int fd)
+{
+  Fd_entry key;
+  key.Fd = fd;
+  if (list->Count == 0)
+    return NULL;
+  return bsearch(&key, list->Entries, list->Count, sizeof(Fd_entry), compare_entries);
+}
+
+#ifdef __linux__
+static void reserve_entries(Fd_list* list, size_t count)
+{
+  if (count <= list->__capacity)
+    return;
+
+  size_t capacity = list->__capacity ? list->__capacity * 2 : 64;
+  while (capacity < count)
+    capacity *= 2;
+
+  Fd_entry* entries = realloc(list->Entries, capacity * sizeof(Fd_entry));
+  ASSERT(entries != NULL, "entries (Fd_entry*) != NULL; realloc(...) returns NULL.");
+  list->Entries = entries;
+
+  Fd_entry* prev = realloc(list->__prev, capacity * sizeof(Fd_entry));
+  ASSERT(prev != NULL, "prev (Fd_entry*) != NULL; realloc(...) returns NULL.");
+  list->__prev = prev;
+
+  list->__capacity = capacity;
+}
+
+// reads 'pos' and 'flags' fields from '/proc/[pid]/fdinfo/[fd]'
+static bool read_fdinfo(int fdinfodir, const char* name, unsigned long long* pos, int* flags)
+{
+  int fd = openat(fdinfodir, name, O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+    return false;
+
+  char buf[FDINFO_BUFFER_SIZE];
+  ssize_t bytes = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (bytes <= 0)
+    return false;
+  buf[bytes] = '\0';
+
+  unsigned int oflags = 0;
+  if (sscanf(buf, "pos:\t%llu\nflags:\t%o", pos, &oflags) != 2)
+    return false;
+  *flags = (int) oflags;
+  return true;
+}
+#endif
+
+bool Fd_list_update(Fd_list* list, int pid, char** errormsg)
+{
+#ifdef __linux__
+  char fdpath[PROC_PATH_SIZE], fdinfopath[PROC_PATH_SIZE];
+  snprintf(fdpath, sizeof(fdpath), "/proc/%d/fd", pid);
+  snprintf(fdinfopath, sizeof(fdinfopath), "/proc/%d/fdinfo", pid);
+
+  Dir_reader* reader = (Dir_reader*) list->__dir;
+  if (!Dir_reader_open(reader, fdpath)) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open directory '", fdpath, "': ", strerror(errno)));
+    return false;
+  }
+  int fdinfodir = open(fdinfopath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fdinfodir == -1) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open directory '", fdinfopath, "': ", strerror(errno)));
+    Dir_reader_close(reader);
+    return false;
+  }
+
+  double period_sec;
+  {
+    long long monotime_now = monotime_ms();
+    period_sec = (double) (monotime_now - list->__last_monotime) / 1000;
+    list->__last_monotime = monotime_now;
+  }
+
+  // the current entries become the previous entries, targets are moved to the new entries
+  {
+    Fd_entry* tmp = list->__prev;
+    list->__prev = list->Entries;
+    list->Entries = tmp;
+    list->__prev_count = list->Count;
+    list->Count = 0;
+  }
+
+  const char* name;
+  while ((name = Dir_reader_next(reader)) != NULL) {
+    char target[PATH_MAX];
+    ssize_t target_len = readlinkat(reader->Fd, name, target, sizeof(target) - 1);
+    if (target_len <= 0)
+      continue; // descriptor was closed
+    target[target_len] = '\0';
+
+    Fd_entry entry;
+    entry.Fd = (int) strtol(name, NULL, 10);
+    entry.Target = NULL;
+    entry.Pos = 0;
+    entry.Flags = 0;
+    entry.Size = 0;
+    entry.Rate_mb_usage = 0.0;
+    entry.Eta_sec = -1;
+    if (!read_fdinfo(fdinfodir, name, &entry.Pos, &entry.Flags))
+      continue;
+    entry.__last_pos = entry.Pos;
+
+    Fd_entry key;
+    key.Fd = entry.Fd;
+    Fd_entry* prev = list->__prev_count > 0
+                         ? bsearch(&key, list->__prev, list->__prev_count, sizeof(Fd_entry), compare_entries)
+                         : NULL;
+    if (prev && prev->Target && strcmp(prev->Target, target) == 0) {
+      // the same file, so we can calculate speed
+      entry.Target = prev->Target;
+      prev->Target = NULL;
+      if (entry.Pos >= prev->__last_pos && period_sec > 0)
+        entry.Rate_mb_usage = ((double) (entry.Pos - prev->__last_pos) / 1000 / 1000) / period_sec;
+    } else {
+      entry.Target = malloc(sizeof(char) * (size_t) target_len + 1);
+      ASSERT(entry.Target != NULL, "entry.Target (char*) != NULL; malloc(...) returns NULL.");
+      memcpy(entry.Target, target, (size_t) target_len + 1);
+    }
+
+    if ((entry.Flags & O_ACCMODE) == O_RDONLY && entry.Target[0] == '/') {
+      struct stat st;
+      if (fstatat(reader->Fd, name, &st, 0) == 0 && S_ISREG(st.st_mode)) {
+        entry.Size = (unsigned long long) st.st_size;
+        if (entry.Rate_mb_usage > 0.0 && entry.Size >= entry.Pos)
+          entry.Eta_sec = (long long) ((double) (entry.Size - entry.Pos) / (entry.Rate_mb_usage * 1000 * 1000));
+      }
+    }
+
+    reserve_entries(list, list->Count + 1);
+    list->Entries[list->Count++] = entry;
+  }
+  close(fdinfodir);
+  Dir_reader_close(reader);
+
+  // free targets of closed descriptors
+  for (size_t i = 0; i < list->__prev_count; ++i)
+    free(list->__prev[i].Target);
+  list->__prev_count = 0;
+
+  qsort(list->Entries, list->Count, sizeof(Fd_entry), compare_entries);
+  return true;
+#elif _WIN32
+  UNUSED(list);
+  UNUSED(pid);
+  strconcat(errormsg, 1, SAFE_PASS_VARGS("The list of file descriptors is not supported on Windows."));
+  return false;
+#endif
+}
+
+void Fd_list_free(Fd_list* list)
+{
+  for (size_t i = 0; i < list->Count; ++i)
+    free(list->Entries[i].Target);
+  for (size_t i = 0; i < list->__prev_count; ++i)
+    free(list->__prev[i].Target);
+  free(list->Entries);
+  free(list->__prev);
+#ifdef __linux__
+  Dir_reader_free((Dir_reader*) list->__dir);
+#endif
+
+  free(list);
+}
@@ -0,0 +1,331 @@
+#include "hosttop.h"
+#include "ioutils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+#define FILE_BUFFER_SIZE 1024 // 'stat' and 'io' are less than 512 bytes
+#define PID_PATH_SIZE 32      // '[pid]/stat' and '[pid]/io'
+#define RESERVED_FILES 256    // descriptors, which are not kept opened for processes (the interface, outputs)
+
+#ifdef __linux__
+static const char* PROC_DIRECTORY_PATH = "/proc";
+#endif
+
+Host_top* Host_top_init(size_t size)
+{
+  Host_top* top = malloc(sizeof(Host_top));
+  ASSERT(top != NULL, "top (Host_top*) != NULL; malloc(...) returns NULL.");
+  memset(top, 0, sizeof(Host_top));
+  top->Size = size;
+  top->Sort = TARGET_COLUMN_CPU;
+  top->Selected_pid = -1;
+  top->Top = malloc(sizeof(size_t) * MAX(size, 1));
+  ASSERT(top->Top != NULL, "top->Top (size_t*) != NULL; malloc(...) returns NULL.");
+#ifdef __linux__
+  // two descriptors per process are kept opened
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    if (limit.rlim_cur < limit.rlim_max) {
+      limit.rlim_cur = limit.rlim_max;
+      if (setrlimit(RLIMIT_NOFILE, &limit) != 0)
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    top->__max_opened_files = limit.rlim_cur > RESERVED_FILES ? (size_t) (limit.rlim_cur - RESERVED_FILES) : 0;
+  }
+#endif
+  return top;
+}
+
+#ifdef __linux__
+// reads the file of the process from the beginning, the file is opened, if it is not opened yet, and it is kept
+// opened, while the limit of opened files is not reached; returns the length of contents or -1
+static ssize_t read_file(Host_top* top, int dirfd, int pid, const char* name, int* fd, char* buffer)
+{
+  bool opened = *fd != -1;
+  if (!opened) {
+    char path[PID_PATH_SIZE];
+    snprintf(path, sizeof(path), "%d/%s", pid, name);
+    ++top->Syscalls;
+    if ((*fd = openat(dirfd, path, O_RDONLY | O_CLOEXEC)) == -1)
+      return -1;
+  }
+  ssize_t length = pread(*fd, buffer, FILE_BUFFER_SIZE - 1, 0);
+  ++top->Syscalls;
+  if (length >= 0)
+    buffer[length] = '\0';
+  if (!opened && top->__opened_files >= top->__max_opened_files) {
+    close(*fd);
+    *fd = -1;
+    ++top->Syscalls;
+  } else if (!opened)
+    ++top->__opened_files;
+  return length;
+}
+
+static void close_file(Host_top* top, int* fd)
+{
+  if (*fd == -1)
+    return;
+  close(*fd);
+  *fd = -1;
+  --top->__opened_files;
+  ++top->Syscalls;
+}
+
+// returns the field after 'count' fields separated by spaces or NULL
+static const char* skip_fields(const char* field, int count)
+{
+  for (; field && count > 0; --count)
+    if ((field = strchr(field, ' ')))
+      ++field;
+  return field;
+}
+
+// parses '/proc/[pid]/stat', the name can contain spaces and parentheses, so fields are counted after the last ')'
+static bool parse_stat(const char* stat, Host_process* process, long* rss)
+{
+  const char *begin = strchr(stat, '('), *end = strrchr(stat, ')');
+  if (!begin || !end || end < begin || end[1] != ' ' || end[2] == '\0')
+    return false;
+  size_t length = MIN((size_t) (end - begin - 1), (size_t) HOST_TOP_NAME_SIZE - 1);
+  memcpy(process->Name, begin + 1, length);
+  process->Name[length] = '\0';
+  process->State = end[2];
+
+  // the state is the 3rd field, 'utime' and 'stime' are 14th and 15th, 'starttime' is 22nd, 'rss' is 24th
+  char* next = NULL;
+  const char* field = skip_fields(end + 2, 11);
+  if (!field)
+    return false;
+  unsigned long long utime = strtoull(field, &next, 10), stime = strtoull(next, &next, 10);
+  if (!(field = skip_fields(next + 1, 6)))
+    return false;
+  process->Start_time = strtoull(field, &next, 10);
+  if (!(field = skip_fields(next + 1, 1)))
+    return false;
+  *rss = strtol(field, &next, 10);
+  process->__cpu_time = utime + stime;
+  return next != field;
+}
+
+// reads and parses 'stat' of the process
+static bool read_stat(Host_top* top, int dirfd, Host_process* process, char* buffer, long* rss)
+{
+  return read_file(top, dirfd, process->Pid, "stat", &process->__stat_fd, buffer) > 0 &&
+         parse_stat(buffer, process, rss);
+}
+
+// finds the process of the previous tick by the merge of PIDs in the ascending order, 'cursor' is the merged position
+static Host_process* find_previous(const Host_top* top, int pid, size_t* cursor)
+{
+  Host_process* previous = top->__previous;
+  size_t count = top->__previous_count, i = *cursor;
+  if (i > 0 && previous[i - 1].Pid >= pid) { // PIDs are not listed in the ascending order, the binary search
+    size_t low = 0, high = count;
+    while (low < high) {
+      size_t middle = low + (high - low) / 2;
+      if (previous[middle].Pid < pid)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+    i = low;
+  }
+  while (i < count && previous[i].Pid < pid)
+    ++i;
+  *cursor = i;
+  return i < count && previous[i].Pid == pid ? &previous[i] : NULL;
+}
+
+static int compare_pids(const void* a, const void* b)
+{
+  int x = ((const Host_process*) a)->Pid, y = ((const Host_process*) b)->Pid;
+  return (x > y) - (x < y);
+}
+
+// adds the process to the current tick, it is not added, if it has exited
+static void add_process(
+    Host_top* top, int dirfd, int pid, size_t* cursor, double cpu_total, double period_s, long page_kb)
+{
+  if (top->Count == top->__capacity) {
+    top->__capacity = top->__capacity ? top->__capacity * 2 : 1024;
+    top->Processes = realloc(top->Processes, sizeof(Host_process) * top->__capacity);
+    ASSERT(top->Processes != NULL, "top->Processes (Host_process*) != NULL; realloc(...) returns NULL.");
+    top->__values = realloc(top->__values, sizeof(double) * MAX(top->__capacity, top->__previous_capacity));
+    ASSERT(top->__values != NULL, "top->__values (double*) != NULL; realloc(...) returns NULL.");
+  }
+
+  char buffer[FILE_BUFFER_SIZE];
+  Host_process* process = &top->Processes[top->Count];
+  Host_process* last = find_previous(top, pid, cursor);
+  process->Pid = pid;
+  process->__stat_fd = process->__io_fd = -1;
+  if (last) { // descriptors are moved to the current tick
+    process->__stat_fd = last->__stat_fd;
+    process->__io_fd = last->__io_fd;
+    last->__stat_fd = last->__io_fd = -1;
+  }
+
+  long rss = 0;
+  bool kept = process->__stat_fd != -1, parsed = kept && read_stat(top, dirfd, process, buffer, &rss);
+  if (kept && !parsed) { // the opened process has exited, so the PID is reused
+    close_file(top, &process->__stat_fd);
+    close_file(top, &process->__io_fd);
+    last = NULL;
+  }
+  if (!parsed && !read_stat(top, dirfd, process, buffer, &rss)) {
+    close_file(top, &process->__stat_fd);
+    close_file(top, &process->__io_fd);
+    return;
+  }
+  if (last && last->Start_time != process->Start_time) {
+    close_file(top, &process->__io_fd); // the PID is reused, the process was not kept opened
+    last = NULL;
+  }
+
+  process->__io = !last || last->__io;
+  process->__read_bytes = process->__written_bytes = 0;
+  if (process->__io)
+    process->__io = read_file(top, dirfd, pid, "io", &process->__io_fd, buffer) > 0 &&
+                    sscanf(buffer, "rchar: %llu\nwchar: %llu", &process->__read_bytes, &process->__written_bytes) == 2;
+  if (!process->__io)
+    close_file(top, &process->__io_fd);
+
+  double* values = process->Values;
+  values[TARGET_COLUMN_MEMORY] = (double) (rss * page_kb) / 1000.0;
+  values[TARGET_COLUMN_CPU] = values[TARGET_COLUMN_DISK_READ] = values[TARGET_COLUMN_DISK_WRITE] = 0.0;
+  if (last) {
+    if (cpu_total > 0.0)
+      values[TARGET_COLUMN_CPU] = 100.0 * (double) (process->__cpu_time - last->__cpu_time) / cpu_total;
+    if (period_s > 0.0 && process->__io && last->__io) {
+      values[TARGET_COLUMN_DISK_READ] =
+          (double) (process->__read_bytes - last->__read_bytes) / 1000.0 / 1000.0 / period_s;
+      values[TARGET_COLUMN_DISK_WRITE] =
+          (double) (process->__written_bytes - last->__written_bytes) / 1000.0 / 1000.0 / period_s;
+    }
+  }
+  top->Count++;
+}
+#endif
+
+bool Host_top_update(Host_top* top, char** errormsg)
+{
+#ifdef __linux__
+  long long begin = monotime_ms();
+  Process_tick last_tick = top->Tick;
+  if (!Process_tick_read(&top->Tick, errormsg))
+    return false;
+  DIR* dir = opendir(PROC_DIRECTORY_PATH);
+  if (!dir) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open directory '", PROC_DIRECTORY_PATH, "': ", strerror(errno)));
+    return false;
+  }
+
+  // the current tick becomes the previous one
+  Host_process* processes = top->__previous;
+  size_t capacity = top->__previous_capacity;
+  top->__previous = top->Processes;
+  top->__previous_count = top->Count;
+  top->__previous_capacity = top->__capacity;
+  top->Processes = processes;
+  top->__capacity = capacity;
+  top->Count = 0;
+
+  // the first tick has no rates
+  double cpu_total = last_tick.Cpu_total ? (double) (top->Tick.Cpu_total - last_tick.Cpu_total) : 0.0,
+         period_s = last_tick.Monotime_ms ? (double) (top->Tick.Monotime_ms - last_tick.Monotime_ms) / 1000.0 : 0.0;
+  long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+  bool ascending = true;
+  size_t cursor = 0;
+  top->Syscalls = 0;
+  for (struct dirent* entry; (entry = readdir(dir));) {
+    if (entry->d_name[0] < '1' || entry->d_name[0] > '9')
+      continue;
+    int pid = atoi(entry->d_name);
+    if (top->Count > 0 && top->Processes[top->Count - 1].Pid > pid)
+      ascending = false;
+    add_process(top, dirfd(dir), pid, &cursor, cpu_total, period_s, page_kb);
+  }
+  closedir(dir);
+  for (size_t i = 0; i < top->__previous_count; ++i) { // exited processes
+    close_file(top, &top->__previous[i].__stat_fd);
+    close_file(top, &top->__previous[i].__io_fd);
+  }
+  if (!ascending) // the next tick is merged in the order of PIDs
+    qsort(top->Processes, top->Count, sizeof(Host_process), compare_pids);
+
+  memset(top->Sums, 0, sizeof(top->Sums));
+  for (size_t i = 0; i < top->Count; ++i)
+    for (int column = 0; column < TARGET_COLUMNS_COUNT; ++column)
+      top->Sums[column] += top->Processes[i].Values[column];
+  Host_top_sort(top, top->Sort);
+  top->Scan_ms = (double) (monotime_ms() - begin);
+  return true;
+#else
+  UNUSED(top);
+  strconcat(errormsg, 1, SAFE_PASS_VARGS("The top of processes of the host is supported only on Linux."));
+  return false;
+#endif
+}
+
+void Host_top_sort(Host_top* top, Target_column column)
+{
+  if (column < 0 || column >= TARGET_COLUMNS_COUNT)
+    column = TARGET_COLUMN_CPU;
+  top->Sort = column;
+  for (size_t i = 0; i < top->Count; ++i)
+    top->__values[i] = top->Processes[i].Values[column];
+  top->Top_count = top->Count ? Columns_top(top->__values, NULL, top->Count, top->Size, top->Top) : 0;
+
+  // the selected process keeps the selection, if it is in the top, otherwise the row is selected
+  for (size_t row = 0; row < top->Top_count; ++row)
+    if (top->Processes[top->Top[row]].Pid == top->Selected_pid) {
+      top->Selected = row;
+      return;
+    }
+  top->Selected = top->Top_count > 0 ? MIN(top->Selected, top->Top_count - 1) : 0;
+  top->Selected_pid = -1;
+}
+
+void Host_top_move(Host_top* top, int rows)
+{
+  if (top->Top_count == 0) {
+    top->Selected = 0;
+    top->Selected_pid = -1;
+    return;
+  }
+  long long row = (long long) top->Selected + rows;
+  row = MAX(row, 0);
+  row = MIN(row, (long long) top->Top_count - 1);
+  top->Selected = (size_t) row;
+  top->Selected_pid = top->Processes[top->Top[top->Selected]].Pid;
+}
+
+const Host_process* Host_top_selected(const Host_top* top)
+{
+  return top->Top_count > 0 ? &top->Processes[top->Top[top->Selected]] : NULL;
+}
+
+void Host_top_free(Host_top* top)
+{
+#ifdef __linux__
+  for (size_t i = 0; i < top->Count; ++i) {
+    close_file(top, &top->Processes[i].__stat_fd);
+    close_file(top, &top->Processes[i].__io_fd);
+  }
+#endif
+  free(top->Processes);
+  free(top->__previous);
+  free(top->__values);
+  free(top->Top);
+  free(top);
+}
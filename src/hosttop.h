@@ -0,0 +1,116 @@
+#ifndef __HOSTTOP_H
+#define __HOSTTOP_H
+
+#include "../include/process.h"
+#include "columns.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define HOST_TOP_NAME_SIZE 16 // 'comm' of the kernel (TASK_COMM_LEN) with the terminating zero
+
+/**
+ * @brief Host_process
+ * One process of the host sampled by Host_top.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  int Pid;                             //! PID
+  unsigned long long Start_time;       //! Start time after the boot in clock ticks, it identifies the process with PID
+  char Name[HOST_TOP_NAME_SIZE];       //! The name of the executable ('comm')
+  char State;                          //! State
+  double Values[TARGET_COLUMNS_COUNT]; //! Metrics, see Target_column
+
+  // private fields
+  unsigned long long __cpu_time;      // utime + stime in clock ticks
+  unsigned long long __read_bytes;    // read bytes
+  unsigned long long __written_bytes; // written bytes
+  bool __io;                          // '/proc/[pid]/io' can be read
+  int __stat_fd;                      // opened '/proc/[pid]/stat' or -1
+  int __io_fd;                        // opened '/proc/[pid]/io' or -1
+} Host_process;
+
+/**
+ * @brief Host_top
+ * Samples all processes of the host every tick and keeps the top of them by one metric, like 'top'. Processes are
+ * listed from '/proc', 'stat' and 'io' of a process are opened once and read again by 'pread' every tick, so the tick
+ * costs two system calls per process, and nothing is allocated per process. Counters of the tick are matched with the
+ * previous tick by one merge of both arrays in the order of PIDs, a process is the same, if its PID and its start time
+ * are the same; the opened 'stat' of the exited process cannot be read, so a reused PID is detected and has no rates in
+ * its first tick. The top is selected by the bounded heap (Columns_top), the host is never sorted. If 'io' of the
+ * process cannot be read (the process of other user), it is not read again and its disk rates are 0. The soft limit of
+ * opened files is raised to the hard limit, files of processes over the limit are opened and closed every tick.
+ * Only on Linux.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  size_t Size;                         //! Maximal number of processes in the top
+  Target_column Sort;                  //! The metric of the top
+  Host_process* Processes;             //! Processes of the last tick in the ascending order of PIDs
+  size_t Count;                        //! Number of processes of the last tick
+  size_t* Top;                         //! Indices of processes in the top, in the descending order of the metric
+  size_t Top_count;                    //! Number of processes in the top
+  size_t Selected;                     //! The selected row of the top
+  int Selected_pid;                    //! PID of the process selected by Host_top_move or -1, it keeps the selection
+  double Sums[TARGET_COLUMNS_COUNT];   //! Sums of metrics of all processes
+  Process_tick Tick;                   //! System-wide data of the last tick
+  double Scan_ms;                      //! Duration of the last update
+  unsigned long long Syscalls;         //! System calls to read files of processes in the last update
+
+  // private fields
+  Host_process* __previous;   // processes of the previous tick
+  size_t __previous_count;    // number of processes of the previous tick
+  size_t __capacity;          // capacity of 'Processes'
+  size_t __previous_capacity; // capacity of '__previous'
+  double* __values;           // values of the sorted metric, its capacity is the maximal capacity of both ticks
+  size_t __opened_files;      // number of opened files of processes
+  size_t __max_opened_files;  // maximal number of opened files of processes
+} Host_top;
+
+/**
+ * @brief Host_top_init
+ * Initializes the new empty top sorted by CPU usage.
+ * @param size Maximal number of processes in the top
+ * @return The pointer to the new structure
+ */
+DECLFUNC Host_top* Host_top_init(size_t size) ATTR(warn_unused_result);
+/**
+ * @brief Host_top_update
+ * Reads system-wide data of the new tick and all processes of the host, calculates their metrics and selects the top.
+ * If '/proc' cannot be read, stores the error message in the 'errormsg' parameter.
+ * @param top The pointer to the structure
+ * @param errormsg The pointer to the error message
+ * @return Result of the update
+ */
+DECLFUNC bool Host_top_update(Host_top* top, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Host_top_sort
+ * Selects the top of the last tick by another metric.
+ * @param top The pointer to the structure
+ * @param column The metric
+ */
+DECLFUNC void Host_top_sort(Host_top* top, Target_column column) ATTR(nonnull(1));
+/**
+ * @brief Host_top_move
+ * Moves the selection by the number of rows, the selection stays in the top. The selected process keeps the selection
+ * in next ticks, while it is in the top.
+ * @param top The pointer to the structure
+ * @param rows Number of rows, negative rows move the selection up
+ */
+DECLFUNC void Host_top_move(Host_top* top, int rows) ATTR(nonnull(1));
+/**
+ * @brief Host_top_selected
+ * Returns the selected process.
+ * @param top The pointer to the structure
+ * @return The pointer to the process of the last tick or NULL, if the top is empty
+ */
+DECLFUNC const Host_process* Host_top_selected(const Host_top* top) ATTR(nonnull(1));
+/**
+ * @brief Host_top_free
+ * Deletes the structure.
+ * @param top The pointer to the structure
+ */
+DECLFUNC void Host_top_free(Host_top* top) ATTR(nonnull(1));
+
+#endif // __HOSTTOP_H
@@ -2,8 +2,13 @@
 
 #ifdef _WIN32
 #include <io.h>
+#include <Windows.h>
 #elif __linux__
 #include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/syscall.h>
 #endif
 
 #include <stdarg.h>
@@ -13,6 +18,20 @@
 
 #define SMALL_BUFFER_SIZE 128
 
+#ifdef __linux__
+#define DIR_READER_BUFFER_SIZE 32768
+
+// the entry returned by the 'getdents64' system call
+struct __linux_dirent64
+{
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+#endif
+
 DECLFUNC static void strrecreate(char **dst)
 {
   char *tmp = malloc(1 * sizeof(char));
@@ -238,3 +257,153 @@ void ulltostr(unsigned long long n, char **dst)
 {
   tostr(&n, dst, UNSIGLED_LONG_LONG_T);
 }
+
+long long fdreadlines(int fd, char *buf, size_t size, Line_handler handler, void *arg)
+{
+  long long total = 0;
+  size_t len = 0;
+  bool skip = false; // skip the rest of too long line
+  while (1) {
+#ifdef _WIN32
+    int bytes = _read(fd, buf + len, (unsigned int) (size - 1 - len));
+#else
+    ssize_t bytes = read(fd, buf + len, size - 1 - len);
+#endif
+    if (bytes < 0)
+      return -1;
+    if (bytes == 0)
+      break;
+    total += bytes;
+    len += (size_t) bytes;
+    buf[len] = '\0';
+
+    char *line = buf, *eol;
+    while ((eol = strchr(line, '\n')) != NULL) {
+      *eol = '\0';
+      if (!skip && !handler(line, arg))
+        return total;
+      skip = false;
+      line = eol + 1;
+    }
+
+    len = (size_t) (buf + len - line);
+    if (len == size - 1) { // line is longer than buffer
+      skip = true;
+      len = 0;
+    }
+    memmove(buf, line, len);
+  }
+  if (len > 0 && !skip) // the last line without newline character
+    handler(buf, arg);
+  return total;
+}
+
+long long monotime_ms()
+{
+  long long t = 0;
+#ifdef __linux__
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  t += ts.tv_sec * 1000;
+  t += ts.tv_nsec / 1000000;
+#elif _WIN32
+  static LARGE_INTEGER freq; // cached frequency
+  if (freq.QuadPart == 0)
+    QueryPerformanceFrequency(&freq);
+  LARGE_INTEGER ts;
+  QueryPerformanceCounter(&ts);
+
+  if (freq.QuadPart != 0)
+    ts.QuadPart /= freq.QuadPart;
+
+  t += ts.QuadPart * 1000;
+#endif
+  return t;
+}
+
+long long realtime_ms()
+{
+  long long t = 0;
+#ifdef __linux__
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+
+  t += ts.tv_sec * 1000;
+  t += ts.tv_nsec / 1000000;
+#elif _WIN32
+  FILETIME ft;
+  GetSystemTimeAsFileTime(&ft);
+  ULARGE_INTEGER i;
+  i.LowPart = ft.dwLowDateTime;
+  i.HighPart = ft.dwHighDateTime;
+  // windows epoch starts at 1 january 1601, 100-nanosecond intervals
+  t = (long long) (i.QuadPart / 10000) - 11644473600000LL;
+#endif
+  return t;
+}
+
+#ifdef __linux__
+Dir_reader *Dir_reader_init()
+{
+  Dir_reader *reader = malloc(sizeof(Dir_reader));
+  ASSERT(reader != NULL, "reader (Dir_reader*) != NULL; malloc(...) returns NULL.");
+  reader->Fd = -1;
+  reader->__bufsize = DIR_READER_BUFFER_SIZE;
+  reader->__buf = malloc(reader->__bufsize);
+  ASSERT(reader->__buf != NULL, "reader->__buf (char*) != NULL; malloc(...) returns NULL.");
+  reader->__pos = 0;
+  reader->__len = 0;
+  return reader;
+}
+
+bool Dir_reader_open(Dir_reader *reader, const char *path)
+{
+  Dir_reader_close(reader);
+
+  reader->Fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  return reader->Fd != -1;
+}
+
+const char *Dir_reader_next(Dir_reader *reader)
+{
+  if (reader->Fd == -1)
+    return NULL;
+
+  while (1) {
+    if (reader->__pos >= reader->__len) {
+      long bytes = syscall(SYS_getdents64, reader->Fd, reader->__buf, reader->__bufsize);
+      if (bytes <= 0)
+        return NULL;
+      reader->__len = (size_t) bytes;
+      reader->__pos = 0;
+    }
+
+    struct __linux_dirent64 *entry = (struct __linux_dirent64 *) (reader->__buf + reader->__pos);
+    reader->__pos += entry->d_reclen;
+
+    const char *name = entry->d_name;
+    // skip '.' and '..'
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+      continue;
+    return name;
+  }
+}
+
+void Dir_reader_close(Dir_reader *reader)
+{
+  if (reader->Fd != -1)
+    close(reader->Fd);
+  reader->Fd = -1;
+  reader->__pos = 0;
+  reader->__len = 0;
+}
+
+void Dir_reader_free(Dir_reader *reader)
+{
+  Dir_reader_close(reader);
+  free(reader->__buf);
+
+  free(reader);
+}
+#endif
@@ -1,33 +1,11 @@
 #include "keys.h"
 
 #ifdef __linux__
-#include <pthread.h>
-#include <unistd.h>
 #include <ncurses.h>
 #elif _WIN32
-#include <Windows.h>
 #include <curses.h>
 #endif
 #include <stdlib.h>
-#include <signal.h>
-
-struct __Keys_thread
-{
-#ifdef __linux__
-  pthread_t Thrd;                //! Thread
-  pthread_mutex_t Mut;           //! Mutex
-  pthread_mutexattr_t Mut_attrs; //! Mutex attributes
-#elif _WIN32
-  HANDLE Thrd;
-  HANDLE Mut;
-#endif
-#ifdef _MSC_VER // TODO: support atomic
-  volatile
-#elif defined __GNUC__ || defined __MINGW32__
-  _Atomic
-#endif
-      bool Running; //! Thread status
-};
 
 struct __Keys_handler
 {
@@ -35,22 +13,19 @@ struct __Keys_handler
   void *Arg;
 };
 
-#ifdef __linux__
-DECLFUNC static void *process_key(void *arg); // Forward declaration
-#elif _WIN32
-DECLFUNC static DWORD WINAPI process_key(LPVOID arg);
-#endif
-
 Keys *Keys_init()
 {
   Keys *k = malloc(sizeof(Keys));
   ASSERT(k != NULL, "k (Keys*) != NULL; malloc(...) returns NULL.");
   k->Error_msg = NULL;
   k->Good = true;
+  k->Chosen_pid = -1;
 
   k->__stat = NULL;
   k->__win = NULL;
-  k->__thrd = NULL;
+  k->__replay = NULL;
+  k->__targets = NULL;
+  k->__top = NULL;
 
   k->__on_start = NULL;
   k->__on_exit = NULL;
@@ -61,116 +36,168 @@ void Keys_set_args(Keys *k, Process_stat *stat, Window *win)
 {
   k->__stat = stat;
   k->__win = win;
-  k->__thrd = malloc(sizeof(struct __Keys_thread));
-  ASSERT(k->__thrd != NULL, "k-<__thrd (__Keys_thread*) != NULL; malloc(...) returns NULL.");
 }
 
-void Keys_start_handle(Keys *k)
+void Keys_set_replay(Keys *k, Replay *replay)
 {
-  if (k->__on_start)
-    k->__on_start->Handler(k->__on_start->Arg);
-
-#ifdef __linux__
-  pthread_mutexattr_init(&(k->__thrd->Mut_attrs));
-  pthread_mutexattr_settype(&(k->__thrd->Mut_attrs), PTHREAD_MUTEX_NORMAL);
-
-  pthread_mutex_init(&(k->__thrd->Mut), &(k->__thrd->Mut_attrs));
-#elif _WIN32
-  k->__thrd->Mut = CreateMutexA(NULL, FALSE /* not thread owner */, NULL);
-#endif
-
-  k->__thrd->Running = true;
-#ifdef __linux__
-  pthread_create(&(k->__thrd->Thrd), NULL, process_key, k);
-#elif _WIN32
-  k->__thrd->Thrd =
-      CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) process_key, k, STACK_SIZE_PARAM_IS_A_RESERVATION, NULL);
-#endif
+  k->__replay = replay;
 }
 
-DECLFUNC ATTR(nonnull(1)) void Keys_destroy(Keys *k)
+void Keys_set_targets(Keys *k, Target_list *targets)
 {
-  k->__thrd->Running = false;
-#ifdef __linux__
-  pthread_join(k->__thrd->Thrd, NULL);
+  k->__targets = targets;
+}
 
-  pthread_mutexattr_destroy(&(k->__thrd->Mut_attrs));
-  pthread_mutex_destroy(&(k->__thrd->Mut));
-#elif _WIN32
-  WaitForSingleObject(k->__thrd->Thrd, INFINITE);
+// processes keys of the table of targets, returns false, if the key is not processed
+static bool process_targets_key(Target_list *targets, int key)
+{
+  switch (key) {
+  case KEY_F(2) /* F2 */:
+    Target_list_sort(targets, (Target_sort) ((targets->Sort + 1) % TARGET_SORT_COLUMNS_COUNT), targets->Descending);
+    break;
+  case KEY_F(3) /* F3 */:
+    Target_list_sort(targets, targets->Sort, !targets->Descending);
+    break;
+  case KEY_F(1) /* F1 */:
+    break; // targets are not killed from the table
+  default:
+    return false;
+  }
+  return true;
+}
 
-  CloseHandle(k->__thrd->Mut);
-  CloseHandle(k->__thrd->Thrd);
-#endif
+void Keys_set_host_top(Keys *k, Host_top *top)
+{
+  k->__top = top;
+}
 
-  free(k->__thrd);
+// processes keys of the top of processes, returns false, if the key is not processed
+static bool process_top_key(Host_top *top, int key)
+{
+  static const int PAGE_ROWS = 10;
+  switch (key) {
+  case KEY_F(2) /* F2 */:
+    Host_top_sort(top, (Target_column) ((top->Sort + 1) % TARGET_COLUMNS_COUNT));
+    break;
+  case KEY_UP:
+    Host_top_move(top, -1);
+    break;
+  case KEY_DOWN:
+    Host_top_move(top, 1);
+    break;
+  case KEY_PPAGE:
+    Host_top_move(top, -PAGE_ROWS);
+    break;
+  case KEY_NPAGE:
+    Host_top_move(top, PAGE_ROWS);
+    break;
+  case KEY_F(1) /* F1 */:
+    break; // processes are not killed from the top
+  case KEY_F(3) /* F3 */:
+    break; // the top has no quantiles
+  default:
+    return false;
+  }
+  return true;
+}
 
-  free(k->__on_start);
-  free(k->__on_exit);
+// processes keys of the replay, returns false, if the key is not processed
+static bool process_replay_key(Replay *replay, int key)
+{
+  static const long long MINUTE_MS = 60 * 1000, HOUR_MS = 60 * 60 * 1000;
+  switch (key) {
+  case ' ':
+    replay->Paused = !replay->Paused;
+    break;
+  case '1':
+    replay->Speed = 1;
+    break;
+  case '2':
+    replay->Speed = 10;
+    break;
+  case '3':
+    replay->Speed = 100;
+    break;
+  case KEY_LEFT:
+    Replay_seek_relative(replay, -MINUTE_MS);
+    break;
+  case KEY_RIGHT:
+    Replay_seek_relative(replay, MINUTE_MS);
+    break;
+  case KEY_PPAGE:
+    Replay_seek_relative(replay, -HOUR_MS);
+    break;
+  case KEY_NPAGE:
+    Replay_seek_relative(replay, HOUR_MS);
+    break;
+  case KEY_HOME:
+    Replay_seek(replay, replay->Reader->First_time_ms);
+    break;
+  case KEY_END:
+    Replay_seek(replay, replay->Reader->Last_time_ms);
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
 
-  free(k);
+void Keys_start_handle(Keys *k)
+{
+  if (k->__on_start)
+    k->__on_start->Handler(k->__on_start->Arg);
 }
 
-#ifdef __linux__
-static void *process_key(void *arg)
-#elif _WIN32
-static DWORD WINAPI process_key(LPVOID arg)
-#endif
+bool Keys_process(Keys *k)
 {
-  Keys *k = (Keys *) arg;
-  if (!k)
-#ifdef __linux__
-    return (void *) -1;
-#elif _WIN32
-    return FALSE;
-#endif
+  int key;
+  while ((key = (int) getch()) != ERR) {
+    if (k->__replay && process_replay_key(k->__replay, key))
+      continue;
+    if (k->__targets && process_targets_key(k->__targets, key))
+      continue;
+    if (k->__top && process_top_key(k->__top, key))
+      continue;
+    if (k->__top && (key == '\n' || key == '\r' || key == KEY_ENTER) && Host_top_selected(k->__top)) {
+      k->Chosen_pid = Host_top_selected(k->__top)->Pid;
+      return false;
+    }
+
+    switch (key) {
+    case KEY_F(1) /* F1 */:
+      if (k->__replay)
+        break; // the recorded process is not killed
 
-  while (k->__thrd->Running) {
-    switch ((int) getch()) {
-    case KEY_F(1) /* F1 */: {
-#ifdef __linux__
-      pthread_mutex_lock(&(k->__thrd->Mut));
-#elif _WIN32
-      DWORD lock_result = WaitForSingleObject(k->__thrd->Mut, INFINITE);
-      switch (lock_result) {
-      case WAIT_ABANDONED:
-      case WAIT_TIMEOUT:
-      case WAIT_FAILED: {
-        ASSERT(lock_result == WAIT_OBJECT_0, "Cannot to lock mutex!");
-      }
-      }
-#endif
       if (k->Good && !Process_stat_kill(k->__stat, &k->Error_msg)) {
         k->Good = false;
         printf("%s\n", k->Error_msg);
         printw("%s\n", k->Error_msg);
       }
-
       Window_refresh(k->__win, k->__stat); // refresh
-#ifdef __linux__
-      pthread_mutex_unlock(&(k->__thrd->Mut));
-#elif _WIN32
-      ASSERT(!ReleaseMutex(k->__thrd->Mut), "Cannot to unlock mutex!");
-#endif
       break;
-    }
+    case KEY_F(2) /* F2 */:
+      Window_next_panel(k->__win);
+      break;
+    case KEY_F(3) /* F3 */:
+      Window_toggle_quantiles(k->__win);
+      break;
     case KEY_F(4) /* F4 */:
-      raise(SIGINT); // raise SIGINT and exit
       if (k->__on_exit)
         k->__on_exit->Handler(k->__on_exit->Arg);
-#ifdef __linux__
-      return (void *) 0;
-    }
-    usleep(80 * 1000 /* 80 ms */);
-  }
-  return (void *) 0;
-#elif _WIN32
-      return TRUE;
+      return false;
+    default:
+      break;
     }
-    Sleep(80 /* 80 ms */);
   }
-  return TRUE;
-#endif
+  return true;
+}
+
+DECLFUNC ATTR(nonnull(1)) void Keys_destroy(Keys *k)
+{
+  free(k->__on_start);
+  free(k->__on_exit);
+
+  free(k);
 }
 
 void Keys_set_handler(Keys *k, Keys_handler_attr attr, Keys_handler f, void *arg)
@@ -3,8 +3,7 @@
 
 #include "twindow.h"
 #include "process.h"
-
-struct __Keys_thread; // Forward declaration
+#include "replay.h"
 
 /**
  * @brief Keys_handler
@@ -22,10 +21,13 @@ typedef struct
 {
   char *Error_msg; //! Error message
   bool Good;       //! The status of processing keys
+  int Chosen_pid;  //! PID chosen by Enter in the top of processes or -1
   // private fields
   Process_stat *__stat;
   Window *__win;
-  struct __Keys_thread *__thrd;
+  Replay *__replay;
+  Target_list *__targets;
+  Host_top *__top;
   struct __Keys_handler *__on_start; // hanler on start
   struct __Keys_handler *__on_exit;  // handler on exit
 } Keys;
@@ -56,6 +58,28 @@ DECLFUNC Keys *Keys_init() ATTR(warn_unused_result);
  * @param win The pointer to the Window structure
  */
 DECLFUNC void Keys_set_args(Keys *k, Process_stat *stat, Window *win) ATTR(nonnull(1, 2, 3));
+/**
+ * @brief Keys_set_replay
+ * Sets the replay controlled by keys. In replay, the process cannot be killed.
+ * @param k The pointer to the Keys structure
+ * @param replay The pointer to the Replay structure
+ */
+DECLFUNC void Keys_set_replay(Keys *k, Replay *replay) ATTR(nonnull(1, 2));
+/**
+ * @brief Keys_set_targets
+ * Sets the list of targets of the table view: F2 sorts by the next column, F3 reverses the order.
+ * @param k The pointer to the Keys structure
+ * @param targets The pointer to the list of targets
+ */
+DECLFUNC void Keys_set_targets(Keys *k, Target_list *targets) ATTR(nonnull(1, 2));
+/**
+ * @brief Keys_set_host_top
+ * Sets the top of processes of the host: F2 sorts by the next metric, Up/Down/PgUp/PgDn select the process, Enter
+ * chooses the selected process and stops processing of keys like the exit key ('Chosen_pid').
+ * @param k The pointer to the Keys structure
+ * @param top The pointer to the top of processes
+ */
+DECLFUNC void Keys_set_host_top(Keys *k, Host_top *top) ATTR(nonnull(1, 2));
 /**
  * @brief Keys_set_handler
  * Sets handler with attributes. Handlers may be use on start or exit.
@@ -67,10 +91,17 @@ DECLFUNC void Keys_set_args(Keys *k, Process_stat *stat, Window *win) ATTR(nonnu
 DECLFUNC void Keys_set_handler(Keys *k, Keys_handler_attr attr, Keys_handler f, void *arg) ATTR(nonnull(1, 3, 4));
 /**
  * @brief Keys_start_handle
- * Starts the keys processing in an another thread.
+ * Starts the keys processing, calls the start handler. Keys are passed to Keys_process by the event loop of the caller.
  * @param k The pointer to the Keys structure
  */
 DECLFUNC void Keys_start_handle(Keys *k) ATTR(nonnull(1));
+/**
+ * @brief Keys_process
+ * Reads and processes all available keys of the window. Calls the exit handler, if the exit key is pressed.
+ * @param k The pointer to the Keys structure
+ * @return false, if the exit key is pressed or the process is chosen in the top of processes
+ */
+DECLFUNC bool Keys_process(Keys *k) ATTR(nonnull(1));
 /**
  * @brief Keys_destroy
  * Deletes the Keys structure.
@@ -1,9 +1,20 @@
 #include "ioutils.h"
 #include "twindow.h"
 #include "process.h"
+#include "metrics.h"
+#include "recording.h"
+#include "replay.h"
+#include "batch.h"
+#include "prometheus.h"
+#include "shmsnapshot.h"
+#include "statsd.h"
 #include "keys.h"
 #include "cmdargs.h"
-#include "multithreading.h"
+#include "eventloop.h"
+#include "adaptive.h"
+#include "targets.h"
+#include "samplerpool.h"
+#include "hosttop.h"
 
 #ifdef __linux__
 #include <unistd.h>
@@ -12,7 +23,9 @@
 #include <Windows.h>
 #endif
 #include <signal.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 static
 #ifdef _MSC_VER // TODO: support atomic
@@ -28,9 +41,445 @@ static void sighandler(int sig)
   Is_running = false;
 }
 
-KEYS_DECL_HANDLER(exit_handler, arg);
 KEYS_DECL_HANDLER(start_handler, arg);
 
+// outputs fed with every sample
+typedef struct
+{
+  Recording_writer* Recorder;
+  Prometheus_server* Exporter;
+  Shm_publisher* Publisher;
+  Statsd_exporter* Statsd;
+} Outputs;
+
+// the sampling schedule
+typedef struct
+{
+  Event_loop* Loop;
+  Adaptive_rate* Rate; // NULL, if the interval is fixed
+} Schedule;
+
+// opens the replay or finds the process
+static bool open_source(const Cmd_args* args, const char* target, Process_stat* stat, Replay** replay, char** errormsg)
+{
+  if (args->Replay_path)
+    return (*replay = Replay_init(args->Replay_path, stat, errormsg)) != NULL;
+  return Target_find(stat, target, errormsg);
+}
+
+// opens outputs requested by options
+static bool open_outputs(const Cmd_args* args, const Process_stat* stat, Outputs* outputs, char** errormsg)
+{
+  // samples are recorded by the monotonic time, the real time is restored by the offset in the header
+  if (args->Record_path &&
+      !(outputs->Recorder = Recording_writer_open(
+            args->Record_path, stat->Process_name, stat->Pid, realtime_ms() - monotime_ms(), errormsg)))
+    return false;
+  if (args->Prometheus_address && !(outputs->Exporter = Prometheus_start(args->Prometheus_address, errormsg)))
+    return false;
+  if (args->Shm_name &&
+      !(outputs->Publisher = Shm_publisher_open(
+            args->Shm_name, stat->Process_name, stat->Pid, (size_t) args->Shm_history_size, errormsg)))
+    return false;
+  if (args->Statsd_address &&
+      !(outputs->Statsd = Statsd_start(args->Statsd_address,
+                                       args->Statsd_prefix,
+                                       stat->Process_name,
+                                       (size_t) args->Statsd_mtu,
+                                       args->Statsd_interval_ms,
+                                       errormsg)))
+    return false;
+  return true;
+}
+
+static void close_outputs(Outputs* outputs)
+{
+  if (outputs->Recorder)
+    Recording_writer_close(outputs->Recorder);
+  if (outputs->Exporter)
+    Prometheus_stop(outputs->Exporter);
+  if (outputs->Publisher)
+    Shm_publisher_close(outputs->Publisher);
+  if (outputs->Statsd)
+    Statsd_stop(outputs->Statsd);
+}
+
+// feeds the sample to all outputs, the recorder takes the monotonic time, other outputs take the real time
+static bool output_sample(
+    Outputs* outputs, const Process_stat* stat, long long monotime, long long time_ms, char** errormsg)
+{
+  if (outputs->Recorder) {
+    double values[METRIC_COUNT];
+    Metric_values(stat, values);
+    if (!Recording_writer_append(outputs->Recorder, monotime, values, errormsg))
+      return false;
+  }
+  if (outputs->Exporter)
+    Prometheus_publish(outputs->Exporter, stat, time_ms);
+  if (outputs->Publisher)
+    Shm_publisher_publish(outputs->Publisher, stat, time_ms);
+  if (outputs->Statsd)
+    Statsd_publish(outputs->Statsd, stat);
+  return true;
+}
+
+// adapts the interval of ticks to the new sample
+static void adapt_interval(Schedule* schedule, const Process_stat* stat)
+{
+  if (schedule->Rate)
+    Event_loop_set_interval(schedule->Loop, Adaptive_rate_update(schedule->Rate, stat));
+}
+
+// starts measuring the own cost of the tick, if the overhead is measured
+static void begin_tick(Process_stat* stat)
+{
+  if (stat->Overhead)
+    Overhead_begin_tick(stat->Overhead);
+}
+
+// finishes measuring the own cost of the tick
+static void end_tick(Process_stat* stat)
+{
+  if (stat->Overhead)
+    Overhead_end_tick(stat->Overhead);
+}
+
+// starts the probe of the tick
+static void probe_begin(Process_stat* stat, Overhead_probe probe)
+{
+  if (stat->Overhead)
+    Overhead_begin(stat->Overhead, probe);
+}
+
+// finishes the probe of the tick
+static void probe_end(Process_stat* stat, Overhead_probe probe)
+{
+  if (stat->Overhead)
+    Overhead_end(stat->Overhead, probe);
+}
+
+// waits for the next sampling tick, returns false, if the loop must be stopped
+static bool wait_tick(Event_loop* loop)
+{
+  int events;
+  while (!((events = Event_loop_wait(loop)) & (EVENT_LOOP_TICK | EVENT_LOOP_EXIT | EVENT_LOOP_PROCESS_EXIT)))
+    ; // resizes are not important without the interface
+  return !(events & EVENT_LOOP_EXIT);
+}
+
+// writes samples without the interface until the process exits or a signal is received
+static void run_batch(const Cmd_args* args, Process_stat* stat, Outputs* outputs, Schedule* schedule, char** errormsg)
+{
+  Batch_writer* writer = Batch_writer_open(args->Output_path, args->Batch, errormsg);
+  if (!writer)
+    return;
+#ifdef __linux__
+  signal(SIGPIPE, SIG_IGN); // the closed pipe is reported by the writer
+#endif
+
+  double values[METRIC_COUNT];
+  while (Is_running) {
+    begin_tick(stat);
+    if (!Process_stat_update(stat, errormsg))
+      break;
+    long long now = realtime_ms();
+    probe_begin(stat, OVERHEAD_OUTPUTS);
+    Metric_values(stat, values);
+    bool written = Batch_writer_write(writer, now, values, errormsg) &&
+                   output_sample(outputs, stat, monotime_ms(), now, errormsg);
+    probe_end(stat, OVERHEAD_OUTPUTS);
+    end_tick(stat);
+    if (!written)
+      break;
+
+    adapt_interval(schedule, stat);
+    if (!wait_tick(schedule->Loop))
+      break;
+  }
+  Batch_writer_close(writer);
+}
+
+// draws recorded samples instead of the running process, graphs are not moved while the replay is paused
+static void draw_replay(Window* win, Process_stat* stat, Replay* replay)
+{
+  if (Replay_update(replay, stat) > 0)
+    Window_add_sample(win, stat);
+  Replay_status(replay, win->Status, sizeof(win->Status));
+  Window_draw(win, stat);
+}
+
+// stores the effective sampling rate and the accuracy of the sampling cadence in the status line
+static void format_ticks(const Schedule* schedule, char* status, size_t size)
+{
+  const Event_loop* loop = schedule->Loop;
+  long int interval_ms = Event_loop_interval(loop);
+  snprintf(status,
+           size,
+           "Interval: %ldms (%.2f/s%s), ticks: %llu, missed: %llu, lateness p50 < %lldus, p99 < %lldus, max %lldus",
+           interval_ms,
+           1000.0 / (double) interval_ms,
+           schedule->Rate ? ", adaptive" : "",
+           loop->Ticks_count,
+           loop->Missed_ticks,
+           Event_loop_lateness_us(loop, 0.5),
+           Event_loop_lateness_us(loop, 0.99),
+           loop->Max_lateness_us);
+}
+
+// takes the new sample and draws it, returns false, if the process is not available
+static bool sample_window(
+    Window* win, Process_stat* stat, Replay* replay, Outputs* outputs, Schedule* schedule, char** errormsg)
+{
+  if (replay) {
+    draw_replay(win, stat, replay);
+    return output_sample(outputs, stat, replay->Time_ms, replay->Time_ms, errormsg); // nothing is recorded
+  }
+
+  begin_tick(stat);
+  format_ticks(schedule, win->Status, sizeof(win->Status));
+  if (!Window_refresh(win, stat))
+    return false;
+  adapt_interval(schedule, stat);
+
+  probe_begin(stat, OVERHEAD_OUTPUTS);
+  bool success = output_sample(outputs, stat, monotime_ms(), realtime_ms(), errormsg);
+  probe_end(stat, OVERHEAD_OUTPUTS);
+  end_tick(stat);
+  return success;
+}
+
+// draws the interface until the exit key is pressed, the process exits or a signal is received
+static void run_window(Process_stat* stat, Replay* replay, Outputs* outputs, Schedule* schedule, char** errormsg)
+{
+  Keys* keys = Keys_init();
+  Window* mainwin = Window_init();
+
+  Keys_set_args(keys, stat, mainwin);
+  Keys_set_handler(keys, KEYS_ON_START, start_handler, mainwin);
+  if (replay) {
+    Keys_set_replay(keys, replay);
+    mainwin->Read_only = true;
+  }
+
+  Keys_start_handle(keys); // start process keys
+  bool running = sample_window(mainwin, stat, replay, outputs, schedule, errormsg);
+  while (running && Is_running) {
+    int events = Event_loop_wait(schedule->Loop);
+    if ((events & EVENT_LOOP_EXIT) || ((events & EVENT_LOOP_INPUT) && !Keys_process(keys)))
+      break;
+
+    if (events & (EVENT_LOOP_TICK | EVENT_LOOP_PROCESS_EXIT))
+      running = sample_window(mainwin, stat, replay, outputs, schedule, errormsg);
+    else if (replay) // keys and resizes are drawn at once without sampling
+      draw_replay(mainwin, stat, replay);
+    else
+      Window_draw(mainwin, stat);
+  }
+
+  Is_running = false;
+  Window_destroy(mainwin);
+  Keys_destroy(keys);
+}
+
+// takes the new sample of all targets and draws the table, returns false, if no target is available
+static bool sample_table(Window* win, Target_list* targets, Sampler_pool* pool, Schedule* schedule, char** errormsg)
+{
+  size_t alive = Sampler_pool_update(pool, targets, errormsg);
+  format_ticks(schedule, win->Status, sizeof(win->Status));
+  size_t length = strlen(win->Status);
+  snprintf(win->Status + length,
+           sizeof(win->Status) - length,
+           ", workers: %zu, update: %.0fms",
+           pool->Workers_count,
+           pool->Tick_ms);
+  if (targets->Reader) {
+    length = strlen(win->Status);
+    snprintf(win->Status + length,
+             sizeof(win->Status) - length,
+             ", %s: %llu syscalls",
+             Proc_reader_backend_name(targets->Reader->Backend),
+             targets->Reader->Syscalls);
+  }
+  Window_draw_table(win, targets);
+  return alive > 0;
+}
+
+// draws the table of targets until the exit key is pressed, all targets exit or a signal is received
+static void run_table(Target_list* targets, Sampler_pool* pool, Schedule* schedule, char** errormsg)
+{
+  Keys* keys = Keys_init();
+  Window* mainwin = Window_init();
+
+  Keys_set_targets(keys, targets);
+  Keys_set_handler(keys, KEYS_ON_START, start_handler, mainwin);
+  mainwin->Read_only = true;
+
+  Keys_start_handle(keys); // start process keys
+  bool running = sample_table(mainwin, targets, pool, schedule, errormsg);
+  while (running && Is_running) {
+    int events = Event_loop_wait(schedule->Loop);
+    if ((events & EVENT_LOOP_EXIT) || ((events & EVENT_LOOP_INPUT) && !Keys_process(keys)))
+      break;
+
+    if (events & EVENT_LOOP_TICK)
+      running = sample_table(mainwin, targets, pool, schedule, errormsg);
+    else // keys and resizes are drawn at once without sampling
+      Window_draw_table(mainwin, targets);
+  }
+
+  Is_running = false;
+  Window_destroy(mainwin);
+  Keys_destroy(keys);
+}
+
+// watches many targets by one sampler, outputs of one process are not supported
+static void watch_targets(const Cmd_args* args, char** errormsg)
+{
+  Target_list* targets = Target_list_init();
+  bool found = true;
+  for (int i = 0; found && i < args->Targets_count; ++i)
+    found = Target_list_add(targets, args->Targets[i], errormsg) != NULL;
+
+  if (found && args->Batched_reads)
+    targets->Reader = Proc_reader_init(args->Reader_backend);
+  if (found) {
+    Is_running = true;
+    // the loop is created before workers, so they do not receive signals of the loop
+    Schedule schedule = {Event_loop_init(fileno(stdin), args->Refresh_timeout_ms, errormsg), NULL};
+    if (schedule.Loop) {
+      Sampler_pool* pool = Sampler_pool_init((size_t) args->Workers);
+      run_table(targets, pool, &schedule, errormsg);
+      Sampler_pool_free(pool);
+      Event_loop_free(schedule.Loop);
+    }
+    Is_running = false;
+  }
+  Target_list_free(targets);
+}
+
+// takes the new sample of all processes of the host and draws the top, returns false, if '/proc' cannot be read
+static bool sample_top(Window* win, Host_top* top, Schedule* schedule, char** errormsg)
+{
+  bool success = Host_top_update(top, errormsg);
+  format_ticks(schedule, win->Status, sizeof(win->Status));
+  size_t length = strlen(win->Status);
+  snprintf(win->Status + length,
+           sizeof(win->Status) - length,
+           ", update: %.0fms, %llu syscalls",
+           top->Scan_ms,
+           top->Syscalls);
+  Window_draw_host_top(win, top);
+  return success;
+}
+
+// draws the top of processes until the exit key is pressed, the process is chosen or a signal is received, returns
+// PID of the chosen process or -1
+static int run_top(Host_top* top, Schedule* schedule, char** errormsg)
+{
+  Keys* keys = Keys_init();
+  Window* mainwin = Window_init();
+
+  Keys_set_host_top(keys, top);
+  Keys_set_handler(keys, KEYS_ON_START, start_handler, mainwin);
+  mainwin->Read_only = true;
+
+  Keys_start_handle(keys); // start process keys
+  bool running = sample_top(mainwin, top, schedule, errormsg);
+  while (running && Is_running) {
+    int events = Event_loop_wait(schedule->Loop);
+    if ((events & EVENT_LOOP_EXIT) || ((events & EVENT_LOOP_INPUT) && !Keys_process(keys)))
+      break;
+
+    if (events & EVENT_LOOP_TICK)
+      running = sample_top(mainwin, top, schedule, errormsg);
+    else // keys and resizes are drawn at once without sampling
+      Window_draw_host_top(mainwin, top);
+  }
+
+  int pid = Is_running ? keys->Chosen_pid : -1;
+  Window_destroy(mainwin);
+  Keys_destroy(keys);
+  return pid;
+}
+
+// watches the top of all processes of the host, returns PID of the process chosen to watch or -1
+static int watch_top(const Cmd_args* args, char** errormsg)
+{
+  int pid = -1;
+  Host_top* top = Host_top_init((size_t) args->Top);
+  Is_running = true;
+  Schedule schedule = {Event_loop_init(fileno(stdin), args->Refresh_timeout_ms, errormsg), NULL};
+  if (schedule.Loop) {
+    pid = run_top(top, &schedule, errormsg);
+    Event_loop_free(schedule.Loop);
+  }
+  Is_running = false;
+  Host_top_free(top);
+  return pid;
+}
+
+// watches one process (the target) or the replay
+static void watch_process(const Cmd_args* args, const char* target)
+{
+  Process_stat* stat = Process_stat_init();
+#ifdef __linux__
+  if (!args->Replay_path) {
+    stat->Fds = Fd_list_init();
+    stat->Sockets = Socket_list_init();
+    stat->Numa = Numa_stat_init(args->Numa_interval_ms);
+  }
+#endif
+  stat->History = Timeseries_init(METRIC_COUNT, (size_t) args->History_size);
+  if (!args->Replay_path)
+    stat->Overhead = Overhead_init(); // the main thread samples, draws and feeds outputs
+  {
+    long long window_ms = (long long) args->Quantile_window_min * 60 * 1000;
+    stat->Cpu_sketch = Sketch_init(window_ms);
+    stat->Memory_sketch = Sketch_init(window_ms);
+    stat->Disk_read_sketch = Sketch_init(window_ms);
+    stat->Disk_write_sketch = Sketch_init(window_ms);
+  }
+
+  char* errormsg = NULL;
+  Replay* replay = NULL;
+  Outputs outputs = {NULL, NULL, NULL, NULL};
+  if (open_source(args, target, stat, &replay, &errormsg)) {
+    Is_running = true;
+
+    Schedule schedule = {NULL, NULL};
+    if (args->Adaptive)
+      schedule.Rate = Adaptive_rate_init(args->Adaptive_min_ms, args->Adaptive_max_ms, args->Refresh_timeout_ms);
+    // the loop is created before threads of outputs, so they do not receive signals of the loop
+    schedule.Loop = Event_loop_init(args->Batch != BATCH_NONE ? -1 : fileno(stdin),
+                                    schedule.Rate ? schedule.Rate->Interval_ms : args->Refresh_timeout_ms,
+                                    &errormsg);
+    if (schedule.Loop && !replay)
+      Event_loop_watch_pid(schedule.Loop, stat->Pid);
+    if (schedule.Loop && open_outputs(args, stat, &outputs, &errormsg)) {
+      if (args->Batch != BATCH_NONE)
+        run_batch(args, stat, &outputs, &schedule, &errormsg); // curses is not initialized
+      else
+        run_window(stat, replay, &outputs, &schedule, &errormsg);
+    }
+
+    Is_running = false;
+    close_outputs(&outputs);
+    if (schedule.Loop)
+      Event_loop_free(schedule.Loop);
+    if (schedule.Rate)
+      Adaptive_rate_free(schedule.Rate);
+    if (replay)
+      Replay_free(replay);
+  }
+  if (errormsg)
+    fprintf(args->Batch != BATCH_NONE ? stderr : stdout, "%s\n", errormsg); // stdout contains only samples
+
+  free(errormsg);
+  if (stat->Overhead)
+    Overhead_free(stat->Overhead);
+  Process_stat_free(stat);
+}
+
 int main(int argc, char** argv)
 {
   UNUSED(argc);
@@ -41,42 +490,26 @@ int main(int argc, char** argv)
 
   int rc = 0;
   Cmd_args* args = Cmd_args_init(argc, argv);
-  if (args->Valid) {
-    Process_stat* stat = Process_stat_init();
-
+  if (args->Valid && args->Targets_count > 1) {
     char* errormsg = NULL;
-    if (Process_stat_set_pid(stat, args->Process_name, &errormsg)) {
-      Is_running = true;
-
-      Condition_variable* maincv = Condition_variable_init();
-      Condition_variable_set_time(maincv, args->Refresh_timeout_ms);
-
-      Keys* keys = Keys_init();
-      Window* mainwin = Window_init();
-
-      Keys_set_args(keys, stat, mainwin);
-      Keys_set_handler(keys, KEYS_ON_START, start_handler, mainwin);
-      Keys_set_handler(keys, KEYS_ON_EXIT, exit_handler, maincv);
-
-      Keys_start_handle(keys); // start process keys
-      while (Is_running) {
-        if (!Window_refresh(mainwin, stat))
-          break;
-
-        Condition_variable_wait(maincv);
-      }
-
-      Is_running = false;
-      Window_destroy(mainwin);
-      Keys_destroy(keys);
-      Condition_variable_destroy(maincv);
-    } else {
-      if (errormsg)
-        printf("%s\n", errormsg);
+    watch_targets(args, &errormsg);
+    if (errormsg)
+      printf("%s\n", errormsg);
+    free(errormsg);
+  } else if (args->Valid && args->Top > 0) {
+    char* errormsg = NULL;
+    int pid = watch_top(args, &errormsg);
+    if (pid > 0 && !errormsg) { // the chosen process is watched in the detailed view
+      char* target = NULL;
+      itostr(pid, &target);
+      watch_process(args, target);
+      free(target);
     }
-
+    if (errormsg)
+      printf("%s\n", errormsg);
     free(errormsg);
-    Process_stat_free(stat);
+  } else if (args->Valid) {
+    watch_process(args, args->Process_name);
   } else {
     if (args->Errormsg)
       printf("%s\n", args->Errormsg);
@@ -87,15 +520,6 @@ int main(int argc, char** argv)
   return rc;
 }
 
-KEYS_DECL_HANDLER(exit_handler, arg)
-{
-  Condition_variable* cv = (Condition_variable*) arg;
-  if (!cv)
-    return;
-
-  Condition_variable_signal(cv); // signal waiting
-}
-
 KEYS_DECL_HANDLER(start_handler, arg)
 {
   Window* w = (Window*) arg;
@@ -0,0 +1,123 @@
+#include "metrics.h"
+
+// clang-format off
+static const Metric_info METRICS[METRIC_COUNT] = {
+  {"cpu_usage",           "%",    "CPU usage",                                     METRIC_GAUGE},
+  {"memory_usage",        "MB",   "Memory usage",                                  METRIC_GAUGE},
+  {"disk_read_mb_usage",  "MB/s", "Disk read usage",                               METRIC_GAUGE},
+  {"disk_write_mb_usage", "MB/s", "Disk write usage",                              METRIC_GAUGE},
+  {"disk_read_kb",        "KB",   "Disk read",                                     METRIC_COUNTER},
+  {"disk_written_kb",     "KB",   "Disk written",                                  METRIC_COUNTER},
+  {"priority",            "",     "Priority",                                      METRIC_GAUGE},
+  {"open_fds",            "",     "Open file descriptors",                         METRIC_GAUGE},
+  {"sockets",             "",     "Sockets",                                       METRIC_GAUGE},
+  {"socket_recv_queue",   "B",    "Bytes in socket receive queues",                METRIC_GAUGE},
+  {"socket_send_queue",   "B",    "Bytes in socket send queues",                   METRIC_GAUGE},
+  {"numa_remote_usage",   "%",    "Share of memory on remote NUMA nodes",          METRIC_GAUGE},
+  {"thp_usage",           "%",    "Share of anonymous memory in huge pages",       METRIC_GAUGE},
+  {"self_cpu_ms",         "ms",   "CPU time of the watcher per tick",              METRIC_GAUGE},
+  {"self_syscalls",       "",     "Syscalls of the watcher per tick",              METRIC_GAUGE},
+  {"self_read_bytes",     "B",    "Bytes read by the watcher per tick",            METRIC_GAUGE},
+  {"self_allocations",    "",     "Heap allocations of the watcher per tick",      METRIC_GAUGE},
+  {"self_process_cpu_ms", "ms",   "CPU time of the process collector per tick",    METRIC_GAUGE},
+  {"self_fds_cpu_ms",     "ms",   "CPU time of the fds collector per tick",        METRIC_GAUGE},
+  {"self_sockets_cpu_ms", "ms",   "CPU time of the sockets collector per tick",    METRIC_GAUGE},
+  {"self_numa_cpu_ms",    "ms",   "CPU time of the NUMA collector per tick",       METRIC_GAUGE},
+  {"self_history_cpu_ms", "ms",   "CPU time of the history per tick",              METRIC_GAUGE},
+  {"self_render_cpu_ms",  "ms",   "CPU time of the rendering per tick",            METRIC_GAUGE},
+  {"self_outputs_cpu_ms", "ms",   "CPU time of outputs per tick",                  METRIC_GAUGE},
+};
+// clang-format on
+
+const Metric_info* Metric_get_info(Metric_id id)
+{
+  if (id < 0 || id >= METRIC_COUNT)
+    return NULL;
+  return &METRICS[id];
+}
+
+double Metric_value(const Process_stat* stat, Metric_id id)
+{
+  switch (id) {
+  case METRIC_CPU_USAGE:
+    return stat->Cpu_usage;
+  case METRIC_MEMORY_USAGE:
+    return stat->Memory_usage;
+  case METRIC_DISK_READ_MB_USAGE:
+    return stat->Disk_read_mb_usage;
+  case METRIC_DISK_WRITE_MB_USAGE:
+    return stat->Disk_write_mb_usage;
+  case METRIC_DISK_READ_KB:
+    return (double) stat->Disk_read_kb;
+  case METRIC_DISK_WRITTEN_KB:
+    return (double) stat->Disk_written_kb;
+  case METRIC_PRIORITY:
+    return (double) stat->Priority;
+  case METRIC_OPEN_FDS:
+    return stat->Fds ? (double) stat->Fds->Count : 0.0;
+  case METRIC_SOCKETS:
+    return stat->Sockets ? (double) stat->Sockets->Count : 0.0;
+  case METRIC_SOCKET_RECV_QUEUE:
+    return stat->Sockets ? (double) stat->Sockets->Recv_queue_total : 0.0;
+  case METRIC_SOCKET_SEND_QUEUE:
+    return stat->Sockets ? (double) stat->Sockets->Send_queue_total : 0.0;
+  case METRIC_NUMA_REMOTE_USAGE:
+    return stat->Numa ? stat->Numa->Remote_usage : 0.0;
+  case METRIC_THP_USAGE:
+    return stat->Numa ? stat->Numa->Thp_usage : 0.0;
+  case METRIC_SELF_CPU_MS:
+    return stat->Overhead ? stat->Overhead->Tick.Cpu_ms : 0.0;
+  case METRIC_SELF_SYSCALLS:
+    return stat->Overhead ? (double) stat->Overhead->Tick.Syscalls : 0.0;
+  case METRIC_SELF_READ_BYTES:
+    return stat->Overhead ? (double) stat->Overhead->Tick.Read_bytes : 0.0;
+  case METRIC_SELF_ALLOCATIONS:
+    return stat->Overhead ? (double) stat->Overhead->Tick.Allocations : 0.0;
+  case METRIC_SELF_PROCESS_CPU_MS:
+  case METRIC_SELF_FDS_CPU_MS:
+  case METRIC_SELF_SOCKETS_CPU_MS:
+  case METRIC_SELF_NUMA_CPU_MS:
+  case METRIC_SELF_HISTORY_CPU_MS:
+  case METRIC_SELF_RENDER_CPU_MS:
+  case METRIC_SELF_OUTPUTS_CPU_MS: // probes are in the same order
+    return stat->Overhead ? stat->Overhead->Probes[id - METRIC_SELF_PROCESS_CPU_MS].Cpu_ms : 0.0;
+  default:
+    return 0.0;
+  }
+}
+
+void Metric_values(const Process_stat* stat, double* values)
+{
+  for (int id = 0; id < METRIC_COUNT; ++id)
+    values[id] = Metric_value(stat, (Metric_id) id);
+}
+
+bool Metric_set_value(Process_stat* stat, Metric_id id, double value)
+{
+  switch (id) {
+  case METRIC_CPU_USAGE:
+    stat->Cpu_usage = value;
+    break;
+  case METRIC_MEMORY_USAGE:
+    stat->Memory_usage = value;
+    break;
+  case METRIC_DISK_READ_MB_USAGE:
+    stat->Disk_read_mb_usage = value;
+    break;
+  case METRIC_DISK_WRITE_MB_USAGE:
+    stat->Disk_write_mb_usage = value;
+    break;
+  case METRIC_DISK_READ_KB:
+    stat->Disk_read_kb = (unsigned long long) value;
+    break;
+  case METRIC_DISK_WRITTEN_KB:
+    stat->Disk_written_kb = (unsigned long long) value;
+    break;
+  case METRIC_PRIORITY:
+    stat->Priority = (int) value;
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
@@ -8,7 +8,7 @@
 static void set_timeout_from_now(long int offsetms, time_t *sec, long *nsec)
 {
   struct timespec now;
-  clock_gettime(CLOCK_REALTIME, &now);
+  clock_gettime(CLOCK_MONOTONIC, &now);
 
   *sec = now.tv_sec + (offsetms / 1000);             // sec
   *nsec = now.tv_nsec + (offsetms % 1000) * 1000000; // convert to nanosec
@@ -27,7 +27,7 @@ Condition_variable *Condition_variable_init()
   {
     pthread_condattr_t cvattr;
     pthread_condattr_init(&cvattr);
-    pthread_condattr_setclock(&cvattr, CLOCK_REALTIME);
+    pthread_condattr_setclock(&cvattr, CLOCK_MONOTONIC); // timeouts do not follow steps of the system clock
     pthread_cond_init(&cv->__cv, &cvattr);
   }
   cv->__ts = NULL;
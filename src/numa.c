@@ -0,0 +1,285 @@
+#include "numa.h"
+
+#include "ioutils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#define NUMA_BUFFER_SIZE 65536
+#define PROC_PATH_SIZE 96
+
+#ifdef __linux__
+static const char* NODE_DIRECTORY_PATH = "/sys/devices/system/node";
+
+// parses the list of CPUs like '0-3,8-11' and sets the node for these CPUs
+static void parse_cpulist(Numa_stat* stat, const char* cpulist, int node)
+{
+  const char* p = cpulist;
+  while (*p >= '0' && *p <= '9') {
+    char* end;
+    long first = strtol(p, &end, 10), last = first;
+    if (*end == '-')
+      last = strtol(end + 1, &end, 10);
+    for (long cpu = first; cpu <= last && cpu < NUMA_MAX_CPUS; ++cpu) {
+      stat->__cpu_node[cpu] = node;
+      if (cpu + 1 > stat->__cpus_count)
+        stat->__cpus_count = (int) cpu + 1;
+    }
+    if (*end != ',')
+      break;
+    p = end + 1;
+  }
+}
+
+static void read_topology(Numa_stat* stat)
+{
+  Dir_reader* reader = (Dir_reader*) stat->__dir;
+  if (!Dir_reader_open(reader, NODE_DIRECTORY_PATH))
+    return;
+
+  const char* name;
+  while ((name = Dir_reader_next(reader)) != NULL) {
+    if (strncmp(name, "node", 4) != 0 || name[4] < '0' || name[4] > '9')
+      continue;
+    int node = (int) strtol(name + 4, NULL, 10);
+    if (node >= NUMA_MAX_NODES)
+      continue;
+
+    char path[PROC_PATH_SIZE], cpulist[1024];
+    snprintf(path, sizeof(path), "%s/%s/cpulist", NODE_DIRECTORY_PATH, name);
+    FILE* file = fopen(path, "r");
+    if (!file)
+      continue;
+    if (fgets(cpulist, sizeof(cpulist), file))
+      parse_cpulist(stat, cpulist, node);
+    fclose(file);
+
+    if (node + 1 > stat->Nodes_count)
+      stat->Nodes_count = node + 1;
+  }
+  Dir_reader_close(reader);
+
+  stat->Numa_available = stat->Nodes_count > 0;
+  if (!stat->Numa_available)
+    stat->Nodes_count = 1;
+}
+
+static double monotime_ns_diff_ms(const struct timespec* begin, const struct timespec* end)
+{
+  return (double) (end->tv_sec - begin->tv_sec) * 1000 + (double) (end->tv_nsec - begin->tv_nsec) / 1000000;
+}
+
+// opens the file and passes all lines to the handler, returns number of bytes read or -1
+static long long read_lines(Numa_stat* stat, const char* path, Line_handler handler, void* arg)
+{
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+    return -1;
+  long long bytes = fdreadlines(fd, stat->__buf, NUMA_BUFFER_SIZE, handler, arg);
+  close(fd);
+  return bytes;
+}
+
+// line of '/proc/[pid]/numa_maps': '7f0000000000 default file=/lib/x.so mapped=4 N0=3 N1=1 kernelpagesize_kB=4'
+static bool numa_maps_line_handler(char* line, void* arg)
+{
+  Numa_stat* stat = (Numa_stat*) arg;
+  unsigned long long pages[NUMA_MAX_NODES];
+  memset(pages, 0, sizeof(pages));
+  unsigned long long pagesize_kb = 4;
+
+  char* saveptr = NULL;
+  for (char* token = strtok_r(line, " ", &saveptr); token; token = strtok_r(NULL, " ", &saveptr)) {
+    if (token[0] == 'N' && token[1] >= '0' && token[1] <= '9') {
+      char* end;
+      long node = strtol(token + 1, &end, 10);
+      if (*end == '=' && node < NUMA_MAX_NODES)
+        pages[node] += strtoull(end + 1, NULL, 10);
+    } else if (strncmp(token, "kernelpagesize_kB=", 18) == 0)
+      pagesize_kb = strtoull(token + 18, NULL, 10);
+  }
+
+  for (int node = 0; node < NUMA_MAX_NODES; ++node) {
+    if (pages[node] == 0)
+      continue;
+    stat->Node_memory_kb[node] += pages[node] * pagesize_kb;
+    if (node + 1 > stat->Nodes_count)
+      stat->Nodes_count = node + 1;
+  }
+  return true;
+}
+
+struct __Smaps_rollup
+{
+  unsigned long long Rss_kb;
+  unsigned long long Anon_kb;
+  unsigned long long Anon_huge_pages_kb;
+};
+
+static bool smaps_rollup_line_handler(char* line, void* arg)
+{
+  struct __Smaps_rollup* rollup = (struct __Smaps_rollup*) arg;
+  sscanf(line, "Rss: %llu kB", &rollup->Rss_kb);
+  sscanf(line, "Anonymous: %llu kB", &rollup->Anon_kb);
+  sscanf(line, "AnonHugePages: %llu kB", &rollup->Anon_huge_pages_kb);
+  return true;
+}
+
+// marks nodes of CPUs, where threads of the process ran last time, returns number of bytes read
+static long long read_local_nodes(Numa_stat* stat, int pid)
+{
+  long long bytes = 0;
+  char taskpath[PROC_PATH_SIZE];
+  snprintf(taskpath, sizeof(taskpath), "/proc/%d/task", pid);
+
+  Dir_reader* reader = (Dir_reader*) stat->__dir;
+  if (!Dir_reader_open(reader, taskpath))
+    return 0;
+
+  const char* name;
+  while ((name = Dir_reader_next(reader)) != NULL) {
+    int fd = openat(reader->Fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1)
+      continue;
+    int statfd = openat(fd, "stat", O_RDONLY | O_CLOEXEC);
+    close(fd);
+    if (statfd == -1)
+      continue;
+
+    char buf[1024];
+    ssize_t len = read(statfd, buf, sizeof(buf) - 1);
+    close(statfd);
+    if (len <= 0)
+      continue;
+    buf[len] = '\0';
+    bytes += len;
+
+    // the name of thread may contain spaces, so fields are counted after ')'
+    // the 'processor' field is the 39th field, the 'state' field is the 3rd field
+    char* p = strrchr(buf, ')');
+    if (!p)
+      continue;
+    ++p;
+    for (int field = 3; field < 39 && *p; ++field) {
+      while (*p == ' ')
+        ++p;
+      while (*p && *p != ' ')
+        ++p;
+    }
+    int cpu = (int) strtol(p, NULL, 10);
+    if (cpu >= 0 && cpu < stat->__cpus_count && stat->__cpu_node[cpu] < NUMA_MAX_NODES)
+      stat->Node_local[stat->__cpu_node[cpu]] = true;
+  }
+  Dir_reader_close(reader);
+  return bytes;
+}
+#endif
+
+Numa_stat* Numa_stat_init(long int interval_ms)
+{
+  Numa_stat* stat = malloc(sizeof(Numa_stat));
+  ASSERT(stat != NULL, "stat (Numa_stat*) != NULL; malloc(...) returns NULL.");
+  memset(stat, 0, sizeof(Numa_stat));
+  stat->Interval_ms = interval_ms;
+
+  stat->__buf = malloc(NUMA_BUFFER_SIZE);
+  ASSERT(stat->__buf != NULL, "stat->__buf (char*) != NULL; malloc(...) returns NULL.");
+  stat->__next_update_ms = 0;
+#ifdef __linux__
+  stat->__dir = Dir_reader_init();
+  read_topology(stat);
+#else
+  stat->__dir = NULL;
+  stat->Nodes_count = 1;
+#endif
+  return stat;
+}
+
+bool Numa_stat_update(Numa_stat* stat, int pid, char** errormsg)
+{
+  long long now = monotime_ms();
+  if (now < stat->__next_update_ms)
+    return true;
+  stat->__next_update_ms = now + stat->Interval_ms;
+#ifdef __linux__
+  struct timespec begin, end;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+
+  memset(stat->Node_memory_kb, 0, sizeof(stat->Node_memory_kb));
+  memset(stat->Node_local, 0, sizeof(stat->Node_local));
+  stat->Read_bytes = 0;
+
+  char path[PROC_PATH_SIZE];
+  bool numa_maps_read = false;
+  if (stat->Numa_available) {
+    snprintf(path, sizeof(path), "/proc/%d/numa_maps", pid);
+    long long bytes = read_lines(stat, path, numa_maps_line_handler, stat);
+    if (bytes == -1 && errno != ENOENT) {
+      strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to read file '", path, "': ", strerror(errno)));
+      return false;
+    }
+    numa_maps_read = bytes != -1;
+    if (numa_maps_read)
+      stat->Read_bytes += (unsigned long long) bytes;
+  }
+
+  struct __Smaps_rollup rollup = {0, 0, 0};
+  snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", pid);
+  {
+    long long bytes = read_lines(stat, path, smaps_rollup_line_handler, &rollup);
+    if (bytes == -1 && errno != ENOENT) {
+      strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to read file '", path, "': ", strerror(errno)));
+      return false;
+    }
+    if (bytes != -1)
+      stat->Read_bytes += (unsigned long long) bytes;
+  }
+
+  if (numa_maps_read)
+    stat->Read_bytes += (unsigned long long) read_local_nodes(stat, pid);
+  else {
+    // single node view
+    stat->Node_memory_kb[0] = rollup.Rss_kb;
+    stat->Node_local[0] = true;
+  }
+
+  stat->Total_memory_kb = 0;
+  unsigned long long remote_kb = 0;
+  for (int node = 0; node < stat->Nodes_count; ++node) {
+    stat->Total_memory_kb += stat->Node_memory_kb[node];
+    if (!stat->Node_local[node])
+      remote_kb += stat->Node_memory_kb[node];
+  }
+  stat->Remote_usage = stat->Total_memory_kb > 0 ? 100.0 * (double) remote_kb / (double) stat->Total_memory_kb : 0.0;
+
+  stat->Anon_kb = rollup.Anon_kb;
+  stat->Anon_huge_pages_kb = rollup.Anon_huge_pages_kb;
+  stat->Thp_usage = rollup.Anon_kb > 0 ? 100.0 * (double) rollup.Anon_huge_pages_kb / (double) rollup.Anon_kb : 0.0;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  stat->Read_cost_ms = monotime_ns_diff_ms(&begin, &end);
+  stat->Updates++;
+  return true;
+#elif _WIN32
+  UNUSED(pid);
+  strconcat(errormsg, 1, SAFE_PASS_VARGS("The NUMA memory placement is not supported on Windows."));
+  return false;
+#endif
+}
+
+void Numa_stat_free(Numa_stat* stat)
+{
+  free(stat->__buf);
+#ifdef __linux__
+  Dir_reader_free((Dir_reader*) stat->__dir);
+#endif
+
+  free(stat);
+}
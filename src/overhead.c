@@ -0,0 +1,203 @@
+#include "overhead.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const int CALIBRATION_READINGS = 8;
+
+static const char* PROBE_NAMES[OVERHEAD_PROBES_COUNT] = {
+    "process", "fds", "sockets", "numa", "history", "render", "outputs"};
+
+#ifdef OVERHEAD_COUNT_ALLOCATIONS
+static _Thread_local long long allocations = 0;
+
+// the real functions are called by wrappers, see the '--wrap' option of ld
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size)
+{
+  ++allocations;
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+  ++allocations;
+  return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+  ++allocations;
+  return __real_realloc(ptr, size);
+}
+
+long long Overhead_allocations()
+{
+  return allocations;
+}
+#else
+long long Overhead_allocations()
+{
+  return -1;
+}
+#endif
+
+static double clock_ms(clockid_t clock)
+{
+  struct timespec now;
+  if (clock_gettime(clock, &now) != 0)
+    return 0.0;
+  return (double) now.tv_sec * 1000.0 + (double) now.tv_nsec / 1000000.0;
+}
+
+// returns the value of the field of '/proc/thread-self/io'
+static unsigned long long io_field(const char* io, const char* name)
+{
+  const char* field = strstr(io, name);
+  return field ? strtoull(field + strlen(name), NULL, 10) : 0;
+}
+
+// reads current counters of the calling thread
+static void read_counters(Overhead* overhead, Overhead_cost* counters)
+{
+  counters->Cpu_ms = clock_ms(CLOCK_THREAD_CPUTIME_ID);
+  counters->Wall_ms = clock_ms(CLOCK_MONOTONIC);
+  counters->Syscalls = 0;
+  counters->Read_bytes = 0;
+#ifdef __linux__
+  char io[512];
+  ssize_t bytes = overhead->__io_fd != -1 ? pread(overhead->__io_fd, io, sizeof(io) - 1, 0) : -1;
+  if (bytes > 0) {
+    io[bytes] = '\0';
+    counters->Syscalls = io_field(io, "syscr: ") + io_field(io, "syscw: ");
+    counters->Read_bytes = io_field(io, "rchar: ");
+  }
+#endif
+  counters->Allocations = Overhead_allocations();
+  overhead->__readings++;
+}
+
+// stores the difference of counters without the cost of 'readings' readings of counters
+static void subtract(const Overhead_cost* end,
+                     const Overhead_cost* begin,
+                     const Overhead_cost* calibration,
+                     int readings,
+                     Overhead_cost* cost)
+{
+  double cpu_ms = end->Cpu_ms - begin->Cpu_ms - calibration->Cpu_ms * readings,
+         wall_ms = end->Wall_ms - begin->Wall_ms - calibration->Wall_ms * readings;
+  unsigned long long syscalls = calibration->Syscalls * (unsigned long long) readings,
+                     read_bytes = calibration->Read_bytes * (unsigned long long) readings;
+  cost->Cpu_ms = cpu_ms > 0.0 ? cpu_ms : 0.0;
+  cost->Wall_ms = wall_ms > 0.0 ? wall_ms : 0.0;
+  cost->Syscalls = end->Syscalls - begin->Syscalls > syscalls ? end->Syscalls - begin->Syscalls - syscalls : 0;
+  cost->Read_bytes =
+      end->Read_bytes - begin->Read_bytes > read_bytes ? end->Read_bytes - begin->Read_bytes - read_bytes : 0;
+  cost->Allocations = end->Allocations - begin->Allocations;
+}
+
+// adds the cost to the sum
+static void add(Overhead_cost* sum, const Overhead_cost* cost)
+{
+  sum->Cpu_ms += cost->Cpu_ms;
+  sum->Wall_ms += cost->Wall_ms;
+  sum->Syscalls += cost->Syscalls;
+  sum->Read_bytes += cost->Read_bytes;
+  sum->Allocations += cost->Allocations;
+}
+
+Overhead* Overhead_init()
+{
+  Overhead* overhead = calloc(1, sizeof(Overhead));
+  ASSERT(overhead != NULL, "overhead (Overhead*) != NULL; calloc(...) returns NULL.");
+#ifdef __linux__
+  overhead->__io_fd = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+#else
+  overhead->__io_fd = -1;
+#endif
+
+  // the cheapest reading of counters is subtracted from every probe
+  Overhead_cost zero, previous, current, cost;
+  memset(&zero, 0, sizeof(zero));
+  read_counters(overhead, &previous);
+  for (int i = 0; i < CALIBRATION_READINGS; ++i) {
+    read_counters(overhead, &current);
+    subtract(&current, &previous, &zero, 0, &cost);
+    if (i == 0 || cost.Cpu_ms < overhead->__calibration.Cpu_ms)
+      overhead->__calibration.Cpu_ms = cost.Cpu_ms;
+    if (i == 0 || cost.Wall_ms < overhead->__calibration.Wall_ms)
+      overhead->__calibration.Wall_ms = cost.Wall_ms;
+    if (i == 0 || cost.Syscalls < overhead->__calibration.Syscalls)
+      overhead->__calibration.Syscalls = cost.Syscalls;
+    if (i == 0 || cost.Read_bytes < overhead->__calibration.Read_bytes)
+      overhead->__calibration.Read_bytes = cost.Read_bytes;
+    previous = current;
+  }
+  overhead->__calibration.Allocations = 0;
+  overhead->__readings = 0;
+  return overhead;
+}
+
+void Overhead_begin_tick(Overhead* overhead)
+{
+  memset(overhead->__current, 0, sizeof(overhead->__current));
+  overhead->__readings = 0;
+  read_counters(overhead, &overhead->__tick_begin);
+}
+
+void Overhead_begin(Overhead* overhead, Overhead_probe probe)
+{
+  if (probe < OVERHEAD_PROBES_COUNT)
+    read_counters(overhead, &overhead->__probe_begin[probe]);
+}
+
+void Overhead_end(Overhead* overhead, Overhead_probe probe)
+{
+  if (probe >= OVERHEAD_PROBES_COUNT)
+    return;
+  Overhead_cost end, cost;
+  read_counters(overhead, &end);
+  subtract(&end, &overhead->__probe_begin[probe], &overhead->__calibration, 1, &cost);
+  add(&overhead->__current[probe], &cost);
+}
+
+void Overhead_end_tick(Overhead* overhead)
+{
+  Overhead_cost end;
+  read_counters(overhead, &end);
+  // all readings of the tick except the first one are measured
+  subtract(&end, &overhead->__tick_begin, &overhead->__calibration, overhead->__readings - 1, &overhead->Tick);
+  // the subtracted calibration can exceed the cost of cheaper readings, but the tick is not cheaper than its probes
+  Overhead_cost probes;
+  memset(&probes, 0, sizeof(probes));
+  for (int probe = 0; probe < OVERHEAD_PROBES_COUNT; ++probe)
+    add(&probes, &overhead->__current[probe]);
+  overhead->Tick.Cpu_ms = MAX(overhead->Tick.Cpu_ms, probes.Cpu_ms);
+  overhead->Tick.Wall_ms = MAX(overhead->Tick.Wall_ms, probes.Wall_ms);
+  overhead->Tick.Syscalls = MAX(overhead->Tick.Syscalls, probes.Syscalls);
+  overhead->Tick.Read_bytes = MAX(overhead->Tick.Read_bytes, probes.Read_bytes);
+  memcpy(overhead->Probes, overhead->__current, sizeof(overhead->Probes));
+  overhead->Ticks_count++;
+}
+
+const char* Overhead_probe_name(Overhead_probe probe)
+{
+  return probe < OVERHEAD_PROBES_COUNT ? PROBE_NAMES[probe] : "";
+}
+
+void Overhead_free(Overhead* overhead)
+{
+#ifdef __linux__
+  if (overhead->__io_fd != -1)
+    close(overhead->__io_fd);
+#endif
+  free(overhead);
+}
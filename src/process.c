@@ -1,6 +1,7 @@
 #include "process.h"
 
 #include "ioutils.h"
+#include "metrics.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -28,8 +29,6 @@
 #include <sysinfoapi.h>
 #endif
 
-#define MAX(a, b) (a > b ? a : b)
-
 #ifdef __linux__
 static const char* SYSTEM_PATH_SEPARATOR = "/"; // only linux
 
@@ -38,6 +37,7 @@ static const char* CMDLINE_FILENAME = "cmdline";
 static const char* EXE_FILENAME = "exe";
 static const char* STAT_FILENAME = "stat";
 static const char* IO_FILENAME = "io";
+static const char* COMM_FILENAME = "comm";
 
 static const int PAGESIZE_DIV_VALUE = 1024;
 #endif
@@ -61,30 +61,6 @@ static unsigned long long ft2ull(const FILETIME* ft)
 }
 #endif
 
-static long long monotime_ms()
-{
-  long long t = 0;
-#ifdef __linux__
-  struct timespec ts;
-  clock_gettime(CLOCK_MONOTONIC, &ts);
-
-  t += ts.tv_sec * 1000;
-  t += ts.tv_nsec / 1000000;
-#elif _WIN32
-  static LARGE_INTEGER freq; // cached frequency
-  if (freq.QuadPart == 0)
-    QueryPerformanceFrequency(&freq);
-  LARGE_INTEGER ts;
-  QueryPerformanceCounter(&ts);
-
-  if (freq.QuadPart != 0)
-    ts.QuadPart /= freq.QuadPart;
-
-  t += ts.QuadPart * 1000;
-#endif
-  return t;
-}
-
 static double CPU_usage_calculate(unsigned long long utime,
                                   unsigned long long last_utime,
                                   unsigned long long stime,
@@ -109,6 +85,27 @@ static bool is_finite(double x)
 #endif
 }
 
+// adds the value to the sketch, if the sketch is collected
+static void sketch_add(Sketch* sketch, long long monotime, double value)
+{
+  if (sketch)
+    Sketch_add(sketch, monotime, value);
+}
+
+// starts the probe of the collector, if the overhead is measured
+static void probe_begin(Overhead* overhead, Overhead_probe probe)
+{
+  if (overhead)
+    Overhead_begin(overhead, probe);
+}
+
+// finishes the probe of the collector, if the overhead is measured
+static void probe_end(Overhead* overhead, Overhead_probe probe)
+{
+  if (overhead)
+    Overhead_end(overhead, probe);
+}
+
 int pid_by_name(const char* name)
 {
   int pid = -1;
@@ -230,6 +227,16 @@ Process_stat* Process_stat_init()
   stat->Disk_write_mb_peak_usage = 0.0;
   stat->Disk_read_kb = 0;
   stat->Disk_written_kb = 0;
+  stat->Fds = NULL;
+  stat->Sockets = NULL;
+  stat->Numa = NULL;
+  stat->History = NULL;
+  stat->Cpu_sketch = NULL;
+  stat->Memory_sketch = NULL;
+  stat->Disk_read_sketch = NULL;
+  stat->Disk_write_sketch = NULL;
+  stat->Overhead = NULL;
+  stat->Counters_only = false;
 
   // private
   stat->__last_utime = 0;
@@ -279,7 +286,135 @@ bool Process_stat_set_pid(Process_stat* stat, const char* processname, char** er
   return true;
 }
 
+bool Process_stat_attach(Process_stat* stat, int pid, char** errormsg)
+{
+  char* str_pid = NULL;
+  itostr(pid, &str_pid);
+  free(stat->Process_name);
+  stat->Process_name = NULL;
+#ifdef __linux__
+  char* commpath = NULL;
+  strconcat(&commpath,
+            5,
+            SAFE_PASS_VARGS(PROC_DIRECTORY_PATH, SYSTEM_PATH_SEPARATOR, str_pid, SYSTEM_PATH_SEPARATOR, COMM_FILENAME));
+  bool success = pid > 0 && fgetall(commpath, &stat->Process_name) != -1;
+  if (success)
+    stat->Process_name[strcspn(stat->Process_name, "\n")] = '\0';
+  free(commpath);
+#elif _WIN32
+  stat->__phandle = (HANDLE) OpenProcess(PROCESS_ALL_ACCESS, false, (DWORD) pid);
+  bool success = stat->__phandle != NULL;
+  if (success) {
+    stat->Process_name = malloc(strlen(str_pid) + 1);
+    ASSERT(stat->Process_name != NULL, "stat->Process_name (char*) != NULL; malloc(...) returns NULL.");
+    strcpy(stat->Process_name, str_pid);
+  }
+#endif
+  if (success)
+    stat->Pid = pid;
+  else {
+    free(stat->Process_name);
+    stat->Process_name = NULL;
+    strconcat(errormsg,
+              3,
+              SAFE_PASS_VARGS("Unable to get the information about this process: Pid '", str_pid, "' not found!"));
+  }
+  free(str_pid);
+  return success;
+}
+
+bool Process_tick_read(Process_tick* tick, char** errormsg)
+{
+  bool success = true;
+  tick->Cpu_total = 0;
+  tick->Boot_time = 0;
+#ifdef __linux__
+  char* statpath = NULL;
+  strconcat(&statpath, 3, SAFE_PASS_VARGS(PROC_DIRECTORY_PATH, SYSTEM_PATH_SEPARATOR, STAT_FILENAME));
+
+  char* statcache = NULL;
+  if (fgetall(statpath, &statcache) == -1) {
+    success = false;
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open file '", statpath, "': ", strerror(errno)));
+  } else {
+    // we need only the first line: 'cpu' and times of all CPUs
+    char* end = NULL;
+    const char* sub = strchr(statcache, ' ');
+    for (unsigned long long value; sub && *sub != '\n' && *sub != '\0'; sub = end) {
+      value = strtoull(sub, &end, 10);
+      if (end == sub)
+        break;
+      tick->Cpu_total += value;
+    }
+    if (tick->Cpu_total == 0) {
+      success = false;
+      strconcat(errormsg, 3, SAFE_PASS_VARGS("Invalid data in the file '", statpath, "'"));
+    }
+
+    // read btime
+    const char* btime_begin = strstr(statcache, "btime ");
+    if (btime_begin)
+      sscanf(btime_begin + 6 /* btime word length and space */, "%llu", &tick->Boot_time);
+  }
+  free(statpath);
+  free(statcache);
+#elif _WIN32
+  FILETIME ftime;
+  GetSystemTimeAsFileTime(&ftime);
+  tick->Cpu_total = ft2ull(&ftime);
+  if (tick->Cpu_total == 0) {
+    success = false;
+    strconcat(errormsg, 1, SAFE_PASS_VARGS("Unable to get the system information for CPU."));
+  }
+#endif
+  tick->Monotime_ms = monotime_ms();
+  tick->Realtime_ms = realtime_ms();
+  return success;
+}
+
 bool Process_stat_update(Process_stat* pstat, char** errormsg)
+{
+  Process_tick tick;
+  probe_begin(pstat->Overhead, OVERHEAD_PROCESS);
+  bool success = Process_tick_read(&tick, errormsg);
+  probe_end(pstat->Overhead, OVERHEAD_PROCESS);
+  return success && Process_stat_update_tick(pstat, &tick, errormsg);
+}
+
+bool Process_stat_update_tick(Process_stat* pstat, const Process_tick* tick, char** errormsg)
+{
+  return Process_stat_update_files(pstat, tick, NULL, errormsg);
+}
+
+#ifdef __linux__
+// stores the owner of the process and looks up the user name, only when the owner changes, the reentrant lookup allows
+// sampling from many threads
+static void set_owner(Process_stat* pstat, int uid)
+{
+  if (uid < 0) {
+    pstat->Uid = -1;
+    free(pstat->Username);
+    pstat->Username = NULL;
+    return;
+  }
+  struct passwd pwbuf, *pw = NULL;
+  char pwdata[1024];
+  if ((pstat->Uid != uid || !pstat->Username) && getpwuid_r((uid_t) uid, &pwbuf, pwdata, sizeof(pwdata), &pw) == 0 &&
+      pw) {
+    pstat->Uid = uid;
+    if (pstat->Username)
+      free(pstat->Username);
+
+    pstat->Username = malloc(sizeof(char) * strlen(pw->pw_name) + 1);
+    strcpy(pstat->Username, pw->pw_name);
+  }
+}
+#endif
+
+bool Process_stat_update_files(Process_stat* pstat,
+                               const Process_tick* tick,
+                               const Process_files* files,
+                               char** errormsg)
 {
   char* str_pid = NULL;
   itostr(pstat->Pid, &str_pid);
@@ -288,6 +423,7 @@ bool Process_stat_update(Process_stat* pstat, char** errormsg)
     strconcat(errormsg, 5, SAFE_PASS_VARGS("Invalid PID '", str_pid, "' for process '", pstat->Process_name, "'"));
     return false;
   }
+  probe_begin(pstat->Overhead, OVERHEAD_PROCESS);
 #ifdef __linux__
   // common variables
   size_t utimepid, stimepid;
@@ -300,15 +436,19 @@ bool Process_stat_update(Process_stat* pstat, char** errormsg)
         SAFE_PASS_VARGS(PROC_DIRECTORY_PATH, SYSTEM_PATH_SEPARATOR, str_pid, SYSTEM_PATH_SEPARATOR, STAT_FILENAME));
 
     char* pidstatcache = NULL;
-    if (fgetall(pidstatpath, &pidstatcache) == -1) {
+    const char* pidstat = files ? files->Stat : fgetall(pidstatpath, &pidstatcache) != -1 ? pidstatcache : NULL;
+    if (!pidstat) {
       success = false;
-      strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open file '", pidstatpath, "': ", strerror(errno)));
+      if (files)
+        strconcat(errormsg, 3, SAFE_PASS_VARGS("Unable to read file '", pidstatpath, "'"));
+      else
+        strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open file '", pidstatpath, "': ", strerror(errno)));
     } else {
       // %*d - skip
       // count all variables in file - 52
       // https://man7.org/linux/man-pages/man5/proc.5.html
       int args_set =
-          sscanf(pidstatcache,
+          sscanf(pidstat,
                  "%*d "
                  "%*s "
                  "%c " // state
@@ -334,25 +474,11 @@ bool Process_stat_update(Process_stat* pstat, char** errormsg)
         strconcat(errormsg, 3, SAFE_PASS_VARGS("Unable to read data from '/proc/", str_pid, "/stat': Invalid order."));
       }
 
-      {
-        int fd = open(pidstatpath, O_RDONLY);
+      if (files)
+        set_owner(pstat, files->Uid);
+      else {
         struct stat st;
-        if (fstat(fd, &st) == 0) {
-          struct passwd* pw = getpwuid(st.st_uid);
-          if (pw) {
-            pstat->Uid = (int) st.st_uid;
-            if (pstat->Username)
-              free(pstat->Username);
-
-            pstat->Username = malloc(sizeof(char) * strlen(pw->pw_name) + 1);
-            strcpy(pstat->Username, pw->pw_name);
-          }
-        } else {
-          pstat->Uid = -1;
-          free(pstat->Username);
-          pstat->Username = NULL;
-        }
-        close(fd);
+        set_owner(pstat, stat(pidstatpath, &st) == 0 ? (int) st.st_uid : -1);
       }
     }
 
@@ -360,6 +486,7 @@ bool Process_stat_update(Process_stat* pstat, char** errormsg)
     free(pidstatcache);
   }
 #elif _WIN32
+  UNUSED(files);
   if (success && !pstat->Killed) {
     HANDLE token;
     if (!OpenProcessToken((HANDLE) pstat->__phandle, TOKEN_QUERY, &token)) {
@@ -449,80 +576,35 @@ bool Process_stat_update(Process_stat* pstat, char** errormsg)
 
   if (success && !pstat->Killed) {
 #ifdef __linux__
-    char* statpath = NULL;
-    strconcat(&statpath, 3, SAFE_PASS_VARGS(PROC_DIRECTORY_PATH, SYSTEM_PATH_SEPARATOR, STAT_FILENAME));
-
-    char* statcache = NULL;
-    long long statcache_len = fgetall(statpath, &statcache);
-    if (statcache_len == -1) {
-      success = false;
-      strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open file '", statpath, "': ", strerror(errno)));
-    } else {
-      // calculate cpu
-      char tmp[statcache_len + 1];
-      strcpy(tmp, statcache); // copy cache
-
-      // we need only the first line
-      char* line = strtok(tmp, "\r\n");
-      size_t line_len = strlen(line);
-      if (line_len) {
-        size_t total = 0;
-        char* sub = strtok(line, " ");
-        while (sub != NULL) {
-          total += strtoul(sub, NULL, 10);
-          sub = strtok(NULL, " ");
-        }
-
-        if (total <= 0) {
-          success = false;
-          strconcat(errormsg, 3, SAFE_PASS_VARGS("Invalid data in the file '", statpath, "'"));
-        } else {
-          // calculate cpu usage
-          pstat->Cpu_usage = CPU_usage_calculate(
-              utimepid, pstat->__last_utime, stimepid, pstat->__last_stime, total, pstat->__last_total);
-
-          pstat->Cpu_peak_usage = MAX(pstat->Cpu_peak_usage, pstat->Cpu_usage);
-
-          // save values
-          pstat->__last_utime = utimepid;
-          pstat->__last_stime = stimepid;
-          pstat->__last_total = total;
-        }
-      }
-
-      // read btime
-      char* btime_begin = strstr(statcache, "btime ") + 6 /* btime word length and space */;
-      if (btime_begin)
-        sscanf(btime_begin, "%llu", &pstat->__last_btime);
+    // calculate cpu usage, if the caller does not calculate it by counters
+    if (!pstat->Counters_only) {
+      pstat->Cpu_usage = CPU_usage_calculate(
+          utimepid, pstat->__last_utime, stimepid, pstat->__last_stime, tick->Cpu_total, pstat->__last_total);
 
-      free(statpath);
-      free(statcache);
-    }
-#elif _WIN32
-    unsigned long long total_time;
-    {
-      FILETIME ftime;
-      GetSystemTimeAsFileTime(&ftime);
-      total_time = ft2ull(&ftime);
-      if (total_time == 0) {
-        success = false;
-        strconcat(errormsg, 1, SAFE_PASS_VARGS("Unable to get the system information for CPU."));
-        // TODO: total_time == 0, it is error?
-      }
+      pstat->Cpu_peak_usage = MAX(pstat->Cpu_peak_usage, pstat->Cpu_usage);
+      sketch_add(pstat->Cpu_sketch, tick->Monotime_ms, pstat->Cpu_usage);
     }
 
+    // save values
+    pstat->__last_utime = utimepid;
+    pstat->__last_stime = stimepid;
+    pstat->__last_total = tick->Cpu_total;
+    pstat->__last_btime = tick->Boot_time;
+#elif _WIN32
     FILETIME begin_time, end_time, fsys_time, fuser_time;
     if (GetProcessTimes((HANDLE) pstat->__phandle, &begin_time, &end_time, &fsys_time, &fuser_time)) {
       unsigned long long sys_time = ft2ull(&fsys_time), user_time = ft2ull(&fuser_time);
       // TODO: maybe divide this value on num threads/cores
-      pstat->Cpu_usage = CPU_usage_calculate(
-          user_time, pstat->__last_utime, sys_time, pstat->__last_stime, total_time, pstat->__last_total);
+      if (!pstat->Counters_only) {
+        pstat->Cpu_usage = CPU_usage_calculate(
+            user_time, pstat->__last_utime, sys_time, pstat->__last_stime, tick->Cpu_total, pstat->__last_total);
 
-      pstat->Cpu_peak_usage = MAX(pstat->Cpu_peak_usage, pstat->Cpu_usage);
+        pstat->Cpu_peak_usage = MAX(pstat->Cpu_peak_usage, pstat->Cpu_usage);
+      }
 
       pstat->__last_utime = user_time;
       pstat->__last_stime = sys_time;
-      pstat->__last_total = total_time;
+      pstat->__last_total = tick->Cpu_total;
 
       pstat->__last_starttime = ft2ull(&begin_time) / (unsigned long long) 1e7; // convert to sec
     }
@@ -549,6 +631,7 @@ bool Process_stat_update(Process_stat* pstat, char** errormsg)
     pstat->Memory_usage = (double) mem_usage_kb / 1000 + (double) (mem_usage_kb % 1000) / 1000;
 
     pstat->Memory_peak_usage = MAX(pstat->Memory_peak_usage, pstat->Memory_usage);
+    sketch_add(pstat->Memory_sketch, tick->Monotime_ms, pstat->Memory_usage);
   }
 
   if (success && !pstat->Killed) {
@@ -607,11 +690,16 @@ bool Process_stat_update(Process_stat* pstat, char** errormsg)
               SAFE_PASS_VARGS(PROC_DIRECTORY_PATH, SYSTEM_PATH_SEPARATOR, str_pid, SYSTEM_PATH_SEPARATOR, IO_FILENAME));
 
     char* pidiocache = NULL;
-    if (fgetall(pidiopath, &pidiocache) == -1) {
+    // 'io' of other users is opened, but not read
+    const char* pidio = files ? files->Io : fgetall(pidiopath, &pidiocache) != -1 ? pidiocache : NULL;
+    if (!pidio) {
       success = false;
-      strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open file '", pidiopath, "': ", strerror(errno)));
+      if (files)
+        strconcat(errormsg, 3, SAFE_PASS_VARGS("Unable to read file '", pidiopath, "'"));
+      else
+        strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open file '", pidiopath, "': ", strerror(errno)));
     } else {
-      int args_set = sscanf(pidiocache,
+      int args_set = sscanf(pidio,
                             "rchar: %llu\n"
                             "wchar: %llu\n"
                             "syscr: %llu\n"
@@ -642,32 +730,32 @@ bool Process_stat_update(Process_stat* pstat, char** errormsg)
 #endif
     if (success) {
       // ms, because we can refresh information every 1 ms.
-      double period_ms;
-      {
-        long long monotime_now = monotime_ms();
-        period_ms = (double) (monotime_now - pstat->__last_monotime);
-        pstat->__last_monotime = monotime_now;
-      }
+      double period_ms = (double) (tick->Monotime_ms - pstat->__last_monotime);
+      pstat->__last_monotime = tick->Monotime_ms;
 
       pstat->Disk_read_kb = rbytes / 1000;
       pstat->Disk_written_kb = wbytes / 1000;
 
-      // convert to mb/sec
-      pstat->Disk_read_mb_usage =
-          ((double) (rbytes - pstat->__last_read_bytes) / 1000 / 1000) / (double) (period_ms / 1000);
-      if (!is_finite(pstat->Disk_read_mb_usage))
-        pstat->Disk_read_mb_usage = 0.0;
-
-      pstat->Disk_write_mb_usage =
-          ((double) (wbytes - pstat->__last_written_bytes) / 1000 / 1000) / (double) (period_ms / 1000);
-      if (!is_finite(pstat->Disk_write_mb_usage))
-        pstat->Disk_write_mb_usage = 0.0;
+      // convert to mb/sec, if the caller does not calculate rates by counters
+      if (!pstat->Counters_only) {
+        pstat->Disk_read_mb_usage =
+            ((double) (rbytes - pstat->__last_read_bytes) / 1000 / 1000) / (double) (period_ms / 1000);
+        if (!is_finite(pstat->Disk_read_mb_usage))
+          pstat->Disk_read_mb_usage = 0.0;
+
+        pstat->Disk_write_mb_usage =
+            ((double) (wbytes - pstat->__last_written_bytes) / 1000 / 1000) / (double) (period_ms / 1000);
+        if (!is_finite(pstat->Disk_write_mb_usage))
+          pstat->Disk_write_mb_usage = 0.0;
+      }
 
       // skip first update, when all values are zeros
       // TODO: maybe we can find a better desicion
-      if (pstat->__last_sread_calls > 0 && pstat->__last_swrite_calls > 0) {
+      if (!pstat->Counters_only && pstat->__last_sread_calls > 0 && pstat->__last_swrite_calls > 0) {
         pstat->Disk_read_mb_peak_usage = MAX(pstat->Disk_read_mb_peak_usage, pstat->Disk_read_mb_usage);
         pstat->Disk_write_mb_peak_usage = MAX(pstat->Disk_write_mb_peak_usage, pstat->Disk_write_mb_usage);
+        sketch_add(pstat->Disk_read_sketch, tick->Monotime_ms, pstat->Disk_read_mb_usage);
+        sketch_add(pstat->Disk_write_sketch, tick->Monotime_ms, pstat->Disk_write_mb_usage);
       }
 
       pstat->__last_read_bytes = rbytes;
@@ -681,6 +769,36 @@ bool Process_stat_update(Process_stat* pstat, char** errormsg)
 #endif
   }
 
+  probe_end(pstat->Overhead, OVERHEAD_PROCESS);
+
+  if (success && !pstat->Killed && pstat->Fds) {
+    probe_begin(pstat->Overhead, OVERHEAD_FDS);
+    success = Fd_list_update(pstat->Fds, pstat->Pid, errormsg);
+    probe_end(pstat->Overhead, OVERHEAD_FDS);
+  }
+
+  if (success && !pstat->Killed && pstat->Sockets) {
+    probe_begin(pstat->Overhead, OVERHEAD_SOCKETS);
+    success = Socket_list_update(pstat->Sockets, pstat->Pid, pstat->Fds, errormsg);
+    probe_end(pstat->Overhead, OVERHEAD_SOCKETS);
+  }
+
+  if (success && !pstat->Killed && pstat->Numa) {
+    probe_begin(pstat->Overhead, OVERHEAD_NUMA);
+    success = Numa_stat_update(pstat->Numa, pstat->Pid, errormsg);
+    probe_end(pstat->Overhead, OVERHEAD_NUMA);
+  }
+
+  if (success && pstat->History) {
+    probe_begin(pstat->Overhead, OVERHEAD_HISTORY);
+    double values[METRIC_COUNT];
+    Metric_values(pstat, values);
+    // an NTP step of the real time does not reorder points, the real time is only for display
+    Timeseries_append(pstat->History, tick->Monotime_ms, values);
+    pstat->History->Realtime_offset_ms = tick->Realtime_ms - tick->Monotime_ms;
+    probe_end(pstat->Overhead, OVERHEAD_HISTORY);
+  }
+
   free(str_pid);
 
   return success;
@@ -693,6 +811,22 @@ void Process_stat_free(Process_stat* stat)
   free(stat->Start_time);
   free(stat->Time_usage);
   free(stat->Username);
+  if (stat->Fds)
+    Fd_list_free(stat->Fds);
+  if (stat->Sockets)
+    Socket_list_free(stat->Sockets);
+  if (stat->Numa)
+    Numa_stat_free(stat->Numa);
+  if (stat->History)
+    Timeseries_free(stat->History);
+  if (stat->Cpu_sketch)
+    Sketch_free(stat->Cpu_sketch);
+  if (stat->Memory_sketch)
+    Sketch_free(stat->Memory_sketch);
+  if (stat->Disk_read_sketch)
+    Sketch_free(stat->Disk_read_sketch);
+  if (stat->Disk_write_sketch)
+    Sketch_free(stat->Disk_write_sketch);
 
   free(stat);
 }
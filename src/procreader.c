@@ -0,0 +1,354 @@
+#include "procreader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifdef __linux__
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined __has_include
+#if __has_include(<linux/io_uring.h>) && defined __NR_io_uring_setup
+#include <linux/io_uring.h>
+#define PROC_READER_HAS_IO_URING
+#endif
+#endif
+#endif
+
+#define FILES_PER_PROCESS 2 // 'stat' and 'io'
+
+static const char* BACKEND_NAMES[] = {"pread", "io_uring"};
+
+#ifdef PROC_READER_HAS_IO_URING
+// the mapped io_uring without liburing
+typedef struct
+{
+  int Fd;
+  unsigned Entries;
+  bool Fixed; // descriptors are registered
+  void* Sq_ptr;
+  size_t Sq_size;
+  void* Cq_ptr;
+  size_t Cq_size;
+  struct io_uring_sqe* Sqes;
+  size_t Sqes_size;
+  unsigned *Sq_head, *Sq_tail, *Sq_mask, *Sq_array;
+  unsigned *Cq_head, *Cq_tail, *Cq_mask;
+  struct io_uring_cqe* Cqes;
+  struct iovec* Iovecs; // buffers of submission slots
+} Ring;
+
+static void ring_free(Ring* ring)
+{
+  if (ring->Sqes != MAP_FAILED)
+    munmap(ring->Sqes, ring->Sqes_size);
+  if (ring->Cq_ptr != MAP_FAILED && ring->Cq_ptr != ring->Sq_ptr)
+    munmap(ring->Cq_ptr, ring->Cq_size);
+  if (ring->Sq_ptr != MAP_FAILED)
+    munmap(ring->Sq_ptr, ring->Sq_size);
+  close(ring->Fd);
+  free(ring->Iovecs);
+  free(ring);
+}
+
+// creates the ring, returns NULL, if io_uring is not available
+static Ring* ring_init()
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = (int) syscall(__NR_io_uring_setup, PROC_READER_RING_ENTRIES, &params);
+  if (fd == -1)
+    return NULL;
+
+  Ring* ring = malloc(sizeof(Ring));
+  ASSERT(ring != NULL, "ring (Ring*) != NULL; malloc(...) returns NULL.");
+  ring->Fd = fd;
+  ring->Entries = params.sq_entries;
+  ring->Fixed = false;
+  ring->Sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->Cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single)
+    ring->Sq_size = ring->Cq_size = MAX(ring->Sq_size, ring->Cq_size);
+  ring->Sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->Iovecs = malloc(sizeof(struct iovec) * ring->Entries);
+  ASSERT(ring->Iovecs != NULL, "ring->Iovecs (struct iovec*) != NULL; malloc(...) returns NULL.");
+
+  ring->Sq_ptr = mmap(NULL, ring->Sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  ring->Cq_ptr = single ? ring->Sq_ptr
+                        : mmap(NULL,
+                               ring->Cq_size,
+                               PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE,
+                               fd,
+                               IORING_OFF_CQ_RING);
+  ring->Sqes = mmap(NULL, ring->Sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (ring->Sq_ptr == MAP_FAILED || ring->Cq_ptr == MAP_FAILED || ring->Sqes == MAP_FAILED) {
+    ring_free(ring);
+    return NULL;
+  }
+
+  char *sq = ring->Sq_ptr, *cq = ring->Cq_ptr;
+  ring->Sq_head = (unsigned*) (sq + params.sq_off.head);
+  ring->Sq_tail = (unsigned*) (sq + params.sq_off.tail);
+  ring->Sq_mask = (unsigned*) (sq + params.sq_off.ring_mask);
+  ring->Sq_array = (unsigned*) (sq + params.sq_off.array);
+  ring->Cq_head = (unsigned*) (cq + params.cq_off.head);
+  ring->Cq_tail = (unsigned*) (cq + params.cq_off.tail);
+  ring->Cq_mask = (unsigned*) (cq + params.cq_off.ring_mask);
+  ring->Cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+  return ring;
+}
+
+// registers descriptors in the ring, closed descriptors (-1) are sparse slots
+static void ring_register(Ring* ring, const int* fds, size_t count, unsigned long long* syscalls)
+{
+  if (ring->Fixed) {
+    syscall(__NR_io_uring_register, ring->Fd, IORING_UNREGISTER_FILES, NULL, 0);
+    ++*syscalls;
+  }
+  // old kernels do not accept sparse slots, raw descriptors are used then
+  ring->Fixed = count > 0 && syscall(__NR_io_uring_register, ring->Fd, IORING_REGISTER_FILES, fds, count) == 0;
+  ++*syscalls;
+}
+
+static int ring_enter(Ring* ring, unsigned submit, unsigned complete, unsigned long long* syscalls)
+{
+  int result;
+  do {
+    ++*syscalls;
+    result = (int) syscall(__NR_io_uring_enter, ring->Fd, submit, complete, IORING_ENTER_GETEVENTS, NULL, 0);
+  } while (result == -1 && errno == EINTR);
+  return result;
+}
+
+// reads all opened files by batches of the ring size, returns false, if the ring is broken
+static bool ring_read(Proc_reader* reader, size_t files_count)
+{
+  Ring* ring = (Ring*) reader->__ring;
+  size_t next = 0;
+  while (next < files_count) {
+    unsigned tail = *ring->Sq_tail, queued = 0;
+    for (; next < files_count && queued < ring->Entries; ++next) {
+      int fd = reader->__fds[next];
+      if (fd == -1)
+        continue;
+      unsigned slot = tail & *ring->Sq_mask;
+      ring->Iovecs[slot].iov_base = reader->__buffers + next * PROC_READER_BUFFER_SIZE;
+      ring->Iovecs[slot].iov_len = PROC_READER_BUFFER_SIZE - 1;
+
+      struct io_uring_sqe* sqe = &ring->Sqes[slot];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_READV;
+      sqe->flags = ring->Fixed ? IOSQE_FIXED_FILE : 0;
+      sqe->fd = ring->Fixed ? (int) next : fd;
+      sqe->addr = (unsigned long long) (uintptr_t) &ring->Iovecs[slot];
+      sqe->len = 1;
+      sqe->off = 0;
+      sqe->user_data = next;
+      ring->Sq_array[slot] = slot;
+      ++tail;
+      ++queued;
+    }
+    if (queued == 0)
+      break;
+    __atomic_store_n(ring->Sq_tail, tail, __ATOMIC_RELEASE);
+
+    if (ring_enter(ring, queued, queued, &reader->Syscalls) != (int) queued)
+      return false;
+    for (unsigned reaped = 0; reaped < queued;) {
+      unsigned head = *ring->Cq_head, ctail = __atomic_load_n(ring->Cq_tail, __ATOMIC_ACQUIRE);
+      for (; head != ctail; ++head, ++reaped) {
+        const struct io_uring_cqe* cqe = &ring->Cqes[head & *ring->Cq_mask];
+        reader->__results[cqe->user_data] = cqe->res;
+      }
+      __atomic_store_n(ring->Cq_head, head, __ATOMIC_RELEASE);
+      if (reaped < queued && ring_enter(ring, 0, queued - reaped, &reader->Syscalls) == -1)
+        return false;
+    }
+  }
+  return true;
+}
+#endif
+
+#ifdef __linux__
+// grows arrays, new processes have no opened files
+static void reserve(Proc_reader* reader, size_t count)
+{
+  if (count <= reader->__capacity)
+    return;
+  size_t capacity = MAX(count, reader->__capacity * 2), files = capacity * FILES_PER_PROCESS;
+  reader->__fds = realloc(reader->__fds, sizeof(int) * files);
+  ASSERT(reader->__fds != NULL, "reader->__fds (int*) != NULL; realloc(...) returns NULL.");
+  reader->__results = realloc(reader->__results, sizeof(int) * files);
+  ASSERT(reader->__results != NULL, "reader->__results (int*) != NULL; realloc(...) returns NULL.");
+  reader->__buffers = realloc(reader->__buffers, PROC_READER_BUFFER_SIZE * files);
+  ASSERT(reader->__buffers != NULL, "reader->__buffers (char*) != NULL; realloc(...) returns NULL.");
+  reader->__uids = realloc(reader->__uids, sizeof(int) * capacity);
+  ASSERT(reader->__uids != NULL, "reader->__uids (int*) != NULL; realloc(...) returns NULL.");
+  reader->__opened = realloc(reader->__opened, sizeof(bool) * capacity);
+  ASSERT(reader->__opened != NULL, "reader->__opened (bool*) != NULL; realloc(...) returns NULL.");
+  for (size_t i = reader->__capacity; i < capacity; ++i) {
+    for (size_t file = 0; file < FILES_PER_PROCESS; ++file) {
+      reader->__fds[i * FILES_PER_PROCESS + file] = -1;
+      reader->__results[i * FILES_PER_PROCESS + file] = -EBADF;
+    }
+    reader->__uids[i] = -1;
+    reader->__opened[i] = false;
+  }
+  reader->__capacity = capacity;
+}
+
+static void open_files(Proc_reader* reader, size_t index, int pid)
+{
+  static const char* FILENAMES[FILES_PER_PROCESS] = {"stat", "io"};
+  int* fds = &reader->__fds[index * FILES_PER_PROCESS];
+  for (size_t file = 0; file < FILES_PER_PROCESS; ++file) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/%s", pid, FILENAMES[file]);
+    fds[file] = open(path, O_RDONLY | O_CLOEXEC);
+    reader->Syscalls++;
+  }
+  struct stat st;
+  reader->__uids[index] = fds[0] != -1 && fstat(fds[0], &st) == 0 ? (int) st.st_uid : -1;
+  reader->Syscalls++;
+  reader->__opened[index] = true;
+}
+
+// closes files of the process, returns true, if any file was opened
+static bool close_files(Proc_reader* reader, size_t index)
+{
+  bool closed = false;
+  for (size_t file = 0; file < FILES_PER_PROCESS; ++file) {
+    int* fd = &reader->__fds[index * FILES_PER_PROCESS + file];
+    if (*fd != -1) {
+      close(*fd);
+      reader->Syscalls++;
+      *fd = -1;
+      closed = true;
+    }
+  }
+  return closed;
+}
+#endif
+
+Proc_reader* Proc_reader_init(Proc_reader_backend backend)
+{
+  Proc_reader* reader = malloc(sizeof(Proc_reader));
+  ASSERT(reader != NULL, "reader (Proc_reader*) != NULL; malloc(...) returns NULL.");
+  reader->Backend = PROC_READER_PREAD;
+  reader->Syscalls = 0;
+  reader->__count = 0;
+  reader->__capacity = 0;
+  reader->__fds = NULL;
+  reader->__uids = NULL;
+  reader->__results = NULL;
+  reader->__buffers = NULL;
+  reader->__opened = NULL;
+  reader->__ring = NULL;
+#ifdef PROC_READER_HAS_IO_URING
+  if (backend == PROC_READER_IO_URING && (reader->__ring = ring_init()) != NULL)
+    reader->Backend = PROC_READER_IO_URING;
+#else
+  UNUSED(backend);
+#endif
+#ifdef __linux__
+  // two descriptors per process are kept opened
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+#endif
+  return reader;
+}
+
+void Proc_reader_read(Proc_reader* reader, Process_stat* const* stats, const bool* alive, size_t count)
+{
+  reader->Syscalls = 0;
+#ifdef __linux__
+  reserve(reader, count);
+  bool changed = count != reader->__count;
+  for (size_t i = 0; i < count; ++i) {
+    if (alive[i] && !reader->__opened[i]) {
+      open_files(reader, i, stats[i]->Pid);
+      changed = true;
+    } else if (!alive[i] && close_files(reader, i))
+      changed = true;
+  }
+  reader->__count = count;
+
+  size_t files_count = count * FILES_PER_PROCESS;
+  for (size_t file = 0; file < files_count; ++file)
+    reader->__results[file] = -EBADF;
+#ifdef PROC_READER_HAS_IO_URING
+  if (reader->__ring) {
+    Ring* ring = (Ring*) reader->__ring;
+    if (changed)
+      ring_register(ring, reader->__fds, files_count, &reader->Syscalls);
+    if (!ring_read(reader, files_count)) {
+      ring_free(ring); // the rest of the tick and next ticks are read by 'pread'
+      reader->__ring = NULL;
+      reader->Backend = PROC_READER_PREAD;
+    }
+  }
+#endif
+  if (!reader->__ring)
+    for (size_t file = 0; file < files_count; ++file)
+      if (reader->__fds[file] != -1 && reader->__results[file] < 0) {
+        char* buffer = reader->__buffers + file * PROC_READER_BUFFER_SIZE;
+        ssize_t bytes = pread(reader->__fds[file], buffer, PROC_READER_BUFFER_SIZE - 1, 0);
+        reader->__results[file] = bytes >= 0 ? (int) bytes : -errno;
+        reader->Syscalls++;
+      }
+
+  for (size_t file = 0; file < files_count; ++file)
+    if (reader->__results[file] > 0)
+      reader->__buffers[file * PROC_READER_BUFFER_SIZE + (size_t) reader->__results[file]] = '\0';
+#else
+  UNUSED(stats);
+  UNUSED(alive);
+  UNUSED(count);
+#endif
+}
+
+bool Proc_reader_files(const Proc_reader* reader, size_t index, Process_files* files)
+{
+  if (index >= reader->__count || reader->__fds[index * FILES_PER_PROCESS] == -1)
+    return false;
+  const int* results = &reader->__results[index * FILES_PER_PROCESS];
+  const char* buffers = reader->__buffers + index * FILES_PER_PROCESS * PROC_READER_BUFFER_SIZE;
+  files->Stat = results[0] > 0 ? buffers : NULL;
+  files->Io = results[1] > 0 ? buffers + PROC_READER_BUFFER_SIZE : NULL;
+  files->Uid = reader->__uids[index];
+  return true;
+}
+
+const char* Proc_reader_backend_name(Proc_reader_backend backend)
+{
+  return backend >= PROC_READER_PREAD && backend <= PROC_READER_IO_URING ? BACKEND_NAMES[backend] : "";
+}
+
+void Proc_reader_free(Proc_reader* reader)
+{
+#ifdef PROC_READER_HAS_IO_URING
+  if (reader->__ring)
+    ring_free((Ring*) reader->__ring);
+#endif
+#ifdef __linux__
+  for (size_t i = 0; i < reader->__count; ++i)
+    close_files(reader, i);
+#endif
+  free(reader->__fds);
+  free(reader->__uids);
+  free(reader->__results);
+  free(reader->__buffers);
+  free(reader->__opened);
+  free(reader);
+}
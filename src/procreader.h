@@ -0,0 +1,94 @@
+#ifndef __PROCREADER_H
+#define __PROCREADER_H
+
+#include "../include/process.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PROC_READER_BUFFER_SIZE 1024 // buffer of one file, 'stat' and 'io' are less than 512 bytes
+#define PROC_READER_RING_ENTRIES 256 // reads submitted by one 'io_uring_enter'
+
+/**
+ * @brief Proc_reader_backend
+ * Ways to read files of many processes.
+ */
+typedef enum
+{
+  PROC_READER_PREAD,   //! One 'pread' per file
+  PROC_READER_IO_URING //! Batches of reads submitted and reaped by one 'io_uring_enter'
+} Proc_reader_backend;
+
+/**
+ * @brief Proc_reader
+ * Reads '/proc/[pid]/stat' and '/proc/[pid]/io' of many processes per tick without opening and closing files every
+ * time. Files of a process are opened once, when the process is read first, and its owner is taken from the opened
+ * 'stat' then. Every tick, files are read again from the offset 0: by 'pread' or, with io_uring, by batches of reads
+ * against descriptors registered in the ring, so the tick costs a few system calls for thousands of files. If io_uring
+ * is not available (old kernels or it is disabled), 'pread' is used. Files of '/proc' cannot be read without blocking,
+ * so io_uring completes them by its kernel workers: the watcher makes fewer system calls, but the whole process may
+ * spend more CPU time than with 'pread', see the benchmark 'process-watcher-bench-procreader'. Descriptors of a not
+ * alive process are closed, the opened descriptor keeps the process, so a reused PID is not read by mistake.
+ * The soft limit of opened files is raised to the hard limit, a process, whose files cannot be opened, has no contents
+ * (see Proc_reader_files), so it is read as usual.
+ * Only on Linux, nothing is read on other systems.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  Proc_reader_backend Backend; //! The used backend
+  unsigned long long Syscalls; //! System calls of the last Proc_reader_read
+
+  // private fields
+  size_t __count;    // number of processes
+  size_t __capacity; // capacity of arrays
+  int* __fds;        // descriptors of 'stat' and 'io' of every process or -1
+  int* __uids;       // owners of processes or -1
+  int* __results;    // read bytes or the negative error of every file
+  char* __buffers;   // contents of every file
+  bool* __opened;    // files of the process were opened
+  void* __ring;      // io_uring (Ring) or NULL
+} Proc_reader;
+
+/**
+ * @brief Proc_reader_init
+ * Initializes the new reader. If io_uring is requested, but it is not available, 'pread' is used.
+ * @param backend The requested backend
+ * @return The pointer to the new reader
+ */
+DECLFUNC Proc_reader* Proc_reader_init(Proc_reader_backend backend) ATTR(warn_unused_result);
+/**
+ * @brief Proc_reader_read
+ * Reads files of all alive processes. New processes are added by their indices, so indices of processes must not
+ * change between ticks. Files of not alive processes are closed.
+ * @param reader The pointer to the reader
+ * @param stats Processes
+ * @param alive Alive processes
+ * @param count Number of processes
+ */
+DECLFUNC void Proc_reader_read(Proc_reader* reader, Process_stat* const* stats, const bool* alive, size_t count)
+    ATTR(nonnull(1));
+/**
+ * @brief Proc_reader_files
+ * Returns contents of files of the process read by the last Proc_reader_read. Different processes can be requested
+ * from different threads at the same time.
+ * @param reader The pointer to the reader
+ * @param index Index of the process
+ * @param files The pointer to contents
+ * @return false, if files of the process are not opened, so they must be read as usual
+ */
+DECLFUNC bool Proc_reader_files(const Proc_reader* reader, size_t index, Process_files* files) ATTR(nonnull(1, 3));
+/**
+ * @brief Proc_reader_backend_name
+ * Returns the name of the backend.
+ * @param backend The backend
+ * @return The static name
+ */
+DECLFUNC const char* Proc_reader_backend_name(Proc_reader_backend backend);
+/**
+ * @brief Proc_reader_free
+ * Closes all files and deletes the reader.
+ * @param reader The pointer to the reader
+ */
+DECLFUNC void Proc_reader_free(Proc_reader* reader) ATTR(nonnull(1));
+
+#endif // __PROCREADER_H
@@ -0,0 +1,433 @@
+#include "procwatch.h"
+
+#include "ioutils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#define PROCWATCH_BUFFER_SIZE 4096 // '/proc/[pid]/stat', '/proc/[pid]/io' and the first line of '/proc/stat'
+#define PROC_PATH_SIZE 64
+
+static const char* ERROR_STRINGS[PROCWATCH_ERRORS_COUNT] = {
+    "No error.",
+    "Invalid argument.",
+    "Unable to allocate memory.",
+    "The process does not exist.",
+    "Access to the process information is denied.",
+    "Unable to read the process information.",
+    "The process information has an unexpected format.",
+    "No free slots for targets.",
+    "The process is already watched.",
+    "The library is supported only on Linux.",
+};
+
+// the watched process
+typedef struct
+{
+  int Pid;
+  int Uid;
+  int Stat_fd;                             // '/proc/[pid]/stat'
+  int Io_fd;                               // '/proc/[pid]/io'
+  unsigned long long Last_utime;           // user time
+  unsigned long long Last_stime;           // system time
+  unsigned long long Last_total;           // total time of all CPUs
+  unsigned long long Last_read_bytes;      // read bytes
+  unsigned long long Last_written_bytes;   // written bytes
+  long long Last_monotime;                 // monotime in ms
+} Procwatch_target;
+
+struct __Procwatch
+{
+  size_t __capacity;             // number of slots
+  size_t __count;                // number of targets
+  Procwatch_target* __targets;   // targets in the order of watching
+  int __stat_fd;                 // '/proc/stat'
+  long int __page_kb;            // size of the page in KB
+  char __buf[PROCWATCH_BUFFER_SIZE];
+#ifdef __linux__
+  Dir_reader* __dir; // directory reader of '/proc' for Procwatch_find
+#endif
+};
+
+const char* Procwatch_error_string(Procwatch_error error)
+{
+  if ((int) error < 0 || error >= PROCWATCH_ERRORS_COUNT)
+    return "Unknown error.";
+  return ERROR_STRINGS[error];
+}
+
+#ifdef __linux__
+static Procwatch_error errno_to_error(int error)
+{
+  switch (error) {
+  case ENOENT:
+  case ESRCH:
+    return PROCWATCH_ERROR_NOT_FOUND;
+  case EACCES:
+  case EPERM:
+    return PROCWATCH_ERROR_ACCESS;
+  case ENOMEM:
+    return PROCWATCH_ERROR_NO_MEMORY;
+  default:
+    return PROCWATCH_ERROR_IO;
+  }
+}
+
+// reads the file from the beginning into the buffer of the handle, the descriptor stays open
+static Procwatch_error read_fd(Procwatch* pw, int fd)
+{
+  ssize_t bytes = pread(fd, pw->__buf, sizeof(pw->__buf) - 1, 0);
+  if (bytes < 0)
+    return errno_to_error(errno);
+  if (bytes == 0)
+    return PROCWATCH_ERROR_NOT_FOUND; // the process has exited
+  pw->__buf[bytes] = '\0';
+  return PROCWATCH_OK;
+}
+
+// sums times of the first line of '/proc/stat': 'cpu  user nice system idle ...'
+static Procwatch_error read_total(Procwatch* pw, unsigned long long* total)
+{
+  Procwatch_error error = read_fd(pw, pw->__stat_fd);
+  if (error != PROCWATCH_OK)
+    return error == PROCWATCH_ERROR_NOT_FOUND ? PROCWATCH_ERROR_IO : error;
+  if (strncmp(pw->__buf, "cpu ", 4) != 0)
+    return PROCWATCH_ERROR_FORMAT;
+
+  *total = 0;
+  char* p = pw->__buf + 4;
+  while (*p != '\n' && *p != '\0') {
+    char* end;
+    unsigned long long value = strtoull(p, &end, 10);
+    if (end == p)
+      break;
+    *total += value;
+    p = end;
+  }
+  return *total ? PROCWATCH_OK : PROCWATCH_ERROR_FORMAT;
+}
+
+// parses '/proc/[pid]/stat': 'pid (comm) state ppid ...', the name can contain spaces and parentheses
+static Procwatch_error parse_stat(char* buf,
+                                  Procwatch_sample* sample,
+                                  unsigned long long* utime,
+                                  unsigned long long* stime,
+                                  long long* rss)
+{
+  char* begin = strchr(buf, '(');
+  char* end = strrchr(buf, ')');
+  if (!begin || !end || end < begin || end[1] != ' ' || end[2] == '\0')
+    return PROCWATCH_ERROR_FORMAT;
+
+  size_t length = (size_t) (end - begin - 1);
+  if (length > PROCWATCH_NAME_SIZE - 1)
+    length = PROCWATCH_NAME_SIZE - 1;
+  memcpy(sample->Name, begin + 1, length);
+  sample->Name[length] = '\0';
+  sample->State = end[2];
+
+  // fields from 4 (ppid) to 24 (rss), numbers of fields are from proc(5)
+  long long fields[25];
+  char* p = end + 3;
+  for (int i = 4; i <= 24; ++i) {
+    char* next;
+    fields[i] = strtoll(p, &next, 10);
+    if (next == p)
+      return PROCWATCH_ERROR_FORMAT;
+    p = next;
+  }
+  *utime = (unsigned long long) fields[14];
+  *stime = (unsigned long long) fields[15];
+  sample->Priority = (int) fields[18];
+  sample->Threads = (int) fields[20];
+  *rss = fields[24];
+  return PROCWATCH_OK;
+}
+
+// parses '/proc/[pid]/io': 'rchar: N\nwchar: N\n...'
+static Procwatch_error parse_io(const char* buf, unsigned long long* read_bytes, unsigned long long* written_bytes)
+{
+  const char* rchar = strstr(buf, "rchar: ");
+  const char* wchar = strstr(buf, "wchar: ");
+  if (!rchar || !wchar)
+    return PROCWATCH_ERROR_FORMAT;
+  *read_bytes = strtoull(rchar + 7, NULL, 10);
+  *written_bytes = strtoull(wchar + 7, NULL, 10);
+  return PROCWATCH_OK;
+}
+
+static double rate_mb(unsigned long long bytes, unsigned long long last_bytes, double period_sec)
+{
+  if (period_sec <= 0 || bytes < last_bytes)
+    return 0.0;
+  return (double) (bytes - last_bytes) / 1000 / 1000 / period_sec;
+}
+
+// reads both files of the target, calculates rates since the previous read and saves the current values
+static Procwatch_error sample_target(Procwatch* pw,
+                                     Procwatch_target* target,
+                                     unsigned long long total,
+                                     long long monotime_now,
+                                     Procwatch_sample* sample)
+{
+  unsigned long long utime, stime, read_bytes, written_bytes;
+  long long rss;
+  Procwatch_error error = read_fd(pw, target->Stat_fd);
+  if (error == PROCWATCH_OK)
+    error = parse_stat(pw->__buf, sample, &utime, &stime, &rss);
+  if (error == PROCWATCH_OK)
+    error = read_fd(pw, target->Io_fd);
+  if (error == PROCWATCH_OK)
+    error = parse_io(pw->__buf, &read_bytes, &written_bytes);
+  if (error != PROCWATCH_OK)
+    return error;
+
+  double total_delta = (double) (total - target->Last_total);
+  sample->Cpu_usage =
+      total_delta > 0 ? 100.0 * (double) ((utime - target->Last_utime) + (stime - target->Last_stime)) / total_delta
+                      : 0.0;
+  sample->Memory_usage = (double) (rss * pw->__page_kb) / 1000;
+  double period_sec = (double) (monotime_now - target->Last_monotime) / 1000;
+  sample->Disk_read_mb_usage = rate_mb(read_bytes, target->Last_read_bytes, period_sec);
+  sample->Disk_write_mb_usage = rate_mb(written_bytes, target->Last_written_bytes, period_sec);
+  sample->Disk_read_kb = read_bytes / 1000;
+  sample->Disk_written_kb = written_bytes / 1000;
+  sample->Uid = target->Uid;
+
+  target->Last_utime = utime;
+  target->Last_stime = stime;
+  target->Last_total = total;
+  target->Last_read_bytes = read_bytes;
+  target->Last_written_bytes = written_bytes;
+  target->Last_monotime = monotime_now;
+  return PROCWATCH_OK;
+}
+
+static Procwatch_target* find_target(Procwatch* pw, int pid)
+{
+  for (size_t i = 0; i < pw->__count; ++i)
+    if (pw->__targets[i].Pid == pid)
+      return &pw->__targets[i];
+  return NULL;
+}
+
+static void close_target(Procwatch_target* target)
+{
+  close(target->Stat_fd);
+  close(target->Io_fd);
+}
+#endif
+
+Procwatch* Procwatch_open(size_t capacity, Procwatch_error* error)
+{
+  Procwatch_error result = PROCWATCH_OK;
+  Procwatch* pw = NULL;
+#ifdef __linux__
+  if (capacity == 0)
+    result = PROCWATCH_ERROR_INVALID_ARGUMENT;
+  if (result == PROCWATCH_OK && (pw = malloc(sizeof(Procwatch))) == NULL)
+    result = PROCWATCH_ERROR_NO_MEMORY;
+  if (result == PROCWATCH_OK) {
+    pw->__capacity = capacity;
+    pw->__count = 0;
+    pw->__page_kb = getpagesize() / 1024;
+    pw->__dir = NULL;
+    pw->__targets = malloc(sizeof(Procwatch_target) * capacity);
+    pw->__stat_fd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+    if (!pw->__targets)
+      result = PROCWATCH_ERROR_NO_MEMORY;
+    else if (pw->__stat_fd == -1)
+      result = errno_to_error(errno);
+    if (result != PROCWATCH_OK) {
+      if (pw->__stat_fd != -1)
+        close(pw->__stat_fd);
+      free(pw->__targets);
+      free(pw);
+      pw = NULL;
+    }
+  }
+#else
+  UNUSED(capacity);
+  result = PROCWATCH_ERROR_UNSUPPORTED;
+#endif
+  if (error)
+    *error = result;
+  return pw;
+}
+
+Procwatch_error Procwatch_watch(Procwatch* pw, int pid)
+{
+#ifdef __linux__
+  if (pid <= 0)
+    return PROCWATCH_ERROR_INVALID_ARGUMENT;
+  if (find_target(pw, pid))
+    return PROCWATCH_ERROR_EXISTS;
+  if (pw->__count == pw->__capacity)
+    return PROCWATCH_ERROR_FULL;
+
+  Procwatch_target* target = &pw->__targets[pw->__count];
+  memset(target, 0, sizeof(Procwatch_target));
+  target->Pid = pid;
+
+  char path[PROC_PATH_SIZE];
+  snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+  if ((target->Stat_fd = open(path, O_RDONLY | O_CLOEXEC)) == -1)
+    return errno_to_error(errno);
+  snprintf(path, sizeof(path), "/proc/%d/io", pid);
+  if ((target->Io_fd = open(path, O_RDONLY | O_CLOEXEC)) == -1) {
+    Procwatch_error error = errno_to_error(errno);
+    close(target->Stat_fd);
+    return error;
+  }
+
+  struct stat st;
+  target->Uid = fstat(target->Stat_fd, &st) == 0 ? (int) st.st_uid : -1;
+
+  // the first read sets the base of rates
+  Procwatch_sample sample;
+  unsigned long long total;
+  Procwatch_error error = read_total(pw, &total);
+  if (error == PROCWATCH_OK)
+    error = sample_target(pw, target, total, monotime_ms(), &sample);
+  if (error != PROCWATCH_OK) {
+    close_target(target);
+    return error;
+  }
+  ++pw->__count;
+  return PROCWATCH_OK;
+#else
+  UNUSED(pw);
+  UNUSED(pid);
+  return PROCWATCH_ERROR_UNSUPPORTED;
+#endif
+}
+
+Procwatch_error Procwatch_unwatch(Procwatch* pw, int pid)
+{
+#ifdef __linux__
+  Procwatch_target* target = find_target(pw, pid);
+  if (!target)
+    return PROCWATCH_ERROR_NOT_FOUND;
+  close_target(target);
+  size_t index = (size_t) (target - pw->__targets);
+  memmove(target, target + 1, sizeof(Procwatch_target) * (pw->__count - index - 1));
+  --pw->__count;
+  return PROCWATCH_OK;
+#else
+  UNUSED(pw);
+  UNUSED(pid);
+  return PROCWATCH_ERROR_UNSUPPORTED;
+#endif
+}
+
+size_t Procwatch_count(const Procwatch* pw)
+{
+  return pw->__count;
+}
+
+Procwatch_error Procwatch_sample_all(Procwatch* pw, Procwatch_sample* samples, size_t capacity, size_t* count)
+{
+#ifdef __linux__
+  *count = pw->__count;
+  if (pw->__count == 0)
+    return PROCWATCH_OK;
+  if (!samples || capacity < pw->__count)
+    return PROCWATCH_ERROR_INVALID_ARGUMENT;
+
+  unsigned long long total;
+  Procwatch_error error = read_total(pw, &total);
+  if (error != PROCWATCH_OK) {
+    *count = 0;
+    return error;
+  }
+  long long monotime_now = monotime_ms(), realtime_now = realtime_ms();
+  for (size_t i = 0; i < pw->__count; ++i) {
+    Procwatch_sample* sample = &samples[i];
+    memset(sample, 0, sizeof(Procwatch_sample));
+    sample->Pid = pw->__targets[i].Pid;
+    sample->Time_ms = realtime_now;
+    sample->Error = sample_target(pw, &pw->__targets[i], total, monotime_now, sample);
+  }
+  return PROCWATCH_OK;
+#else
+  UNUSED(pw);
+  UNUSED(samples);
+  UNUSED(capacity);
+  *count = 0;
+  return PROCWATCH_ERROR_UNSUPPORTED;
+#endif
+}
+
+#ifdef __linux__
+// compares the name with the executable name of argv[0] in '/proc/[pid]/cmdline' and with '/proc/[pid]/comm'
+static bool process_has_name(Procwatch* pw, int procfd, const char* pid, const char* name)
+{
+  char path[PROC_PATH_SIZE];
+  const char* files[] = {"cmdline", "comm"};
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+    snprintf(path, sizeof(path), "%s/%s", pid, files[i]);
+    int fd = openat(procfd, path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+      return false;
+    bool found = read_fd(pw, fd) == PROCWATCH_OK;
+    close(fd);
+    if (!found)
+      continue; // kernel threads have no command line
+
+    pw->__buf[strcspn(pw->__buf, "\n")] = '\0'; // argv[0] ends with the null character
+    const char* basename = strrchr(pw->__buf, '/');
+    basename = basename ? basename + 1 : pw->__buf;
+    if (strcmp(name, basename) == 0 || strcmp(name, pw->__buf) == 0)
+      return true;
+  }
+  return false;
+}
+#endif
+
+Procwatch_error Procwatch_find(Procwatch* pw, const char* name, int* pid)
+{
+#ifdef __linux__
+  if (!pw->__dir)
+    pw->__dir = Dir_reader_init();
+  Dir_reader* reader = pw->__dir;
+  if (!Dir_reader_open(reader, "/proc"))
+    return errno_to_error(errno);
+
+  *pid = -1;
+  const char* entry;
+  while (*pid == -1 && (entry = Dir_reader_next(reader)) != NULL) {
+    char* end;
+    long value = strtol(entry, &end, 10);
+    if (value > 0 && *end == '\0' && process_has_name(pw, reader->Fd, entry, name))
+      *pid = (int) value;
+  }
+  Dir_reader_close(reader);
+  return *pid == -1 ? PROCWATCH_ERROR_NOT_FOUND : PROCWATCH_OK;
+#else
+  UNUSED(pw);
+  UNUSED(name);
+  *pid = -1;
+  return PROCWATCH_ERROR_UNSUPPORTED;
+#endif
+}
+
+void Procwatch_close(Procwatch* pw)
+{
+#ifdef __linux__
+  for (size_t i = 0; i < pw->__count; ++i)
+    close_target(&pw->__targets[i]);
+  close(pw->__stat_fd);
+  if (pw->__dir)
+    Dir_reader_free(pw->__dir);
+#endif
+  free(pw->__targets);
+  free(pw);
+}
@@ -0,0 +1,381 @@
+#include "prometheus.h"
+#include "ioutils.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#endif
+
+#define PREFIX "process_watcher_"
+
+static const size_t INITIAL_BUFFER_SIZE = 16384;
+static const int POLL_TIMEOUT_MS = 200;  // the server checks the stop flag with this interval
+static const int CLIENT_TIMEOUT_SEC = 1; // slow clients are disconnected after this timeout
+static const char* UNIX_PREFIX = "unix:";
+static const char* DEFAULT_HOST = "127.0.0.1";
+
+static const Metric_id PEAK_METRICS[PROMETHEUS_PEAKS_COUNT] = {
+    METRIC_CPU_USAGE, METRIC_MEMORY_USAGE, METRIC_DISK_READ_MB_USAGE, METRIC_DISK_WRITE_MB_USAGE};
+
+struct __Prometheus_thread
+{
+#ifdef __linux__
+  pthread_t Thrd;
+  pthread_mutex_t Mut; // protects the published snapshot
+#endif
+#ifdef _MSC_VER // TODO: support atomic
+  volatile
+#elif defined __GNUC__ || defined __MINGW32__
+  _Atomic
+#endif
+      bool Running;
+};
+
+// appends the formatted text to the response buffer, which grows if required
+static void append(Prometheus_server* server, const char* format, ...)
+{
+  for (;;) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(server->__buffer + server->__size, server->__capacity - server->__size, format, args);
+    va_end(args);
+    if (length < 0)
+      return;
+    if (server->__size + (size_t) length < server->__capacity) {
+      server->__size += (size_t) length;
+      return;
+    }
+
+    server->__capacity = (server->__capacity + (size_t) length) * 2;
+    server->__buffer = realloc(server->__buffer, server->__capacity);
+    ASSERT(server->__buffer != NULL, "server->__buffer (char*) != NULL; realloc(...) returns NULL.");
+  }
+}
+
+// escapes the label value: backslash, double-quote and line feed
+static void escape_label(char* dst, size_t size, const char* src)
+{
+  size_t length = 0;
+  for (; *src && length + 2 < size; ++src) {
+    if (*src == '\\' || *src == '"') {
+      dst[length++] = '\\';
+      dst[length++] = *src;
+    } else if (*src == '\n') {
+      dst[length++] = '\\';
+      dst[length++] = 'n';
+    } else
+      dst[length++] = *src;
+  }
+  dst[length] = '\0';
+}
+
+void Prometheus_publish(Prometheus_server* server, const Process_stat* stat, long long time_ms)
+{
+  Prometheus_snapshot snapshot;
+  snprintf(snapshot.Process_name, sizeof(snapshot.Process_name), "%s", stat->Process_name ? stat->Process_name : "");
+  snapshot.Pid = stat->Pid;
+  snapshot.Time_ms = time_ms;
+  Metric_values(stat, snapshot.Values);
+  snapshot.Peaks[0] = stat->Cpu_peak_usage;
+  snapshot.Peaks[1] = stat->Memory_peak_usage;
+  snapshot.Peaks[2] = stat->Disk_read_mb_peak_usage;
+  snapshot.Peaks[3] = stat->Disk_write_mb_peak_usage;
+  const Sketch* sketches[PROMETHEUS_PEAKS_COUNT] = {
+      stat->Cpu_sketch, stat->Memory_sketch, stat->Disk_read_sketch, stat->Disk_write_sketch};
+  for (int i = 0; i < PROMETHEUS_PEAKS_COUNT; ++i) {
+    if (sketches[i])
+      Sketch_summarize(&sketches[i]->Window, &snapshot.Summaries[i]);
+    else
+      memset(&snapshot.Summaries[i], 0, sizeof(Sketch_summary));
+  }
+
+  // the lock is held only for copying, rendering is done by the server thread
+#ifdef __linux__
+  pthread_mutex_lock(&server->__thrd->Mut);
+#endif
+  snapshot.Samples_count = server->__published.Samples_count + 1;
+  server->__published = snapshot;
+#ifdef __linux__
+  pthread_mutex_unlock(&server->__thrd->Mut);
+#endif
+}
+
+const char* Prometheus_render(Prometheus_server* server, const Prometheus_snapshot* snapshot)
+{
+  char name[sizeof(snapshot->Process_name) * 2];
+  escape_label(name, sizeof(name), snapshot->Process_name);
+  char labels[sizeof(name) + 64];
+  snprintf(labels, sizeof(labels), "process=\"%s\",pid=\"%d\"", name, snapshot->Pid);
+
+  server->__size = 0;
+  server->__buffer[0] = '\0';
+  for (int id = 0; id < METRIC_COUNT; ++id) {
+    const Metric_info* info = Metric_get_info((Metric_id) id);
+    const char* suffix = info->Type == METRIC_COUNTER ? "_total" : "";
+    const char* type = info->Type == METRIC_COUNTER ? "counter" : "gauge";
+    append(server, "# HELP " PREFIX "%s%s %s", info->Name, suffix, info->Help);
+    append(server, *info->Unit ? " (%s).\n" : "%s.\n", info->Unit);
+    append(server, "# TYPE " PREFIX "%s%s %s\n", info->Name, suffix, type);
+    append(server, PREFIX "%s%s{%s} %.15g\n", info->Name, suffix, labels, snapshot->Values[id]);
+  }
+
+  for (int i = 0; i < PROMETHEUS_PEAKS_COUNT; ++i) {
+    const Metric_info* info = Metric_get_info(PEAK_METRICS[i]);
+    append(server, "# HELP " PREFIX "%s_peak Peak of %s (%s).\n", info->Name, info->Help, info->Unit);
+    append(server, "# TYPE " PREFIX "%s_peak gauge\n", info->Name);
+    append(server, PREFIX "%s_peak{%s} %.15g\n", info->Name, labels, snapshot->Peaks[i]);
+  }
+
+  // sketches have no sum, so the windowed percentiles are exposed as a summary without '_sum'
+  for (int i = 0; i < PROMETHEUS_PEAKS_COUNT; ++i) {
+    const Metric_info* info = Metric_get_info(PEAK_METRICS[i]);
+    const Sketch_summary* summary = &snapshot->Summaries[i];
+    append(server,
+           "# HELP " PREFIX "%s_window Percentiles of %s (%s) in the window.\n",
+           info->Name,
+           info->Help,
+           info->Unit);
+    append(server, "# TYPE " PREFIX "%s_window summary\n", info->Name);
+    append(server, PREFIX "%s_window{%s,quantile=\"0.5\"} %.15g\n", info->Name, labels, summary->P50);
+    append(server, PREFIX "%s_window{%s,quantile=\"0.95\"} %.15g\n", info->Name, labels, summary->P95);
+    append(server, PREFIX "%s_window{%s,quantile=\"0.99\"} %.15g\n", info->Name, labels, summary->P99);
+    append(server, PREFIX "%s_window{%s,quantile=\"1\"} %.15g\n", info->Name, labels, summary->Max);
+    append(server, PREFIX "%s_window_count{%s} %llu\n", info->Name, labels, summary->Count);
+  }
+
+  append(server, "# HELP " PREFIX "samples_total Number of samples.\n");
+  append(server, "# TYPE " PREFIX "samples_total counter\n");
+  append(server, PREFIX "samples_total{%s} %llu\n", labels, snapshot->Samples_count);
+  append(server, "# HELP " PREFIX "last_sample_timestamp_seconds Time of the last sample.\n");
+  append(server, "# TYPE " PREFIX "last_sample_timestamp_seconds gauge\n");
+  append(server, PREFIX "last_sample_timestamp_seconds{%s} %.3f\n", labels, (double) snapshot->Time_ms / 1000.0);
+  return server->__buffer;
+}
+
+#ifdef __linux__
+static bool send_all(int fd, const char* data, size_t size)
+{
+  while (size) {
+    ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+    if (sent <= 0)
+      return false;
+    data += sent;
+    size -= (size_t) sent;
+  }
+  return true;
+}
+
+static void send_response(int fd, const char* status, const char* body, size_t size)
+{
+  char header[256];
+  int length = snprintf(header,
+                        sizeof(header),
+                        "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                        "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                        status,
+                        size);
+  if (send_all(fd, header, (size_t) length))
+    send_all(fd, body, size);
+}
+
+// reads the request line and serves the snapshot
+static void handle_client(Prometheus_server* server, int fd)
+{
+  struct timeval timeout = {CLIENT_TIMEOUT_SEC, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  char request[2048];
+  size_t length = 0;
+  while (length + 1 < sizeof(request)) {
+    ssize_t received = recv(fd, request + length, sizeof(request) - 1 - length, 0);
+    if (received <= 0)
+      break;
+    length += (size_t) received;
+    request[length] = '\0';
+    if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n"))
+      break;
+  }
+  request[length] = '\0';
+
+  if (strncmp(request, "GET ", 4) != 0) {
+    const char* body = "Method Not Allowed\n";
+    send_response(fd, "405 Method Not Allowed", body, strlen(body));
+    return;
+  }
+  const char* path = request + 4;
+  size_t path_length = strcspn(path, " ?\r\n");
+  if (!(path_length == 8 && strncmp(path, "/metrics", 8) == 0) && !(path_length == 1 && path[0] == '/')) {
+    const char* body = "Not Found\n";
+    send_response(fd, "404 Not Found", body, strlen(body));
+    return;
+  }
+
+  pthread_mutex_lock(&server->__thrd->Mut);
+  server->__scraped = server->__published;
+  pthread_mutex_unlock(&server->__thrd->Mut);
+
+  Prometheus_render(server, &server->__scraped);
+  send_response(fd, "200 OK", server->__buffer, server->__size);
+  server->Scrapes_count++;
+}
+
+static void* serve(void* arg)
+{
+  Prometheus_server* server = (Prometheus_server*) arg;
+  while (server->__thrd->Running) {
+    struct pollfd pfd = {server->__fd, POLLIN, 0};
+    if (poll(&pfd, 1, POLL_TIMEOUT_MS) <= 0)
+      continue;
+    int client = accept(server->__fd, NULL, NULL);
+    if (client < 0)
+      continue;
+    handle_client(server, client);
+    close(client);
+  }
+  return NULL;
+}
+
+static int listen_unix(const char* path, char** errormsg)
+{
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    strconcat(errormsg, 3, SAFE_PASS_VARGS("The socket path '", path, "' is too long."));
+    return -1;
+  }
+  strcpy(addr.sun_path, path);
+
+  // the stale socket of the previous run is replaced
+  struct stat st;
+  if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+    unlink(path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0 || bind(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Cannot listen on '", path, "': ", strerror(errno)));
+    if (fd >= 0)
+      close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int listen_tcp(const char* address, int* port, char** errormsg)
+{
+  char host[256];
+  const char* service = strrchr(address, ':');
+  if (service) {
+    size_t length = (size_t) (service - address);
+    if (address[0] == '[' && length >= 2 && address[length - 1] == ']') { // [::1]:9100
+      ++address;
+      length -= 2;
+    }
+    snprintf(host, sizeof(host), "%.*s", (int) length, address);
+    ++service;
+  } else {
+    snprintf(host, sizeof(host), "%s", DEFAULT_HOST);
+    service = address;
+  }
+
+  struct addrinfo hints, *result = NULL;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+  int rc = getaddrinfo(host, service, &hints, &result);
+  if (rc != 0) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Incorrect the address '", address, "': ", gai_strerror(rc)));
+    return -1;
+  }
+
+  int fd = socket(result->ai_family, result->ai_socktype | SOCK_CLOEXEC, result->ai_protocol);
+  int reuse = 1;
+  if (fd >= 0)
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  if (fd < 0 || bind(fd, result->ai_addr, result->ai_addrlen) != 0 || listen(fd, 16) != 0) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Cannot listen on '", address, "': ", strerror(errno)));
+    if (fd >= 0)
+      close(fd);
+    freeaddrinfo(result);
+    return -1;
+  }
+  freeaddrinfo(result);
+
+  struct sockaddr_storage bound;
+  socklen_t bound_length = sizeof(bound);
+  *port = 0;
+  if (getsockname(fd, (struct sockaddr*) &bound, &bound_length) == 0)
+    *port = ntohs(bound.ss_family == AF_INET6 ? ((struct sockaddr_in6*) &bound)->sin6_port
+                                              : ((struct sockaddr_in*) &bound)->sin_port);
+  return fd;
+}
+#endif
+
+Prometheus_server* Prometheus_start(const char* address, char** errormsg)
+{
+#ifdef __linux__
+  int port = 0, fd;
+  bool is_unix = strncmp(address, UNIX_PREFIX, strlen(UNIX_PREFIX)) == 0;
+  if (is_unix)
+    fd = listen_unix(address + strlen(UNIX_PREFIX), errormsg);
+  else
+    fd = listen_tcp(address, &port, errormsg);
+  if (fd < 0)
+    return NULL;
+
+  Prometheus_server* server = malloc(sizeof(Prometheus_server));
+  ASSERT(server != NULL, "server (Prometheus_server*) != NULL; malloc(...) returns NULL.");
+  memset(server, 0, sizeof(Prometheus_server));
+  server->Port = port;
+  server->__fd = fd;
+  if (is_unix) {
+    const char* path = address + strlen(UNIX_PREFIX);
+    server->__unix_path = malloc(strlen(path) + 1);
+    ASSERT(server->__unix_path != NULL, "server->__unix_path (char*) != NULL; malloc(...) returns NULL.");
+    strcpy(server->__unix_path, path);
+  }
+  server->__capacity = INITIAL_BUFFER_SIZE;
+  server->__buffer = malloc(server->__capacity);
+  ASSERT(server->__buffer != NULL, "server->__buffer (char*) != NULL; malloc(...) returns NULL.");
+  server->__thrd = malloc(sizeof(struct __Prometheus_thread));
+  ASSERT(server->__thrd != NULL, "server->__thrd (struct __Prometheus_thread*) != NULL; malloc(...) returns NULL.");
+  pthread_mutex_init(&server->__thrd->Mut, NULL);
+  server->__thrd->Running = true;
+  pthread_create(&server->__thrd->Thrd, NULL, serve, server);
+  return server;
+#else
+  UNUSED(address);
+  strconcat(errormsg, 1, SAFE_PASS_VARGS("The Prometheus endpoint is supported only on Linux."));
+  return NULL;
+#endif
+}
+
+void Prometheus_stop(Prometheus_server* server)
+{
+#ifdef __linux__
+  server->__thrd->Running = false;
+  pthread_join(server->__thrd->Thrd, NULL);
+  pthread_mutex_destroy(&server->__thrd->Mut);
+  close(server->__fd);
+  if (server->__unix_path)
+    unlink(server->__unix_path);
+#endif
+  free(server->__unix_path);
+  free(server->__buffer);
+  free(server->__thrd);
+  free(server);
+}
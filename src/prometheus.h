@@ -0,0 +1,89 @@
+#ifndef __PROMETHEUS_H
+#define __PROMETHEUS_H
+
+#include "../include/process.h"
+#include "../include/metrics.h"
+#include "../include/sketch.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PROMETHEUS_PEAKS_COUNT 4 // CPU, memory, disk read and disk write
+
+struct __Prometheus_thread; // Forward declaration
+
+/**
+ * @brief Prometheus_snapshot
+ * Values of metrics published by the sampler. The snapshot is copied, so the server never reads the Process_stat
+ * structure.
+ */
+typedef struct
+{
+  char Process_name[256];                            //! The process name
+  int Pid;                                           //! PID of the process
+  long long Time_ms;                                 //! Real time of the sample
+  unsigned long long Samples_count;                  //! Number of published samples
+  double Values[METRIC_COUNT];                       //! Values of all metrics of the catalogue
+  double Peaks[PROMETHEUS_PEAKS_COUNT];              //! Peaks of CPU, memory, disk read and disk write
+  Sketch_summary Summaries[PROMETHEUS_PEAKS_COUNT];  //! Percentiles of the windowed view of the same metrics
+} Prometheus_snapshot;
+
+/**
+ * @brief Prometheus_server
+ * The embedded HTTP server, which serves the latest snapshot in the Prometheus text exposition format on '/metrics'.
+ * The server listens on the TCP address (localhost by default) or on the Unix socket and handles scrapes in its own
+ * thread. The sampler only copies the snapshot under the mutex, responses are rendered from the copy into the reusable
+ * buffer, so scrapes never block the sampler.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  int Port;                            //! The bound TCP port or 0 for the Unix socket
+  unsigned long long Scrapes_count;    //! Number of served scrapes
+
+  // private fields
+  int __fd;                            // the listening socket
+  char* __unix_path;                   // path of the Unix socket
+  Prometheus_snapshot __published;     // the latest published snapshot, protected by the mutex
+  Prometheus_snapshot __scraped;       // the copy used by the server thread
+  char* __buffer;                      // the response buffer
+  size_t __capacity;                   // capacity of the response buffer
+  size_t __size;                       // size of the rendered response
+  struct __Prometheus_thread* __thrd;  // the server thread
+} Prometheus_server;
+
+/**
+ * @brief Prometheus_start
+ * Binds the listening socket and starts the server thread. The address is 'PORT' (bound to 127.0.0.1),
+ * 'HOST:PORT' or 'unix:PATH'. If any error occurs, stores the error message in the 'errormsg' parameter.
+ * @param address The listening address
+ * @param errormsg Pointer to char array.
+ * @return The pointer to the new structure or NULL
+ */
+DECLFUNC Prometheus_server* Prometheus_start(const char* address, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Prometheus_publish
+ * Copies metrics of the structure into the snapshot served by next scrapes.
+ * @param server The pointer to the server
+ * @param stat The pointer to the Process_stat structure
+ * @param time_ms Real time of the sample in milliseconds
+ */
+DECLFUNC void Prometheus_publish(Prometheus_server* server, const Process_stat* stat, long long time_ms)
+    ATTR(nonnull(1, 2));
+/**
+ * @brief Prometheus_render
+ * Renders the snapshot in the text exposition format into the response buffer of the server. The buffer grows only
+ * if the response does not fit it. Called by the server thread, exposed for tests.
+ * @param server The pointer to the server
+ * @param snapshot The pointer to the snapshot
+ * @return The rendered text, valid until the next rendering
+ */
+DECLFUNC const char* Prometheus_render(Prometheus_server* server, const Prometheus_snapshot* snapshot)
+    ATTR(nonnull(1, 2));
+/**
+ * @brief Prometheus_stop
+ * Stops the server thread, closes the socket and deletes the Prometheus_server structure.
+ * @param server The pointer to the server
+ */
+DECLFUNC void Prometheus_stop(Prometheus_server* server) ATTR(nonnull(1));
+
+#endif // __PROMETHEUS_H
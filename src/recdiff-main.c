@@ -0,0 +1,146 @@
+#include "ioutils.h"
+#include "recording.h"
+#include "recdiff.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int EXIT_NO_REGRESSION = 0;
+static const int EXIT_REGRESSION = 1;
+static const int EXIT_ERROR = 2;
+
+static const long long DEFAULT_WINDOW_SEC = 60; // default duration of aligned windows
+static const double DEFAULT_THRESHOLD = 10.0;   // default regression threshold in percent
+static const double DEFAULT_MIN_DELTA = 0.01;   // default minimal absolute difference
+
+static void print_help()
+{
+  printf("Compares two recordings of " __BINARY_NAME " and reports regressions of the candidate.\n"
+         "Usage: " __BINARY_NAME "-diff [OPTIONS] BASELINE CANDIDATE\n"
+         "Options:\n"
+         "  -window-sec N      duration of aligned windows in seconds (default: 60)\n"
+         "  -threshold PCT     regression threshold in percent (default: 10)\n"
+         "  -min-delta VALUE   minimal absolute difference counted as a regression (default: 0.01)\n"
+         "  -statistic NAME    compared statistic: mean, p50, p95, p99 or max (default: p95)\n"
+         "  -metric NAME       compare only this metric\n"
+         "  -h, --help         print this help\n"
+         "Recordings are aligned by time from their first samples. Counters are compared as rates per second.\n"
+         "Exit status: 0 - no regressions, 1 - regression detected, 2 - error.\n");
+}
+
+// reads the non-negative number after the option
+static bool read_number(int argc, char** argv, int* i, double* dst)
+{
+  if (*i + 1 >= argc) {
+    fprintf(stderr, "No the value after '%s' option.\n", argv[*i]);
+    return false;
+  }
+
+  char* end = NULL;
+  double value = strtod(argv[*i + 1], &end);
+  if (end == argv[*i + 1] || *end != '\0' || value < 0.0) {
+    fprintf(stderr, "Incorrect the value after '%s' option.\n", argv[*i]);
+    return false;
+  }
+  *dst = value;
+  ++(*i);
+  return true;
+}
+
+static bool read_statistic(int argc, char** argv, int* i, Diff_statistic* dst)
+{
+  if (*i + 1 < argc) {
+    for (int s = 0; s < DIFF_STATISTICS_COUNT; ++s) {
+      if (strcmp(argv[*i + 1], Diff_statistic_name((Diff_statistic) s)) == 0) {
+        *dst = (Diff_statistic) s;
+        ++(*i);
+        return true;
+      }
+    }
+  }
+  fprintf(stderr, "Incorrect the value after '%s' option.\n", argv[*i]);
+  return false;
+}
+
+static Recording_reader* open_recording(const char* path)
+{
+  char* errormsg = NULL;
+  Recording_reader* reader = Recording_reader_open(path, &errormsg);
+  if (!reader) {
+    fprintf(stderr, "%s\n", errormsg);
+    free(errormsg);
+    return NULL;
+  }
+  printf("%s: %s (PID %d), %llu samples\n", path, reader->Process_name, reader->Pid, reader->Samples_count);
+  return reader;
+}
+
+int main(int argc, char** argv)
+{
+  Diff_options options = {DEFAULT_WINDOW_SEC * 1000, DEFAULT_THRESHOLD, DEFAULT_MIN_DELTA, DIFF_P95, NULL};
+  const char* paths[2] = {NULL, NULL};
+  int paths_count = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+      print_help();
+      return EXIT_NO_REGRESSION;
+    } else if (strcmp(argv[i], "-window-sec") == 0) {
+      double value = 0.0;
+      if (!read_number(argc, argv, &i, &value) || value <= 0.0) {
+        fprintf(stderr, "Incorrect the value after '-window-sec' option.\n");
+        return EXIT_ERROR;
+      }
+      options.Window_ms = (long long) (value * 1000.0);
+    } else if (strcmp(argv[i], "-threshold") == 0) {
+      if (!read_number(argc, argv, &i, &options.Threshold))
+        return EXIT_ERROR;
+    } else if (strcmp(argv[i], "-min-delta") == 0) {
+      if (!read_number(argc, argv, &i, &options.Min_delta))
+        return EXIT_ERROR;
+    } else if (strcmp(argv[i], "-statistic") == 0) {
+      if (!read_statistic(argc, argv, &i, &options.Statistic))
+        return EXIT_ERROR;
+    } else if (strcmp(argv[i], "-metric") == 0) {
+      if (i + 1 >= argc) {
+        fprintf(stderr, "No the value after '-metric' option.\n");
+        return EXIT_ERROR;
+      }
+      options.Metric = argv[++i];
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      fprintf(stderr, "Unknown option '%s'.\n", argv[i]);
+      return EXIT_ERROR;
+    } else if (paths_count < 2)
+      paths[paths_count++] = argv[i];
+    else {
+      fprintf(stderr, "Too many recordings.\n");
+      return EXIT_ERROR;
+    }
+  }
+  if (paths_count != 2) {
+    print_help();
+    return EXIT_ERROR;
+  }
+
+  int rc = EXIT_ERROR;
+  Recording_reader *baseline = open_recording(paths[0]), *candidate = NULL;
+  if (baseline && (candidate = open_recording(paths[1])) != NULL) {
+    char* errormsg = NULL;
+    Diff_report* report = Diff_recordings(baseline, candidate, &options, &errormsg);
+    if (report) {
+      Diff_report_print(report, stdout);
+      rc = report->Regression ? EXIT_REGRESSION : EXIT_NO_REGRESSION;
+      Diff_report_free(report);
+    } else {
+      fprintf(stderr, "%s\n", errormsg);
+      free(errormsg);
+    }
+  }
+
+  if (candidate)
+    Recording_reader_close(candidate);
+  if (baseline)
+    Recording_reader_close(baseline);
+  return rc;
+}
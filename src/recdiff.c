@@ -0,0 +1,293 @@
+#include "recdiff.h"
+#include "ioutils.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* STATISTIC_NAMES[DIFF_STATISTICS_COUNT] = {"mean", "p50", "p95", "p99", "max"};
+
+// accumulated values of one metric in one recording
+typedef struct
+{
+  Sketch* sketch;                    // distribution of all values
+  double sum;                        // sum of all values
+  unsigned long long count;          // number of all values
+  double window_sum;                 // sum of values in the current window
+  unsigned long long window_count;   // number of values in the current window
+} metric_state;
+
+// one recording, which is read sample by sample
+typedef struct
+{
+  Recording_reader* reader;
+  int* map;                   // index of every compared metric in the recording
+  metric_state* states;       // state of every compared metric
+  double* values;             // values of the current sample
+  double* last;               // values of the previous sample
+  long long time_ms;          // time of the current sample
+  long long last_time_ms;     // time of the previous sample
+  bool has;                   // the current sample exists
+  bool has_last;              // the previous sample exists
+  unsigned long long samples; // number of consumed samples
+} stream;
+
+static void stream_init(stream* s, Recording_reader* reader, size_t metrics_count, long long window_ms)
+{
+  s->reader = reader;
+  s->map = malloc(sizeof(int) * metrics_count);
+  ASSERT(s->map != NULL, "s->map (int*) != NULL; malloc(...) returns NULL.");
+  s->states = calloc(metrics_count, sizeof(metric_state));
+  ASSERT(s->states != NULL, "s->states (metric_state*) != NULL; calloc(...) returns NULL.");
+  for (size_t i = 0; i < metrics_count; ++i)
+    s->states[i].sketch = Sketch_init(window_ms);
+  s->values = calloc(reader->Metrics_count + 1, sizeof(double));
+  ASSERT(s->values != NULL, "s->values (double*) != NULL; calloc(...) returns NULL.");
+  s->last = calloc(reader->Metrics_count + 1, sizeof(double));
+  ASSERT(s->last != NULL, "s->last (double*) != NULL; calloc(...) returns NULL.");
+  s->has_last = false;
+  s->samples = 0;
+
+  Recording_reader_seek(reader, reader->First_time_ms);
+  s->has = Recording_reader_next(reader, &s->time_ms, s->values);
+}
+
+static void stream_free(stream* s, size_t metrics_count)
+{
+  for (size_t i = 0; i < metrics_count; ++i)
+    Sketch_free(s->states[i].sketch);
+  free(s->states);
+  free(s->map);
+  free(s->values);
+  free(s->last);
+}
+
+// feeds samples with the time from the start less than the limit, counters are converted to rates per second
+static void stream_consume(stream* s, const Diff_report* report, long long limit_ms)
+{
+  while (s->has && s->time_ms - s->reader->First_time_ms < limit_ms) {
+    for (size_t i = 0; i < report->Metrics_count; ++i) {
+      double value = s->values[s->map[i]];
+      if (report->Metrics[i].Rate) {
+        long long dt = s->time_ms - s->last_time_ms;
+        if (!s->has_last || dt <= 0 || value < s->last[s->map[i]])
+          continue; // no previous sample or the counter is reset
+        value = (value - s->last[s->map[i]]) * 1000.0 / (double) dt;
+      }
+
+      metric_state* state = &s->states[i];
+      Sketch_add(state->sketch, s->time_ms, value);
+      state->sum += value;
+      state->count++;
+      state->window_sum += value;
+      state->window_count++;
+    }
+
+    double* tmp = s->last;
+    s->last = s->values;
+    s->values = tmp;
+    s->last_time_ms = s->time_ms;
+    s->has_last = true;
+    s->samples++;
+    s->has = Recording_reader_next(s->reader, &s->time_ms, s->values);
+  }
+}
+
+static void summarize(const metric_state* state, double* statistics)
+{
+  Sketch_summary summary;
+  Sketch_summarize(&state->sketch->Lifetime, &summary);
+  statistics[DIFF_MEAN] = state->count ? state->sum / (double) state->count : 0.0;
+  statistics[DIFF_P50] = summary.P50;
+  statistics[DIFF_P95] = summary.P95;
+  statistics[DIFF_P99] = summary.P99;
+  statistics[DIFF_MAX] = summary.Max;
+}
+
+static bool exceeds(double baseline, double candidate, const Diff_options* options)
+{
+  return candidate - baseline > options->Min_delta && candidate > baseline * (1.0 + options->Threshold / 100.0);
+}
+
+static double change(double baseline, double candidate)
+{
+  if (baseline > 0.0)
+    return (candidate - baseline) * 100.0 / baseline;
+  return candidate > 0.0 ? HUGE_VAL : 0.0;
+}
+
+static void add_metric(Diff_report* report, stream* baseline, stream* candidate, const char* name, bool rate)
+{
+  Diff_metric* metric = &report->Metrics[report->Metrics_count];
+  metric->Name = malloc(strlen(name) + 1);
+  ASSERT(metric->Name != NULL, "metric->Name (char*) != NULL; malloc(...) returns NULL.");
+  strcpy(metric->Name, name);
+  metric->Rate = rate;
+  metric->Windows = 0;
+  metric->Regressed_windows = 0;
+  baseline->map[report->Metrics_count] = Recording_reader_metric(baseline->reader, name);
+  candidate->map[report->Metrics_count] = Recording_reader_metric(candidate->reader, name);
+  report->Metrics_count++;
+}
+
+const char* Diff_statistic_name(Diff_statistic statistic)
+{
+  if (statistic < 0 || statistic >= DIFF_STATISTICS_COUNT)
+    return "";
+  return STATISTIC_NAMES[statistic];
+}
+
+Diff_report* Diff_recordings(
+    Recording_reader* baseline, Recording_reader* candidate, const Diff_options* options, char** errormsg)
+{
+  if (baseline->Samples_count == 0 || candidate->Samples_count == 0) {
+    strconcat(errormsg, 1, SAFE_PASS_VARGS("The recording is empty."));
+    return NULL;
+  }
+  if (options->Window_ms <= 0) {
+    strconcat(errormsg, 1, SAFE_PASS_VARGS("The window duration must be positive."));
+    return NULL;
+  }
+
+  Diff_report* report = malloc(sizeof(Diff_report));
+  ASSERT(report != NULL, "report (Diff_report*) != NULL; malloc(...) returns NULL.");
+  report->Options = *options;
+  report->Metrics_count = 0;
+  report->Metrics = calloc(baseline->Metrics_count + 1, sizeof(Diff_metric));
+  ASSERT(report->Metrics != NULL, "report->Metrics (Diff_metric*) != NULL; calloc(...) returns NULL.");
+  report->Regression = false;
+
+  // metrics are matched by names, so recordings of different versions can be compared
+  stream base, cand;
+  stream_init(&base, baseline, baseline->Metrics_count, options->Window_ms);
+  stream_init(&cand, candidate, baseline->Metrics_count, options->Window_ms);
+  for (size_t i = 0; i < baseline->Metrics_count; ++i) {
+    const char* name = baseline->Metric_names[i];
+    if (options->Metric && strcmp(options->Metric, name) != 0)
+      continue;
+    if (Recording_reader_metric(candidate, name) >= 0)
+      add_metric(report, &base, &cand, name, baseline->Metric_types[i] == METRIC_COUNTER);
+  }
+
+  if (report->Metrics_count == 0) {
+    if (options->Metric)
+      strconcat(errormsg, 3, SAFE_PASS_VARGS("The metric '", options->Metric, "' is not found in both recordings."));
+    else
+      strconcat(errormsg, 1, SAFE_PASS_VARGS("The recordings have no common metrics."));
+    stream_free(&base, baseline->Metrics_count);
+    stream_free(&cand, baseline->Metrics_count);
+    Diff_report_free(report);
+    return NULL;
+  }
+
+  // both recordings are read once in parallel, window by window
+  report->Duration_ms = MIN(baseline->Last_time_ms - baseline->First_time_ms,
+                            candidate->Last_time_ms - candidate->First_time_ms);
+  for (long long end = options->Window_ms;; end += options->Window_ms) {
+    long long limit = MIN(end, report->Duration_ms + 1);
+    stream_consume(&base, report, limit);
+    stream_consume(&cand, report, limit);
+
+    for (size_t i = 0; i < report->Metrics_count; ++i) {
+      metric_state *bstate = &base.states[i], *cstate = &cand.states[i];
+      if (bstate->window_count && cstate->window_count) {
+        Diff_metric* metric = &report->Metrics[i];
+        metric->Windows++;
+        if (exceeds(bstate->window_sum / (double) bstate->window_count,
+                    cstate->window_sum / (double) cstate->window_count,
+                    options))
+          metric->Regressed_windows++;
+      }
+      bstate->window_sum = cstate->window_sum = 0.0;
+      bstate->window_count = cstate->window_count = 0;
+    }
+    if (end > report->Duration_ms)
+      break;
+  }
+
+  for (size_t i = 0; i < report->Metrics_count; ++i) {
+    Diff_metric* metric = &report->Metrics[i];
+    summarize(&base.states[i], metric->Baseline);
+    summarize(&cand.states[i], metric->Candidate);
+    double b = metric->Baseline[options->Statistic], c = metric->Candidate[options->Statistic];
+    metric->Change = change(b, c);
+    metric->Regression = exceeds(b, c, options);
+    report->Regression = report->Regression || metric->Regression;
+  }
+  report->Baseline_samples = base.samples;
+  report->Candidate_samples = cand.samples;
+
+  stream_free(&base, baseline->Metrics_count);
+  stream_free(&cand, baseline->Metrics_count);
+  return report;
+}
+
+// returns the unit of the known metric
+static const char* metric_unit(const char* name)
+{
+  for (int id = 0; id < METRIC_COUNT; ++id) {
+    const Metric_info* info = Metric_get_info((Metric_id) id);
+    if (strcmp(info->Name, name) == 0)
+      return info->Unit;
+  }
+  return "";
+}
+
+static void print_change(double value, FILE* file)
+{
+  if (isinf(value))
+    fprintf(file, "%10s", "+inf");
+  else
+    fprintf(file, "%+9.1f%%", value);
+}
+
+void Diff_report_print(const Diff_report* report, FILE* file)
+{
+  const Diff_options* options = &report->Options;
+  fprintf(file,
+          "Aligned duration: %.1f s, baseline samples: %llu, candidate samples: %llu\n",
+          (double) report->Duration_ms / 1000.0,
+          report->Baseline_samples,
+          report->Candidate_samples);
+  fprintf(file,
+          "Window: %.1f s, compared statistic: %s, threshold: %.1f%%, min delta: %g\n\n",
+          (double) options->Window_ms / 1000.0,
+          Diff_statistic_name(options->Statistic),
+          options->Threshold,
+          options->Min_delta);
+  fprintf(file, "%-32s %14s %14s %10s\n", "METRIC", "BASELINE", "CANDIDATE", "CHANGE");
+
+  for (size_t i = 0; i < report->Metrics_count; ++i) {
+    const Diff_metric* metric = &report->Metrics[i];
+    const char* unit = metric_unit(metric->Name);
+    if (metric->Rate)
+      fprintf(file, "%s (%s/s)\n", metric->Name, *unit ? unit : "1");
+    else if (*unit)
+      fprintf(file, "%s (%s)\n", metric->Name, unit);
+    else
+      fprintf(file, "%s\n", metric->Name);
+
+    for (int s = 0; s < DIFF_STATISTICS_COUNT; ++s) {
+      fprintf(file,
+              "  %-30s %14.3f %14.3f ",
+              Diff_statistic_name((Diff_statistic) s),
+              metric->Baseline[s],
+              metric->Candidate[s]);
+      print_change(change(metric->Baseline[s], metric->Candidate[s]), file);
+      fprintf(file, "\n");
+    }
+    char windows[64];
+    snprintf(windows, sizeof(windows), "regressed windows: %zu / %zu", metric->Regressed_windows, metric->Windows);
+    fprintf(file, "  %-60s %10s\n", windows, metric->Regression ? "REGRESSION" : "ok");
+  }
+
+  fprintf(file, "\n%s\n", report->Regression ? "Regression detected." : "No regressions.");
+}
+
+void Diff_report_free(Diff_report* report)
+{
+  for (size_t i = 0; i < report->Metrics_count; ++i)
+    free(report->Metrics[i].Name);
+  free(report->Metrics);
+  free(report);
+}
@@ -0,0 +1,103 @@
+#ifndef __RECDIFF_H
+#define __RECDIFF_H
+
+#include "../include/recording.h"
+#include "../include/sketch.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Diff_statistic
+ * The statistic, which is compared to detect regressions.
+ */
+typedef enum
+{
+  DIFF_MEAN,
+  DIFF_P50,
+  DIFF_P95,
+  DIFF_P99,
+  DIFF_MAX,
+  DIFF_STATISTICS_COUNT
+} Diff_statistic;
+
+/**
+ * @brief Diff_options
+ * Options of comparing recordings.
+ */
+typedef struct
+{
+  long long Window_ms;      //! Duration of aligned windows
+  double Threshold;         //! Regression threshold in percent
+  double Min_delta;         //! Minimal absolute difference for a regression
+  Diff_statistic Statistic; //! The compared statistic
+  const char* Metric;       //! Compare only this metric (NULL for all metrics)
+} Diff_options;
+
+/**
+ * @brief Diff_metric
+ * Distributions of one metric in both recordings. Counters are compared as rates per second.
+ */
+typedef struct
+{
+  char* Name;                                //! The metric name
+  bool Rate;                                 //! The metric is a counter, values are rates per second
+  double Baseline[DIFF_STATISTICS_COUNT];    //! Statistics of the baseline
+  double Candidate[DIFF_STATISTICS_COUNT];   //! Statistics of the candidate
+  double Change;                             //! Change of the compared statistic in percent
+  size_t Windows;                            //! Number of windows with samples in both recordings
+  size_t Regressed_windows;                  //! Number of windows, where the candidate mean exceeds the threshold
+  bool Regression;                           //! The compared statistic exceeds the threshold
+} Diff_metric;
+
+/**
+ * @brief Diff_report
+ * The result of comparing two recordings. Recordings are aligned by time from their first samples and compared over
+ * the duration of the shorter recording.
+ */
+typedef struct
+{
+  Diff_options Options;                   //! Used options
+  size_t Metrics_count;                   //! Number of compared metrics
+  Diff_metric* Metrics;                   //! Compared metrics
+  long long Duration_ms;                  //! Aligned duration
+  unsigned long long Baseline_samples;    //! Number of compared samples of the baseline
+  unsigned long long Candidate_samples;   //! Number of compared samples of the candidate
+  bool Regression;                        //! At least one metric has a regression
+} Diff_report;
+
+/**
+ * @brief Diff_statistic_name
+ * Returns the name of the statistic ('mean', 'p50', ...).
+ * @param statistic The statistic
+ * @return The name
+ */
+DECLFUNC const char* Diff_statistic_name(Diff_statistic statistic);
+/**
+ * @brief Diff_recordings
+ * Streams both recordings once and compares distributions of metrics, which exist in both recordings. Memory does not
+ * depend on sizes of recordings. If any error occurs, stores the error message in the 'errormsg' parameter.
+ * @param baseline The baseline recording
+ * @param candidate The candidate recording
+ * @param options Options of comparing
+ * @param errormsg Pointer to char array.
+ * @return The pointer to the new report or NULL
+ */
+DECLFUNC Diff_report* Diff_recordings(
+    Recording_reader* baseline, Recording_reader* candidate, const Diff_options* options, char** errormsg)
+    ATTR(nonnull(1, 2, 3));
+/**
+ * @brief Diff_report_print
+ * Prints the report in the human-readable form.
+ * @param report The pointer to the report
+ * @param file The output file
+ */
+DECLFUNC void Diff_report_print(const Diff_report* report, FILE* file) ATTR(nonnull(1, 2));
+/**
+ * @brief Diff_report_free
+ * Deletes the Diff_report structure.
+ * @param report The pointer to the report
+ */
+DECLFUNC void Diff_report_free(Diff_report* report) ATTR(nonnull(1));
+
+#endif // __RECDIFF_H
@@ -0,0 +1,548 @@
+#include "recording.h"
+
+#include "ioutils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#elif _WIN32
+#include <Windows.h>
+#endif
+
+static const char RECORDING_MAGIC[8] = {'P', 'W', 'R', 'E', 'C', 'O', 'R', 'D'};
+static const uint32_t RECORDING_VERSION = 2;
+static const uint32_t BLOCK_MAGIC = 0x4B425750; // 'PWBK'
+
+#define BLOCK_HEADER_SIZE 32
+#define MAX_VARINT_SIZE 10
+#define MAX_SAMPLE_SIZE (MAX_VARINT_SIZE * (METRIC_COUNT + 1))
+#define BLOCK_CAPACITY (BLOCK_HEADER_SIZE + RECORDING_BLOCK_SAMPLES * MAX_SAMPLE_SIZE)
+
+// little-endian integers
+
+static void put_u32(unsigned char* p, uint32_t v)
+{
+  for (int i = 0; i < 4; ++i)
+    p[i] = (unsigned char) (v >> (8 * i));
+}
+
+static void put_u64(unsigned char* p, uint64_t v)
+{
+  for (int i = 0; i < 8; ++i)
+    p[i] = (unsigned char) (v >> (8 * i));
+}
+
+static uint32_t get_u32(const unsigned char* p)
+{
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i)
+    v |= (uint32_t) p[i] << (8 * i);
+  return v;
+}
+
+static uint64_t get_u64(const unsigned char* p)
+{
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i)
+    v |= (uint64_t) p[i] << (8 * i);
+  return v;
+}
+
+// varints, signed values are zigzag-encoded
+
+static size_t put_varint(unsigned char* p, uint64_t v)
+{
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (unsigned char) (v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (unsigned char) v;
+  return n;
+}
+
+static size_t put_svarint(unsigned char* p, int64_t v)
+{
+  return put_varint(p, ((uint64_t) v << 1) ^ (uint64_t) (v >> 63));
+}
+
+// returns false, if the varint is truncated
+static bool get_varint(const unsigned char* p, size_t end, size_t* pos, uint64_t* v)
+{
+  *v = 0;
+  for (int shift = 0; shift < 64 && *pos < end; shift += 7) {
+    unsigned char byte = p[(*pos)++];
+    *v |= (uint64_t) (byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+static bool get_svarint(const unsigned char* p, size_t end, size_t* pos, int64_t* v)
+{
+  uint64_t u;
+  if (!get_varint(p, end, pos, &u))
+    return false;
+  *v = (int64_t) (u >> 1) ^ -(int64_t) (u & 1);
+  return true;
+}
+
+// XOR-encoded doubles: the byte 0 for the unchanged value, otherwise the byte with numbers of leading and trailing
+// zero bytes of the XOR result and the meaningful bytes
+
+static uint64_t double_bits(double v)
+{
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+static double bits_double(uint64_t bits)
+{
+  double v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+static size_t put_xor(unsigned char* p, double prev, double value)
+{
+  uint64_t x = double_bits(prev) ^ double_bits(value);
+  if (x == 0) {
+    p[0] = 0;
+    return 1;
+  }
+
+  int leading = 0, trailing = 0;
+  while (leading < 7 && !(x >> (8 * (7 - leading)) & 0xFF))
+    ++leading;
+  while (trailing < 7 && !(x >> (8 * trailing) & 0xFF))
+    ++trailing;
+  int count = 8 - leading - trailing;
+
+  p[0] = (unsigned char) (0x40 | (leading << 3) | trailing);
+  for (int i = 0; i < count; ++i)
+    p[1 + i] = (unsigned char) (x >> (8 * (trailing + count - 1 - i)));
+  return (size_t) count + 1;
+}
+
+static bool get_xor(const unsigned char* p, size_t end, size_t* pos, double prev, double* value)
+{
+  if (*pos >= end)
+    return false;
+  unsigned char hdr = p[(*pos)++];
+  if (hdr == 0) {
+    *value = prev;
+    return true;
+  }
+
+  int leading = (hdr >> 3) & 0x07, trailing = hdr & 0x07, count = 8 - leading - trailing;
+  if (count <= 0 || *pos + (size_t) count > end)
+    return false;
+  uint64_t x = 0;
+  for (int i = 0; i < count; ++i)
+    x = (x << 8) | p[(*pos)++];
+  *value = bits_double(double_bits(prev) ^ (x << (8 * trailing)));
+  return true;
+}
+
+static bool write_data(Recording_writer* writer, const void* data, size_t size, char** errormsg)
+{
+  if (fwrite(data, 1, size, writer->__file) != size || fflush(writer->__file) != 0) {
+    strconcat(errormsg, 2, SAFE_PASS_VARGS("Unable to write the recording: ", strerror(errno)));
+    return false;
+  }
+  writer->Bytes_written += size;
+  return true;
+}
+
+Recording_writer* Recording_writer_open(
+    const char* path, const char* process_name, int pid, long long realtime_offset_ms, char** errormsg)
+{
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open file '", path, "': ", strerror(errno)));
+    return NULL;
+  }
+
+  Recording_writer* writer = malloc(sizeof(Recording_writer));
+  ASSERT(writer != NULL, "writer (Recording_writer*) != NULL; malloc(...) returns NULL.");
+  memset(writer, 0, sizeof(Recording_writer));
+  writer->__file = file;
+  writer->__block = malloc(BLOCK_CAPACITY);
+  ASSERT(writer->__block != NULL, "writer->__block (unsigned char*) != NULL; malloc(...) returns NULL.");
+  writer->__block_size = BLOCK_HEADER_SIZE;
+
+  // header: magic, version, pid, metrics count, real-time offset, the process name, types and names of metrics
+  size_t namelen = strlen(process_name) > 0xFFFF ? 0xFFFF : strlen(process_name);
+  unsigned char header[8 + 4 + 4 + 4 + 8 + 2];
+  memcpy(header, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+  put_u32(header + 8, RECORDING_VERSION);
+  put_u32(header + 12, (uint32_t) pid);
+  put_u32(header + 16, METRIC_COUNT);
+  put_u64(header + 20, (uint64_t) realtime_offset_ms);
+  header[28] = (unsigned char) namelen;
+  header[29] = (unsigned char) (namelen >> 8);
+
+  bool success = write_data(writer, header, sizeof(header), errormsg) &&
+                 write_data(writer, process_name, namelen, errormsg);
+  for (int id = 0; success && id < METRIC_COUNT; ++id) {
+    const Metric_info* info = Metric_get_info((Metric_id) id);
+    unsigned char metric[2 + 255];
+    size_t len = strlen(info->Name) > 255 ? 255 : strlen(info->Name);
+    metric[0] = (unsigned char) info->Type;
+    metric[1] = (unsigned char) len;
+    memcpy(metric + 2, info->Name, len);
+    success = write_data(writer, metric, len + 2, errormsg);
+  }
+
+  if (!success) {
+    Recording_writer_close(writer);
+    return NULL;
+  }
+  return writer;
+}
+
+bool Recording_writer_append(Recording_writer* writer, long long time_ms, const double* values, char** errormsg)
+{
+  unsigned char* p = writer->__block + writer->__block_size;
+  size_t size = 0;
+  // times of blocks are searched by the reader, so the time never decreases
+  if (writer->Samples_count > 0 && time_ms < writer->__last_time_ms)
+    time_ms = writer->__last_time_ms;
+
+  if (writer->__block_samples == 0) {
+    // the time of the first sample is stored in the block header
+    writer->__first_time_ms = time_ms;
+    writer->__last_delta_ms = 0;
+    memset(writer->__last, 0, sizeof(writer->__last));
+  } else {
+    long long delta = time_ms - writer->__last_time_ms;
+    size += put_svarint(p, (int64_t) (delta - writer->__last_delta_ms));
+    writer->__last_delta_ms = delta;
+  }
+  writer->__last_time_ms = time_ms;
+
+  for (int id = 0; id < METRIC_COUNT; ++id) {
+    if (Metric_get_info((Metric_id) id)->Type == METRIC_COUNTER)
+      size += put_svarint(p + size, (int64_t) values[id] - (int64_t) writer->__last[id]);
+    else
+      size += put_xor(p + size, writer->__last[id], values[id]);
+    writer->__last[id] = values[id];
+  }
+
+  writer->__block_size += size;
+  writer->__block_samples++;
+  writer->Samples_count++;
+
+  if (writer->__block_samples >= RECORDING_BLOCK_SAMPLES)
+    return Recording_writer_flush(writer, errormsg);
+  return true;
+}
+
+bool Recording_writer_flush(Recording_writer* writer, char** errormsg)
+{
+  if (writer->__block_samples == 0)
+    return true;
+
+  unsigned char* hdr = writer->__block;
+  put_u32(hdr, BLOCK_MAGIC);
+  put_u32(hdr + 4, writer->__block_samples);
+  put_u64(hdr + 8, (uint64_t) writer->__first_time_ms);
+  put_u64(hdr + 16, (uint64_t) writer->__last_time_ms);
+  put_u32(hdr + 24, (uint32_t) (writer->__block_size - BLOCK_HEADER_SIZE));
+  put_u32(hdr + 28, 0);
+
+  bool success = write_data(writer, writer->__block, writer->__block_size, errormsg);
+  writer->__block_size = BLOCK_HEADER_SIZE;
+  writer->__block_samples = 0;
+  return success;
+}
+
+void Recording_writer_close(Recording_writer* writer)
+{
+  char* errormsg = NULL;
+  Recording_writer_flush(writer, &errormsg);
+  free(errormsg);
+
+  fclose(writer->__file);
+  free(writer->__block);
+  free(writer);
+}
+
+// maps the file to memory
+static bool map_file(Recording_reader* reader, const char* path, char** errormsg)
+{
+#ifdef __linux__
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open file '", path, "': ", strerror(errno)));
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to read file '", path, "': ", strerror(errno)));
+    close(fd);
+    return false;
+  }
+  reader->__size = (size_t) st.st_size;
+  if (reader->__size > 0) {
+    void* data = mmap(NULL, reader->__size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to map file '", path, "': ", strerror(errno)));
+      close(fd);
+      return false;
+    }
+    reader->__data = data;
+  }
+  close(fd);
+  return true;
+#elif _WIN32
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    strconcat(errormsg, 3, SAFE_PASS_VARGS("Unable to open file '", path, "'"));
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    strconcat(errormsg, 3, SAFE_PASS_VARGS("Unable to read file '", path, "'"));
+    return false;
+  }
+  reader->__size = (size_t) size.QuadPart;
+  if (reader->__size > 0) {
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping)
+      reader->__data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!reader->__data) {
+      if (mapping)
+        CloseHandle(mapping);
+      CloseHandle(file);
+      strconcat(errormsg, 3, SAFE_PASS_VARGS("Unable to map file '", path, "'"));
+      return false;
+    }
+    reader->__handle = mapping;
+  }
+  CloseHandle(file);
+  return true;
+#endif
+}
+
+// reads the file header, returns the size of the header or 0
+static size_t read_header(Recording_reader* reader)
+{
+  const unsigned char* p = reader->__data;
+  size_t size = reader->__size, pos = 8 + 4 + 4 + 4 + 8 + 2;
+  if (size < pos || memcmp(p, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0 || get_u32(p + 8) != RECORDING_VERSION)
+    return 0;
+  reader->Pid = (int) get_u32(p + 12);
+  size_t namelen = (size_t) p[28] | (size_t) p[29] << 8;
+  // every metric takes 2 bytes at least, so the corrupted count is rejected before the allocation
+  if (pos + namelen > size || get_u32(p + 16) > (size - pos - namelen) / 2)
+    return 0;
+  reader->Metrics_count = get_u32(p + 16);
+  reader->Realtime_offset_ms = (long long) get_u64(p + 20);
+
+  reader->Process_name = malloc(namelen + 1);
+  ASSERT(reader->Process_name != NULL, "reader->Process_name (char*) != NULL; malloc(...) returns NULL.");
+  memcpy(reader->Process_name, p + pos, namelen);
+  reader->Process_name[namelen] = '\0';
+  pos += namelen;
+
+  reader->Metric_names = calloc(reader->Metrics_count, sizeof(char*));
+  reader->Metric_types = calloc(reader->Metrics_count, sizeof(Metric_type));
+  reader->__values = calloc(reader->Metrics_count, sizeof(double));
+  ASSERT(reader->Metric_names != NULL && reader->Metric_types != NULL && reader->__values != NULL,
+         "reader->Metric_names, reader->Metric_types, reader->__values != NULL; calloc(...) returns NULL.");
+  for (size_t i = 0; i < reader->Metrics_count; ++i) {
+    if (pos + 2 > size || pos + 2 + p[pos + 1] > size)
+      return 0;
+    reader->Metric_types[i] = p[pos] == METRIC_COUNTER ? METRIC_COUNTER : METRIC_GAUGE;
+    size_t len = p[pos + 1];
+    reader->Metric_names[i] = malloc(len + 1);
+    ASSERT(reader->Metric_names[i] != NULL, "reader->Metric_names[i] (char*) != NULL; malloc(...) returns NULL.");
+    memcpy(reader->Metric_names[i], p + pos + 2, len);
+    reader->Metric_names[i][len] = '\0';
+    pos += 2 + len;
+  }
+  return pos;
+}
+
+// indexes blocks after the header, the truncated block ends the index
+static void index_blocks(Recording_reader* reader, size_t pos)
+{
+  size_t capacity = 0;
+  while (pos + BLOCK_HEADER_SIZE <= reader->__size) {
+    const unsigned char* hdr = reader->__data + pos;
+    size_t payload = get_u32(hdr + 24);
+    if (get_u32(hdr) != BLOCK_MAGIC || payload > reader->__size - pos - BLOCK_HEADER_SIZE)
+      break;
+
+    if (reader->__blocks_count == capacity) {
+      capacity = capacity ? capacity * 2 : 64;
+      reader->__blocks = realloc(reader->__blocks, capacity * sizeof(Recording_block));
+      ASSERT(reader->__blocks != NULL, "reader->__blocks (Recording_block*) != NULL; realloc(...) returns NULL.");
+    }
+    Recording_block* block = &reader->__blocks[reader->__blocks_count++];
+    block->Offset = pos + BLOCK_HEADER_SIZE;
+    block->Size = payload;
+    block->Samples = get_u32(hdr + 4);
+    block->First_time = (long long) get_u64(hdr + 8) + reader->Realtime_offset_ms;
+    block->Last_time = (long long) get_u64(hdr + 16) + reader->Realtime_offset_ms;
+    reader->Samples_count += block->Samples;
+    pos += BLOCK_HEADER_SIZE + payload;
+  }
+
+  if (reader->__blocks_count > 0) {
+    reader->First_time_ms = reader->__blocks[0].First_time;
+    reader->Last_time_ms = reader->__blocks[reader->__blocks_count - 1].Last_time;
+  }
+}
+
+static void start_block(Recording_reader* reader, size_t block)
+{
+  reader->__pending = false;
+  reader->__block = block;
+  reader->__sample = 0;
+  reader->__pos = block < reader->__blocks_count ? reader->__blocks[block].Offset : 0;
+}
+
+Recording_reader* Recording_reader_open(const char* path, char** errormsg)
+{
+  Recording_reader* reader = malloc(sizeof(Recording_reader));
+  ASSERT(reader != NULL, "reader (Recording_reader*) != NULL; malloc(...) returns NULL.");
+  memset(reader, 0, sizeof(Recording_reader));
+
+  if (!map_file(reader, path, errormsg)) {
+    Recording_reader_close(reader);
+    return NULL;
+  }
+
+  size_t pos = reader->__data ? read_header(reader) : 0;
+  if (pos == 0) {
+    strconcat(errormsg, 3, SAFE_PASS_VARGS("The file '", path, "' is not a recording."));
+    Recording_reader_close(reader);
+    return NULL;
+  }
+  index_blocks(reader, pos);
+  start_block(reader, 0);
+  return reader;
+}
+
+bool Recording_reader_seek(Recording_reader* reader, long long time_ms)
+{
+  // the first block, which ends after this time
+  size_t low = 0, high = reader->__blocks_count;
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (reader->__blocks[mid].Last_time < time_ms)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  start_block(reader, low);
+  if (low >= reader->__blocks_count)
+    return false;
+
+  // skip samples before this time in the block, the found sample is returned by the next call
+  long long time;
+  while (Recording_reader_next(reader, &time, reader->__values)) {
+    if (time >= time_ms) {
+      reader->__pending = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Recording_reader_next(Recording_reader* reader, long long* time_ms, double* values)
+{
+  if (reader->__pending) {
+    reader->__pending = false;
+    *time_ms = reader->__time_ms;
+    if (values != reader->__values)
+      memcpy(values, reader->__values, reader->Metrics_count * sizeof(double));
+    return true;
+  }
+
+  while (reader->__block < reader->__blocks_count &&
+         reader->__sample >= reader->__blocks[reader->__block].Samples)
+    start_block(reader, reader->__block + 1);
+  if (reader->__block >= reader->__blocks_count)
+    return false;
+
+  const Recording_block* block = &reader->__blocks[reader->__block];
+  const unsigned char* p = reader->__data;
+  size_t end = block->Offset + block->Size;
+
+  if (reader->__sample == 0) {
+    reader->__time_ms = block->First_time;
+    reader->__delta_ms = 0;
+    memset(reader->__values, 0, reader->Metrics_count * sizeof(double));
+  } else {
+    int64_t dod;
+    if (!get_svarint(p, end, &reader->__pos, &dod))
+      goto corrupted;
+    reader->__delta_ms += dod;
+    reader->__time_ms += reader->__delta_ms;
+  }
+
+  for (size_t i = 0; i < reader->Metrics_count; ++i) {
+    if (reader->Metric_types[i] == METRIC_COUNTER) {
+      int64_t delta;
+      if (!get_svarint(p, end, &reader->__pos, &delta))
+        goto corrupted;
+      reader->__values[i] = (double) ((int64_t) reader->__values[i] + delta);
+    } else if (!get_xor(p, end, &reader->__pos, reader->__values[i], &reader->__values[i]))
+      goto corrupted;
+  }
+
+  reader->__sample++;
+  *time_ms = reader->__time_ms;
+  if (values != reader->__values)
+    memcpy(values, reader->__values, reader->Metrics_count * sizeof(double));
+  return true;
+
+corrupted:
+  // skip the rest of the block
+  start_block(reader, reader->__block + 1);
+  return Recording_reader_next(reader, time_ms, values);
+}
+
+int Recording_reader_metric(const Recording_reader* reader, const char* name)
+{
+  for (size_t i = 0; i < reader->Metrics_count; ++i) {
+    if (strcmp(reader->Metric_names[i], name) == 0)
+      return (int) i;
+  }
+  return -1;
+}
+
+void Recording_reader_close(Recording_reader* reader)
+{
+  if (reader->__data) {
+#ifdef __linux__
+    munmap((void*) reader->__data, reader->__size);
+#elif _WIN32
+    UnmapViewOfFile(reader->__data);
+    CloseHandle((HANDLE) reader->__handle);
+#endif
+  }
+  if (reader->Metric_names) {
+    for (size_t i = 0; i < reader->Metrics_count; ++i)
+      free(reader->Metric_names[i]);
+  }
+  free(reader->Metric_names);
+  free(reader->Metric_types);
+  free(reader->Process_name);
+  free(reader->__values);
+  free(reader->__blocks);
+  free(reader);
+}
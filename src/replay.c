@@ -0,0 +1,177 @@
+#include "replay.h"
+#include "ioutils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+static const long long NO_SEEK = LLONG_MIN;
+
+// reads the next sample of the recording
+static void read_next(Replay *replay)
+{
+  replay->__has_next = Recording_reader_next(replay->Reader, &replay->__next_time_ms, replay->__values);
+}
+
+// applies the sample to the structure and feeds the history and sketches
+static void apply_sample(Replay *replay, Process_stat *stat)
+{
+  long long time_ms = replay->__next_time_ms;
+  for (int id = 0; id < METRIC_COUNT; ++id) {
+    if (replay->__map[id] >= 0)
+      Metric_set_value(stat, (Metric_id) id, replay->__values[replay->__map[id]]);
+  }
+  stat->Cpu_peak_usage = MAX(stat->Cpu_peak_usage, stat->Cpu_usage);
+  stat->Memory_peak_usage = MAX(stat->Memory_peak_usage, stat->Memory_usage);
+  stat->Disk_read_mb_peak_usage = MAX(stat->Disk_read_mb_peak_usage, stat->Disk_read_mb_usage);
+  stat->Disk_write_mb_peak_usage = MAX(stat->Disk_write_mb_peak_usage, stat->Disk_write_mb_usage);
+
+  if (stat->Cpu_sketch)
+    Sketch_add(stat->Cpu_sketch, time_ms, stat->Cpu_usage);
+  if (stat->Memory_sketch)
+    Sketch_add(stat->Memory_sketch, time_ms, stat->Memory_usage);
+  if (stat->Disk_read_sketch)
+    Sketch_add(stat->Disk_read_sketch, time_ms, stat->Disk_read_mb_usage);
+  if (stat->Disk_write_sketch)
+    Sketch_add(stat->Disk_write_sketch, time_ms, stat->Disk_write_mb_usage);
+  if (stat->History) {
+    double values[METRIC_COUNT];
+    Metric_values(stat, values);
+    Timeseries_append(stat->History, time_ms, values);
+  }
+}
+
+// clears all data collected from previous samples
+static void reset_stat(Process_stat *stat)
+{
+  stat->Cpu_peak_usage = 0.0;
+  stat->Memory_peak_usage = 0.0;
+  stat->Disk_read_mb_peak_usage = 0.0;
+  stat->Disk_write_mb_peak_usage = 0.0;
+  if (stat->Cpu_sketch)
+    Sketch_reset(stat->Cpu_sketch);
+  if (stat->Memory_sketch)
+    Sketch_reset(stat->Memory_sketch);
+  if (stat->Disk_read_sketch)
+    Sketch_reset(stat->Disk_read_sketch);
+  if (stat->Disk_write_sketch)
+    Sketch_reset(stat->Disk_write_sketch);
+  if (stat->History)
+    Timeseries_reset(stat->History);
+}
+
+Replay *Replay_init(const char *path, Process_stat *stat, char **errormsg)
+{
+  Recording_reader *reader = Recording_reader_open(path, errormsg);
+  if (!reader)
+    return NULL;
+  if (reader->Samples_count == 0) {
+    strconcat(errormsg, 3, SAFE_PASS_VARGS("The recording '", path, "' is empty."));
+    Recording_reader_close(reader);
+    return NULL;
+  }
+
+  Replay *replay = malloc(sizeof(Replay));
+  ASSERT(replay != NULL, "replay (Replay*) != NULL; malloc(...) returns NULL.");
+  replay->Reader = reader;
+  replay->Speed = 1;
+  replay->Paused = false;
+  replay->__values = calloc(reader->Metrics_count + 1, sizeof(double));
+  ASSERT(replay->__values != NULL, "replay->__values (double*) != NULL; calloc(...) returns NULL.");
+  replay->__seek_ms = NO_SEEK;
+  replay->__last_monotime = monotime_ms();
+  // metrics are matched by names, so recordings of older versions can be replayed
+  for (int id = 0; id < METRIC_COUNT; ++id)
+    replay->__map[id] = Recording_reader_metric(reader, Metric_get_info((Metric_id) id)->Name);
+
+  free(stat->Process_name);
+  stat->Process_name = malloc(strlen(reader->Process_name) + 1);
+  ASSERT(stat->Process_name != NULL, "stat->Process_name (char*) != NULL; malloc(...) returns NULL.");
+  strcpy(stat->Process_name, reader->Process_name);
+  stat->Pid = reader->Pid;
+
+  read_next(replay);
+  replay->Time_ms = replay->__next_time_ms;
+  apply_sample(replay, stat);
+  read_next(replay);
+  return replay;
+}
+
+int Replay_update(Replay *replay, Process_stat *stat)
+{
+  long long now = monotime_ms(), seek = replay->__seek_ms;
+  int applied = 0;
+  if (seek != NO_SEEK) {
+    replay->__seek_ms = NO_SEEK;
+    if (seek < replay->Reader->First_time_ms)
+      seek = replay->Reader->First_time_ms;
+    if (seek > replay->Reader->Last_time_ms)
+      seek = replay->Reader->Last_time_ms;
+
+    reset_stat(stat);
+    Recording_reader_seek(replay->Reader, seek);
+    read_next(replay);
+    if (replay->__has_next) {
+      replay->Time_ms = replay->__next_time_ms;
+      apply_sample(replay, stat);
+      read_next(replay);
+      applied++;
+    }
+  } else if (!replay->Paused)
+    replay->Time_ms += (now - replay->__last_monotime) * replay->Speed;
+  replay->__last_monotime = now;
+
+  while (replay->__has_next && replay->__next_time_ms <= replay->Time_ms) {
+    apply_sample(replay, stat);
+    read_next(replay);
+    applied++;
+  }
+
+  if (!replay->__has_next && replay->Time_ms >= replay->Reader->Last_time_ms) {
+    replay->Time_ms = replay->Reader->Last_time_ms;
+    replay->Paused = true;
+  }
+  return applied;
+}
+
+void Replay_seek(Replay *replay, long long time_ms)
+{
+  replay->__seek_ms = time_ms;
+}
+
+void Replay_seek_relative(Replay *replay, long long delta_ms)
+{
+  replay->__seek_ms = replay->Time_ms + delta_ms;
+}
+
+void Replay_status(const Replay *replay, char *buf, size_t size)
+{
+  char timestr[32] = "";
+  time_t t = (time_t) (replay->Time_ms / 1000);
+  struct tm tm;
+#ifdef _WIN32
+  if (localtime_s(&tm, &t) == 0)
+#else
+  if (localtime_r(&t, &tm) != NULL)
+#endif
+    strftime(timestr, sizeof(timestr), "%Y-%m-%d %H:%M:%S", &tm);
+
+  long long elapsed = (replay->Time_ms - replay->Reader->First_time_ms) / 1000,
+            total = (replay->Reader->Last_time_ms - replay->Reader->First_time_ms) / 1000;
+  snprintf(buf,
+           size,
+           "Replay %s (%llds / %llds) %dx%s",
+           timestr,
+           elapsed,
+           total,
+           replay->Speed,
+           replay->Paused ? " [paused]" : "");
+}
+
+void Replay_free(Replay *replay)
+{
+  Recording_reader_close(replay->Reader);
+  free(replay->__values);
+  free(replay);
+}
@@ -0,0 +1,87 @@
+#ifndef __REPLAY_H
+#define __REPLAY_H
+
+#include "../include/process.h"
+#include "../include/recording.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Replay
+ * Plays the recording back into the Process_stat structure instead of reading the running process. The replay time
+ * moves with the chosen speed, samples up to this time are applied to the structure. Seeking uses the time index of
+ * the recording, so jumps take constant time. Seeking, pausing and the speed are changed by keys between ticks of the
+ * event loop.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  Recording_reader* Reader; //! The recording
+  long long Time_ms;        //! The current replay time
+  int Speed;                //! Speed multiplier (1, 10 or 100)
+  bool Paused;              //! Replay is paused
+
+  // private fields
+  int __map[METRIC_COUNT];  // index of every metric in the recording or -1
+  double* __values;         // values of the next sample
+  long long __next_time_ms; // time of the next sample
+  bool __has_next;          // the next sample exists
+  long long __last_monotime; // monotime of the last update
+#ifdef _MSC_VER // TODO: support atomic
+  volatile
+#elif defined __GNUC__ || defined __MINGW32__
+  _Atomic
+#endif
+      long long __seek_ms; // requested time of seeking
+} Replay;
+
+/**
+ * @brief Replay_init
+ * Opens the recording and initializes the new Replay structure. The process name and PID from the recording are set
+ * to the Process_stat structure. If any error occurs, stores the error message in the 'errormsg' parameter.
+ * @param path Path to the recording
+ * @param stat The pointer to the Process_stat structure
+ * @param errormsg Pointer to char array.
+ * @return The pointer to the new structure or NULL
+ */
+DECLFUNC Replay* Replay_init(const char* path, Process_stat* stat, char** errormsg) ATTR(nonnull(1, 2));
+/**
+ * @brief Replay_update
+ * Moves the replay time and applies samples up to this time to the Process_stat structure. The history and sketches
+ * of this structure are fed with replayed samples and cleared on seeking. The replay is paused at the end of the
+ * recording.
+ * @param replay The pointer to the structure
+ * @param stat The pointer to the Process_stat structure
+ * @return Number of applied samples, 0 if the replay is paused or the next sample is not reached
+ */
+DECLFUNC int Replay_update(Replay* replay, Process_stat* stat) ATTR(nonnull(1, 2));
+/**
+ * @brief Replay_seek
+ * Requests seeking to the time. The seek is done on the next update.
+ * @param replay The pointer to the structure
+ * @param time_ms The time in the recording
+ */
+DECLFUNC void Replay_seek(Replay* replay, long long time_ms) ATTR(nonnull(1));
+/**
+ * @brief Replay_seek_relative
+ * Requests seeking relative to the current replay time.
+ * @param replay The pointer to the structure
+ * @param delta_ms Offset in milliseconds
+ */
+DECLFUNC void Replay_seek_relative(Replay* replay, long long delta_ms) ATTR(nonnull(1));
+/**
+ * @brief Replay_status
+ * Formats the replay time, the speed and the pause state.
+ * @param replay The pointer to the structure
+ * @param buf The buffer
+ * @param size Size of the buffer
+ */
+DECLFUNC void Replay_status(const Replay* replay, char* buf, size_t size) ATTR(nonnull(1, 2));
+/**
+ * @brief Replay_free
+ * Closes the recording and deletes the Replay structure.
+ * @param replay The pointer to the structure
+ */
+DECLFUNC void Replay_free(Replay* replay) ATTR(nonnull(1));
+
+#endif // __REPLAY_H
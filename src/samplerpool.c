@@ -0,0 +1,158 @@
+#include "samplerpool.h"
+#include "ioutils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+// updates chunks of the own shard, then steals chunks of other shards
+static void run_worker(Sampler_pool* pool, size_t worker)
+{
+  _Atomic size_t* cursors = (_Atomic size_t*) pool->__cursors;
+  Sampler_worker_stat* stat = &pool->Workers[worker];
+  stat->Targets_count = 0;
+  stat->Stolen_count = 0;
+  for (size_t i = 0; i < pool->Workers_count; ++i) {
+    size_t shard = (worker + i) % pool->Workers_count, end = pool->__ends[shard], begin;
+    while ((begin = atomic_fetch_add(&cursors[shard], SAMPLER_POOL_CHUNK)) < end) {
+      size_t count = MIN(end - begin, (size_t) SAMPLER_POOL_CHUNK);
+      for (size_t target = begin; target < begin + count; ++target)
+        Target_list_update_target(pool->__list, target);
+      stat->Targets_count += count;
+      if (shard != worker)
+        stat->Stolen_count += count;
+    }
+  }
+}
+
+#ifdef __linux__
+typedef struct
+{
+  Sampler_pool* Pool;
+  size_t Worker;
+} Worker_arg;
+
+// waits for ticks and updates targets until the pool is stopped
+static void* worker_thread(void* arg)
+{
+  Worker_arg worker = *(Worker_arg*) arg;
+  free(arg);
+  Sampler_pool* pool = worker.Pool;
+  unsigned long long generation = 0;
+  for (;;) {
+    pthread_mutex_lock(&pool->__mutex);
+    while (!pool->__stop && pool->__generation == generation)
+      pthread_cond_wait(&pool->__start, &pool->__mutex);
+    if (pool->__stop) {
+      pthread_mutex_unlock(&pool->__mutex);
+      return NULL;
+    }
+    generation = pool->__generation;
+    pthread_mutex_unlock(&pool->__mutex);
+
+    run_worker(pool, worker.Worker);
+
+    pthread_mutex_lock(&pool->__mutex);
+    if (--pool->__pending == 0)
+      pthread_cond_signal(&pool->__done);
+    pthread_mutex_unlock(&pool->__mutex);
+  }
+}
+#endif
+
+Sampler_pool* Sampler_pool_init(size_t workers_count)
+{
+  Sampler_pool* pool = malloc(sizeof(Sampler_pool));
+  ASSERT(pool != NULL, "pool (Sampler_pool*) != NULL; malloc(...) returns NULL.");
+#ifdef __linux__
+  pool->Workers_count = workers_count > 0 ? workers_count : 1;
+#else
+  UNUSED(workers_count);
+  pool->Workers_count = 1;
+#endif
+  pool->Workers = calloc(pool->Workers_count, sizeof(Sampler_worker_stat));
+  ASSERT(pool->Workers != NULL, "pool->Workers (Sampler_worker_stat*) != NULL; calloc(...) returns NULL.");
+  pool->Tick_ms = 0.0;
+  pool->__list = NULL;
+  pool->__cursors = malloc(sizeof(_Atomic size_t) * pool->Workers_count);
+  ASSERT(pool->__cursors != NULL, "pool->__cursors (_Atomic size_t*) != NULL; malloc(...) returns NULL.");
+  pool->__ends = malloc(sizeof(size_t) * pool->Workers_count);
+  ASSERT(pool->__ends != NULL, "pool->__ends (size_t*) != NULL; malloc(...) returns NULL.");
+#ifdef __linux__
+  pthread_mutex_init(&pool->__mutex, NULL);
+  pthread_cond_init(&pool->__start, NULL);
+  pthread_cond_init(&pool->__done, NULL);
+  pool->__generation = 0;
+  pool->__pending = 0;
+  pool->__stop = false;
+  pool->__threads = malloc(sizeof(pthread_t) * pool->Workers_count);
+  ASSERT(pool->__threads != NULL, "pool->__threads (pthread_t*) != NULL; malloc(...) returns NULL.");
+  for (size_t i = 1; i < pool->Workers_count; ++i) {
+    Worker_arg* arg = malloc(sizeof(Worker_arg));
+    ASSERT(arg != NULL, "arg (Worker_arg*) != NULL; malloc(...) returns NULL.");
+    arg->Pool = pool;
+    arg->Worker = i;
+    pthread_create(&pool->__threads[i], NULL, worker_thread, arg);
+  }
+#endif
+  return pool;
+}
+
+size_t Sampler_pool_update(Sampler_pool* pool, Target_list* list, char** errormsg)
+{
+  long long begin = monotime_ms();
+  if (!Target_list_read_tick(list, errormsg))
+    return 0;
+
+  // contiguous shards, the first shards are larger by one target
+  _Atomic size_t* cursors = (_Atomic size_t*) pool->__cursors;
+  size_t size = list->Count / pool->Workers_count, rest = list->Count % pool->Workers_count, offset = 0;
+  for (size_t i = 0; i < pool->Workers_count; ++i) {
+    atomic_store(&cursors[i], offset);
+    offset += size + (i < rest ? 1 : 0);
+    pool->__ends[i] = offset;
+  }
+  pool->__list = list;
+
+#ifdef __linux__
+  pthread_mutex_lock(&pool->__mutex);
+  pool->__pending = pool->Workers_count - 1;
+  pool->__generation++;
+  pthread_cond_broadcast(&pool->__start);
+  pthread_mutex_unlock(&pool->__mutex);
+#endif
+
+  run_worker(pool, 0); // the calling thread is the first worker
+
+#ifdef __linux__
+  pthread_mutex_lock(&pool->__mutex);
+  while (pool->__pending > 0)
+    pthread_cond_wait(&pool->__done, &pool->__mutex);
+  pthread_mutex_unlock(&pool->__mutex);
+#endif
+  pool->__list = NULL;
+
+  size_t alive = Target_list_finish_tick(list);
+  pool->Tick_ms = (double) (monotime_ms() - begin);
+  return alive;
+}
+
+void Sampler_pool_free(Sampler_pool* pool)
+{
+#ifdef __linux__
+  pthread_mutex_lock(&pool->__mutex);
+  pool->__stop = true;
+  pthread_cond_broadcast(&pool->__start);
+  pthread_mutex_unlock(&pool->__mutex);
+  for (size_t i = 1; i < pool->Workers_count; ++i)
+    pthread_join(pool->__threads[i], NULL);
+  free(pool->__threads);
+  pthread_cond_destroy(&pool->__done);
+  pthread_cond_destroy(&pool->__start);
+  pthread_mutex_destroy(&pool->__mutex);
+#endif
+  free(pool->__cursors);
+  free(pool->__ends);
+  free(pool->Workers);
+  free(pool);
+}
@@ -0,0 +1,79 @@
+#ifndef __SAMPLERPOOL_H
+#define __SAMPLERPOOL_H
+
+#include "targets.h"
+#include <stdbool.h>
+#include <stddef.h>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+#define SAMPLER_POOL_CHUNK 16 // number of targets claimed by a worker at once
+
+/**
+ * @brief Sampler_worker_stat
+ * Work of one worker in the last tick.
+ */
+typedef struct
+{
+  unsigned long long Targets_count; //! Targets updated by the worker
+  unsigned long long Stolen_count;  //! Targets stolen from shards of other workers
+} Sampler_worker_stat;
+
+/**
+ * @brief Sampler_pool
+ * Updates thousands of targets of the Target_list by the pool of workers. System-wide data of the tick (and files of
+ * targets, if the list has the reader) is read once, then targets are split into contiguous shards, one shard per
+ * worker. Every worker claims chunks of its own shard by the atomic cursor of the shard, and when its shard is
+ * finished, it steals remaining chunks from other shards, so slow reads of '/proc' in one shard do not stall the
+ * tick. The calling thread is the first worker, so the pool of N workers uses N cores. When the update returns, all
+ * workers are finished and the list is the snapshot of the tick.
+ * On other systems than Linux, all targets are updated by the calling thread.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  size_t Workers_count;         //! Number of workers including the calling thread
+  Sampler_worker_stat* Workers; //! Work of every worker in the last tick
+  double Tick_ms;               //! Wall time of the last update
+
+  // private fields
+  Target_list* __list;             // the list of the current tick
+  void* __cursors;                 // the next target of every shard (_Atomic size_t)
+  size_t* __ends;                  // the end of every shard
+#ifdef __linux__
+  pthread_t* __threads;            // threads of workers except the first one
+  pthread_mutex_t __mutex;         // protects the generation, the number of pending workers and the stop flag
+  pthread_cond_t __start;          // signaled, when the tick is started or the pool is stopped
+  pthread_cond_t __done;           // signaled, when the last worker is finished
+  unsigned long long __generation; // number of started ticks
+  size_t __pending;                // workers, which have not finished the tick
+  bool __stop;                     // workers must exit
+#endif
+} Sampler_pool;
+
+/**
+ * @brief Sampler_pool_init
+ * Starts the pool of workers.
+ * @param workers_count Number of workers including the calling thread, it is at least 1
+ * @return The pointer to the new pool
+ */
+DECLFUNC Sampler_pool* Sampler_pool_init(size_t workers_count) ATTR(warn_unused_result);
+/**
+ * @brief Sampler_pool_update
+ * Reads system-wide data of the new tick once, updates all alive targets of the list by workers and calculates their
+ * metrics in columns. If system-wide data cannot be read, stores the error message in the 'errormsg' parameter.
+ * @param pool The pointer to the pool
+ * @param list The pointer to the list
+ * @param errormsg The pointer to the error message
+ * @return Number of alive targets
+ */
+DECLFUNC size_t Sampler_pool_update(Sampler_pool* pool, Target_list* list, char** errormsg) ATTR(nonnull(1, 2));
+/**
+ * @brief Sampler_pool_free
+ * Stops workers and deletes the pool.
+ * @param pool The pointer to the pool
+ */
+DECLFUNC void Sampler_pool_free(Sampler_pool* pool) ATTR(nonnull(1));
+
+#endif // __SAMPLERPOOL_H
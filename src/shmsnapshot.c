@@ -0,0 +1,283 @@
+#include "shmsnapshot.h"
+#include "metrics.h"
+#include "sketch.h"
+#include "ioutils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifdef __linux__
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+_Static_assert(METRIC_COUNT <= SHM_METRICS_MAX, "metrics of the catalogue do not fit the shared layout");
+
+#ifdef __linux__
+// returns the name with the leading '/'
+static char* object_name(const char* name)
+{
+  char* path = malloc(strlen(name) + 2);
+  ASSERT(path != NULL, "path (char*) != NULL; malloc(...) returns NULL.");
+  path[0] = '/';
+  strcpy(path + 1, name);
+  return path;
+}
+
+// begins the seqlock read section, returns false, if the publisher updates data
+static bool read_begin(const Shm_layout* layout, uint64_t* sequence)
+{
+  *sequence = atomic_load_explicit(&((Shm_layout*) layout)->Sequence, memory_order_acquire);
+  return (*sequence & 1) == 0;
+}
+
+// ends the seqlock read section, returns false, if data has changed during the copy
+static bool read_end(const Shm_layout* layout, uint64_t sequence)
+{
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit(&((Shm_layout*) layout)->Sequence, memory_order_relaxed) == sequence;
+}
+#endif
+
+Shm_publisher* Shm_publisher_open(
+    const char* name, const char* process_name, int pid, size_t history_capacity, char** errormsg)
+{
+#ifdef __linux__
+  char* path = object_name(name);
+  size_t size = sizeof(Shm_layout) + history_capacity * sizeof(Shm_point);
+  shm_unlink(path); // readers of the previous object keep their mappings
+  int fd = shm_open(path, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+  if (fd < 0 || ftruncate(fd, (off_t) size) != 0) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Cannot create the shared memory '", path, "': ", strerror(errno)));
+    if (fd >= 0) {
+      close(fd);
+      shm_unlink(path);
+    }
+    free(path);
+    return NULL;
+  }
+  Shm_layout* layout = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (layout == MAP_FAILED) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Cannot map the shared memory '", path, "': ", strerror(errno)));
+    shm_unlink(path);
+    free(path);
+    return NULL;
+  }
+
+  // the object is filled with zeros, the magic is written last, so readers do not see the partial header
+  layout->Version = SHM_SNAPSHOT_VERSION;
+  layout->Size = size;
+  layout->Metrics_count = METRIC_COUNT;
+  layout->History_capacity = (uint32_t) history_capacity;
+  layout->Pid = pid;
+  snprintf(layout->Process_name, sizeof(layout->Process_name), "%s", process_name);
+  for (int id = 0; id < METRIC_COUNT; ++id) {
+    const Metric_info* info = Metric_get_info((Metric_id) id);
+    snprintf(layout->Metric_names[id], sizeof(layout->Metric_names[id]), "%s", info->Name);
+    layout->Metric_types[id] = (uint8_t) info->Type;
+  }
+  atomic_thread_fence(memory_order_release);
+  layout->Magic = SHM_SNAPSHOT_MAGIC;
+
+  Shm_publisher* publisher = malloc(sizeof(Shm_publisher));
+  ASSERT(publisher != NULL, "publisher (Shm_publisher*) != NULL; malloc(...) returns NULL.");
+  publisher->Layout = layout;
+  publisher->__name = path;
+  publisher->__samples = 0;
+  return publisher;
+#else
+  UNUSED(name);
+  UNUSED(process_name);
+  UNUSED(pid);
+  UNUSED(history_capacity);
+  strconcat(errormsg, 1, SAFE_PASS_VARGS("The shared memory snapshot is supported only on Linux."));
+  return NULL;
+#endif
+}
+
+#ifdef __linux__
+// copies raw points appended to the history since the previous publication into the ring, the first publication
+// copies the last points of the history, the reset of the history clears the ring
+static void copy_history(Shm_publisher* publisher, const Timeseries* history)
+{
+  Shm_layout* layout = publisher->Layout;
+  size_t size = Timeseries_size(history, TIMESERIES_RAW), count = MIN(size, (size_t) layout->History_capacity);
+  unsigned long long samples = history->Samples_count;
+  if (samples < publisher->__samples)
+    layout->History_count = 0;
+  else if (samples - publisher->__samples < count)
+    count = (size_t) (samples - publisher->__samples);
+  publisher->__samples = samples;
+
+  for (size_t age = count; age-- > 0;) {
+    Shm_point* point = &layout->History[layout->History_count % layout->History_capacity];
+    Timeseries_point value = {0, 0.0, 0.0, 0.0, 0};
+    for (int metric = 0; metric < METRIC_COUNT; ++metric)
+      point->Values[metric] = Timeseries_get(history, (size_t) metric, TIMESERIES_RAW, age, &value) ? value.Avg : 0.0;
+    point->Time_ms = value.Time_ms + history->Realtime_offset_ms;
+    layout->History_count++;
+  }
+}
+#endif
+
+void Shm_publisher_publish(Shm_publisher* publisher, const Process_stat* stat, long long time_ms)
+{
+#ifdef __linux__
+  Shm_layout* layout = publisher->Layout;
+  // the sample is prepared before the write section, so readers retry only during the copy
+  Shm_sample sample;
+  memset(&sample, 0, sizeof(sample));
+  sample.Time_ms = time_ms;
+  sample.Samples_count = layout->Sample.Samples_count + 1;
+  Metric_values(stat, sample.Values);
+  sample.Peaks[0] = stat->Cpu_peak_usage;
+  sample.Peaks[1] = stat->Memory_peak_usage;
+  sample.Peaks[2] = stat->Disk_read_mb_peak_usage;
+  sample.Peaks[3] = stat->Disk_write_mb_peak_usage;
+  const Sketch* sketches[SHM_PEAKS_COUNT] = {
+      stat->Cpu_sketch, stat->Memory_sketch, stat->Disk_read_sketch, stat->Disk_write_sketch};
+  for (int i = 0; i < SHM_PEAKS_COUNT; ++i) {
+    if (!sketches[i])
+      continue;
+    Sketch_summary summary;
+    Sketch_summarize(&sketches[i]->Window, &summary);
+    sample.Percentiles[i][0] = summary.P50;
+    sample.Percentiles[i][1] = summary.P95;
+    sample.Percentiles[i][2] = summary.P99;
+    sample.Percentiles[i][3] = summary.Max;
+  }
+
+  uint64_t sequence = atomic_load_explicit(&layout->Sequence, memory_order_relaxed);
+  atomic_store_explicit(&layout->Sequence, sequence + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  layout->Sample = sample;
+  if (layout->History_capacity && stat->History)
+    copy_history(publisher, stat->History);
+  else if (layout->History_capacity) {
+    Shm_point* point = &layout->History[layout->History_count % layout->History_capacity];
+    point->Time_ms = time_ms;
+    memcpy(point->Values, sample.Values, sizeof(point->Values));
+    layout->History_count++;
+  }
+
+  atomic_store_explicit(&layout->Sequence, sequence + 2, memory_order_release);
+#else
+  UNUSED(publisher);
+  UNUSED(stat);
+  UNUSED(time_ms);
+#endif
+}
+
+void Shm_publisher_close(Shm_publisher* publisher)
+{
+#ifdef __linux__
+  munmap(publisher->Layout, (size_t) publisher->Layout->Size);
+  shm_unlink(publisher->__name);
+#endif
+  free(publisher->__name);
+  free(publisher);
+}
+
+Shm_reader* Shm_reader_open(const char* name, char** errormsg)
+{
+#ifdef __linux__
+  char* path = object_name(name);
+  int fd = shm_open(path, O_RDONLY | O_CLOEXEC, 0);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Cannot open the shared memory '", path, "': ", strerror(errno)));
+    if (fd >= 0)
+      close(fd);
+    free(path);
+    return NULL;
+  }
+
+  const Shm_layout* layout = NULL;
+  if ((size_t) st.st_size >= sizeof(Shm_layout))
+    layout = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (layout == MAP_FAILED || layout == NULL || layout->Magic != SHM_SNAPSHOT_MAGIC ||
+      layout->Version != SHM_SNAPSHOT_VERSION || layout->Size != (uint64_t) st.st_size) {
+    strconcat(errormsg, 3, SAFE_PASS_VARGS("The shared memory '", path, "' is not a snapshot of this version."));
+    if (layout != MAP_FAILED && layout != NULL)
+      munmap((void*) layout, (size_t) st.st_size);
+    free(path);
+    return NULL;
+  }
+  free(path);
+
+  Shm_reader* reader = malloc(sizeof(Shm_reader));
+  ASSERT(reader != NULL, "reader (Shm_reader*) != NULL; malloc(...) returns NULL.");
+  reader->Layout = layout;
+  return reader;
+#else
+  UNUSED(name);
+  strconcat(errormsg, 1, SAFE_PASS_VARGS("The shared memory snapshot is supported only on Linux."));
+  return NULL;
+#endif
+}
+
+int Shm_reader_metric(const Shm_reader* reader, const char* name)
+{
+  for (uint32_t i = 0; i < reader->Layout->Metrics_count && i < SHM_METRICS_MAX; ++i) {
+    if (strncmp(reader->Layout->Metric_names[i], name, SHM_METRIC_NAME_SIZE) == 0)
+      return (int) i;
+  }
+  return -1;
+}
+
+bool Shm_reader_read(const Shm_reader* reader, Shm_sample* sample)
+{
+#ifdef __linux__
+  for (int attempt = 0; attempt < SHM_READ_ATTEMPTS; ++attempt) {
+    uint64_t sequence;
+    if (!read_begin(reader->Layout, &sequence))
+      continue;
+    *sample = reader->Layout->Sample;
+    if (read_end(reader->Layout, sequence))
+      return true;
+  }
+#else
+  UNUSED(reader);
+  UNUSED(sample);
+#endif
+  return false;
+}
+
+size_t Shm_reader_history(const Shm_reader* reader, Shm_point* points, size_t count)
+{
+#ifdef __linux__
+  const Shm_layout* layout = reader->Layout;
+  size_t capacity = layout->History_capacity;
+  for (int attempt = 0; attempt < SHM_READ_ATTEMPTS; ++attempt) {
+    uint64_t sequence;
+    if (!read_begin(layout, &sequence))
+      continue;
+    size_t written = (size_t) layout->History_count, copied = written < capacity ? written : capacity;
+    if (copied > count)
+      copied = count;
+    for (size_t i = 0; i < copied; ++i)
+      points[i] = layout->History[(written - copied + i) % capacity];
+    if (read_end(layout, sequence))
+      return copied;
+  }
+#else
+  UNUSED(reader);
+  UNUSED(points);
+  UNUSED(count);
+#endif
+  return 0;
+}
+
+void Shm_reader_close(Shm_reader* reader)
+{
+#ifdef __linux__
+  munmap((void*) reader->Layout, (size_t) reader->Layout->Size);
+#endif
+  free(reader);
+}
@@ -0,0 +1,162 @@
+#include "sketch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// index of the bucket for the value: the bucket 0 is for zeros, others are powers of two split into sub-buckets
+static int bucket_index(double value)
+{
+  if (!(value >= ldexp(1.0, SKETCH_MIN_EXPONENT)))
+    return 0; // zeros, negative values and NaN
+
+  int exponent;
+  double mantissa = frexp(value, &exponent); // value = mantissa * 2^exponent, mantissa in [0.5, 1)
+  int power = exponent - 1;
+  if (power >= SKETCH_MAX_EXPONENT)
+    return SKETCH_BUCKETS_COUNT - 1;
+
+  int sub = (int) ((mantissa * 2 - 1) * SKETCH_SUB_BUCKETS);
+  return 1 + (power - SKETCH_MIN_EXPONENT) * SKETCH_SUB_BUCKETS + sub;
+}
+
+// middle value of the bucket
+static double bucket_value(int index)
+{
+  if (index == 0)
+    return 0.0;
+
+  int power = SKETCH_MIN_EXPONENT + (index - 1) / SKETCH_SUB_BUCKETS, sub = (index - 1) % SKETCH_SUB_BUCKETS;
+  return ldexp(1.0 + (sub + 0.5) / SKETCH_SUB_BUCKETS, power);
+}
+
+// value of the quantile in the bucket, it is not greater than the maximum value
+static double histogram_value(const Sketch_histogram *hist, int index)
+{
+  if (index == SKETCH_BUCKETS_COUNT - 1)
+    return hist->Max; // values out of range
+  double value = bucket_value(index);
+  return value < hist->Max ? value : hist->Max;
+}
+
+static void histogram_add(Sketch_histogram *hist, int index, double value)
+{
+  hist->Buckets[index]++;
+  hist->Count++;
+  if (value > hist->Max)
+    hist->Max = value;
+}
+
+static void histogram_clear(Sketch_histogram *hist)
+{
+  memset(hist, 0, sizeof(Sketch_histogram));
+}
+
+// moves the window to the passed time, the time must not decrease
+static void move_window(Sketch *sketch, long long time_ms)
+{
+  long long slot_ms = sketch->Window_ms / SKETCH_WINDOW_SLOTS;
+  if (slot_ms <= 0)
+    slot_ms = 1;
+
+  if (sketch->__slot_end_ms < 0 || time_ms - sketch->__slot_end_ms >= sketch->Window_ms) {
+    // the first value or all slots are outdated
+    histogram_clear(&sketch->Window);
+    for (int slot = 0; slot < SKETCH_WINDOW_SLOTS; ++slot)
+      histogram_clear(&sketch->__slots[slot]);
+    sketch->__slot = 0;
+    sketch->__slot_end_ms = time_ms + slot_ms;
+    return;
+  }
+
+  while (time_ms >= sketch->__slot_end_ms) {
+    sketch->__slot = (sketch->__slot + 1) % SKETCH_WINDOW_SLOTS;
+    Sketch_histogram *oldest = &sketch->__slots[sketch->__slot];
+    if (oldest->Count > 0) {
+      for (int i = 0; i < SKETCH_BUCKETS_COUNT; ++i)
+        sketch->Window.Buckets[i] -= oldest->Buckets[i];
+      sketch->Window.Count -= oldest->Count;
+      histogram_clear(oldest);
+    }
+    sketch->__slot_end_ms += slot_ms;
+  }
+
+  sketch->Window.Max = 0.0;
+  for (int slot = 0; slot < SKETCH_WINDOW_SLOTS; ++slot) {
+    if (sketch->__slots[slot].Max > sketch->Window.Max)
+      sketch->Window.Max = sketch->__slots[slot].Max;
+  }
+}
+
+Sketch *Sketch_init(long long window_ms)
+{
+  Sketch *sketch = malloc(sizeof(Sketch));
+  ASSERT(sketch != NULL, "sketch (Sketch*) != NULL; malloc(...) returns NULL.");
+  memset(sketch, 0, sizeof(Sketch));
+  sketch->Window_ms = window_ms;
+  sketch->__slot_end_ms = -1;
+  return sketch;
+}
+
+void Sketch_add(Sketch *sketch, long long time_ms, double value)
+{
+  if (sketch->__slot_end_ms < 0 || time_ms >= sketch->__slot_end_ms)
+    move_window(sketch, time_ms);
+
+  if (!(value > 0.0))
+    value = 0.0;
+  int index = bucket_index(value);
+  histogram_add(&sketch->Lifetime, index, value);
+  histogram_add(&sketch->Window, index, value);
+  histogram_add(&sketch->__slots[sketch->__slot], index, value);
+}
+
+double Sketch_quantile(const Sketch_histogram *hist, double q)
+{
+  if (hist->Count == 0)
+    return 0.0;
+
+  unsigned long long rank = (unsigned long long) ceil(q * (double) hist->Count), count = 0;
+  if (rank == 0)
+    rank = 1;
+  for (int i = 0; i < SKETCH_BUCKETS_COUNT; ++i) {
+    count += hist->Buckets[i];
+    if (count >= rank)
+      return histogram_value(hist, i);
+  }
+  return hist->Max;
+}
+
+void Sketch_summarize(const Sketch_histogram *hist, Sketch_summary *summary)
+{
+  static const double QUANTILES[] = {0.5, 0.95, 0.99};
+  double values[] = {0.0, 0.0, 0.0};
+  summary->Count = hist->Count;
+  summary->Max = hist->Max;
+
+  if (hist->Count > 0) {
+    int q = 0;
+    unsigned long long count = 0;
+    for (int i = 0; i < SKETCH_BUCKETS_COUNT && q < 3; ++i) {
+      count += hist->Buckets[i];
+      while (q < 3 && (double) count >= ceil(QUANTILES[q] * (double) hist->Count))
+        values[q++] = histogram_value(hist, i);
+    }
+  }
+  summary->P50 = values[0];
+  summary->P95 = values[1];
+  summary->P99 = values[2];
+}
+
+void Sketch_reset(Sketch *sketch)
+{
+  long long window_ms = sketch->Window_ms;
+  memset(sketch, 0, sizeof(Sketch));
+  sketch->Window_ms = window_ms;
+  sketch->__slot_end_ms = -1;
+}
+
+void Sketch_free(Sketch *sketch)
+{
+  free(sketch);
+}
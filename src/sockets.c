@@ -0,0 +1,384 @@
+#include "sockets.h"
+
+#include "ioutils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <linux/limits.h>
+#include <arpa/inet.h>
+#endif
+
+#define SOCKETS_BUFFER_SIZE 65536
+#define PROC_PATH_SIZE 64
+#define INITIAL_TABLE_SIZE 64
+#define EMPTY_SLOT -1
+
+static const char* SOCKET_TARGET_PREFIX = "socket:[";
+
+static const char* PROTO_FILENAMES[SOCKET_PROTO_COUNT] = {"tcp", "tcp6", "udp", "udp6", "unix"};
+static const char* PROTO_NAMES[SOCKET_PROTO_COUNT] = {"TCP", "TCP6", "UDP", "UDP6", "UNIX"};
+// https://elixir.bootlin.com/linux/latest/source/include/net/tcp_states.h
+static const char* TCP_STATE_NAMES[SOCKET_TCP_STATES_COUNT] = {"UNKNOWN",
+                                                               "ESTABLISHED",
+                                                               "SYN_SENT",
+                                                               "SYN_RECV",
+                                                               "FIN_WAIT1",
+                                                               "FIN_WAIT2",
+                                                               "TIME_WAIT",
+                                                               "CLOSE",
+                                                               "CLOSE_WAIT",
+                                                               "LAST_ACK",
+                                                               "LISTEN",
+                                                               "CLOSING"};
+
+static size_t inode_hash(unsigned long inode, size_t table_size)
+{
+  unsigned long long h = (unsigned long long) inode * 11400714819323198485ull; // fibonacci hashing
+  return (size_t) (h >> 32) & (table_size - 1);
+}
+
+static void table_rebuild(Socket_list* list, size_t table_size)
+{
+  if (table_size != list->__table_size) {
+    long* table = realloc(list->__table, table_size * sizeof(long));
+    ASSERT(table != NULL, "table (long*) != NULL; realloc(...) returns NULL.");
+    list->__table = table;
+    list->__table_size = table_size;
+  }
+  for (size_t i = 0; i < table_size; ++i)
+    list->__table[i] = EMPTY_SLOT;
+
+  for (size_t i = 0; i < list->Count; ++i) {
+    size_t slot = inode_hash(list->Entries[i].Inode, table_size);
+    while (list->__table[slot] != EMPTY_SLOT)
+      slot = (slot + 1) & (table_size - 1);
+    list->__table[slot] = (long) i;
+  }
+}
+
+static Socket_entry* table_find(const Socket_list* list, unsigned long inode)
+{
+  size_t slot = inode_hash(inode, list->__table_size);
+  while (list->__table[slot] != EMPTY_SLOT) {
+    Socket_entry* entry = &list->Entries[list->__table[slot]];
+    if (entry->Inode == inode)
+      return entry;
+    slot = (slot + 1) & (list->__table_size - 1);
+  }
+  return NULL;
+}
+
+static void table_insert(Socket_list* list, unsigned long inode)
+{
+  if (list->Count + 1 > list->__capacity) {
+    size_t capacity = list->__capacity ? list->__capacity * 2 : INITIAL_TABLE_SIZE / 2;
+    Socket_entry* entries = realloc(list->Entries, capacity * sizeof(Socket_entry));
+    ASSERT(entries != NULL, "entries (Socket_entry*) != NULL; realloc(...) returns NULL.");
+    list->Entries = entries;
+    list->__capacity = capacity;
+  }
+
+  Socket_entry* entry = &list->Entries[list->Count++];
+  memset(entry, 0, sizeof(Socket_entry));
+  entry->Inode = inode;
+  entry->Proto = SOCKET_PROTO_COUNT; // unknown, until found in '/proc/[pid]/net'
+  entry->__generation = list->__generation;
+
+  // load factor <= 0.5
+  if (list->Count * 2 > list->__table_size)
+    table_rebuild(list, list->__table_size * 2);
+  else {
+    size_t slot = inode_hash(inode, list->__table_size);
+    while (list->__table[slot] != EMPTY_SLOT)
+      slot = (slot + 1) & (list->__table_size - 1);
+    list->__table[slot] = (long) (list->Count - 1);
+  }
+}
+
+static void socket_seen(Socket_list* list, unsigned long inode)
+{
+  Socket_entry* entry = table_find(list, inode);
+  if (entry)
+    entry->__generation = list->__generation;
+  else
+    table_insert(list, inode);
+}
+
+static bool parse_socket_target(const char* target, unsigned long* inode)
+{
+  size_t prefix_len = strlen(SOCKET_TARGET_PREFIX);
+  if (strncmp(target, SOCKET_TARGET_PREFIX, prefix_len) != 0)
+    return false;
+  *inode = strtoul(target + prefix_len, NULL, 10);
+  return *inode != 0;
+}
+
+// skips the passed number of fields separated by whitespaces
+static const char* skip_fields(const char* p, int count)
+{
+  while (*p == ' ')
+    ++p;
+  while (count-- > 0) {
+    while (*p && *p != ' ')
+      ++p;
+    while (*p == ' ')
+      ++p;
+  }
+  return p;
+}
+
+#ifdef __linux__
+static void format_address(const char* hex, bool ipv6, char* dst, size_t size)
+{
+  const char* colon = strchr(hex, ':');
+  unsigned long port = colon ? strtoul(colon + 1, NULL, 16) : 0;
+  char ip[INET6_ADDRSTRLEN] = "?";
+  if (!ipv6) {
+    struct in_addr addr;
+    addr.s_addr = (uint32_t) strtoul(hex, NULL, 16); // the kernel prints the address in the host order
+    inet_ntop(AF_INET, &addr, ip, sizeof(ip));
+    snprintf(dst, size, "%s:%lu", ip, port);
+  } else {
+    struct in6_addr addr;
+    for (int i = 0; i < 4; ++i) {
+      char word[9];
+      memcpy(word, hex + i * 8, 8);
+      word[8] = '\0';
+      uint32_t w = (uint32_t) strtoul(word, NULL, 16);
+      memcpy(addr.s6_addr + i * 4, &w, sizeof(w));
+    }
+    inet_ntop(AF_INET6, &addr, ip, sizeof(ip));
+    snprintf(dst, size, "[%s]:%lu", ip, port);
+  }
+}
+
+// parses a line of '/proc/[pid]/net/{tcp,tcp6,udp,udp6}' or '/proc/[pid]/net/unix', returns true if the socket of
+// this process was found
+static bool parse_line(Socket_list* list, Socket_proto proto, const char* line)
+{
+  // sl local_address rem_address st tx_queue:rx_queue tr:tm->when retrnsmt uid timeout inode
+  // Num RefCount Protocol Flags Type St Inode Path
+  const char* inodestr = skip_fields(line, proto == SOCKET_UNIX ? 6 : 9);
+  unsigned long inode = strtoul(inodestr, NULL, 10);
+  if (inode == 0)
+    return false;
+
+  Socket_entry* entry = table_find(list, inode);
+  if (!entry || entry->__found)
+    return false;
+
+  if (proto == SOCKET_UNIX) {
+    int state = 0;
+    if (sscanf(line, "%*s %*x %*x %*x %*x %x", &state) != 1)
+      return false;
+    entry->State = state;
+    entry->Recv_queue = 0;
+    entry->Send_queue = 0;
+    const char* path = skip_fields(inodestr, 1);
+    snprintf(entry->Local, sizeof(entry->Local), "%s", *path ? path : "-");
+    entry->Remote[0] = '\0';
+  } else {
+    char local[SOCKET_ADDRESS_SIZE], remote[SOCKET_ADDRESS_SIZE];
+    int state = 0;
+    if (sscanf(line,
+               "%*s %71[0-9A-Fa-f:] %71[0-9A-Fa-f:] %x %lx:%lx",
+               local,
+               remote,
+               &state,
+               &entry->Send_queue,
+               &entry->Recv_queue) != 5)
+      return false;
+    entry->State = state;
+    bool ipv6 = proto == SOCKET_TCP6 || proto == SOCKET_UDP6;
+    format_address(local, ipv6, entry->Local, sizeof(entry->Local));
+    format_address(remote, ipv6, entry->Remote, sizeof(entry->Remote));
+  }
+  entry->Proto = proto;
+  entry->__found = true;
+  return true;
+}
+
+struct __Proto_reader
+{
+  Socket_list* List;
+  Socket_proto Proto;
+  size_t Found;
+};
+
+static bool proto_line_handler(char* line, void* arg)
+{
+  struct __Proto_reader* reader = (struct __Proto_reader*) arg;
+  if (parse_line(reader->List, reader->Proto, line))
+    reader->Found++;
+  return reader->Found < reader->List->Count; // stop reading, when all sockets are found
+}
+
+// reads the file line by line using the buffer of the list, stops reading when all sockets are found
+static bool read_proto_file(Socket_list* list, int pid, Socket_proto proto, size_t* found, char** errormsg)
+{
+  char path[PROC_PATH_SIZE];
+  snprintf(path, sizeof(path), "/proc/%d/net/%s", pid, PROTO_FILENAMES[proto]);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    if (errno == ENOENT) // protocol is not supported (for example IPv6 is disabled)
+      return true;
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open file '", path, "': ", strerror(errno)));
+    return false;
+  }
+
+  struct __Proto_reader reader = {list, proto, *found};
+  bool success = fdreadlines(fd, list->__buf, SOCKETS_BUFFER_SIZE, proto_line_handler, &reader) != -1;
+  if (!success)
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to read file '", path, "': ", strerror(errno)));
+  close(fd);
+  *found = reader.Found;
+  return success;
+}
+#endif
+
+Socket_list* Socket_list_init()
+{
+  Socket_list* list = malloc(sizeof(Socket_list));
+  ASSERT(list != NULL, "list (Socket_list*) != NULL; malloc(...) returns NULL.");
+  list->Entries = NULL;
+  list->Count = 0;
+  memset(list->Proto_counts, 0, sizeof(list->Proto_counts));
+  memset(list->Tcp_state_counts, 0, sizeof(list->Tcp_state_counts));
+  list->Recv_queue_total = 0;
+  list->Send_queue_total = 0;
+
+  list->__capacity = 0;
+  list->__table = NULL;
+  list->__table_size = 0;
+  table_rebuild(list, INITIAL_TABLE_SIZE);
+  list->__generation = 0;
+  list->__buf = malloc(SOCKETS_BUFFER_SIZE);
+  ASSERT(list->__buf != NULL, "list->__buf (char*) != NULL; malloc(...) returns NULL.");
+#ifdef __linux__
+  list->__dir = Dir_reader_init();
+#else
+  list->__dir = NULL;
+#endif
+  return list;
+}
+
+const Socket_entry* Socket_list_find(const Socket_list* list, unsigned long inode)
+{
+  return table_find(list, inode);
+}
+
+bool Socket_list_update(Socket_list* list, int pid, const Fd_list* fds, char** errormsg)
+{
+#ifdef __linux__
+  list->__generation++;
+
+  // mark sockets of the process
+  if (fds) {
+    for (size_t i = 0; i < fds->Count; ++i) {
+      unsigned long inode;
+      if (parse_socket_target(fds->Entries[i].Target, &inode))
+        socket_seen(list, inode);
+    }
+  } else {
+    char fdpath[PROC_PATH_SIZE];
+    snprintf(fdpath, sizeof(fdpath), "/proc/%d/fd", pid);
+    Dir_reader* reader = (Dir_reader*) list->__dir;
+    if (!Dir_reader_open(reader, fdpath)) {
+      strconcat(errormsg, 4, SAFE_PASS_VARGS("Unable to open directory '", fdpath, "': ", strerror(errno)));
+      return false;
+    }
+    const char* name;
+    while ((name = Dir_reader_next(reader)) != NULL) {
+      char target[PATH_MAX];
+      ssize_t target_len = readlinkat(reader->Fd, name, target, sizeof(target) - 1);
+      if (target_len <= 0)
+        continue;
+      target[target_len] = '\0';
+
+      unsigned long inode;
+      if (parse_socket_target(target, &inode))
+        socket_seen(list, inode);
+    }
+    Dir_reader_close(reader);
+  }
+
+  // remove closed sockets
+  {
+    size_t count = 0;
+    for (size_t i = 0; i < list->Count; ++i) {
+      if (list->Entries[i].__generation == list->__generation)
+        list->Entries[count++] = list->Entries[i];
+    }
+    if (count != list->Count) {
+      list->Count = count;
+      table_rebuild(list, list->__table_size);
+    }
+  }
+
+  memset(list->Proto_counts, 0, sizeof(list->Proto_counts));
+  memset(list->Tcp_state_counts, 0, sizeof(list->Tcp_state_counts));
+  list->Recv_queue_total = 0;
+  list->Send_queue_total = 0;
+  for (size_t i = 0; i < list->Count; ++i)
+    list->Entries[i].__found = false;
+
+  size_t found = 0;
+  for (int proto = 0; proto < SOCKET_PROTO_COUNT && found < list->Count; ++proto) {
+    if (!read_proto_file(list, pid, (Socket_proto) proto, &found, errormsg))
+      return false;
+  }
+
+  for (size_t i = 0; i < list->Count; ++i) {
+    Socket_entry* entry = &list->Entries[i];
+    if (!entry->__found) {
+      entry->Proto = SOCKET_PROTO_COUNT; // netlink, packet and other sockets
+      continue;
+    }
+    list->Proto_counts[entry->Proto]++;
+    if ((entry->Proto == SOCKET_TCP || entry->Proto == SOCKET_TCP6) && entry->State > 0 &&
+        entry->State < SOCKET_TCP_STATES_COUNT)
+      list->Tcp_state_counts[entry->State]++;
+    list->Recv_queue_total += entry->Recv_queue;
+    list->Send_queue_total += entry->Send_queue;
+  }
+  return true;
+#elif _WIN32
+  UNUSED(list);
+  UNUSED(pid);
+  UNUSED(fds);
+  strconcat(errormsg, 1, SAFE_PASS_VARGS("The list of sockets is not supported on Windows."));
+  return false;
+#endif
+}
+
+const char* Socket_state_name(int state)
+{
+  if (state <= 0 || state >= SOCKET_TCP_STATES_COUNT)
+    return TCP_STATE_NAMES[0];
+  return TCP_STATE_NAMES[state];
+}
+
+const char* Socket_proto_name(Socket_proto proto)
+{
+  if (proto < 0 || proto >= SOCKET_PROTO_COUNT)
+    return "OTHER";
+  return PROTO_NAMES[proto];
+}
+
+void Socket_list_free(Socket_list* list)
+{
+  free(list->Entries);
+  free(list->__table);
+  free(list->__buf);
+#ifdef __linux__
+  Dir_reader_free((Dir_reader*) list->__dir);
+#endif
+
+  free(list);
+}
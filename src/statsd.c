@@ -0,0 +1,317 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // sendmmsg
+#endif
+#include "statsd.h"
+#include "ioutils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+static const char* DEFAULT_PORT = "8125";
+static const char* PERCENTILE_NAMES[3] = {"p50", "p95", "p99"};
+static const Metric_id PEAK_METRICS[STATSD_PEAKS_COUNT] = {
+    METRIC_CPU_USAGE, METRIC_MEMORY_USAGE, METRIC_DISK_READ_MB_USAGE, METRIC_DISK_WRITE_MB_USAGE};
+
+struct __Statsd_thread
+{
+#ifdef __linux__
+  pthread_t Thrd;
+  pthread_mutex_t Mut; // protects the published snapshot and the stop flag
+  pthread_cond_t Cv;   // signals stopping
+#endif
+  bool Started;
+  bool Running;
+};
+
+// appends the part of the name, characters, which are not allowed by statsd, are replaced by '_'
+static void append_name(char* dst, size_t size, const char* name)
+{
+  size_t length = strlen(dst);
+  for (; *name && length + 1 < size; ++name)
+    dst[length++] = isalnum((unsigned char) *name) || *name == '-' || *name == '.' ? *name : '_';
+  dst[length] = '\0';
+}
+
+void Statsd_publish(Statsd_exporter* exporter, const Process_stat* stat)
+{
+  Statsd_snapshot snapshot;
+  Metric_values(stat, snapshot.Values);
+  snapshot.Peaks[0] = stat->Cpu_peak_usage;
+  snapshot.Peaks[1] = stat->Memory_peak_usage;
+  snapshot.Peaks[2] = stat->Disk_read_mb_peak_usage;
+  snapshot.Peaks[3] = stat->Disk_write_mb_peak_usage;
+  const Sketch* sketches[STATSD_PEAKS_COUNT] = {
+      stat->Cpu_sketch, stat->Memory_sketch, stat->Disk_read_sketch, stat->Disk_write_sketch};
+  for (int i = 0; i < STATSD_PEAKS_COUNT; ++i) {
+    Sketch_summary summary = {0, 0.0, 0.0, 0.0, 0.0};
+    if (sketches[i])
+      Sketch_summarize(&sketches[i]->Window, &summary);
+    snapshot.Percentiles[i][0] = summary.P50;
+    snapshot.Percentiles[i][1] = summary.P95;
+    snapshot.Percentiles[i][2] = summary.P99;
+  }
+
+#ifdef __linux__
+  pthread_mutex_lock(&exporter->__thrd->Mut);
+#endif
+  snapshot.Samples_count = exporter->__published.Samples_count + 1;
+  exporter->__published = snapshot;
+#ifdef __linux__
+  pthread_mutex_unlock(&exporter->__thrd->Mut);
+#endif
+}
+
+#ifdef __linux__
+// packs lines into datagrams up to the MTU
+typedef struct
+{
+  Statsd_exporter* exporter;
+  int count;     // number of datagrams
+  size_t length; // length of the last datagram
+} packer;
+
+// returns the index of the datagram with the line or -1, if the line is dropped
+static int pack_line(packer* p, const char* line, size_t length)
+{
+  Statsd_exporter* exporter = p->exporter;
+  struct iovec* iovecs = (struct iovec*) exporter->__iovecs;
+  if (length > exporter->__mtu)
+    return -1; // the truncated line is not valid for the agent
+  if (p->count == 0 || p->length + 1 + length > exporter->__mtu) {
+    if (p->count == STATSD_MAX_DATAGRAMS)
+      return -1;
+    iovecs[p->count].iov_base = exporter->__buffer + (size_t) p->count * exporter->__mtu;
+    p->count++;
+    p->length = 0;
+  } else
+    ((char*) iovecs[p->count - 1].iov_base)[p->length++] = '\n';
+
+  memcpy((char*) iovecs[p->count - 1].iov_base + p->length, line, length);
+  p->length += length;
+  iovecs[p->count - 1].iov_len = p->length;
+  return p->count - 1;
+}
+
+static int pack_value(packer* p, const char* name, const char* suffix, double value, const char* type)
+{
+  char line[STATSD_MAX_LINE_SIZE];
+  int length = snprintf(line, sizeof(line), "%s.%s%s:%.15g|%s", p->exporter->__prefix, name, suffix, value, type);
+  if (length <= 0 || (size_t) length >= sizeof(line))
+    return -1;
+  return pack_line(p, line, (size_t) length);
+}
+#endif
+
+int Statsd_flush(Statsd_exporter* exporter)
+{
+#ifdef __linux__
+  pthread_mutex_lock(&exporter->__thrd->Mut);
+  exporter->__flushed = exporter->__published;
+  pthread_mutex_unlock(&exporter->__thrd->Mut);
+
+  const Statsd_snapshot* snapshot = &exporter->__flushed;
+  if (snapshot->Samples_count == exporter->__last_samples_count)
+    return 0; // no new samples, or the snapshot is sent already
+  if (!exporter->__has_last) { // the first flush sets the base of counters
+    for (int id = 0; id < METRIC_COUNT; ++id)
+      exporter->__last_counters[id] = snapshot->Values[id];
+    exporter->__has_last = true;
+  }
+
+  packer p = {exporter, 0, 0};
+  int datagrams[METRIC_COUNT]; // datagrams of increments of counters, -1 if there is no increment
+  for (int id = 0; id < METRIC_COUNT; ++id) {
+    const Metric_info* info = Metric_get_info((Metric_id) id);
+    datagrams[id] = -1;
+    if (info->Type == METRIC_COUNTER) {
+      double delta = snapshot->Values[id] - exporter->__last_counters[id];
+      if (delta > 0.0 && (datagrams[id] = pack_value(&p, info->Name, "", delta, "c")) == -1)
+        datagrams[id] = STATSD_MAX_DATAGRAMS; // the dropped increment is carried into the next flush
+    } else
+      pack_value(&p, info->Name, "", snapshot->Values[id], "g");
+  }
+  for (int i = 0; i < STATSD_PEAKS_COUNT; ++i) {
+    const char* name = Metric_get_info(PEAK_METRICS[i])->Name;
+    pack_value(&p, name, ".peak", snapshot->Peaks[i], "g");
+    for (int q = 0; q < 3; ++q) {
+      char suffix[8];
+      snprintf(suffix, sizeof(suffix), ".%s", PERCENTILE_NAMES[q]);
+      pack_value(&p, name, suffix, snapshot->Percentiles[i][q], "g");
+    }
+  }
+
+  // one system call per flush
+  struct mmsghdr* messages = (struct mmsghdr*) exporter->__messages;
+  struct iovec* iovecs = (struct iovec*) exporter->__iovecs;
+  for (int i = 0; i < p.count; ++i) {
+    memset(&messages[i], 0, sizeof(struct mmsghdr));
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+  int sent = p.count > 0 ? sendmmsg(exporter->__fd, messages, (unsigned int) p.count, 0) : 0;
+  if (sent < 0)
+    return 0; // the agent is not available, the next flush sends the new snapshot with the same increments
+
+  // the base of counters moves only by increments, which are sent
+  for (int id = 0; id < METRIC_COUNT; ++id)
+    if (Metric_get_info((Metric_id) id)->Type == METRIC_COUNTER && datagrams[id] < sent)
+      exporter->__last_counters[id] = snapshot->Values[id];
+  exporter->__last_samples_count = snapshot->Samples_count;
+  exporter->Flushes_count++;
+  exporter->Datagrams_count += (unsigned long long) sent;
+  return sent;
+#else
+  UNUSED(exporter);
+  return 0;
+#endif
+}
+
+#ifdef __linux__
+static void* run_flushes(void* arg)
+{
+  Statsd_exporter* exporter = (Statsd_exporter*) arg;
+  struct __Statsd_thread* thrd = exporter->__thrd;
+  struct timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+  pthread_mutex_lock(&thrd->Mut);
+  while (thrd->Running) {
+    // deadlines are absolute, so flushes do not drift
+    deadline.tv_sec += exporter->__interval_ms / 1000;
+    deadline.tv_nsec += (exporter->__interval_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000;
+    }
+    while (thrd->Running && pthread_cond_timedwait(&thrd->Cv, &thrd->Mut, &deadline) != ETIMEDOUT)
+      ;
+    if (!thrd->Running)
+      break;
+
+    pthread_mutex_unlock(&thrd->Mut);
+    Statsd_flush(exporter);
+    pthread_mutex_lock(&thrd->Mut);
+  }
+  pthread_mutex_unlock(&thrd->Mut);
+  return NULL;
+}
+
+static int open_socket(const char* address, char** errormsg)
+{
+  char host[256];
+  const char* port = strrchr(address, ':');
+  if (port) {
+    snprintf(host, sizeof(host), "%.*s", (int) (port - address), address);
+    ++port;
+  } else {
+    snprintf(host, sizeof(host), "%s", address);
+    port = DEFAULT_PORT;
+  }
+
+  struct addrinfo hints, *result = NULL;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = AI_NUMERICSERV;
+  int rc = getaddrinfo(host, port, &hints, &result);
+  if (rc != 0) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Incorrect the address '", address, "': ", gai_strerror(rc)));
+    return -1;
+  }
+
+  // the connected socket does not require the address in every message
+  int fd = socket(result->ai_family, result->ai_socktype | SOCK_CLOEXEC, result->ai_protocol);
+  if (fd < 0 || connect(fd, result->ai_addr, result->ai_addrlen) != 0) {
+    strconcat(errormsg, 4, SAFE_PASS_VARGS("Cannot connect to '", address, "': ", strerror(errno)));
+    if (fd >= 0)
+      close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(result);
+  return fd;
+}
+#endif
+
+Statsd_exporter* Statsd_start(const char* address,
+                              const char* prefix,
+                              const char* process_name,
+                              size_t mtu,
+                              long int interval_ms,
+                              char** errormsg)
+{
+#ifdef __linux__
+  int fd = open_socket(address, errormsg);
+  if (fd < 0)
+    return NULL;
+
+  Statsd_exporter* exporter = malloc(sizeof(Statsd_exporter));
+  ASSERT(exporter != NULL, "exporter (Statsd_exporter*) != NULL; malloc(...) returns NULL.");
+  memset(exporter, 0, sizeof(Statsd_exporter));
+  exporter->__fd = fd;
+  exporter->__mtu = mtu;
+  exporter->__interval_ms = interval_ms;
+  snprintf(exporter->__prefix, sizeof(exporter->__prefix), "%s.", prefix);
+  append_name(exporter->__prefix, sizeof(exporter->__prefix), process_name);
+  exporter->__buffer = malloc(STATSD_MAX_DATAGRAMS * mtu);
+  ASSERT(exporter->__buffer != NULL, "exporter->__buffer (char*) != NULL; malloc(...) returns NULL.");
+  exporter->__messages = calloc(STATSD_MAX_DATAGRAMS, sizeof(struct mmsghdr));
+  ASSERT(exporter->__messages != NULL, "exporter->__messages (struct mmsghdr*) != NULL; calloc(...) returns NULL.");
+  exporter->__iovecs = calloc(STATSD_MAX_DATAGRAMS, sizeof(struct iovec));
+  ASSERT(exporter->__iovecs != NULL, "exporter->__iovecs (struct iovec*) != NULL; calloc(...) returns NULL.");
+
+  exporter->__thrd = malloc(sizeof(struct __Statsd_thread));
+  ASSERT(exporter->__thrd != NULL, "exporter->__thrd (struct __Statsd_thread*) != NULL; malloc(...) returns NULL.");
+  pthread_mutex_init(&exporter->__thrd->Mut, NULL);
+  pthread_condattr_t attrs;
+  pthread_condattr_init(&attrs);
+  pthread_condattr_setclock(&attrs, CLOCK_MONOTONIC);
+  pthread_cond_init(&exporter->__thrd->Cv, &attrs);
+  pthread_condattr_destroy(&attrs);
+  exporter->__thrd->Running = true;
+  exporter->__thrd->Started = interval_ms > 0;
+  if (exporter->__thrd->Started)
+    pthread_create(&exporter->__thrd->Thrd, NULL, run_flushes, exporter);
+  return exporter;
+#else
+  UNUSED(address);
+  UNUSED(prefix);
+  UNUSED(process_name);
+  UNUSED(mtu);
+  UNUSED(interval_ms);
+  strconcat(errormsg, 1, SAFE_PASS_VARGS("The statsd exporter is supported only on Linux."));
+  return NULL;
+#endif
+}
+
+void Statsd_stop(Statsd_exporter* exporter)
+{
+#ifdef __linux__
+  pthread_mutex_lock(&exporter->__thrd->Mut);
+  exporter->__thrd->Running = false;
+  pthread_cond_signal(&exporter->__thrd->Cv);
+  pthread_mutex_unlock(&exporter->__thrd->Mut);
+  if (exporter->__thrd->Started)
+    pthread_join(exporter->__thrd->Thrd, NULL);
+
+  Statsd_flush(exporter);
+  pthread_cond_destroy(&exporter->__thrd->Cv);
+  pthread_mutex_destroy(&exporter->__thrd->Mut);
+  close(exporter->__fd);
+#endif
+  free(exporter->__buffer);
+  free(exporter->__messages);
+  free(exporter->__iovecs);
+  free(exporter->__thrd);
+  free(exporter);
+}
@@ -0,0 +1,97 @@
+#ifndef __STATSD_H
+#define __STATSD_H
+
+#include "../include/process.h"
+#include "../include/metrics.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define STATSD_MAX_DATAGRAMS 64    // maximal number of datagrams in one flush
+#define STATSD_MAX_LINE_SIZE 512   // maximal size of one line, the MTU is not less than it
+#define STATSD_PEAKS_COUNT 4       // CPU, memory, disk read and disk write
+
+struct __Statsd_thread; // Forward declaration
+
+/**
+ * @brief Statsd_snapshot
+ * Values of metrics published by the sampler.
+ */
+typedef struct
+{
+  unsigned long long Samples_count;                     //! Number of published samples
+  double Values[METRIC_COUNT];                          //! Values of all metrics of the catalogue
+  double Peaks[STATSD_PEAKS_COUNT];                     //! Peaks of CPU, memory, disk read and disk write
+  double Percentiles[STATSD_PEAKS_COUNT][3];            //! p50, p95 and p99 of the windowed view
+} Statsd_snapshot;
+
+/**
+ * @brief Statsd_exporter
+ * Pushes the latest snapshot to the statsd agent over UDP on its own flush interval, independently of the sampling
+ * rate. Gauges are sent as '|g', counters as '|c' with the increment since the previous sent flush, so increments of a
+ * failed send are carried into the next flush. Lines are packed into datagrams up to the MTU, a line longer than the
+ * MTU is dropped, and all datagrams of one flush are sent by one 'sendmmsg' call. Buffers are allocated once.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  unsigned long long Flushes_count;   //! Number of flushes with the new sample
+  unsigned long long Datagrams_count; //! Number of sent datagrams
+
+  // private fields
+  int __fd;                                  // the UDP socket connected to the agent
+  size_t __mtu;                              // maximal size of the datagram
+  long int __interval_ms;                    // flush interval
+  char __prefix[256];                        // prefix of metric names
+  Statsd_snapshot __published;               // the latest published snapshot, protected by the mutex
+  Statsd_snapshot __flushed;                 // the copy used by the flush
+  unsigned long long __last_samples_count;   // number of samples on the previous flush
+  double __last_counters[METRIC_COUNT];      // values of counters on the previous sent flush
+  bool __has_last;                           // the previous flush exists
+  char* __buffer;                            // datagrams of one flush
+  void* __messages;                          // headers of datagrams (struct mmsghdr)
+  void* __iovecs;                            // buffers of datagrams (struct iovec)
+  struct __Statsd_thread* __thrd;            // the flush thread
+} Statsd_exporter;
+
+/**
+ * @brief Statsd_start
+ * Opens the UDP socket to the agent and starts the flush thread. The address is 'HOST' or 'HOST:PORT' (the default
+ * port is 8125). Names of metrics are '<prefix>.<process name>.<metric>'. If the interval is not positive, the thread
+ * is not started and samples are sent by Statsd_flush only. If any error occurs, stores the error message in the
+ * 'errormsg' parameter.
+ * @param address Address of the agent
+ * @param prefix Prefix of metric names
+ * @param process_name The process name
+ * @param mtu Maximal size of the datagram
+ * @param interval_ms Flush interval in milliseconds
+ * @param errormsg Pointer to char array.
+ * @return The pointer to the new structure or NULL
+ */
+DECLFUNC Statsd_exporter* Statsd_start(const char* address,
+                                       const char* prefix,
+                                       const char* process_name,
+                                       size_t mtu,
+                                       long int interval_ms,
+                                       char** errormsg) ATTR(nonnull(1, 2, 3));
+/**
+ * @brief Statsd_publish
+ * Copies metrics of the structure into the snapshot sent by the next flush.
+ * @param exporter The pointer to the exporter
+ * @param stat The pointer to the Process_stat structure
+ */
+DECLFUNC void Statsd_publish(Statsd_exporter* exporter, const Process_stat* stat) ATTR(nonnull(1, 2));
+/**
+ * @brief Statsd_flush
+ * Sends the latest snapshot, if it is new or its previous send has failed. Called by the flush thread.
+ * @param exporter The pointer to the exporter
+ * @return Number of sent datagrams
+ */
+DECLFUNC int Statsd_flush(Statsd_exporter* exporter) ATTR(nonnull(1));
+/**
+ * @brief Statsd_stop
+ * Stops the flush thread, sends the last snapshot, closes the socket and deletes the Statsd_exporter structure.
+ * @param exporter The pointer to the exporter
+ */
+DECLFUNC void Statsd_stop(Statsd_exporter* exporter) ATTR(nonnull(1));
+
+#endif // __STATSD_H
@@ -0,0 +1,222 @@
+#include "targets.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+static const char* SORT_NAMES[TARGET_SORT_COLUMNS_COUNT] = {
+    "PID", "NAME", "CPU, %", "MEMORY, MB", "READ, MB/s", "WRITE, MB/s"};
+
+Target_list* Target_list_init()
+{
+  Target_list* list = malloc(sizeof(Target_list));
+  ASSERT(list != NULL, "list (Target_list*) != NULL; malloc(...) returns NULL.");
+  list->Stats = NULL;
+  list->Alive = NULL;
+  list->Order = NULL;
+  list->Order_count = 0;
+  list->Count = 0;
+  list->Sort = TARGET_SORT_CPU;
+  list->Descending = true;
+  memset(&list->Tick, 0, sizeof(list->Tick));
+  list->Reader = NULL;
+  list->Columns = Target_columns_init();
+  list->__capacity = 0;
+  list->__sorted = NULL;
+  list->__sorted_count = 0;
+  list->__sorted_by = TARGET_SORT_PID;
+  list->__sorted_descending = false;
+  return list;
+}
+
+// returns true, if the target is PID
+static bool is_pid(const char* target)
+{
+  if (*target == '\0')
+    return false;
+  for (; *target != '\0'; ++target)
+    if (!isdigit((unsigned char) *target))
+      return false;
+  return true;
+}
+
+bool Target_find(Process_stat* stat, const char* target, char** errormsg)
+{
+  return is_pid(target) ? Process_stat_attach(stat, atoi(target), errormsg)
+                        : Process_stat_set_pid(stat, target, errormsg);
+}
+
+Process_stat* Target_list_add(Target_list* list, const char* target, char** errormsg)
+{
+  Process_stat* stat = Process_stat_init();
+  if (!Target_find(stat, target, errormsg)) {
+    Process_stat_free(stat);
+    return NULL;
+  }
+  stat->Counters_only = true; // rates are calculated by columns
+
+  if (list->Count == list->__capacity) {
+    list->__capacity = list->__capacity ? list->__capacity * 2 : 16;
+    list->Stats = realloc(list->Stats, sizeof(Process_stat*) * list->__capacity);
+    ASSERT(list->Stats != NULL, "list->Stats (Process_stat**) != NULL; realloc(...) returns NULL.");
+    list->Alive = realloc(list->Alive, sizeof(bool) * list->__capacity);
+    ASSERT(list->Alive != NULL, "list->Alive (bool*) != NULL; realloc(...) returns NULL.");
+    list->Order = realloc(list->Order, sizeof(size_t) * list->__capacity);
+    ASSERT(list->Order != NULL, "list->Order (size_t*) != NULL; realloc(...) returns NULL.");
+    list->__sorted = realloc(list->__sorted, sizeof(size_t) * list->__capacity);
+    ASSERT(list->__sorted != NULL, "list->__sorted (size_t*) != NULL; realloc(...) returns NULL.");
+  }
+  list->Stats[list->Count] = stat;
+  list->Alive[list->Count] = true;
+  list->Count++;
+  list->__sorted_count = 0; // the new target is not sorted
+  return stat;
+}
+
+bool Target_list_read_tick(Target_list* list, char** errormsg)
+{
+  if (!Process_tick_read(&list->Tick, errormsg))
+    return false;
+  if (list->Reader)
+    Proc_reader_read(list->Reader, list->Stats, list->Alive, list->Count);
+  Target_columns_begin(list->Columns, list->Count, &list->Tick);
+  return true;
+}
+
+size_t Target_list_update(Target_list* list, char** errormsg)
+{
+  if (!Target_list_read_tick(list, errormsg))
+    return 0;
+
+  for (size_t i = 0; i < list->Count; ++i)
+    Target_list_update_target(list, i);
+  return Target_list_finish_tick(list);
+}
+
+bool Target_list_update_target(Target_list* list, size_t index)
+{
+  if (index >= list->Count || !list->Alive[index])
+    return false;
+  char* error = NULL; // the exited target does not stop others
+  Process_files files;
+  list->Alive[index] = list->Reader && Proc_reader_files(list->Reader, index, &files)
+                           ? Process_stat_update_files(list->Stats[index], &list->Tick, &files, &error)
+                           : Process_stat_update_tick(list->Stats[index], &list->Tick, &error);
+  if (list->Alive[index])
+    Target_columns_store(list->Columns, index, list->Stats[index]);
+  free(error);
+  return list->Alive[index];
+}
+
+size_t Target_list_finish_tick(Target_list* list)
+{
+  Target_columns_finish(list->Columns);
+  return list->Columns->Alive;
+}
+
+void Target_list_sort(Target_list* list, Target_sort sort, bool descending)
+{
+  if (sort < 0 || sort >= TARGET_SORT_COLUMNS_COUNT)
+    sort = TARGET_SORT_CPU;
+  list->Sort = sort;
+  list->Descending = descending;
+}
+
+// the target sorted by the PID or the name
+typedef struct
+{
+  const Process_stat* Stat;
+  size_t Index;
+  int Sign; // -1 for the descending order
+} Sort_key;
+
+// equal targets keep the order of indices
+static int compare_indices(const Sort_key* x, const Sort_key* y)
+{
+  return x->Index < y->Index ? -1 : x->Index > y->Index ? 1 : 0;
+}
+
+static int compare_pids(const void* a, const void* b)
+{
+  const Sort_key *x = a, *y = b;
+  if (x->Stat->Pid != y->Stat->Pid)
+    return x->Stat->Pid < y->Stat->Pid ? -x->Sign : x->Sign;
+  return compare_indices(x, y);
+}
+
+static int compare_names(const void* a, const void* b)
+{
+  const Sort_key *x = a, *y = b;
+  int result = strcmp(x->Stat->Process_name ? x->Stat->Process_name : "",
+                      y->Stat->Process_name ? y->Stat->Process_name : "");
+  return result != 0 ? x->Sign * (result < 0 ? -1 : 1) : compare_indices(x, y);
+}
+
+// sorts all targets by the PID or the name, if they are not sorted in this order yet
+static void sort_targets(Target_list* list)
+{
+  if (list->__sorted_count == list->Count && list->__sorted_by == list->Sort &&
+      list->__sorted_descending == list->Descending)
+    return;
+
+  Sort_key* keys = malloc(sizeof(Sort_key) * list->Count);
+  ASSERT(keys != NULL, "keys (Sort_key*) != NULL; malloc(...) returns NULL.");
+  for (size_t i = 0; i < list->Count; ++i) {
+    keys[i].Stat = list->Stats[i];
+    keys[i].Index = i;
+    keys[i].Sign = list->Descending ? -1 : 1;
+  }
+  qsort(keys, list->Count, sizeof(Sort_key), list->Sort == TARGET_SORT_PID ? compare_pids : compare_names);
+  for (size_t i = 0; i < list->Count; ++i)
+    list->__sorted[i] = keys[i].Index;
+  free(keys);
+  list->__sorted_count = list->Count;
+  list->__sorted_by = list->Sort;
+  list->__sorted_descending = list->Descending;
+}
+
+// returns true, if the target is alive in the last tick of columns
+static bool is_alive(const Target_list* list, size_t index)
+{
+  return index < list->Columns->Count && list->Alive[index];
+}
+
+size_t Target_list_select(Target_list* list, size_t n)
+{
+  n = MIN(n, list->Count);
+  size_t selected = 0;
+  if (n > 0 && (list->Sort == TARGET_SORT_PID || list->Sort == TARGET_SORT_NAME)) {
+    sort_targets(list);
+    for (size_t i = 0; i < list->Count && selected < n; ++i)
+      if (is_alive(list, list->__sorted[i]))
+        list->Order[selected++] = list->__sorted[i];
+  } else if (n > 0)
+    selected = Target_columns_top(
+        list->Columns, (Target_column) (list->Sort - TARGET_SORT_CPU), list->Descending, n, list->Order);
+
+  // not alive targets are at the end in the order of indices
+  for (size_t index = 0; index < list->Count && selected < n; ++index)
+    if (!is_alive(list, index))
+      list->Order[selected++] = index;
+  list->Order_count = selected;
+  return selected;
+}
+
+const char* Target_sort_name(Target_sort sort)
+{
+  return sort >= 0 && sort < TARGET_SORT_COLUMNS_COUNT ? SORT_NAMES[sort] : "";
+}
+
+void Target_list_free(Target_list* list)
+{
+  for (size_t i = 0; i < list->Count; ++i)
+    Process_stat_free(list->Stats[i]);
+  free(list->Stats);
+  free(list->Alive);
+  free(list->Order);
+  free(list->__sorted);
+  if (list->Reader)
+    Proc_reader_free(list->Reader);
+  Target_columns_free(list->Columns);
+  free(list);
+}
@@ -0,0 +1,149 @@
+#ifndef __TARGETS_H
+#define __TARGETS_H
+
+#include "../include/process.h"
+#include "procreader.h"
+#include "columns.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Target_sort
+ * Columns of the table of targets, which can be sorted.
+ */
+typedef enum
+{
+  TARGET_SORT_PID,
+  TARGET_SORT_NAME,
+  TARGET_SORT_CPU,
+  TARGET_SORT_MEMORY,
+  TARGET_SORT_DISK_READ,
+  TARGET_SORT_DISK_WRITE,
+  TARGET_SORT_COLUMNS_COUNT
+} Target_sort;
+
+/**
+ * @brief Target_list
+ * Watches many processes from one instance. Every tick, system-wide data ('/proc/stat' and timestamps) is read once
+ * and all targets are updated with it, so rates of all targets are calculated for the same period. Targets store only
+ * counters (Counters_only), their rates are calculated only by columns, see Target_columns. A target, which
+ * cannot be updated (for example, it has exited), is not updated anymore and is placed at the end of the order. If the
+ * list has the reader, files of all targets are read by one batch per tick, see Proc_reader. The list is never sorted
+ * per tick: only the first targets of the order, which are shown, are selected by Target_list_select.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  Process_stat** Stats;    //! Targets
+  bool* Alive;             //! The target was updated by the last tick
+  size_t* Order;           //! Indices of the first 'Order_count' targets in the sorted order, see Target_list_select
+  size_t Order_count;      //! Number of selected targets
+  size_t Count;            //! Number of targets
+  Target_sort Sort;        //! The sorted column
+  bool Descending;         //! The order is descending
+  Process_tick Tick;       //! System-wide data of the last tick
+  Proc_reader* Reader;     //! Batched reads of files of targets, it is deleted with the list (NULL, not batched)
+  Target_columns* Columns; //! Metrics of targets in columns, totals and the top of targets are calculated by them
+
+  // private fields
+  size_t __capacity;        // capacity of arrays
+  size_t* __sorted;         // indices of all targets sorted by '__sorted_by'
+  size_t __sorted_count;    // number of targets in '__sorted', it is 0, if targets are not sorted
+  Target_sort __sorted_by;  // PID or the name, they do not change between ticks
+  bool __sorted_descending; // the order of '__sorted' is descending
+} Target_list;
+
+/**
+ * @brief Target_find
+ * Finds the process by its PID (if the target is a number) or by its name and stores it to the Process_stat
+ * structure. If the process not found, stores the error message in the 'errormsg' parameter.
+ * @param stat The pointer to the structure
+ * @param target PID or the name of the process
+ * @param errormsg The pointer to the error message
+ * @return Result of searching for the process
+ */
+DECLFUNC bool Target_find(Process_stat* stat, const char* target, char** errormsg) ATTR(nonnull(1, 2));
+/**
+ * @brief Target_list_init
+ * Initializes the new empty list sorted by the CPU usage in the descending order.
+ * @return The pointer to the new list
+ */
+DECLFUNC Target_list* Target_list_init() ATTR(warn_unused_result);
+/**
+ * @brief Target_list_add
+ * Finds the process by Target_find and adds it to the list. If the process not found, stores the error message in the
+ * 'errormsg' parameter.
+ * @param list The pointer to the list
+ * @param target PID or the name of the process
+ * @param errormsg The pointer to the error message
+ * @return The new Process_stat structure owned by the list or NULL
+ */
+DECLFUNC Process_stat* Target_list_add(Target_list* list, const char* target, char** errormsg) ATTR(nonnull(1, 2));
+/**
+ * @brief Target_list_update
+ * Reads system-wide data of the new tick once and updates all alive targets with it. If
+ * system-wide data cannot be read, stores the error message in the 'errormsg' parameter.
+ * @param list The pointer to the list
+ * @param errormsg The pointer to the error message
+ * @return Number of alive targets
+ */
+DECLFUNC size_t Target_list_update(Target_list* list, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Target_list_read_tick
+ * Reads system-wide data of the new tick and, if the list has the reader, files of all alive targets. If system-wide
+ * data cannot be read, stores the error message in the 'errormsg' parameter.
+ * @param list The pointer to the list
+ * @param errormsg The pointer to the error message
+ * @return Result of reading
+ */
+DECLFUNC bool Target_list_read_tick(Target_list* list, char** errormsg) ATTR(nonnull(1));
+/**
+ * @brief Target_list_update_target
+ * Updates one alive target with system-wide data of the current tick ('Tick') and its files read by the reader.
+ * Different targets can be updated from different threads at the same time.
+ * @param list The pointer to the list
+ * @param index Index of the target
+ * @return true, if the target is alive
+ */
+DECLFUNC bool Target_list_update_target(Target_list* list, size_t index) ATTR(nonnull(1));
+/**
+ * @brief Target_list_finish_tick
+ * Calculates metrics of updated targets in columns, it is called after all targets are updated.
+ * @param list The pointer to the list
+ * @return Number of alive targets
+ */
+DECLFUNC size_t Target_list_finish_tick(Target_list* list) ATTR(nonnull(1));
+/**
+ * @brief Target_list_sort
+ * Sets the sorted column and the order, targets are selected in this order by Target_list_select.
+ * @param list The pointer to the list
+ * @param sort The column
+ * @param descending The order is descending
+ */
+DECLFUNC void Target_list_sort(Target_list* list, Target_sort sort, bool descending) ATTR(nonnull(1));
+/**
+ * @brief Target_list_select
+ * Selects the first targets of the sorted order of the last tick into 'Order', alive targets are first and equal
+ * targets keep the order of indices. Metrics are selected from columns by the bounded heap (Target_columns_top), so
+ * the cost is O(count * log(n)); PIDs and names do not change, so targets are sorted by them once and the sorted order
+ * is scanned.
+ * @param list The pointer to the list
+ * @param n Maximal number of selected targets
+ * @return Number of selected targets
+ */
+DECLFUNC size_t Target_list_select(Target_list* list, size_t n) ATTR(nonnull(1));
+/**
+ * @brief Target_sort_name
+ * Returns the name of the column.
+ * @param sort The column
+ * @return The static name
+ */
+DECLFUNC const char* Target_sort_name(Target_sort sort);
+/**
+ * @brief Target_list_free
+ * Deletes the list and all its Process_stat structures.
+ * @param list The pointer to the list
+ */
+DECLFUNC void Target_list_free(Target_list* list) ATTR(nonnull(1));
+
+#endif // __TARGETS_H
@@ -0,0 +1,173 @@
+#include "timeseries.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const long long RESOLUTION_PERIODS_MS[TIMESERIES_RESOLUTIONS_COUNT] = {0, 1000, 10 * 1000, 60 * 1000};
+
+static void *alloc_array(size_t count, size_t size)
+{
+  void *array = calloc(count, size);
+  ASSERT(array != NULL, "array (void*) != NULL; calloc(...) returns NULL.");
+  return array;
+}
+
+// index of the point in the ring by age, the age 0 is the newest point
+static size_t ring_index(const Timeseries_ring *ring, size_t capacity, size_t age)
+{
+  return (ring->Head + capacity - age) % capacity;
+}
+
+static void ring_point(const Timeseries *ts, const Timeseries_ring *ring, size_t metric, size_t index,
+                       Timeseries_point *point)
+{
+  size_t i = metric * ts->Capacity + index;
+  point->Time_ms = ring->Times[index];
+  point->Min = ring->Min[i];
+  point->Max = ring->Max[i];
+  point->Count = ring->Counts[index];
+  point->Avg = point->Count > 0 ? ring->Sum[i] / point->Count : 0.0;
+}
+
+Timeseries *Timeseries_init(size_t metrics_count, size_t capacity)
+{
+  ASSERT(capacity > 0, "capacity > 0; the capacity of time series must be positive.");
+  Timeseries *ts = malloc(sizeof(Timeseries));
+  ASSERT(ts != NULL, "ts (Timeseries*) != NULL; malloc(...) returns NULL.");
+  ts->Metrics_count = metrics_count;
+  ts->Capacity = capacity;
+  ts->Realtime_offset_ms = 0;
+  ts->Samples_count = 0;
+
+  for (int res = 0; res < TIMESERIES_RESOLUTIONS_COUNT; ++res) {
+    Timeseries_ring *ring = &ts->__rings[res];
+    ring->Period_ms = RESOLUTION_PERIODS_MS[res];
+    ring->Head = 0;
+    ring->Count = 0;
+    ring->Times = alloc_array(capacity, sizeof(long long));
+    ring->Min = alloc_array(capacity * metrics_count, sizeof(double));
+    // the raw resolution has one sample in every point, so min, max and sum are stored in one array
+    ring->Max = res == TIMESERIES_RAW ? ring->Min : alloc_array(capacity * metrics_count, sizeof(double));
+    ring->Sum = res == TIMESERIES_RAW ? ring->Min : alloc_array(capacity * metrics_count, sizeof(double));
+    ring->Counts = alloc_array(capacity, sizeof(unsigned int));
+  }
+  return ts;
+}
+
+void Timeseries_append(Timeseries *ts, long long time_ms, const double *values)
+{
+  size_t capacity = ts->Capacity;
+  ts->Samples_count++;
+  for (int res = 0; res < TIMESERIES_RESOLUTIONS_COUNT; ++res) {
+    Timeseries_ring *ring = &ts->__rings[res];
+    long long point_time = ring->Period_ms > 0 ? time_ms - time_ms % ring->Period_ms : time_ms;
+
+    if (ring->Count == 0 || res == TIMESERIES_RAW || ring->Times[ring->Head] != point_time) {
+      // new point
+      ring->Head = ring->Count == 0 ? 0 : (ring->Head + 1) % capacity;
+      if (ring->Count < capacity)
+        ring->Count++;
+      ring->Times[ring->Head] = point_time;
+      ring->Counts[ring->Head] = 1;
+      for (size_t metric = 0; metric < ts->Metrics_count; ++metric) {
+        size_t i = metric * capacity + ring->Head;
+        ring->Min[i] = values[metric];
+        ring->Max[i] = values[metric];
+        ring->Sum[i] = values[metric];
+      }
+    } else {
+      // aggregate with the current point
+      ring->Counts[ring->Head]++;
+      for (size_t metric = 0; metric < ts->Metrics_count; ++metric) {
+        size_t i = metric * capacity + ring->Head;
+        double v = values[metric];
+        if (v < ring->Min[i])
+          ring->Min[i] = v;
+        if (v > ring->Max[i])
+          ring->Max[i] = v;
+        ring->Sum[i] += v;
+      }
+    }
+  }
+}
+
+size_t Timeseries_size(const Timeseries *ts, Timeseries_resolution res)
+{
+  if (res < 0 || res >= TIMESERIES_RESOLUTIONS_COUNT)
+    return 0;
+  return ts->__rings[res].Count;
+}
+
+bool Timeseries_get(const Timeseries *ts, size_t metric, Timeseries_resolution res, size_t age,
+                    Timeseries_point *point)
+{
+  if (res < 0 || res >= TIMESERIES_RESOLUTIONS_COUNT || metric >= ts->Metrics_count)
+    return false;
+  const Timeseries_ring *ring = &ts->__rings[res];
+  if (age >= ring->Count)
+    return false;
+
+  ring_point(ts, ring, metric, ring_index(ring, ts->Capacity, age), point);
+  return true;
+}
+
+bool Timeseries_at(const Timeseries *ts, size_t metric, long long time_ms, Timeseries_point *point)
+{
+  if (metric >= ts->Metrics_count)
+    return false;
+
+  for (int res = 0; res < TIMESERIES_RESOLUTIONS_COUNT; ++res) {
+    const Timeseries_ring *ring = &ts->__rings[res];
+    if (ring->Count == 0 || ring->Times[ring_index(ring, ts->Capacity, ring->Count - 1)] > time_ms)
+      continue; // this time is older than all points of this resolution
+
+    // binary search for the newest point with time <= time_ms, times decrease with age
+    size_t low = 0, high = ring->Count - 1;
+    while (low < high) {
+      size_t mid = (low + high) / 2;
+      if (ring->Times[ring_index(ring, ts->Capacity, mid)] <= time_ms)
+        high = mid;
+      else
+        low = mid + 1;
+    }
+    ring_point(ts, ring, metric, ring_index(ring, ts->Capacity, low), point);
+    return true;
+  }
+  return false;
+}
+
+size_t Timeseries_memory_size(const Timeseries *ts)
+{
+  size_t size = 0;
+  for (int res = 0; res < TIMESERIES_RESOLUTIONS_COUNT; ++res) {
+    size_t arrays = res == TIMESERIES_RAW ? 1 : 3; // min, max and sum (one array for the raw resolution)
+    size += ts->Capacity * (sizeof(long long) + sizeof(unsigned int));
+    size += ts->Capacity * ts->Metrics_count * sizeof(double) * arrays;
+  }
+  return size;
+}
+
+void Timeseries_reset(Timeseries *ts)
+{
+  ts->Samples_count = 0;
+  for (int res = 0; res < TIMESERIES_RESOLUTIONS_COUNT; ++res) {
+    ts->__rings[res].Head = 0;
+    ts->__rings[res].Count = 0;
+  }
+}
+
+void Timeseries_free(Timeseries *ts)
+{
+  for (int res = 0; res < TIMESERIES_RESOLUTIONS_COUNT; ++res) {
+    Timeseries_ring *ring = &ts->__rings[res];
+    free(ring->Times);
+    if (ring->Max != ring->Min)
+      free(ring->Max);
+    if (ring->Sum != ring->Min)
+      free(ring->Sum);
+    free(ring->Min);
+    free(ring->Counts);
+  }
+
+  free(ts);
+}
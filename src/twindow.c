@@ -1,11 +1,14 @@
 #include "twindow.h"
 #include "ioutils.h"
 
+#include <math.h>
 #include <string.h>
 #include <stdlib.h>
 #ifdef __linux__
 #include <sys/ioctl.h>
+#include <sys/syscall.h>
 #include <unistd.h>
+#include <fcntl.h>
 #elif _WIN32
 #include <Windows.h>
 #endif
@@ -17,14 +20,87 @@ static const short int MEDIUM_CPU_USAGE = 4;
 static const short int HARD_CPU_USAGE = 5;
 static const short int MENU_PAIR = 6;
 
+#define MAX_PANEL_ROWS 128
+#define PANEL_LINE_SIZE 512
+
 static const int MAX_CPU_VALUE_LENGTH =
     7; // max CPU value if XXX.XXX (example 100.121), 3 digits + dot + 3 digits as precision
 
+static const char GRAPH_LEVELS[] = "_.:-=+*#"; // columns of graphs from zero to the maximum
+#define GRAPH_LEVELS_COUNT ((int) sizeof(GRAPH_LEVELS) - 1)
+
+// the cell of the frame
+typedef struct
+{
+  char Ch;    // character
+  short Pair; // color pair id, 0 is the default color of the terminal
+} Window_cell;
+
+#ifdef __linux__
+static long thread_id()
+{
+  return (long) syscall(SYS_gettid);
+}
+
+// returns the number of bytes written by the calling thread, see 'wchar' in proc(5)
+static long long written_bytes(Window *win)
+{
+  char buf[512];
+  ssize_t bytes = -1;
+  if (win->__io_fd != -1 && win->__io_tid == thread_id())
+    bytes = pread(win->__io_fd, buf, sizeof(buf) - 1, 0);
+  else { // the window is drawn by other thread than the one, which initialized it
+    int fd = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+    if (fd != -1) {
+      bytes = pread(fd, buf, sizeof(buf) - 1, 0);
+      close(fd);
+    }
+  }
+  if (bytes <= 0)
+    return 0;
+  buf[bytes] = '\0';
+  const char *wchar = strstr(buf, "wchar: ");
+  return wchar ? strtoll(wchar + 7, NULL, 10) : 0;
+}
+#endif
+
 Window *Window_init()
+{
+  return Window_open(NULL, stdout, stdin);
+}
+
+Window *Window_open(const char *term, FILE *output, FILE *input)
 {
   Window *win = malloc(sizeof(Window));
   ASSERT(win != NULL, "win (Window*) != NULL; malloc(...) returns NULL.");
-  win->__p = initscr(); // init ncurses WINDOW
+  win->Panel = WINDOW_PANEL_FILES;
+  win->Lifetime_quantiles = false;
+  win->Read_only = false;
+  win->Status[0] = '\0';
+  win->Frames_count = 0;
+  win->Frame_cells = 0;
+  win->Frame_bytes = 0;
+  win->Total_bytes = 0;
+  win->Graphs_count = 0;
+  Window_add_graph(win, METRIC_CPU_USAGE, 100.0);
+  Window_add_graph(win, METRIC_MEMORY_USAGE, 0.0);
+  Window_add_graph(win, METRIC_DISK_READ_MB_USAGE, 0.0);
+  Window_add_graph(win, METRIC_DISK_WRITE_MB_USAGE, 0.0);
+  win->__screen = newterm(term, output, input); // init ncurses WINDOW
+  ASSERT(win->__screen != NULL, "win->__screen (SCREEN*) != NULL; newterm(...) returns NULL.");
+  win->__p = stdscr;
+  win->__cells = NULL;
+  win->__prev = NULL;
+  win->__run = NULL;
+  win->__rows = 0;
+  win->__cols = 0;
+#ifdef __linux__
+  win->__io_fd = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+  win->__io_tid = thread_id();
+#else
+  win->__io_fd = -1;
+  win->__io_tid = 0;
+#endif
 
   clear();
   curs_set(0);
@@ -51,6 +127,225 @@ Window *Window_init()
   return win;
 }
 
+// returns the column of the value of the graph with the passed scale
+static char graph_column(double value, double max)
+{
+  if (!(value > 0.0) || !(max > 0.0))
+    return GRAPH_LEVELS[0];
+  int level = (int) ceil(value / max * (GRAPH_LEVELS_COUNT - 1)); // any positive value is above the zero level
+  return GRAPH_LEVELS[level < GRAPH_LEVELS_COUNT ? level : GRAPH_LEVELS_COUNT - 1];
+}
+
+void Window_graph_init(Window_graph *graph, Metric_id metric, double scale)
+{
+  graph->Metric = metric;
+  graph->Scale = scale > 0.0 ? scale : 0.0;
+  graph->Count = 0;
+  graph->__head = 0;
+  graph->__max = graph->Scale;
+  graph->__max_age = 0;
+  graph->__samples = 0;
+}
+
+// returns the value of the raw point of the history by its age, negative values and NaN are 0
+static double graph_value(const Window_graph *graph, const Timeseries *history, size_t age)
+{
+  Timeseries_point point;
+  if (!Timeseries_get(history, (size_t) graph->Metric, TIMESERIES_RAW, age, &point) || !(point.Avg >= 0.0))
+    return 0.0;
+  return point.Avg;
+}
+
+// converts all points of the graph to columns with the maximum of the history or with the fixed scale
+static void graph_rebuild(Window_graph *graph, const Timeseries *history)
+{
+  if (graph->Scale == 0.0) {
+    graph->__max = 0.0;
+    graph->__max_age = 0;
+    for (size_t age = 0; age < graph->Count; ++age) {
+      double value = graph_value(graph, history, age);
+      if (value > graph->__max) { // the newest maximum stays in the history longer
+        graph->__max = value;
+        graph->__max_age = age;
+      }
+    }
+  }
+  for (size_t age = 0; age < graph->Count; ++age)
+    graph->__columns[(graph->__head + WINDOW_GRAPH_CAPACITY - 1 - age) % WINDOW_GRAPH_CAPACITY] =
+        graph_column(graph_value(graph, history, age), graph->__max);
+}
+
+void Window_graph_update(Window_graph *graph, const Timeseries *history)
+{
+  size_t size = Timeseries_size(history, TIMESERIES_RAW);
+  size_t count = size < WINDOW_GRAPH_CAPACITY ? size : WINDOW_GRAPH_CAPACITY;
+  unsigned long long samples = history->Samples_count;
+  // all columns are built again, if the history is reset or all its points are new
+  bool rebuild = samples < graph->__samples || samples - graph->__samples >= count;
+  size_t added = rebuild ? count : (size_t) (samples - graph->__samples);
+  graph->__samples = samples;
+  graph->Count = count;
+  graph->__head = (graph->__head + added) % WINDOW_GRAPH_CAPACITY;
+  if (rebuild) {
+    graph_rebuild(graph, history);
+    return;
+  }
+
+  if (graph->Scale == 0.0) {
+    double max = graph->__max;
+    size_t max_age = graph->__max_age + added;
+    for (size_t age = added; age-- > 0;) { // from the oldest new point, the newest maximum stays longer
+      double value = graph_value(graph, history, age);
+      if (value >= max) {
+        max = value;
+        max_age = age;
+      }
+    }
+    graph->__max_age = max_age;
+    if (max != graph->__max || max_age >= count) {
+      graph_rebuild(graph, history); // the scale is changed: the new maximum or the maximum leaves the history
+      return;
+    }
+  }
+  for (size_t age = 0; age < added; ++age) // only new columns are calculated
+    graph->__columns[(graph->__head + WINDOW_GRAPH_CAPACITY - 1 - age) % WINDOW_GRAPH_CAPACITY] =
+        graph_column(graph_value(graph, history, age), graph->__max);
+}
+
+size_t Window_graph_render(const Window_graph *graph, char *buf, size_t width)
+{
+  if (width > WINDOW_GRAPH_CAPACITY)
+    width = WINDOW_GRAPH_CAPACITY;
+  size_t count = graph->Count < width ? graph->Count : width, padding = width - count;
+  memset(buf, ' ', padding);
+  // the last columns are copied by two parts of the ring
+  size_t start = (graph->__head + WINDOW_GRAPH_CAPACITY - count) % WINDOW_GRAPH_CAPACITY,
+         first = count < WINDOW_GRAPH_CAPACITY - start ? count : WINDOW_GRAPH_CAPACITY - start;
+  memcpy(buf + padding, graph->__columns + start, first);
+  memcpy(buf + padding + first, graph->__columns, count - first);
+  buf[width] = '\0';
+  return width;
+}
+
+bool Window_add_graph(Window *win, Metric_id metric, double scale)
+{
+  if (win->Graphs_count == WINDOW_MAX_GRAPHS)
+    return false;
+  Window_graph_init(&win->Graphs[win->Graphs_count++], metric, scale);
+  return true;
+}
+
+void Window_add_sample(Window *win, const Process_stat *proc_stat)
+{
+  if (!proc_stat->History)
+    return;
+  for (size_t i = 0; i < win->Graphs_count; ++i)
+    Window_graph_update(&win->Graphs[i], proc_stat->History);
+}
+
+// puts the text into the composed frame, the text is clipped by the width of the window
+static void put_ntext(Window *win, int y, int x, short pair, const char *text, size_t n)
+{
+  if (y < 0 || y >= win->__rows || x < 0)
+    return;
+  Window_cell *row = (Window_cell *) win->__cells + (size_t) y * (size_t) win->__cols;
+  for (size_t i = 0; i < n && text[i] != '\0' && x < win->__cols; ++i, ++x) {
+    row[x].Ch = text[i];
+    row[x].Pair = pair;
+  }
+}
+
+static void put_text(Window *win, int y, int x, short pair, const char *text)
+{
+  put_ntext(win, y, x, pair, text, strlen(text));
+}
+
+// starts the new frame of the passed size, the previous frame is forgotten if the size is changed
+static void begin_frame(Window *win, int rows, int cols)
+{
+  if (rows < 0)
+    rows = 0;
+  if (cols < 0)
+    cols = 0;
+  size_t count = (size_t) rows * (size_t) cols;
+  if (rows != win->__rows || cols != win->__cols) {
+    free(win->__cells);
+    free(win->__prev);
+    free(win->__run);
+    win->__cells = malloc(sizeof(Window_cell) * count + 1);
+    ASSERT(win->__cells != NULL, "win->__cells (Window_cell*) != NULL; malloc(...) returns NULL.");
+    win->__prev = malloc(sizeof(Window_cell) * count + 1);
+    ASSERT(win->__prev != NULL, "win->__prev (Window_cell*) != NULL; malloc(...) returns NULL.");
+    win->__run = malloc(sizeof(char) * (size_t) cols + 1);
+    ASSERT(win->__run != NULL, "win->__run (char*) != NULL; malloc(...) returns NULL.");
+    win->__rows = rows;
+    win->__cols = cols;
+
+    // every cell differs from the unknown previous frame, the terminal is repainted once
+    Window_cell *prev = (Window_cell *) win->__prev;
+    for (size_t i = 0; i < count; ++i) {
+      prev[i].Ch = '\0';
+      prev[i].Pair = -1;
+    }
+    wresize(win->__p, rows, cols);
+    clearok(win->__p, true);
+  }
+
+  Window_cell *cells = (Window_cell *) win->__cells;
+  for (size_t i = 0; i < count; ++i) {
+    cells[i].Ch = ' ';
+    cells[i].Pair = 0;
+  }
+}
+
+// passes runs of changed cells to ncurses and updates the terminal
+static void end_frame(Window *win)
+{
+  Window_cell *cells = (Window_cell *) win->__cells, *prev = (Window_cell *) win->__prev;
+  unsigned long long changed = 0;
+  for (int y = 0; y < win->__rows; ++y) {
+    size_t offset = (size_t) y * (size_t) win->__cols;
+    int x = 0;
+    while (x < win->__cols) {
+      const Window_cell *cell = &cells[offset + (size_t) x], *old = &prev[offset + (size_t) x];
+      if (cell->Ch == old->Ch && cell->Pair == old->Pair) {
+        ++x;
+        continue;
+      }
+
+      // the run of changed cells with the same color
+      short pair = cell->Pair;
+      int begin = x, n = 0;
+      for (; x < win->__cols; ++x) {
+        cell = &cells[offset + (size_t) x];
+        old = &prev[offset + (size_t) x];
+        if (cell->Pair != pair || (cell->Ch == old->Ch && cell->Pair == old->Pair))
+          break;
+        win->__run[n++] = cell->Ch;
+      }
+      win->__run[n] = '\0';
+      changed += (unsigned long long) n;
+
+      wattron(win->__p, COLOR_PAIR(pair));
+      mvwaddnstr(win->__p, y, begin, win->__run, n);
+      wattroff(win->__p, COLOR_PAIR(pair));
+    }
+  }
+  memcpy(prev, cells, sizeof(Window_cell) * (size_t) win->__rows * (size_t) win->__cols);
+
+#ifdef __linux__
+  long long before = written_bytes(win);
+  wrefresh(win->__p);
+  long long after = written_bytes(win);
+  win->Frame_bytes = after > before ? (unsigned long long) (after - before) : 0;
+#else
+  wrefresh(win->__p);
+#endif
+  win->Frame_cells = changed;
+  win->Total_bytes += win->Frame_bytes;
+  ++win->Frames_count;
+}
+
 static void draw_CPU_usage(Window *win, Process_stat *proc_stat, int termX, int termY)
 {
   UNUSED(termY);
@@ -58,39 +353,20 @@ static void draw_CPU_usage(Window *win, Process_stat *proc_stat, int termX, int
   int cursX = 0,    // cursor X position
       cursY = 0,    // cursor Y position
       roffsetX = 3; // right offset X position
-  char *hdrcpu = NULL;
   {
     // cpu value
-    char *cpu_str = NULL; // cpu usage as str
-    char *hdrcpuoffset = NULL;
-    ftostr(proc_stat->Cpu_usage, &cpu_str);
-    strconcat(&hdrcpu, 3, SAFE_PASS_VARGS("CPU: ", cpu_str, "% "));
-
-    attron(COLOR_PAIR(HEADER_PAIR));
-    mvwaddstr(win->__p, cursY, cursX, hdrcpu);
-    attroff(COLOR_PAIR(HEADER_PAIR));
+    char cpu_str[32], hdrcpu[64]; // cpu usage as str
+    snprintf(cpu_str, sizeof(cpu_str), "%.3f", proc_stat->Cpu_usage);
+    snprintf(hdrcpu, sizeof(hdrcpu), "CPU: %s%% ", cpu_str);
+    put_text(win, cursY, cursX, HEADER_PAIR, hdrcpu);
     cursX += (int) strlen(hdrcpu);
 
-    {
-      // whitespaces
-      int spcount = MAX_CPU_VALUE_LENGTH - (int) strlen(cpu_str);
-      char *spaces = malloc(sizeof(char) * (size_t) spcount + 1);
-      ASSERT(spaces != NULL, "spaces (char*) != NULL; malloc(...) returns NULL.");
-      spaces[0] = '\0';
-
-      while (spcount-- > 1)
-        strcat(spaces, " ");
-
-      strconcat(&hdrcpuoffset, 2, SAFE_PASS_VARGS(spaces, "["));
-      free(spaces);
-    }
-    attron(COLOR_PAIR(DEFAULT_PAIR));
-    mvwaddstr(win->__p, cursY, cursX, hdrcpuoffset);
-    attroff(COLOR_PAIR(DEFAULT_PAIR));
+    // whitespaces
+    int spcount = MAX_CPU_VALUE_LENGTH - (int) strlen(cpu_str);
+    char hdrcpuoffset[16];
+    snprintf(hdrcpuoffset, sizeof(hdrcpuoffset), "%*s[", spcount > 1 ? spcount - 1 : 0, "");
+    put_text(win, cursY, cursX, DEFAULT_PAIR, hdrcpuoffset);
     cursX += (int) strlen(hdrcpuoffset);
-
-    free(cpu_str);
-    free(hdrcpuoffset);
   }
   {
     // print cpu usage bar
@@ -108,232 +384,657 @@ static void draw_CPU_usage(Window *win, Process_stat *proc_stat, int termX, int
       else
         idpair = HARD_CPU_USAGE;
 
-      attron(COLOR_PAIR(idpair));
-      mvwaddch(win->__p, cursY, cursX, '#');
-      attroff(COLOR_PAIR(idpair));
+      put_ntext(win, cursY, cursX, (short) idpair, "#", 1);
 
       ++cursX;
     }
   }
 
-  attron(COLOR_PAIR(DEFAULT_PAIR));
-  mvwaddstr(win->__p, cursY, termX - roffsetX, "]   ");
-  attroff(COLOR_PAIR(DEFAULT_PAIR));
-
-  free(hdrcpu);
+  put_text(win, cursY, termX - roffsetX, DEFAULT_PAIR, "]   ");
 }
 
-static void draw_process_info(Window *win, Process_stat *proc_stat, int termX, int termY)
+static int draw_process_info(Window *win, Process_stat *proc_stat, int termX, int termY)
 {
   UNUSED(termY);
   UNUSED(termX);
 
   int cursY = 2,    // cursor Y position
       loffsetX = 4; // left offset X position
+  char hdr[PANEL_LINE_SIZE]; // header
   {
-    char *hdr = NULL; // header
-
-    char *strPID = NULL; // pid as str
-
-    attron(COLOR_PAIR(DEFAULT_PAIR));
-
-    strconcat(&hdr, 3, SAFE_PASS_VARGS("Name: ", proc_stat->Process_name, " "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
+    snprintf(hdr, sizeof(hdr), "Name: %s ", proc_stat->Process_name ? proc_stat->Process_name : "");
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
     cursY++;
-    free(hdr);
 
-    itostr(proc_stat->Pid, &strPID);
-    strconcat(&hdr, 3, SAFE_PASS_VARGS("PID: ", strPID, " "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
-    free(hdr);
-
-    attroff(COLOR_PAIR(DEFAULT_PAIR));
-    free(strPID);
+    snprintf(hdr, sizeof(hdr), "PID: %d ", proc_stat->Pid);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
   }
   cursY += 2;
   {
-    char *hdr = NULL; // header
-
-    char *strpriority = NULL, // process priority as str
-        *strmemory = NULL,    // memory usage as str
-            *struid = NULL;   // user id
-
-    char strstate[2] = "\0"; // process state as str
-    attron(COLOR_PAIR(DEFAULT_PAIR));
-
-    itostr(proc_stat->Priority, &strpriority);
-    strconcat(&hdr, 3, SAFE_PASS_VARGS("Priority: ", strpriority, " "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
+    snprintf(hdr, sizeof(hdr), "Priority: %d ", proc_stat->Priority);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
     cursY++;
-    free(hdr);
 
-    strstate[0] = proc_stat->State;
-    strconcat(&hdr, 5, SAFE_PASS_VARGS("State: '", strstate, "' (", proc_stat->State_fullname, ") "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
+    snprintf(hdr, sizeof(hdr), "State: '%c' (%s) ", proc_stat->State, proc_stat->State_fullname);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
     cursY++;
-    free(hdr);
 
-    ftostr(proc_stat->Memory_usage, &strmemory);
-    strconcat(&hdr, 3, SAFE_PASS_VARGS("Memory: ", strmemory, "MB "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
+    snprintf(hdr, sizeof(hdr), "Memory: %.3fMB ", proc_stat->Memory_usage);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
     cursY++;
-    free(hdr);
 
-    strconcat(&hdr, 3, SAFE_PASS_VARGS("Time: ", proc_stat->Time_usage, " "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
+    snprintf(hdr, sizeof(hdr), "Time: %s ", proc_stat->Time_usage);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
     cursY++;
-    free(hdr);
 
-    strconcat(&hdr, 3, SAFE_PASS_VARGS("Start time: ", proc_stat->Start_time, " "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
+    snprintf(hdr, sizeof(hdr), "Start time: %s ", proc_stat->Start_time);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
     cursY++;
-    free(hdr);
 
+    const char *username = proc_stat->Username ? proc_stat->Username : "";
 #ifdef _WIN32
-    strconcat(&hdr, 3, SAFE_PASS_VARGS("User: ", proc_stat->Username, " "));
+    snprintf(hdr, sizeof(hdr), "User: %s ", username);
 #elif __linux__
-    itostr(proc_stat->Uid, &struid);
-    strconcat(&hdr, 5, SAFE_PASS_VARGS("User: ", proc_stat->Username, " (Uid=", struid, ") "));
+    snprintf(hdr, sizeof(hdr), "User: %s (Uid=%d) ", username, proc_stat->Uid);
 #endif
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
-    free(hdr);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
+  }
+  cursY += 2;
+  {
+    // percentiles of the windowed view or of the lifetime view
+    static const char *names[] = {"CPU, %", "Memory, MB", "Disk read, MB/s", "Disk write, MB/s"};
+    const Sketch *sketches[] = {
+        proc_stat->Cpu_sketch, proc_stat->Memory_sketch, proc_stat->Disk_read_sketch, proc_stat->Disk_write_sketch};
+    char line[PANEL_LINE_SIZE];
 
-    attroff(COLOR_PAIR(DEFAULT_PAIR));
-    free(strpriority);
-    free(strmemory);
-    free(struid);
+    char title[32];
+    long long window_min = proc_stat->Cpu_sketch ? proc_stat->Cpu_sketch->Window_ms / 60 / 1000 : 0;
+    if (win->Lifetime_quantiles)
+      snprintf(title, sizeof(title), "Lifetime");
+    else
+      snprintf(title, sizeof(title), "Last %lld min", window_min);
+    snprintf(line, sizeof(line), "%-16s %11s %11s %11s %11s ", title, "p50", "p95", "p99", "max");
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
+    for (size_t i = 0; i < sizeof(sketches) / sizeof(sketches[0]); ++i) {
+      if (!sketches[i])
+        continue;
+      Sketch_summary summary;
+      Sketch_summarize(win->Lifetime_quantiles ? &sketches[i]->Lifetime : &sketches[i]->Window, &summary);
+      snprintf(line,
+               sizeof(line),
+               "%-16s %11.3f %11.3f %11.3f %11.3f ",
+               names[i],
+               summary.P50,
+               summary.P95,
+               summary.P99,
+               summary.Max);
+      cursY++;
+      put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
+    }
   }
   cursY += 2;
   {
-    char *hdr = NULL; // header
+    snprintf(hdr,
+             sizeof(hdr),
+             "Disk R/W: %.3fMB/s / %.3fMB/s ",
+             proc_stat->Disk_read_mb_usage,
+             proc_stat->Disk_write_mb_usage);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
+    cursY++;
 
-    char *strcpu = NULL, *strmemory = NULL;
+    snprintf(hdr,
+             sizeof(hdr),
+             "Disk Read/Written: %lluKB / %lluKB ",
+             proc_stat->Disk_read_kb,
+             proc_stat->Disk_written_kb);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, hdr);
+  }
+  return cursY + 2;
+}
+
+static int draw_graphs(Window *win, const Process_stat *proc_stat, int termX, int termY, int cursY)
+{
+  UNUSED(termY);
+
+  int loffsetX = 4,                                  // left offset X position
+      width = termX - loffsetX - 18 - 3 - 12 - 17; // width of graphs without the label, brackets and values
+  if (win->Graphs_count == 0 || width <= 0 || !proc_stat->History)
+    return cursY;
+  char line[WINDOW_GRAPH_CAPACITY + 64], label[32], graph[WINDOW_GRAPH_CAPACITY + 1];
+  for (size_t i = 0; i < win->Graphs_count; ++i) {
+    const Window_graph *g = &win->Graphs[i];
+    const Metric_info *info = Metric_get_info(g->Metric);
+    double last = g->Count ? graph_value(g, proc_stat->History, 0) : 0.0;
+    snprintf(label, sizeof(label), "%s, %s", info ? info->Name : "", info ? info->Unit : "");
+    Window_graph_render(g, graph, (size_t) width);
+    snprintf(line, sizeof(line), "%-18.18s [%s] %11.3f max %11.3f ", label, graph, last, g->__max);
+    put_text(win, cursY++, loffsetX, DEFAULT_PAIR, line);
+  }
+  return cursY + 1;
+}
+
+static void draw_fd_panel(Window *win, Process_stat *proc_stat, int termX, int termY, int cursY)
+{
+  int loffsetX = 4,                  // left offset X position
+      rows = termY - 2 - (cursY + 2); // rows for entries, without the header, the column names and the menu
+  Fd_list *fds = proc_stat->Fds;
+  if (!fds || rows <= 0 || termX <= loffsetX)
+    return;
+  if (rows > MAX_PANEL_ROWS)
+    rows = MAX_PANEL_ROWS;
+
+  // select the entries with the highest speed, the order of descriptors is kept for equal speeds
+  size_t top[MAX_PANEL_ROWS];
+  int topcount = 0;
+  for (size_t i = 0; i < fds->Count; ++i) {
+    double rate = fds->Entries[i].Rate_mb_usage;
+    if (topcount == rows && rate <= fds->Entries[top[topcount - 1]].Rate_mb_usage)
+      continue;
+
+    int j = topcount < rows ? topcount++ : topcount - 1;
+    while (j > 0 && fds->Entries[top[j - 1]].Rate_mb_usage < rate) {
+      top[j] = top[j - 1];
+      --j;
+    }
+    top[j] = i;
+  }
+
+  char line[PANEL_LINE_SIZE];
+  int width = termX - loffsetX < PANEL_LINE_SIZE ? termX - loffsetX : PANEL_LINE_SIZE;
 
-    attron(COLOR_PAIR(DEFAULT_PAIR));
+  snprintf(line, (size_t) width, "Files: %zu open ", fds->Count);
+  put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
+  cursY++;
 
-    ftostr(proc_stat->Cpu_peak_usage, &strcpu);
-    strconcat(&hdr, 3, SAFE_PASS_VARGS("CPU peak: ", strcpu, "% "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
+  snprintf(line, (size_t) width, "%-7s %-14s %-12s %-9s %s", "FD", "POS", "RATE", "ETA", "TARGET");
+  put_text(win, cursY, loffsetX, HEADER_PAIR, line);
+  cursY++;
+
+  for (int i = 0; i < topcount; ++i) {
+    const Fd_entry *entry = &fds->Entries[top[i]];
+    char eta[16] = "-", rate[16];
+    snprintf(rate, sizeof(rate), "%.3fMB/s", entry->Rate_mb_usage);
+    if (entry->Eta_sec >= 0)
+      snprintf(eta,
+               sizeof(eta),
+               "%02lld:%02lld:%02lld",
+               (entry->Eta_sec / 3600) % 100,
+               (entry->Eta_sec / 60) % 60,
+               entry->Eta_sec % 60);
+
+    snprintf(line,
+             (size_t) width,
+             "%-7d %-14llu %-12s %-9s %s",
+             entry->Fd,
+             entry->Pos,
+             rate,
+             eta,
+             entry->Target);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
     cursY++;
-    free(hdr);
+  }
+}
+
+static void draw_sockets_panel(Window *win, Process_stat *proc_stat, int termX, int termY, int cursY)
+{
+  int loffsetX = 4,                  // left offset X position
+      rows = termY - 2 - (cursY + 3); // rows for sockets, without the summary, the column names and the menu
+  Socket_list *sockets = proc_stat->Sockets;
+  if (!sockets || termX <= loffsetX)
+    return;
+  if (rows > MAX_PANEL_ROWS)
+    rows = MAX_PANEL_ROWS;
 
-    ftostr(proc_stat->Memory_peak_usage, &strmemory);
-    strconcat(&hdr, 3, SAFE_PASS_VARGS("Memory peak: ", strmemory, "MB "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
-    free(hdr);
+  char line[PANEL_LINE_SIZE];
+  int width = termX - loffsetX < PANEL_LINE_SIZE ? termX - loffsetX : PANEL_LINE_SIZE;
 
-    attroff(COLOR_PAIR(DEFAULT_PAIR));
-    free(strcpu);
-    free(strmemory);
+  {
+    unsigned int other = (unsigned int) sockets->Count;
+    for (int i = 0; i < SOCKET_PROTO_COUNT; ++i)
+      other -= sockets->Proto_counts[i];
+    snprintf(line,
+             (size_t) width,
+             "Sockets: %zu (TCP %u, UDP %u, UNIX %u, other %u)  Recv-Q: %lluB  Send-Q: %lluB ",
+             sockets->Count,
+             sockets->Proto_counts[SOCKET_TCP] + sockets->Proto_counts[SOCKET_TCP6],
+             sockets->Proto_counts[SOCKET_UDP] + sockets->Proto_counts[SOCKET_UDP6],
+             sockets->Proto_counts[SOCKET_UNIX],
+             other,
+             sockets->Recv_queue_total,
+             sockets->Send_queue_total);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
+    cursY++;
   }
-  cursY += 2;
   {
-    char *hdr = NULL; // header
+    // connections by state, only not empty states
+    int len = snprintf(line, (size_t) width, "TCP states:");
+    for (int state = 1; state < SOCKET_TCP_STATES_COUNT && len < width; ++state) {
+      if (sockets->Tcp_state_counts[state] > 0)
+        len += snprintf(line + len,
+                        (size_t) (width - len),
+                        " %s %u",
+                        Socket_state_name(state),
+                        sockets->Tcp_state_counts[state]);
+    }
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
+    cursY++;
+  }
 
-    char *strdisk_read = NULL, *strdisk_written = NULL, *strdisk_read_usage = NULL, *strdisk_write_usage,
-         *strdisk_read_peak_usage = NULL, *strdisk_write_peak_usage = NULL;
+  snprintf(
+      line, sizeof(line), "%-6s %-12s %-9s %-9s %-30s %s", "PROTO", "STATE", "RECV-Q", "SEND-Q", "LOCAL", "REMOTE");
+  put_ntext(win, cursY, loffsetX, HEADER_PAIR, line, (size_t) width - 1);
+  cursY++;
 
-    attron(COLOR_PAIR(DEFAULT_PAIR));
+  if (rows <= 0)
+    return;
 
-    ftostr(proc_stat->Disk_read_mb_usage, &strdisk_read_usage);
-    ftostr(proc_stat->Disk_write_mb_usage, &strdisk_write_usage);
-    strconcat(&hdr, 6, SAFE_PASS_VARGS("Disk R/W: ", strdisk_read_usage, "MB/s ", "/ ", strdisk_write_usage, "MB/s "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
-    cursY++;
-    free(hdr);
-
-    ftostr(proc_stat->Disk_read_mb_peak_usage, &strdisk_read_peak_usage);
-    ftostr(proc_stat->Disk_write_mb_peak_usage, &strdisk_write_peak_usage);
-    strconcat(
-        &hdr,
-        6,
-        SAFE_PASS_VARGS("Disk peak R/W: ", strdisk_read_peak_usage, "MB/s ", "/ ", strdisk_write_peak_usage, "MB/s "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
+  // select the sockets with the largest backlog
+  size_t top[MAX_PANEL_ROWS];
+  int topcount = 0;
+  for (size_t i = 0; i < sockets->Count; ++i) {
+    const Socket_entry *entry = &sockets->Entries[i];
+    unsigned long backlog = entry->Recv_queue + entry->Send_queue;
+    if (topcount == rows && backlog <= sockets->Entries[top[topcount - 1]].Recv_queue +
+                                           sockets->Entries[top[topcount - 1]].Send_queue)
+      continue;
+
+    int j = topcount < rows ? topcount++ : topcount - 1;
+    while (j > 0 && sockets->Entries[top[j - 1]].Recv_queue + sockets->Entries[top[j - 1]].Send_queue < backlog) {
+      top[j] = top[j - 1];
+      --j;
+    }
+    top[j] = i;
+  }
+
+  for (int i = 0; i < topcount; ++i) {
+    const Socket_entry *entry = &sockets->Entries[top[i]];
+    const char *state = "-";
+    if (entry->Proto == SOCKET_TCP || entry->Proto == SOCKET_TCP6)
+      state = Socket_state_name(entry->State);
+    else if (entry->Proto == SOCKET_UNIX)
+      state = entry->State == 3 /* SS_CONNECTED */ ? "CONNECTED" : "UNCONNECTED";
+
+    snprintf(line,
+             (size_t) width,
+             "%-6s %-12s %-9lu %-9lu %-30s %s",
+             Socket_proto_name(entry->Proto),
+             state,
+             entry->Recv_queue,
+             entry->Send_queue,
+             entry->Local,
+             entry->Remote);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
     cursY++;
-    free(hdr);
+  }
+}
+
+static void draw_numa_panel(Window *win, Process_stat *proc_stat, int termX, int termY, int cursY)
+{
+  int loffsetX = 4,                  // left offset X position
+      rows = termY - 2 - (cursY + 3); // rows for nodes, without the summary, the column names and the menu
+  Numa_stat *numa = proc_stat->Numa;
+  if (!numa || termX <= loffsetX)
+    return;
+
+  char line[PANEL_LINE_SIZE];
+  int width = termX - loffsetX < PANEL_LINE_SIZE ? termX - loffsetX : PANEL_LINE_SIZE;
+
+  if (numa->Numa_available)
+    snprintf(line,
+             (size_t) width,
+             "NUMA: %d nodes  Remote: %.3f%%  THP: %.3fMB (%.3f%% of anonymous) ",
+             numa->Nodes_count,
+             numa->Remote_usage,
+             (double) numa->Anon_huge_pages_kb / 1000,
+             numa->Thp_usage);
+  else
+    snprintf(line,
+             (size_t) width,
+             "NUMA: not available, single node view  THP: %.3fMB (%.3f%% of anonymous) ",
+             (double) numa->Anon_huge_pages_kb / 1000,
+             numa->Thp_usage);
+  put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
+  cursY++;
 
-    ulltostr(proc_stat->Disk_read_kb, &strdisk_read);
-    ulltostr(proc_stat->Disk_written_kb, &strdisk_written);
-    strconcat(&hdr, 6, SAFE_PASS_VARGS("Disk Read/Written: ", strdisk_read, "KB ", "/ ", strdisk_written, "KB "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
-    free(hdr);
+  snprintf(line,
+           (size_t) width,
+           "Last read: %.3fms, %lluKB, every %ldms ",
+           numa->Read_cost_ms,
+           numa->Read_bytes / 1000,
+           numa->Interval_ms);
+  put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
+  cursY++;
 
-    attroff(COLOR_PAIR(DEFAULT_PAIR));
-    free(strdisk_read);
-    free(strdisk_written);
-    free(strdisk_read_usage);
-    free(strdisk_write_usage);
-    free(strdisk_read_peak_usage);
-    free(strdisk_write_peak_usage);
+  snprintf(line, (size_t) width, "%-7s %-7s %-14s %s", "NODE", "LOCAL", "MEMORY", "SHARE");
+  put_text(win, cursY, loffsetX, HEADER_PAIR, line);
+  cursY++;
+
+  for (int node = 0; node < numa->Nodes_count && node < rows; ++node) {
+    char memory[32];
+    snprintf(memory, sizeof(memory), "%.3fMB", (double) numa->Node_memory_kb[node] / 1000);
+    snprintf(line,
+             (size_t) width,
+             "N%-6d %-7s %-14s %.3f%%",
+             node,
+             numa->Node_local[node] ? "yes" : "no",
+             memory,
+             numa->Total_memory_kb > 0 ? 100.0 * (double) numa->Node_memory_kb[node] / (double) numa->Total_memory_kb
+                                       : 0.0);
+    put_text(win, cursY, loffsetX, DEFAULT_PAIR, line);
+    cursY++;
   }
 }
 
-static void draw_menu(Window *win, int termX, int termY)
+static void draw_overhead(Window *win, Process_stat *proc_stat, int termX, int termY)
 {
-  UNUSED(termX);
+  const Overhead *overhead = proc_stat->Overhead;
+  int loffsetX = 4; // left offset X position
+  if (!overhead || overhead->Ticks_count == 0 || termX <= loffsetX)
+    return;
 
+  char line[512], allocations[32];
+  if (overhead->Tick.Allocations >= 0)
+    snprintf(allocations, sizeof(allocations), "%lld", overhead->Tick.Allocations);
+  else
+    strcpy(allocations, "n/a");
+  snprintf(line,
+           sizeof(line),
+           "Overhead per tick: %.3fms CPU, %llu syscalls, %llu B read, %s allocations",
+           overhead->Tick.Cpu_ms,
+           overhead->Tick.Syscalls,
+           overhead->Tick.Read_bytes,
+           allocations);
+  put_ntext(win, termY - 4, loffsetX, DEFAULT_PAIR, line, (size_t) (termX - loffsetX));
+
+  int length = snprintf(line, sizeof(line), "CPU of probes, ms:");
+  for (int i = 0; i < OVERHEAD_PROBES_COUNT && length > 0 && (size_t) length < sizeof(line); ++i)
+    length += snprintf(line + length,
+                       sizeof(line) - (size_t) length,
+                       " %s %.3f",
+                       Overhead_probe_name((Overhead_probe) i),
+                       overhead->Probes[i].Cpu_ms);
+  put_ntext(win, termY - 3, loffsetX, DEFAULT_PAIR, line, (size_t) (termX - loffsetX));
+}
+
+// menus of views
+typedef enum
+{
+  MENU_PROCESS,
+  MENU_TABLE,
+  MENU_TOP
+} Menu;
+
+static void draw_menu(Window *win, int termX, int termY, Menu menu)
+{
   int cursX = 0,         // cursor X position
       cursY = termY - 1, // cursor Y position
       loffsetX = 4;      // left offset X position
 
+  if (win->Status[0] != '\0') {
+    put_ntext(win, cursY - 1, loffsetX, DEFAULT_PAIR, win->Status, termX > loffsetX ? (size_t) (termX - loffsetX) : 0);
+  }
   {
-    attron(COLOR_PAIR(MENU_PAIR));
+    const char *hdr;
+    if (!win->Read_only && menu == MENU_PROCESS) {
+      hdr = " F1 - Kill process ";
+      put_text(win, cursY, loffsetX, MENU_PAIR, hdr);
+      cursX += loffsetX + (int) strlen(hdr);
+    }
 
-    char *hdr = NULL;
-    strconcat(&hdr, 2, SAFE_PASS_VARGS(" F1 - Kill process "));
-    mvwaddstr(win->__p, cursY, loffsetX, hdr);
+    hdr = menu != MENU_PROCESS ? " F2 - Sort column " : " F2 - Next panel ";
+    put_text(win, cursY, loffsetX + cursX, MENU_PAIR, hdr);
     cursX += loffsetX + (int) strlen(hdr);
-    free(hdr);
 
-    strconcat(&hdr, 2, SAFE_PASS_VARGS(" F4 - Exit "));
-    mvwaddstr(win->__p, cursY, loffsetX + cursX, hdr);
-    cursX += loffsetX;
-    free(hdr);
+    if (menu == MENU_PROCESS)
+      hdr = win->Lifetime_quantiles ? " F3 - Last minutes " : " F3 - Lifetime ";
+    else
+      hdr = menu == MENU_TABLE ? " F3 - Reverse order " : " Enter - Watch process ";
+    put_text(win, cursY, loffsetX + cursX, MENU_PAIR, hdr);
+    cursX += loffsetX + (int) strlen(hdr);
 
-    attroff(COLOR_PAIR(MENU_PAIR));
+    hdr = " F4 - Exit ";
+    put_text(win, cursY, loffsetX + cursX, MENU_PAIR, hdr);
   }
 }
 
-bool Window_refresh(Window *win, Process_stat *proc_stat)
+// gets the real size of the terminal at the moment
+static void terminal_size(int *x, int *y)
 {
-  int x = COLS, y = LINES;
-  {
+  *x = COLS;
+  *y = LINES;
 #ifdef __linux__
-    struct winsize sz; // get terminal real size at the moment
-    if (ioctl(2, TIOCGWINSZ, &sz) == 0) {
-      x = sz.ws_col;
-      y = sz.ws_row;
-    }
+  struct winsize sz;
+  if (ioctl(2, TIOCGWINSZ, &sz) == 0 && sz.ws_col > 0 && sz.ws_row > 0) {
+    *x = sz.ws_col;
+    *y = sz.ws_row;
+  }
 #elif _WIN32
-    // TODO: size not updated after resize console
-    CONSOLE_SCREEN_BUFFER_INFO out;
-    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &out)) {
-      x = out.srWindow.Right - out.srWindow.Left + 1;
-      y = out.srWindow.Bottom - out.srWindow.Top + 1;
-    }
+  // TODO: size not updated after resize console
+  CONSOLE_SCREEN_BUFFER_INFO out;
+  if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &out)) {
+    *x = out.srWindow.Right - out.srWindow.Left + 1;
+    *y = out.srWindow.Bottom - out.srWindow.Top + 1;
+  }
 #endif
+}
+
+void Window_draw(Window *win, Process_stat *proc_stat)
+{
+  int x, y;
+  terminal_size(&x, &y);
+  begin_frame(win, y, x);
+
+  draw_CPU_usage(win, proc_stat, x, y);
+  int panelY = draw_process_info(win, proc_stat, x, y);
+  panelY = draw_graphs(win, proc_stat, x, y, panelY);
+  int panelsY = proc_stat->Overhead ? y - 2 : y; // the overhead footer is above the status line
+  switch (win->Panel) {
+  case WINDOW_PANEL_FILES:
+    draw_fd_panel(win, proc_stat, x, panelsY, panelY);
+    break;
+  case WINDOW_PANEL_SOCKETS:
+    draw_sockets_panel(win, proc_stat, x, panelsY, panelY);
+    break;
+  case WINDOW_PANEL_NUMA:
+    draw_numa_panel(win, proc_stat, x, panelsY, panelY);
+    break;
+  default:
+    break;
   }
-  wresize(win->__p, y, x);
-  wrefresh(win->__p);
-  clear();
+  draw_overhead(win, proc_stat, x, y);
+  draw_menu(win, x, y, MENU_PROCESS);
+  end_frame(win);
+}
+
+void Window_draw_table(Window *win, Target_list *targets)
+{
+  int x, y;
+  terminal_size(&x, &y);
+  begin_frame(win, y, x);
+
+  int loffsetX = 4,     // left offset X position
+      cursY = 0,        // cursor Y position
+      rows = y - 2 - 3; // rows for targets, without the summary, the column names and the menu
+  char line[PANEL_LINE_SIZE], columns[TARGET_SORT_COLUMNS_COUNT][32];
+  size_t width = x - loffsetX < PANEL_LINE_SIZE ? (size_t) (x - loffsetX) : PANEL_LINE_SIZE;
+  if (x <= loffsetX) {
+    end_frame(win);
+    return;
+  }
+
+  const Target_columns *metrics = targets->Columns;
+  snprintf(line,
+           width,
+           "Targets: %zu, alive: %zu, sorted by %s (%s) ",
+           targets->Count,
+           metrics->Alive,
+           Target_sort_name(targets->Sort),
+           targets->Descending ? "descending" : "ascending");
+  put_text(win, cursY++, 0, HEADER_PAIR, line);
+  snprintf(line,
+           width,
+           "Total CPU: %.3f%% (max %.3f%%), memory: %.3f MB, read: %.3f MB/s, write: %.3f MB/s",
+           metrics->Sums[TARGET_COLUMN_CPU],
+           metrics->Maxima[TARGET_COLUMN_CPU],
+           metrics->Sums[TARGET_COLUMN_MEMORY],
+           metrics->Sums[TARGET_COLUMN_DISK_READ],
+           metrics->Sums[TARGET_COLUMN_DISK_WRITE]);
+  put_text(win, cursY++, 0, DEFAULT_PAIR, line);
+
+  for (int i = 0; i < TARGET_SORT_COLUMNS_COUNT; ++i)
+    snprintf(columns[i],
+             sizeof(columns[i]),
+             "%s%s",
+             Target_sort_name((Target_sort) i),
+             (Target_sort) i != targets->Sort ? "" : targets->Descending ? " v" : " ^");
+  snprintf(line,
+           width,
+           "%-9s %-20s %-10s %13s %13s %13s %13s",
+           columns[TARGET_SORT_PID],
+           columns[TARGET_SORT_NAME],
+           "STATE",
+           columns[TARGET_SORT_CPU],
+           columns[TARGET_SORT_MEMORY],
+           columns[TARGET_SORT_DISK_READ],
+           columns[TARGET_SORT_DISK_WRITE]);
+  put_text(win, cursY++, loffsetX, HEADER_PAIR, line);
+
+  size_t selected = Target_list_select(targets, rows > 0 ? (size_t) rows : 0);
+  for (size_t i = 0; i < selected; ++i) {
+    // metrics are read from columns, targets of the list do not calculate rates
+    size_t index = targets->Order[i];
+    const Process_stat *stat = targets->Stats[index];
+    bool sampled = index < metrics->Count;
+    snprintf(line,
+             width,
+             "%-9d %-20.20s %-10.10s %13.3f %13.3f %13.3f %13.3f",
+             stat->Pid,
+             stat->Process_name ? stat->Process_name : "",
+             targets->Alive[index] ? stat->State_fullname : "Gone",
+             sampled ? metrics->Values[TARGET_COLUMN_CPU][index] : 0.0,
+             sampled ? metrics->Values[TARGET_COLUMN_MEMORY][index] : 0.0,
+             sampled ? metrics->Values[TARGET_COLUMN_DISK_READ][index] : 0.0,
+             sampled ? metrics->Values[TARGET_COLUMN_DISK_WRITE][index] : 0.0);
+    put_text(win, cursY++, loffsetX, DEFAULT_PAIR, line);
+  }
+
+  draw_menu(win, x, y, MENU_TABLE);
+  end_frame(win);
+}
+
+void Window_draw_host_top(Window *win, const Host_top *top)
+{
+  int x, y;
+  terminal_size(&x, &y);
+  begin_frame(win, y, x);
+
+  int loffsetX = 4,     // left offset X position
+      cursY = 0,        // cursor Y position
+      rows = y - 2 - 3; // rows for processes, without the summary, the column names and the menu
+  char line[PANEL_LINE_SIZE], columns[TARGET_COLUMNS_COUNT][32];
+  size_t width = x - loffsetX < PANEL_LINE_SIZE ? (size_t) (x - loffsetX) : PANEL_LINE_SIZE;
+  if (x <= loffsetX || rows <= 0) {
+    end_frame(win);
+    return;
+  }
+
+  // metrics are named as sorted columns of the table of targets
+  for (int i = 0; i < TARGET_COLUMNS_COUNT; ++i)
+    snprintf(columns[i],
+             sizeof(columns[i]),
+             "%s%s",
+             Target_sort_name((Target_sort) (TARGET_SORT_CPU + i)),
+             (Target_column) i != top->Sort ? "" : " v");
+  snprintf(line,
+           width,
+           "Processes: %zu, top %zu by %s ",
+           top->Count,
+           top->Size,
+           Target_sort_name((Target_sort) (TARGET_SORT_CPU + top->Sort)));
+  put_text(win, cursY++, 0, HEADER_PAIR, line);
+  snprintf(line,
+           width,
+           "Total CPU: %.3f%%, memory: %.3f MB, read: %.3f MB/s, write: %.3f MB/s",
+           top->Sums[TARGET_COLUMN_CPU],
+           top->Sums[TARGET_COLUMN_MEMORY],
+           top->Sums[TARGET_COLUMN_DISK_READ],
+           top->Sums[TARGET_COLUMN_DISK_WRITE]);
+  put_text(win, cursY++, 0, DEFAULT_PAIR, line);
+
+  snprintf(line,
+           width,
+           "%-9s %-20s %-10s %13s %13s %13s %13s",
+           Target_sort_name(TARGET_SORT_PID),
+           Target_sort_name(TARGET_SORT_NAME),
+           "STATE",
+           columns[TARGET_COLUMN_CPU],
+           columns[TARGET_COLUMN_MEMORY],
+           columns[TARGET_COLUMN_DISK_READ],
+           columns[TARGET_COLUMN_DISK_WRITE]);
+  put_text(win, cursY++, loffsetX, HEADER_PAIR, line);
+
+  // the selected row is always visible
+  size_t first = top->Selected >= (size_t) rows ? top->Selected - (size_t) rows + 1 : 0;
+  for (size_t row = first; row < top->Top_count && row < first + (size_t) rows; ++row) {
+    const Host_process *process = &top->Processes[top->Top[row]];
+    snprintf(line,
+             width,
+             "%-9d %-20.20s %-10c %13.3f %13.3f %13.3f %13.3f",
+             process->Pid,
+             process->Name,
+             process->State,
+             process->Values[TARGET_COLUMN_CPU],
+             process->Values[TARGET_COLUMN_MEMORY],
+             process->Values[TARGET_COLUMN_DISK_READ],
+             process->Values[TARGET_COLUMN_DISK_WRITE]);
+    put_text(win, cursY++, loffsetX, row == top->Selected ? HEADER_PAIR : DEFAULT_PAIR, line);
+  }
+
+  draw_menu(win, x, y, MENU_TOP);
+  end_frame(win);
+}
 
+bool Window_refresh(Window *win, Process_stat *proc_stat)
+{
   char *errormsg = NULL;
   if (!Process_stat_update(proc_stat, &errormsg)) {
+    clear();
     printw("%s\n", errormsg);
     printf("%s\n", errormsg);
     free(errormsg);
     return false;
   }
-  draw_CPU_usage(win, proc_stat, x, y);
-  draw_process_info(win, proc_stat, x, y);
-  draw_menu(win, x, y);
+  if (proc_stat->Overhead)
+    Overhead_begin(proc_stat->Overhead, OVERHEAD_RENDER);
+  Window_add_sample(win, proc_stat);
+  Window_draw(win, proc_stat);
+  if (proc_stat->Overhead)
+    Overhead_end(proc_stat->Overhead, OVERHEAD_RENDER);
 
   return true;
 }
 
+void Window_toggle_quantiles(Window *win)
+{
+  win->Lifetime_quantiles = !win->Lifetime_quantiles;
+}
+
+void Window_next_panel(Window *win)
+{
+  win->Panel = (Window_panel) ((win->Panel + 1) % WINDOW_PANELS_COUNT);
+}
+
 void Window_destroy(Window *win)
 {
   endwin(); // remove ncurses WINDOW
+  delscreen((SCREEN *) win->__screen);
+#ifdef __linux__
+  if (win->__io_fd != -1)
+    close(win->__io_fd);
+#endif
 
+  free(win->__cells);
+  free(win->__prev);
+  free(win->__run);
   free(win);
 }
@@ -7,31 +7,184 @@
 #include <curses.h>
 #endif
 #include "../include/process.h"
+#include "../include/metrics.h"
+#include "targets.h"
+#include "hosttop.h"
 #include <stdbool.h>
+#include <stddef.h>
+
+#define WINDOW_GRAPH_CAPACITY 512 // number of samples in the history of the graph, the maximal width of the graph
+#define WINDOW_MAX_GRAPHS 8       // maximal number of graphs
+
+/**
+ * @brief Window_panel
+ * The panel shown below the process information.
+ */
+typedef enum
+{
+  WINDOW_PANEL_FILES,
+  WINDOW_PANEL_SOCKETS,
+  WINDOW_PANEL_NUMA,
+  WINDOW_PANELS_COUNT
+} Window_panel;
+
+/**
+ * @brief Window_graph
+ * The sparkline of one metric drawn from raw points of the history of the process (Process_stat.History), the graph
+ * does not keep its own copy of values. Every new point is converted to its column (one of ASCII levels '_.:-=+*#')
+ * once, when it is appended to the history, so drawing only copies the last columns. Columns are recomputed from the
+ * history only if the scale changes: when the new point exceeds the maximum or the maximum leaves the history.
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
+ */
+typedef struct
+{
+  Metric_id Metric; //! The metric
+  double Scale;     //! The fixed maximum of the graph or 0, if the maximum of the history is used
+  size_t Count;     //! Number of points of the history in the graph
+
+  // private fields
+  char __columns[WINDOW_GRAPH_CAPACITY]; // ring of columns of points
+  size_t __head;                         // index of the next column
+  double __max;                          // the current scale
+  size_t __max_age;                      // age of the maximum in the history
+  unsigned long long __samples;          // number of samples of the history converted to columns
+} Window_graph;
 
 /**
  @brief Window
- * Stores the pointer to the main window on the terminal;.
+ * Stores the pointer to the main window on the terminal, the current panel and the status line.
+ *
+ * Every frame is composed into the grid of cells and compared with the previous frame, only changed cells are passed
+ * to ncurses, so the terminal receives the minimal update instead of the full repaint. Bytes written to the terminal
+ * are counted by the 'wchar' counter of the drawing thread (only on Linux, otherwise they are zero).
+ * Also, this structure contains private fields with the '__' prefix. Do not use it.
  */
 typedef struct
 {
+  Window_panel Panel;                //! The current panel
+  bool Lifetime_quantiles;           //! Percentiles of the whole watching are drawn instead of the windowed view
+  bool Read_only;                    //! The process cannot be killed (for example, in replay)
+  char Status[256];                  //! The status line above the menu (empty, if not shown)
+  unsigned long long Frames_count;   //! Number of drawn frames
+  unsigned long long Frame_cells;    //! Number of cells changed by the last frame
+  unsigned long long Frame_bytes;    //! Bytes written to the terminal by the last frame
+  unsigned long long Total_bytes;    //! Bytes written to the terminal by all frames
+  Window_graph Graphs[WINDOW_MAX_GRAPHS]; //! Sparklines below the process information
+  size_t Graphs_count;                    //! Number of sparklines
   WINDOW* __p;
+  void* __screen; // the ncurses screen (SCREEN*)
+  void* __cells;  // the composed frame
+  void* __prev;   // the previous frame on the terminal
+  char* __run;    // changed cells of one row
+  int __rows;     // rows of frames
+  int __cols;     // columns of frames
+  int __io_fd;    // '/proc/thread-self/io' of the thread, which initialized the window
+  long __io_tid;  // the thread of the descriptor
 } Window;
 
 /**
  * @brief Window_init
- * Initializes the new Window structure with default values.
+ * Initializes the new Window structure with default values on the terminal of the standard streams.
  * @return The pointer to the structure
  */
 DECLFUNC Window* Window_init() ATTR(warn_unused_result);
+/**
+ * @brief Window_open
+ * Initializes the new Window structure on the terminal of the passed streams.
+ * @param term The terminal type or NULL to use the 'TERM' environment variable
+ * @param output The output stream of the terminal
+ * @param input The input stream of the terminal
+ * @return The pointer to the structure
+ */
+DECLFUNC Window* Window_open(const char* term, FILE* output, FILE* input) ATTR(warn_unused_result) ATTR(nonnull(2, 3));
+/**
+ * @brief Window_add_graph
+ * Adds the sparkline of the metric to the window. By default, the window has graphs of CPU, memory and disk rates.
+ * @param win The pointer to the Window structure
+ * @param metric The metric
+ * @param scale The fixed maximum of the graph or 0 to scale by the maximum of the history
+ * @return false, if the window has WINDOW_MAX_GRAPHS graphs
+ */
+DECLFUNC bool Window_add_graph(Window* win, Metric_id metric, double scale) ATTR(nonnull(1));
+/**
+ * @brief Window_add_sample
+ * Adds new points of the history of the Process_stat structure to graphs of the window. Called for every new sample.
+ * @param win The pointer to the Window structure
+ * @param proc_stat The pointer to the Process_stat structure
+ */
+DECLFUNC void Window_add_sample(Window* win, const Process_stat* proc_stat) ATTR(nonnull(1, 2));
+/**
+ * @brief Window_graph_init
+ * Initializes the empty graph.
+ * @param graph The pointer to the graph
+ * @param metric The metric
+ * @param scale The fixed maximum of the graph or 0 to scale by the maximum of the history
+ */
+DECLFUNC void Window_graph_init(Window_graph* graph, Metric_id metric, double scale) ATTR(nonnull(1));
+/**
+ * @brief Window_graph_update
+ * Converts points appended to the history since the previous update to columns of the graph. If the history is reset,
+ * the graph is built again.
+ * @param graph The pointer to the graph
+ * @param history The history of metrics
+ */
+DECLFUNC void Window_graph_update(Window_graph* graph, const Timeseries* history) ATTR(nonnull(1, 2));
+/**
+ * @brief Window_graph_render
+ * Stores the last columns of the graph into the buffer, the newest sample is the rightmost column. If the history is
+ * shorter than the width, the graph is padded by spaces on the left.
+ * @param graph The pointer to the graph
+ * @param buf The buffer with at least 'width + 1' characters
+ * @param width Width of the graph, it is limited by WINDOW_GRAPH_CAPACITY
+ * @return Width of the rendered graph
+ */
+DECLFUNC size_t Window_graph_render(const Window_graph* graph, char* buf, size_t width) ATTR(nonnull(1, 2));
+/**
+ * @brief Window_draw_table
+ * Draws the table of many targets in their sorted order instead of the information about one process. Only targets,
+ * which fit the rows of the table, are selected by Target_list_select.
+ * @param win The pointer to the Window structure
+ * @param targets The pointer to the list of targets
+ */
+DECLFUNC void Window_draw_table(Window* win, Target_list* targets) ATTR(nonnull(1, 2));
+/**
+ * @brief Window_draw_host_top
+ * Draws the top of processes of the host, the selected process is highlighted.
+ * @param win The pointer to the Window structure
+ * @param top The pointer to the top of processes
+ */
+DECLFUNC void Window_draw_host_top(Window* win, const Host_top* top) ATTR(nonnull(1, 2));
 /**
  * @brief Window_refresh
- * Refresh the main window with data.
+ * Updates the Process_stat structure, adds the new sample to graphs and refreshes the main window with data. If the
+ * overhead of the Process_stat structure is measured, graphs and drawing are measured by its render probe.
  * @param win The pointer to the Window structure
  * @param proc_stat The pointer to the Process_stat structure
  * @return The result of updating
  */
 DECLFUNC bool Window_refresh(Window* win, Process_stat* proc_stat) ATTR(nonnull(1, 2));
+/**
+ * @brief Window_draw
+ * Draws the main window with the current data, without updating the Process_stat structure. Only cells changed since
+ * the previous frame are updated on the terminal. If the overhead is measured, costs of the last tick are drawn in the
+ * footer above the status line.
+ * @param win The pointer to the Window structure
+ * @param proc_stat The pointer to the Process_stat structure
+ */
+DECLFUNC void Window_draw(Window* win, Process_stat* proc_stat) ATTR(nonnull(1, 2));
+/**
+ * @brief Window_toggle_quantiles
+ * Switches percentiles of the window between the windowed view and the lifetime view. The view will be drawn on the
+ * next refresh.
+ * @param win The pointer to the Window structure
+ */
+DECLFUNC void Window_toggle_quantiles(Window* win) ATTR(nonnull(1));
+/**
+ * @brief Window_next_panel
+ * Switches the window to the next panel. The panel will be drawn on the next refresh.
+ * @param win The pointer to the Window structure
+ */
+DECLFUNC void Window_next_panel(Window* win) ATTR(nonnull(1));
 /**
  * @brief Window_destroy
  * Deletes the Window structure.
@@ -0,0 +1,37 @@
+#include "testing-globals.h"
+
+#include "adaptive.h"
+
+TEST_CASE(Adaptive_rate, AdaptiveRateUsage)
+{
+  Adaptive_rate *rate = Adaptive_rate_init(100, 1000, 5000);
+  CHECK_EQ(rate->Interval_ms, 1000L); // limited by bounds
+
+  Process_stat *stat = Process_stat_init();
+  // the first sample has nothing to compare, the quiet process backs off to the maximum
+  CHECK_EQ(Adaptive_rate_update(rate, stat), 1000L);
+
+  // the burst of CPU falls to the minimum at once
+  stat->Cpu_usage = 50.0;
+  CHECK_EQ(Adaptive_rate_update(rate, stat), 100L);
+
+  // the stable load is quiet, the interval is doubled
+  CHECK_EQ(Adaptive_rate_update(rate, stat), 200L);
+  CHECK_EQ(Adaptive_rate_update(rate, stat), 400L);
+
+  // disk rates and the resident memory are watched too
+  stat->Disk_write_mb_usage = 10.0;
+  CHECK_EQ(Adaptive_rate_update(rate, stat), 100L);
+  CHECK_EQ(Adaptive_rate_update(rate, stat), 200L);
+  stat->Memory_usage += 0.5; // below the threshold
+  CHECK_EQ(Adaptive_rate_update(rate, stat), 400L);
+  stat->Memory_usage += 64.0;
+  CHECK_EQ(Adaptive_rate_update(rate, stat), 100L);
+
+  for (int i = 0; i < 10; ++i)
+    Adaptive_rate_update(rate, stat);
+  CHECK_EQ(rate->Interval_ms, 1000L);
+
+  Process_stat_free(stat);
+  Adaptive_rate_free(rate);
+}
@@ -0,0 +1,70 @@
+#include "testing-globals.h"
+
+#include "batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// reads the line with the index from the file
+static void read_line(const char *path, int index, char *buf, int size)
+{
+  FILE *file = fopen(path, "r");
+  assert(file != NULL);
+  for (int i = 0; i <= index; ++i)
+    assert(fgets(buf, size, file) != NULL);
+  fclose(file);
+}
+
+TEST_CASE(Batch, BatchUsage)
+{
+  const char *testfilename = "testbatch.out";
+  char *errormsg = NULL;
+  char line[BATCH_LINE_SIZE];
+  double values[METRIC_COUNT];
+  memset(values, 0, sizeof(values));
+  values[METRIC_CPU_USAGE] = 12.5;
+  values[METRIC_MEMORY_USAGE] = 1024.0;
+  values[METRIC_DISK_READ_MB_USAGE] = 0.0004; // rounded to zero
+  values[METRIC_PRIORITY] = -5.0;
+  values[METRIC_DISK_READ_KB] = 123456789.0;
+
+  CHECK_EQ(Batch_format_parse("csv"), BATCH_CSV);
+  CHECK_EQ(Batch_format_parse("json"), BATCH_NDJSON);
+  CHECK_EQ(Batch_format_parse("xml"), BATCH_NONE);
+
+  {
+    Batch_writer *writer = Batch_writer_open(testfilename, BATCH_CSV, &errormsg);
+    CHECK_NE(writer, NULL);
+    CHECK_EQ(errormsg, NULL);
+    for (int i = 0; i < 1000; ++i)
+      CHECK_EQ(Batch_writer_write(writer, 1700000000000LL + i, values, &errormsg), true);
+    CHECK_EQ(writer->Samples_count, 1000ULL);
+    Batch_writer_close(writer);
+
+    read_line(testfilename, 0, line, sizeof(line));
+    CHECK_EQ(strncmp(line, "time_ms,cpu_usage,memory_usage,", 31), 0);
+    read_line(testfilename, 1, line, sizeof(line));
+    CHECK_STR_EQ(line, "1700000000000,12.5,1024,0,0,123456789,0,-5,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0\n");
+    read_line(testfilename, 1000, line, sizeof(line));
+    CHECK_EQ(strncmp(line, "1700000000999,", 14), 0);
+  }
+  {
+    values[METRIC_CPU_USAGE] = 0.125;
+    Batch_writer *writer = Batch_writer_open(testfilename, BATCH_NDJSON, &errormsg);
+    CHECK_NE(writer, NULL);
+    CHECK_EQ(Batch_writer_write(writer, 1700000000000LL, values, &errormsg), true);
+    Batch_writer_close(writer);
+
+    read_line(testfilename, 0, line, sizeof(line));
+    CHECK_EQ(strncmp(line, "{\"time_ms\":1700000000000,\"cpu_usage\":0.125,\"memory_usage\":1024,", 63), 0);
+    CHECK_NE(strstr(line, "\"priority\":-5,"), NULL);
+    CHECK_NE(strstr(line, "\"thp_usage\":0,"), NULL);
+    CHECK_NE(strstr(line, "\"self_outputs_cpu_ms\":0}\n"), NULL);
+  }
+  remove(testfilename);
+
+  CHECK_EQ(Batch_writer_open("/not/existing/dir/file", BATCH_CSV, &errormsg), NULL);
+  CHECK_STR_NE(errormsg, ""); // not empty
+  free(errormsg);
+}
@@ -1,6 +1,7 @@
 #include "testing-globals.h"
 
 #include "cmdargs.h"
+#include <stdio.h>
 #ifdef __linux__
 #include <unistd.h>
 #elif _WIN32
@@ -38,10 +39,204 @@ TEST_CASE(Cmd_args, CorrectCommandLineArguments)
 
     Cmd_args_free(args);
   }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-numa-interval-ms", (char *) "30000", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_STR_EQ(args->Process_name, "test-process-name");
+    CHECK_EQ(args->Numa_interval_ms, 30000);
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Errormsg, NULL);
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-history-size", (char *) "100", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_STR_EQ(args->Process_name, "test-process-name");
+    CHECK_EQ(args->History_size, 100);
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Errormsg, NULL);
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-quantile-window-min", (char *) "15", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_STR_EQ(args->Process_name, "test-process-name");
+    CHECK_EQ(args->Quantile_window_min, 15);
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Errormsg, NULL);
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 3;
+    char *argv[] = {(char *) ".", (char *) "-replay", (char *) "test.pwr"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Process_name, NULL);
+    CHECK_STR_EQ(args->Replay_path, "test.pwr");
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Errormsg, NULL);
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-record", (char *) "test.pwr", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_STR_EQ(args->Process_name, "test-process-name");
+    CHECK_STR_EQ(args->Record_path, "test.pwr");
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Errormsg, NULL);
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 5;
+    char *argv[] = {
+        (char *) ".", (char *) "-adaptive", (char *) "-adaptive-max-ms", (char *) "2000", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Adaptive, true);
+    CHECK_EQ(args->Adaptive_min_ms, 100);
+    CHECK_EQ(args->Adaptive_max_ms, 2000);
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Errormsg, NULL);
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 6;
+    char *argv[] = {
+        (char *) ".", (char *) "-workers", (char *) "4", (char *) "sshd", (char *) "nginx", (char *) "postgres"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Workers, 4);
+    CHECK_EQ(args->Batched_reads, false);
+    CHECK_EQ(args->Targets_count, 3);
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Errormsg, NULL);
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 5;
+    char *argv[] = {(char *) ".", (char *) "-top", (char *) "20", (char *) "-refresh-timeout-ms", (char *) "500"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Top, 20);
+    CHECK_EQ(args->Process_name, NULL);
+    CHECK_EQ(args->Refresh_timeout_ms, 500);
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Errormsg, NULL);
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 5;
+    char *argv[] = {(char *) ".", (char *) "-proc-reader", (char *) "io_uring", (char *) "sshd", (char *) "nginx"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Batched_reads, true);
+    CHECK_EQ(args->Reader_backend, PROC_READER_IO_URING);
+    CHECK_EQ(args->Valid, true);
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 12;
+    char *argv[] = {(char *) ".",
+                    (char *) "-shm",
+                    (char *) "watcher",
+                    (char *) "-shm-history",
+                    (char *) "60",
+                    (char *) "-batch",
+                    (char *) "json",
+                    (char *) "-output",
+                    (char *) "test.ndjson",
+                    (char *) "-prometheus",
+                    (char *) "unix:/tmp/test.sock",
+                    (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Batch, BATCH_NDJSON);
+    CHECK_STR_EQ(args->Output_path, "test.ndjson");
+    CHECK_STR_EQ(args->Prometheus_address, "unix:/tmp/test.sock");
+    CHECK_STR_EQ(args->Shm_name, "watcher");
+    CHECK_EQ(args->Shm_history_size, 60);
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Errormsg, NULL);
+
+    Cmd_args_free(args);
+  }
+  {
+    const char *testfilename = "test-watch-list.txt";
+    FILE *file = fopen(testfilename, "w");
+    CHECK_NE(file, NULL);
+    fputs("# services\n  nginx  \n\n1234\r\n#42\npostgres", file);
+    fclose(file);
+
+    int argc = 5;
+    char *argv[] = {(char *) ".", (char *) "sshd", (char *) "-watch-list", (char *) testfilename, (char *) "1"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, true);
+    CHECK_EQ(args->Targets_count, 5);
+    CHECK_STR_EQ(args->Process_name, "sshd");
+    CHECK_STR_EQ(args->Targets[1], "1");
+    CHECK_STR_EQ(args->Targets[2], "nginx");
+    CHECK_STR_EQ(args->Targets[3], "1234");
+    CHECK_STR_EQ(args->Targets[4], "postgres");
+    CHECK_STR_EQ(args->Watch_list_path, testfilename);
+
+    Cmd_args_free(args);
+    remove(testfilename);
+  }
 }
 
 TEST_CASE(Cmd_args, IncorrectCommandLineArguments)
 {
+  {
+    int argc = 5;
+    char *argv[] = {(char *) ".", (char *) "-batch", (char *) "csv", (char *) "nginx", (char *) "postgres"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false); // outputs of one process
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 3;
+    char *argv[] = {(char *) ".", (char *) "-watch-list", (char *) "/not/existing/watch-list"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
   {
     int argc = 3;
     char *argv[] = {(char *) ".", (char *) "-refresh-timeout-ms", (char *) "test-process-name"};
@@ -69,6 +264,154 @@ TEST_CASE(Cmd_args, IncorrectCommandLineArguments)
 
     Cmd_args_free(args);
   }
+  {
+    int argc = 6;
+    char *argv[] = {(char *) ".",
+                    (char *) "-adaptive-min-ms",
+                    (char *) "500",
+                    (char *) "-adaptive-max-ms",
+                    (char *) "200",
+                    (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-workers", (char *) "0", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-statsd-mtu", (char *) "100", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false); // lines do not fit datagrams
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-top", (char *) "10", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 5;
+    char *argv[] = {(char *) ".", (char *) "-top", (char *) "10", (char *) "-batch", (char *) "csv"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-proc-reader", (char *) "aio", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-numa-interval-ms", (char *) "0", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-history-size", (char *) "-1", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-quantile-window-min", (char *) "0", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-replay", (char *) "test.pwr", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-batch", (char *) "xml", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 4;
+    char *argv[] = {(char *) ".", (char *) "-output", (char *) "test.csv", (char *) "test-process-name"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
+  {
+    int argc = 2;
+    char *argv[] = {(char *) ".", (char *) "-record"};
+
+    Cmd_args *args = Cmd_args_init(argc, argv);
+    assert(args != NULL);
+    CHECK_EQ(args->Valid, false);
+    CHECK_STR_NE(args->Errormsg, ""); // not empty
+
+    Cmd_args_free(args);
+  }
   {
     int cachefd, fd;
     const char *file;
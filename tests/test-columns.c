@@ -0,0 +1,168 @@
+#include "testing-globals.h"
+
+#include "columns.h"
+#include "targets.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+// sets counters of the target, as they are stored by the update
+static void set_counters(Process_stat *stat, unsigned long long cpu, unsigned long long read, double memory)
+{
+  stat->__last_utime = cpu / 2;
+  stat->__last_stime = cpu - cpu / 2;
+  stat->__last_read_bytes = read;
+  stat->__last_written_bytes = read / 2;
+  stat->Memory_usage = memory;
+}
+
+TEST_CASE(Target_columns, TargetColumnsUsage)
+{
+  Target_columns *columns = Target_columns_init();
+  Process_stat *stats[3] = {Process_stat_init(), Process_stat_init(), Process_stat_init()};
+  bool alive[3] = {true, true, true};
+  Process_tick tick = {1000, 0, 1000, 0};
+
+  set_counters(stats[0], 100, 0, 5.0);
+  set_counters(stats[1], 200, 1000000, 7.0);
+  Target_columns_update(columns, stats, alive, 2, &tick);
+  CHECK_EQ(columns->Count, (size_t) 2);
+  CHECK_EQ(columns->Alive, (size_t) 2);
+  CHECK_EQ(columns->Sums[TARGET_COLUMN_CPU], 0.0); // no previous tick
+  CHECK_EQ(columns->Sums[TARGET_COLUMN_MEMORY], 12.0);
+  CHECK_EQ(columns->Maxima[TARGET_COLUMN_MEMORY], 7.0);
+
+  // 2 seconds and 1000 ticks of CPU later, the second target has exited and the third one is new
+  tick.Cpu_total = 2000;
+  tick.Monotime_ms = 3000;
+  set_counters(stats[0], 160, 4000000, 6.0);
+  set_counters(stats[2], 500, 8000000, 1.0);
+  alive[1] = false;
+  Target_columns_update(columns, stats, alive, 3, &tick);
+  CHECK_EQ(columns->Count, (size_t) 3);
+  CHECK_EQ(columns->Alive, (size_t) 2);
+  CHECK_EQ(columns->Values[TARGET_COLUMN_CPU][0], 6.0);
+  CHECK_EQ(columns->Values[TARGET_COLUMN_DISK_READ][0], 2.0);
+  CHECK_EQ(columns->Values[TARGET_COLUMN_DISK_WRITE][0], 1.0);
+  CHECK_EQ(columns->Values[TARGET_COLUMN_CPU][1], 0.0);    // exited
+  CHECK_EQ(columns->Values[TARGET_COLUMN_MEMORY][1], 0.0); // exited
+  CHECK_EQ(columns->Values[TARGET_COLUMN_CPU][2], 0.0);    // new
+  CHECK_EQ(columns->Values[TARGET_COLUMN_MEMORY][2], 1.0);
+  CHECK_EQ(columns->Sums[TARGET_COLUMN_MEMORY], 7.0);
+  CHECK_EQ(columns->Maxima[TARGET_COLUMN_CPU], 6.0);
+
+  // the third target has rates with the next tick
+  tick.Cpu_total = 3000;
+  tick.Monotime_ms = 4000;
+  set_counters(stats[2], 600, 9000000, 1.0);
+  Target_columns_update(columns, stats, alive, 3, &tick);
+  CHECK_EQ(columns->Values[TARGET_COLUMN_CPU][0], 0.0);
+  CHECK_EQ(columns->Values[TARGET_COLUMN_CPU][2], 10.0);
+  CHECK_EQ(columns->Values[TARGET_COLUMN_DISK_READ][2], 1.0);
+  CHECK_EQ(columns->Sums[TARGET_COLUMN_DISK_READ], 1.0);
+
+  size_t top[3];
+  CHECK_EQ(Target_columns_top(columns, TARGET_COLUMN_MEMORY, true, 3, top), (size_t) 2); // only alive targets
+  CHECK_EQ(top[0], (size_t) 0);
+  CHECK_EQ(top[1], (size_t) 2);
+  CHECK_EQ(Target_columns_top(columns, TARGET_COLUMN_CPU, true, 1, top), (size_t) 1);
+  CHECK_EQ(top[0], (size_t) 2);
+  CHECK_EQ(Target_columns_top(columns, TARGET_COLUMN_CPU, false, 1, top), (size_t) 1); // the smallest value
+  CHECK_EQ(top[0], (size_t) 0);
+  CHECK_EQ(Target_columns_top(columns, TARGET_COLUMNS_COUNT, true, 1, top), (size_t) 0);
+  CHECK_EQ(Target_columns_top(columns, TARGET_COLUMN_CPU, true, 0, top), (size_t) 0);
+
+  for (int i = 0; i < 3; ++i)
+    Process_stat_free(stats[i]);
+  Target_columns_free(columns);
+}
+
+TEST_CASE(Target_columns, TargetColumnsTop)
+{
+  Target_columns *columns = Target_columns_init();
+  const size_t count = 100;
+  Process_stat **stats = malloc(sizeof(Process_stat *) * count);
+  bool *alive = malloc(sizeof(bool) * count);
+  Process_tick tick = {1000, 0, 1000, 0};
+  for (size_t i = 0; i < count; ++i) {
+    stats[i] = Process_stat_init();
+    alive[i] = true;
+    set_counters(stats[i], 0, 0, (double) ((i * 37) % count)); // all values from 0 to 99 in the mixed order
+  }
+  stats[3]->Memory_usage = 99.0; // the same value as the target 27, the smaller index is first
+  Target_columns_update(columns, stats, alive, count, &tick);
+
+  size_t top[5];
+  CHECK_EQ(Target_columns_top(columns, TARGET_COLUMN_MEMORY, true, 5, top), (size_t) 5);
+  CHECK_EQ(top[0], (size_t) 3);
+  CHECK_EQ(top[1], (size_t) 27);
+  for (size_t i = 2; i < 5; ++i)
+    CHECK_EQ(columns->Values[TARGET_COLUMN_MEMORY][top[i]], (double) (100 - i));
+  // the ascending order, equal values are selected in the ascending order of indices too
+  stats[5]->Memory_usage = 0.0; // the same value as the target 0
+  Target_columns_update(columns, stats, alive, count, &tick);
+  CHECK_EQ(Target_columns_top(columns, TARGET_COLUMN_MEMORY, false, 5, top), (size_t) 5);
+  CHECK_EQ(top[0], (size_t) 0);
+  CHECK_EQ(top[1], (size_t) 5);
+  for (size_t i = 2; i < 5; ++i)
+    CHECK_EQ(columns->Values[TARGET_COLUMN_MEMORY][top[i]], (double) (i - 1));
+
+  // without the mask, all elements are selected
+  const double values[6] = {3.0, 9.0, 1.0, 9.0, 4.0, 0.0};
+  CHECK_EQ(Columns_top(values, NULL, 6, 3, top), (size_t) 3);
+  CHECK_EQ(top[0], (size_t) 1);
+  CHECK_EQ(top[1], (size_t) 3);
+  CHECK_EQ(top[2], (size_t) 4);
+  CHECK_EQ(Columns_top(values, NULL, 2, 5, top), (size_t) 2);
+
+  for (size_t i = 0; i < count; ++i)
+    Process_stat_free(stats[i]);
+  free(stats);
+  free(alive);
+  Target_columns_free(columns);
+}
+
+TEST_CASE(Target_columns, TargetColumnsOfTargetList)
+{
+#ifdef __linux__
+  // targets of the list store only counters, their rates are calculated only by columns
+  char *errormsg = NULL;
+  char self[16];
+  snprintf(self, sizeof(self), "%d", getpid());
+  Target_list *targets = Target_list_init();
+  CHECK_NE(Target_list_add(targets, self, &errormsg), NULL);
+  CHECK_NE(Target_list_add(targets, self, &errormsg), NULL);
+  CHECK_EQ(targets->Stats[0]->Counters_only, true);
+  double cpu_time[2] = {0.0, 0.0}, cpu_total = 0.0;
+  for (int tick = 0; tick < 3; ++tick) {
+    volatile double work = 0.0;
+    for (int i = 0; i < 1000000; ++i)
+      work += sqrt((double) i);
+    for (size_t i = 0; i < 2; ++i)
+      cpu_time[i] = (double) (targets->Stats[i]->__last_utime + targets->Stats[i]->__last_stime);
+    cpu_total = (double) targets->Tick.Cpu_total;
+    CHECK_EQ(Target_list_update(targets, &errormsg), (size_t) 2);
+  }
+  CHECK_EQ(errormsg, NULL);
+  const Target_columns *columns = targets->Columns;
+  CHECK_EQ(columns->Alive, (size_t) 2);
+  cpu_total = (double) targets->Tick.Cpu_total - cpu_total;
+  for (size_t i = 0; i < 2; ++i) {
+    const Process_stat *stat = targets->Stats[i];
+    double cpu_delta = (double) (stat->__last_utime + stat->__last_stime) - cpu_time[i];
+    double cpu = cpu_total > 0.0 ? cpu_delta * 100.0 / cpu_total : 0.0;
+    CHECK_LT(fabs(columns->Values[TARGET_COLUMN_CPU][i] - cpu), 1e-9);
+    CHECK_EQ(stat->Cpu_usage, 0.0);
+    CHECK_EQ(stat->Disk_read_mb_usage, 0.0);
+    CHECK_LT(fabs(columns->Values[TARGET_COLUMN_MEMORY][i] - stat->Memory_usage), 1e-9);
+  }
+  CHECK_LT(fabs(columns->Sums[TARGET_COLUMN_MEMORY] - targets->Stats[0]->Memory_usage -
+                targets->Stats[1]->Memory_usage),
+           1e-9);
+  Target_list_free(targets);
+#endif
+}
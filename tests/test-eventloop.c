@@ -0,0 +1,82 @@
+#include "testing-globals.h"
+
+#include "eventloop.h"
+#include "ioutils.h"
+
+#include <stdlib.h>
+#ifdef __linux__
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+TEST_CASE(Event_loop, EventLoopUsage)
+{
+#ifdef __linux__
+  int fds[2];
+  assert(pipe(fds) == 0);
+  char* errormsg = NULL;
+  Event_loop* loop = Event_loop_init(fds[0], 20, &errormsg);
+  CHECK_NE(loop, NULL);
+  CHECK_EQ(errormsg, NULL);
+
+  // the idle loop wakes up on ticks only
+  CHECK_EQ(Event_loop_wait(loop), (int) EVENT_LOOP_TICK);
+  CHECK_EQ(loop->Ticks_count, 1ULL);
+  CHECK_EQ(loop->Wakeups_count, 1ULL);
+  CHECK_EQ(loop->Missed_ticks, 0ULL);
+
+  // the busy loop misses deadlines, the next tick is scheduled in the future
+  usleep(110 * 1000);
+  CHECK_EQ(Event_loop_wait(loop), (int) EVENT_LOOP_TICK);
+  CHECK_EQ(loop->Ticks_count, 2ULL);
+  CHECK_GE(loop->Missed_ticks, 4ULL);
+  CHECK_GE(loop->Max_lateness_us, 80000LL);
+  unsigned long long ticks = 0;
+  for (int i = 0; i < EVENT_LOOP_LATENESS_BUCKETS; ++i)
+    ticks += loop->Lateness_us[i];
+  CHECK_EQ(ticks, 2ULL);
+  CHECK_LT(Event_loop_lateness_us(loop, 0.0), Event_loop_lateness_us(loop, 1.0));
+  CHECK_GE(Event_loop_lateness_us(loop, 1.0), 65536LL);
+
+  // the changed interval moves the next deadline
+  Event_loop_set_interval(loop, 5);
+  CHECK_EQ(Event_loop_interval(loop), 5L);
+  long long begin = monotime_ms();
+  CHECK_EQ(Event_loop_wait(loop), (int) EVENT_LOOP_TICK);
+  CHECK_EQ(Event_loop_wait(loop), (int) EVENT_LOOP_TICK);
+  CHECK_LT(monotime_ms() - begin, 35LL); // two ticks of the old interval take 40 ms
+  Event_loop_set_interval(loop, 20);
+
+  // the input is reported at once
+  char ch = 'q';
+  assert(write(fds[1], &ch, 1) == 1);
+  CHECK_NE((Event_loop_wait(loop) & EVENT_LOOP_INPUT), 0);
+  assert(read(fds[0], &ch, 1) == 1);
+
+  // signals are read from the loop instead of handlers
+  raise(SIGWINCH);
+  CHECK_NE((Event_loop_wait(loop) & EVENT_LOOP_RESIZE), 0);
+  raise(SIGTERM);
+  CHECK_NE((Event_loop_wait(loop) & EVENT_LOOP_EXIT), 0);
+
+  // the exit of the watched process is reported once
+  pid_t child = fork();
+  if (child == 0) {
+    usleep(50 * 1000);
+    _exit(0);
+  }
+  if (Event_loop_watch_pid(loop, child)) {
+    int events = 0;
+    for (int i = 0; i < 100 && !(events & EVENT_LOOP_PROCESS_EXIT); ++i)
+      events = Event_loop_wait(loop);
+    CHECK_NE((events & EVENT_LOOP_PROCESS_EXIT), 0);
+    CHECK_EQ((Event_loop_wait(loop) & EVENT_LOOP_PROCESS_EXIT), 0);
+  }
+  waitpid(child, NULL, 0);
+
+  Event_loop_free(loop);
+  close(fds[0]);
+  close(fds[1]);
+#endif
+}
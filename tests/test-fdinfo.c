@@ -0,0 +1,79 @@
+#include "testing-globals.h"
+
+#include "fdinfo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <fcntl.h>
+#include <limits.h>
+#endif
+
+#ifdef __linux__
+TEST_CASE(Fdinfo, FdListUsage)
+{
+  const char *testfilename = "testfdinfo.txt";
+  {
+    FILE *testfile = fopen(testfilename, "w");
+    assert(testfile != NULL);
+    for (int i = 0; i < 4096; ++i)
+      assert(fprintf(testfile, "%s", "0123456789abcdef") > 0);
+    assert(fclose(testfile) == 0);
+  }
+  char fullpath[PATH_MAX];
+  assert(realpath(testfilename, fullpath) != NULL);
+
+  int fd = open(testfilename, O_RDONLY);
+  assert(fd != -1);
+  char buf[4096];
+  assert(read(fd, buf, sizeof(buf)) == sizeof(buf));
+
+  Fd_list *list = Fd_list_init();
+  CHECK_NE(list, NULL);
+  CHECK_EQ(list->Count, 0);
+
+  char *errormsg = NULL;
+  CHECK_EQ(Fd_list_update(list, getpid(), &errormsg), true);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_GT(list->Count, 0);
+  {
+    const Fd_entry *entry = Fd_list_find(list, fd);
+    CHECK_NE(entry, NULL);
+    if (entry) {
+      CHECK_STR_EQ(entry->Target, fullpath);
+      CHECK_EQ(entry->Pos, 4096);
+      int accmode = entry->Flags & O_ACCMODE;
+      CHECK_EQ(accmode, O_RDONLY);
+      CHECK_EQ(entry->Size, 4096 * 16);
+      CHECK_EQ(entry->Rate_mb_usage, 0.0);
+      CHECK_EQ(entry->Eta_sec, -1);
+    }
+  }
+
+  usleep(100 * 1000);
+  assert(read(fd, buf, sizeof(buf)) == sizeof(buf));
+  CHECK_EQ(Fd_list_update(list, getpid(), &errormsg), true);
+  {
+    const Fd_entry *entry = Fd_list_find(list, fd);
+    CHECK_NE(entry, NULL);
+    if (entry) {
+      CHECK_EQ(entry->Pos, 8192);
+      CHECK_GT(entry->Rate_mb_usage, 0.0);
+      CHECK_GE(entry->Eta_sec, 0);
+    }
+  }
+
+  close(fd);
+  CHECK_EQ(Fd_list_update(list, getpid(), &errormsg), true);
+  if (Fd_list_find(list, fd) != NULL)
+    CHECK_STR_NE(Fd_list_find(list, fd)->Target, fullpath);
+
+  // process not found
+  CHECK_EQ(Fd_list_update(list, -1, &errormsg), false);
+  CHECK_NE(errormsg, NULL);
+  free(errormsg);
+
+  Fd_list_free(list);
+  remove(testfilename);
+}
+#endif
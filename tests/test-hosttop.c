@@ -0,0 +1,74 @@
+#include "testing-globals.h"
+
+#include "hosttop.h"
+
+#include <math.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+TEST_CASE(Host_top, HostTopOfProcesses)
+{
+#ifdef __linux__
+  char *errormsg = NULL;
+  Host_top *top = Host_top_init(5);
+  CHECK_EQ(Host_top_selected(top), NULL);
+  for (int tick = 0; tick < 2; ++tick) {
+    volatile double work = 0.0;
+    for (int i = 0; i < 1000000; ++i)
+      work += sqrt((double) i);
+    CHECK_EQ(Host_top_update(top, &errormsg), true);
+  }
+  CHECK_EQ(errormsg, NULL);
+  CHECK_GT(top->Count, (size_t) 0);
+  CHECK_GT(top->Syscalls, 0ULL);
+
+  // processes are in the order of PIDs, the watcher itself is found with its rates
+  const Host_process *self = NULL;
+  for (size_t i = 0; i < top->Count; ++i) {
+    if (i > 0) {
+      CHECK_LT(top->Processes[i - 1].Pid, top->Processes[i].Pid);
+    }
+    if (top->Processes[i].Pid == getpid())
+      self = &top->Processes[i];
+  }
+  CHECK_NE(self, NULL);
+  if (self) {
+    CHECK_GT(self->Start_time, 0ULL);
+    CHECK_GT(self->Values[TARGET_COLUMN_MEMORY], 0.0);
+    CHECK_GE(self->Values[TARGET_COLUMN_CPU], 0.0);
+    CHECK_NE(self->Name[0], '\0');
+  }
+
+  // the top is in the descending order and it contains the largest values
+  CHECK_EQ(top->Top_count, (top->Count < 5 ? top->Count : (size_t) 5));
+  for (size_t row = 1; row < top->Top_count; ++row)
+    CHECK_GE(top->Processes[top->Top[row - 1]].Values[TARGET_COLUMN_CPU],
+             top->Processes[top->Top[row]].Values[TARGET_COLUMN_CPU]);
+  double smallest = top->Processes[top->Top[top->Top_count - 1]].Values[TARGET_COLUMN_CPU];
+  size_t larger = 0;
+  for (size_t i = 0; i < top->Count; ++i)
+    larger += top->Processes[i].Values[TARGET_COLUMN_CPU] > smallest ? 1 : 0;
+  CHECK_LT(larger, top->Top_count);
+
+  // the selection stays in the top and follows the process
+  CHECK_EQ(top->Selected, (size_t) 0);
+  Host_top_move(top, -1);
+  CHECK_EQ(top->Selected, (size_t) 0);
+  Host_top_move(top, 100);
+  CHECK_EQ(top->Selected, top->Top_count - 1);
+  CHECK_EQ(Host_top_selected(top)->Pid, top->Selected_pid);
+
+  Host_top_sort(top, TARGET_COLUMN_MEMORY);
+  CHECK_EQ(top->Sort, TARGET_COLUMN_MEMORY);
+  for (size_t row = 1; row < top->Top_count; ++row)
+    CHECK_GE(top->Processes[top->Top[row - 1]].Values[TARGET_COLUMN_MEMORY],
+             top->Processes[top->Top[row]].Values[TARGET_COLUMN_MEMORY]);
+  Host_top_sort(top, TARGET_COLUMNS_COUNT); // CPU usage
+  CHECK_EQ(top->Sort, TARGET_COLUMN_CPU);
+
+  free(errormsg);
+  Host_top_free(top);
+#endif
+}
@@ -210,3 +210,36 @@ TEST_CASE(String, UnsignedLongLongToString)
     free(number);
   }
 }
+
+#ifdef __linux__
+TEST_CASE(File, DirReader)
+{
+  Dir_reader *reader = Dir_reader_init();
+  CHECK_NE(reader, NULL);
+  CHECK_EQ(reader->Fd, -1);
+  CHECK_EQ(Dir_reader_next(reader), NULL);
+
+  CHECK_EQ(Dir_reader_open(reader, "/proc/self/fd"), true);
+  {
+    int count = 0;
+    bool stdin_found = false;
+    const char *name;
+    while ((name = Dir_reader_next(reader)) != NULL) {
+      CHECK_STR_NE(name, ".");
+      CHECK_STR_NE(name, "..");
+      if (strcmp(name, "0") == 0)
+        stdin_found = true;
+      ++count;
+    }
+    CHECK_GT(count, 0);
+    CHECK_EQ(stdin_found, true);
+  }
+  Dir_reader_close(reader);
+  CHECK_EQ(reader->Fd, -1);
+
+  CHECK_EQ(Dir_reader_open(reader, "/not/existing/directory"), false);
+  CHECK_EQ(Dir_reader_next(reader), NULL);
+
+  Dir_reader_free(reader);
+}
+#endif
@@ -0,0 +1,51 @@
+#include "testing-globals.h"
+
+#include "numa.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+TEST_CASE(Numa, NumaStatUsage)
+{
+  // touch some anonymous memory
+  size_t size = 8 * 1024 * 1024;
+  char *memory = malloc(size);
+  assert(memory != NULL);
+  memset(memory, 1, size);
+
+  Numa_stat *stat = Numa_stat_init(60 * 1000);
+  CHECK_NE(stat, NULL);
+  CHECK_GE(stat->Nodes_count, 1);
+  CHECK_EQ(stat->Updates, 0);
+
+  char *errormsg = NULL;
+  CHECK_EQ(Numa_stat_update(stat, getpid(), &errormsg), true);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_EQ(stat->Updates, 1);
+  CHECK_GT(stat->Total_memory_kb, 0);
+  CHECK_GT(stat->Anon_kb, 0);
+  CHECK_GT(stat->Read_bytes, 0);
+  CHECK_GE(stat->Read_cost_ms, 0.0);
+  CHECK_GE(stat->Remote_usage, 0.0);
+  CHECK_LE(stat->Remote_usage, 100.0);
+  {
+    // at least one node is local
+    bool local = false;
+    unsigned long long total = 0;
+    for (int node = 0; node < stat->Nodes_count; ++node) {
+      local = local || stat->Node_local[node];
+      total += stat->Node_memory_kb[node];
+    }
+    CHECK_EQ(local, true);
+    CHECK_EQ(total, stat->Total_memory_kb);
+  }
+
+  // the interval is not over, so nothing is read
+  CHECK_EQ(Numa_stat_update(stat, getpid(), &errormsg), true);
+  CHECK_EQ(stat->Updates, 1);
+
+  Numa_stat_free(stat);
+  free(memory);
+}
+#endif
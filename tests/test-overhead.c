@@ -0,0 +1,87 @@
+#include "testing-globals.h"
+
+#include "overhead.h"
+#include "process.h"
+#include "metrics.h"
+#include "ioutils.h"
+
+#include <stdlib.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+TEST_CASE(Overhead, OverheadUsage)
+{
+  Overhead *overhead = Overhead_init();
+  CHECK_EQ(overhead->Ticks_count, 0ULL);
+  CHECK_STR_EQ(Overhead_probe_name(OVERHEAD_PROCESS), "process");
+  CHECK_STR_EQ(Overhead_probe_name(OVERHEAD_OUTPUTS), "outputs");
+  CHECK_STR_EQ(Overhead_probe_name(OVERHEAD_PROBES_COUNT), "");
+
+  Overhead_begin_tick(overhead);
+  Overhead_begin(overhead, OVERHEAD_RENDER);
+  void *ptr = malloc(64);
+  free(ptr);
+  Overhead_end(overhead, OVERHEAD_RENDER);
+  Overhead_end_tick(overhead);
+  CHECK_EQ(overhead->Ticks_count, 1ULL);
+  CHECK_GE(overhead->Probes[OVERHEAD_RENDER].Cpu_ms, 0.0);
+  CHECK_GE(overhead->Tick.Cpu_ms, overhead->Probes[OVERHEAD_RENDER].Cpu_ms);
+  if (Overhead_allocations() != -1) {
+    CHECK_EQ(overhead->Probes[OVERHEAD_RENDER].Allocations, 1LL);
+    CHECK_EQ(overhead->Tick.Allocations, 1LL);
+  } else
+    CHECK_EQ(overhead->Probes[OVERHEAD_RENDER].Allocations, 0LL);
+#ifdef __linux__
+  // the own reading of counters is calibrated, so the empty probe does not have syscalls
+  Overhead_begin_tick(overhead);
+  Overhead_begin(overhead, OVERHEAD_OUTPUTS);
+  Overhead_end(overhead, OVERHEAD_OUTPUTS);
+  Overhead_end_tick(overhead);
+  CHECK_EQ(overhead->Probes[OVERHEAD_OUTPUTS].Syscalls, 0ULL);
+  CHECK_EQ(overhead->Probes[OVERHEAD_OUTPUTS].Read_bytes, 0ULL);
+  CHECK_EQ(overhead->Probes[OVERHEAD_RENDER].Syscalls, 0ULL); // probes of the previous tick are reset
+
+  Overhead_begin_tick(overhead);
+  Overhead_begin(overhead, OVERHEAD_OUTPUTS);
+  char *cache = NULL;
+  long long length = fgetall("/proc/self/status", &cache);
+  free(cache);
+  Overhead_end(overhead, OVERHEAD_OUTPUTS);
+  Overhead_end_tick(overhead);
+  CHECK_GT(length, 0LL);
+  CHECK_GE(overhead->Probes[OVERHEAD_OUTPUTS].Syscalls, 1ULL);
+  CHECK_GE(overhead->Probes[OVERHEAD_OUTPUTS].Read_bytes, (unsigned long long) length);
+  CHECK_GE(overhead->Tick.Read_bytes, overhead->Probes[OVERHEAD_OUTPUTS].Read_bytes);
+#endif
+  Overhead_free(overhead);
+}
+
+TEST_CASE(Overhead, ProcessStatOverhead)
+{
+  Process_stat *stat = Process_stat_init();
+  CHECK_EQ(stat->Overhead, NULL);
+  CHECK_EQ(Metric_value(stat, METRIC_SELF_CPU_MS), 0.0); // not measured
+
+#ifdef __linux__
+  char *errormsg = NULL;
+  stat->Pid = getpid();
+  stat->Overhead = Overhead_init();
+  stat->Fds = Fd_list_init();
+  Overhead_begin_tick(stat->Overhead);
+  CHECK_EQ(Process_stat_update(stat, &errormsg), true);
+  Overhead_end_tick(stat->Overhead);
+  CHECK_GT(stat->Overhead->Probes[OVERHEAD_PROCESS].Read_bytes, 0ULL);
+  CHECK_GT(stat->Overhead->Probes[OVERHEAD_FDS].Syscalls, 0ULL);
+  CHECK_EQ(stat->Overhead->Probes[OVERHEAD_SOCKETS].Syscalls, 0ULL); // not collected
+  CHECK_EQ(Metric_value(stat, METRIC_SELF_READ_BYTES), (double) stat->Overhead->Tick.Read_bytes);
+  CHECK_EQ(Metric_value(stat, METRIC_SELF_PROCESS_CPU_MS), stat->Overhead->Probes[OVERHEAD_PROCESS].Cpu_ms);
+  CHECK_EQ(Metric_value(stat, METRIC_SELF_OUTPUTS_CPU_MS), stat->Overhead->Probes[OVERHEAD_OUTPUTS].Cpu_ms);
+  CHECK_STR_EQ(Metric_get_info(METRIC_SELF_ALLOCATIONS)->Name, "self_allocations");
+
+  Overhead_free(stat->Overhead);
+  stat->Overhead = NULL;
+  free(errormsg);
+#endif
+  Process_stat_free(stat);
+}
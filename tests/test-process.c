@@ -1,12 +1,14 @@
 #include "testing-globals.h"
 
 #include "process.h"
+#include "metrics.h"
 #include "ioutils.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #ifdef __linux__
 #include <sys/stat.h>
+#include <unistd.h>
 #elif _WIN32
 #include <Windows.h>
 #endif
@@ -297,3 +299,25 @@ TEST_CASE(Process, ProcessStatStructureUsage)
   clean_temp_files();
   remove(binname);
 }
+
+TEST_CASE(Process, HistoryByMonotonicTime)
+{
+#ifdef __linux__
+  char *errormsg = NULL;
+  Process_stat *stat = Process_stat_init();
+  stat->Pid = getpid();
+  stat->History = Timeseries_init(METRIC_COUNT, 4);
+  Process_tick tick;
+  CHECK_EQ(Process_tick_read(&tick, &errormsg), true);
+  CHECK_EQ(Process_stat_update_tick(stat, &tick, &errormsg), true);
+
+  // points are keyed by the monotonic time, the real time is only for display
+  Timeseries_point point;
+  CHECK_EQ(Timeseries_get(stat->History, METRIC_CPU_USAGE, TIMESERIES_RAW, 0, &point), true);
+  CHECK_EQ(point.Time_ms, tick.Monotime_ms);
+  CHECK_EQ(point.Time_ms + stat->History->Realtime_offset_ms, tick.Realtime_ms);
+
+  free(errormsg);
+  Process_stat_free(stat);
+#endif
+}
@@ -0,0 +1,109 @@
+#include "testing-globals.h"
+
+#include "procreader.h"
+#include "targets.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+TEST_CASE(Proc_reader, ProcReaderUsage)
+{
+  CHECK_STR_EQ(Proc_reader_backend_name(PROC_READER_PREAD), "pread");
+  CHECK_STR_EQ(Proc_reader_backend_name(PROC_READER_IO_URING), "io_uring");
+#ifdef __linux__
+  char *errormsg = NULL;
+  // io_uring falls back to 'pread', if it is not available
+  Proc_reader_backend backends[] = {PROC_READER_PREAD, PROC_READER_IO_URING};
+  for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); ++b) {
+    // reads files of two copies of the current process and the exited child
+    Proc_reader *reader = Proc_reader_init(backends[b]);
+    CHECK_EQ(reader->Syscalls, 0ULL);
+
+    pid_t child = fork();
+    if (child == 0)
+      _exit(0);
+    CHECK_GT(child, 0);
+
+    Process_stat *stats[3] = {Process_stat_init(), Process_stat_init(), Process_stat_init()};
+    bool alive[3] = {true, true, true};
+    CHECK_EQ(Process_stat_attach(stats[0], getpid(), &errormsg), true);
+    CHECK_EQ(Process_stat_attach(stats[1], getpid(), &errormsg), true);
+    stats[2]->Pid = child;
+    CHECK_EQ(errormsg, NULL);
+
+    Process_files files;
+    CHECK_EQ(Proc_reader_files(reader, 0, &files), false); // nothing is read
+
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "%d (", getpid());
+    Process_tick tick;
+    for (int i = 0; i < 3; ++i) {
+      CHECK_EQ(Process_tick_read(&tick, &errormsg), true);
+      Proc_reader_read(reader, stats, alive, 2);
+      if (i == 0) {
+        CHECK_GT(reader->Syscalls, 0ULL); // files are opened
+      } else if (reader->Backend == PROC_READER_IO_URING) {
+        CHECK_EQ(reader->Syscalls, 1ULL); // one batch
+      } else {
+        CHECK_EQ(reader->Syscalls, 4ULL); // one 'pread' per file
+      }
+
+      for (size_t index = 0; index < 2; ++index) {
+        CHECK_EQ(Proc_reader_files(reader, index, &files), true);
+        CHECK_NE(files.Stat, NULL);
+        CHECK_NE(files.Io, NULL);
+        CHECK_EQ(strncmp(files.Stat, prefix, strlen(prefix)), 0);
+        CHECK_NE(strstr(files.Io, "rchar: "), NULL);
+        CHECK_EQ(files.Uid, (int) getuid());
+        CHECK_EQ(Process_stat_update_files(stats[index], &tick, &files, &errormsg), true);
+        CHECK_EQ(errormsg, NULL);
+      }
+    }
+    CHECK_NE(stats[0]->Username, NULL);
+    CHECK_EQ(stats[0]->__last_monotime, tick.Monotime_ms);
+    CHECK_GT(stats[0]->Memory_usage, 0.0);
+
+    // the child is opened, but it is exited before the reading
+    CHECK_EQ(Proc_reader_files(reader, 2, &files), false);
+    Proc_reader_read(reader, stats, alive, 3);
+    CHECK_EQ(Proc_reader_files(reader, 2, &files), true);
+    waitpid(child, NULL, 0);
+    Proc_reader_read(reader, stats, alive, 3);
+    CHECK_EQ(Proc_reader_files(reader, 2, &files), true);
+    CHECK_EQ(files.Stat, NULL);
+    CHECK_EQ(Process_stat_update_files(stats[2], &tick, &files, &errormsg), false);
+    CHECK_STR_NE(errormsg, ""); // not empty
+    free(errormsg);
+    errormsg = NULL;
+
+    // files of not alive processes are closed
+    alive[2] = false;
+    Proc_reader_read(reader, stats, alive, 3);
+    CHECK_EQ(Proc_reader_files(reader, 2, &files), false);
+    CHECK_EQ(Proc_reader_files(reader, 1, &files), true);
+    CHECK_NE(files.Stat, NULL);
+
+    for (int i = 0; i < 3; ++i)
+      Process_stat_free(stats[i]);
+    Proc_reader_free(reader);
+  }
+
+  // the list reads files of targets by the reader
+  char self[16];
+  snprintf(self, sizeof(self), "%d", getpid());
+  Target_list *targets = Target_list_init();
+  targets->Reader = Proc_reader_init(PROC_READER_IO_URING);
+  for (int i = 0; i < 20; ++i)
+    CHECK_NE(Target_list_add(targets, self, &errormsg), NULL);
+  for (int i = 0; i < 2; ++i)
+    CHECK_EQ(Target_list_update(targets, &errormsg), (size_t) 20);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_EQ(targets->Stats[19]->__last_monotime, targets->Tick.Monotime_ms);
+  Target_list_free(targets);
+#endif
+}
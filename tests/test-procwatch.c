@@ -0,0 +1,94 @@
+#include "testing-globals.h"
+
+#include "procwatch.h"
+
+#include <string.h>
+#ifdef __linux__
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// burns CPU time of the current process
+static void burn_cpu(long long duration_ms)
+{
+  volatile unsigned long long counter = 0;
+  struct timespec begin, now;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  do {
+    for (int i = 0; i < 100000; ++i)
+      ++counter;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+  } while ((now.tv_sec - begin.tv_sec) * 1000 + (now.tv_nsec - begin.tv_nsec) / 1000000 < duration_ms);
+}
+#endif
+
+TEST_CASE(Procwatch, ProcwatchUsage)
+{
+#ifdef __linux__
+  Procwatch_error error;
+  CHECK_EQ(Procwatch_open(0, &error), NULL);
+  CHECK_EQ(error, PROCWATCH_ERROR_INVALID_ARGUMENT);
+
+  Procwatch* pw = Procwatch_open(2, &error);
+  CHECK_NE(pw, NULL);
+  CHECK_EQ(error, PROCWATCH_OK);
+
+  // the child sleeps until it is killed
+  pid_t child = fork();
+  if (child == 0) {
+    pause();
+    _exit(0);
+  }
+
+  CHECK_EQ(Procwatch_watch(pw, getpid()), PROCWATCH_OK);
+  CHECK_EQ(Procwatch_watch(pw, getpid()), PROCWATCH_ERROR_EXISTS);
+  CHECK_EQ(Procwatch_watch(pw, -1), PROCWATCH_ERROR_INVALID_ARGUMENT);
+  CHECK_EQ(Procwatch_watch(pw, child), PROCWATCH_OK);
+  CHECK_EQ(Procwatch_watch(pw, 1), PROCWATCH_ERROR_FULL);
+  CHECK_EQ(Procwatch_count(pw), (size_t) 2);
+
+  Procwatch_sample samples[2];
+  size_t count = 0;
+  CHECK_EQ(Procwatch_sample_all(pw, samples, 1, &count), PROCWATCH_ERROR_INVALID_ARGUMENT);
+  CHECK_EQ(count, (size_t) 2); // the required size
+
+  burn_cpu(100);
+  CHECK_EQ(Procwatch_sample_all(pw, samples, 2, &count), PROCWATCH_OK);
+  CHECK_EQ(count, (size_t) 2);
+  CHECK_EQ(samples[0].Pid, getpid());
+  CHECK_EQ(samples[0].Error, PROCWATCH_OK);
+  CHECK_STR_EQ(samples[0].Name, "process-watcher"); // 'comm' is truncated to 15 characters
+  CHECK_EQ(samples[0].State, 'R');
+  CHECK_EQ(samples[0].Uid, (int) getuid());
+  CHECK_GT(samples[0].Cpu_usage, 0.0);
+  CHECK_GT(samples[0].Memory_usage, 0.0);
+  CHECK_GT(samples[0].Time_ms, 0LL);
+  CHECK_EQ(samples[1].Pid, child);
+  CHECK_EQ(samples[1].Error, PROCWATCH_OK);
+  CHECK_EQ(samples[1].State, 'S');
+  CHECK_EQ(samples[1].Cpu_usage, 0.0);
+
+  // the exited process stays watched with the error
+  kill(child, SIGKILL);
+  waitpid(child, NULL, 0);
+  CHECK_EQ(Procwatch_sample_all(pw, samples, 2, &count), PROCWATCH_OK);
+  CHECK_EQ(samples[0].Error, PROCWATCH_OK);
+  CHECK_EQ(samples[1].Error, PROCWATCH_ERROR_NOT_FOUND);
+  CHECK_EQ(Procwatch_watch(pw, child), PROCWATCH_ERROR_EXISTS);
+  CHECK_EQ(Procwatch_unwatch(pw, child), PROCWATCH_OK);
+  CHECK_EQ(Procwatch_unwatch(pw, child), PROCWATCH_ERROR_NOT_FOUND);
+  CHECK_EQ(Procwatch_watch(pw, child), PROCWATCH_ERROR_NOT_FOUND);
+  CHECK_EQ(Procwatch_count(pw), (size_t) 1);
+
+  int pid = -1;
+  CHECK_EQ(Procwatch_find(pw, "process-watcher-test", &pid), PROCWATCH_OK);
+  CHECK_EQ(pid, getpid());
+  CHECK_EQ(Procwatch_find(pw, "not-existing-process-name", &pid), PROCWATCH_ERROR_NOT_FOUND);
+  CHECK_EQ(pid, -1);
+
+  CHECK_STR_EQ(Procwatch_error_string(PROCWATCH_ERROR_NOT_FOUND), "The process does not exist.");
+  CHECK_STR_EQ(Procwatch_error_string(PROCWATCH_ERRORS_COUNT), "Unknown error.");
+  Procwatch_close(pw);
+#endif
+}
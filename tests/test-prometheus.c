@@ -0,0 +1,112 @@
+#include "testing-globals.h"
+
+#include "prometheus.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// sends the request to the connected socket and reads the whole response
+static void request(int fd, const char *text, char *response, size_t size)
+{
+  assert(send(fd, text, strlen(text), 0) == (ssize_t) strlen(text));
+  size_t length = 0;
+  ssize_t received;
+  while (length + 1 < size && (received = recv(fd, response + length, size - 1 - length, 0)) > 0)
+    length += (size_t) received;
+  response[length] = '\0';
+  close(fd);
+}
+
+static void scrape_tcp(int port, const char *text, char *response, size_t size)
+{
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((uint16_t) port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  assert(fd >= 0 && connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+  request(fd, text, response, size);
+}
+
+static void scrape_unix(const char *path, const char *text, char *response, size_t size)
+{
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  assert(fd >= 0 && connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+  request(fd, text, response, size);
+}
+#endif
+
+TEST_CASE(Prometheus, PrometheusUsage)
+{
+#ifdef __linux__
+  static char response[65536];
+  char *errormsg = NULL;
+  Process_stat *stat = Process_stat_init();
+  stat->Process_name = malloc(32);
+  assert(stat->Process_name != NULL);
+  strcpy(stat->Process_name, "my \"process\"");
+  stat->Pid = 1234;
+  stat->Cpu_usage = 12.5;
+  stat->Cpu_peak_usage = 50.0;
+  stat->Disk_read_kb = 4096;
+  stat->Cpu_sketch = Sketch_init(60 * 1000);
+  for (int i = 1; i <= 100; ++i)
+    Sketch_add(stat->Cpu_sketch, i, (double) i);
+
+  Prometheus_server *server = Prometheus_start("127.0.0.1:0", &errormsg);
+  CHECK_NE(server, NULL);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_GT(server->Port, 0);
+
+  Prometheus_publish(server, stat, 1700000000000LL);
+  scrape_tcp(server->Port, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n", response, sizeof(response));
+  CHECK_EQ(strncmp(response, "HTTP/1.0 200 OK\r\n", 17), 0);
+  CHECK_NE(strstr(response, "# TYPE process_watcher_cpu_usage gauge\n"), NULL);
+  CHECK_NE(strstr(response, "process_watcher_cpu_usage{process=\"my \\\"process\\\"\",pid=\"1234\"} 12.5\n"), NULL);
+  CHECK_NE(strstr(response, "# TYPE process_watcher_disk_read_kb_total counter\n"), NULL);
+  CHECK_NE(strstr(response, "process_watcher_disk_read_kb_total{process=\"my \\\"process\\\"\",pid=\"1234\"} 4096\n"),
+           NULL);
+  CHECK_NE(strstr(response, "process_watcher_cpu_usage_peak{process=\"my \\\"process\\\"\",pid=\"1234\"} 50\n"), NULL);
+  CHECK_NE(strstr(response, ",quantile=\"1\"} 100\n"), NULL);
+  CHECK_NE(strstr(response, "process_watcher_cpu_usage_window_count{process=\"my \\\"process\\\"\",pid=\"1234\"} 100\n"),
+           NULL);
+  CHECK_NE(strstr(response, "process_watcher_samples_total{process=\"my \\\"process\\\"\",pid=\"1234\"} 1\n"), NULL);
+
+  scrape_tcp(server->Port, "GET /other HTTP/1.1\r\n\r\n", response, sizeof(response));
+  CHECK_EQ(strncmp(response, "HTTP/1.0 404 Not Found\r\n", 24), 0);
+  scrape_tcp(server->Port, "POST /metrics HTTP/1.1\r\n\r\n", response, sizeof(response));
+  CHECK_EQ(strncmp(response, "HTTP/1.0 405 Method Not Allowed\r\n", 33), 0);
+  CHECK_EQ(server->Scrapes_count, 1ULL);
+  Prometheus_stop(server);
+
+  // the Unix socket is removed on stopping
+  const char *socketpath = "testprometheus.sock";
+  server = Prometheus_start("unix:testprometheus.sock", &errormsg);
+  CHECK_NE(server, NULL);
+  CHECK_EQ(server->Port, 0);
+  Prometheus_publish(server, stat, 1700000000000LL);
+  Prometheus_publish(server, stat, 1700000001000LL);
+  scrape_unix(socketpath, "GET / HTTP/1.0\r\n\r\n", response, sizeof(response));
+  CHECK_NE(strstr(response, "process_watcher_samples_total{process=\"my \\\"process\\\"\",pid=\"1234\"} 2\n"), NULL);
+  CHECK_NE(strstr(response, "process_watcher_last_sample_timestamp_seconds{"), NULL);
+  Prometheus_stop(server);
+  CHECK_NE(access(socketpath, F_OK), 0);
+
+  CHECK_EQ(Prometheus_start("not-a-port", &errormsg), NULL);
+  CHECK_STR_NE(errormsg, ""); // not empty
+  free(errormsg);
+  Process_stat_free(stat);
+#endif
+}
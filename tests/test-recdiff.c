@@ -0,0 +1,93 @@
+#include "testing-globals.h"
+
+#include "recdiff.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// writes one hour at 1 Hz, the CPU usage of the second half is multiplied by 'factor'
+static void write_recording(const char *path, long long start_ms, double factor)
+{
+  char *errormsg = NULL;
+  Recording_writer *writer = Recording_writer_open(path, "diffed-process", 7, 0, &errormsg);
+  assert(writer != NULL);
+  double values[METRIC_COUNT];
+  memset(values, 0, sizeof(values));
+  for (int i = 0; i < 3600; ++i) {
+    values[METRIC_CPU_USAGE] = (double) (10 + i % 10) * (i >= 1800 ? factor : 1.0);
+    values[METRIC_MEMORY_USAGE] = 100.0;
+    values[METRIC_DISK_READ_KB] = (double) (i * 4); // 4 KB/s
+    assert(Recording_writer_append(writer, start_ms + i * 1000, values, &errormsg));
+  }
+  Recording_writer_close(writer);
+}
+
+TEST_CASE(Recdiff, DiffUsage)
+{
+  const char *basefilename = "testdiff-base.pwr", *candfilename = "testdiff-cand.pwr";
+  // the candidate starts later, recordings are aligned by their first samples
+  write_recording(basefilename, 1700000000000LL, 1.0);
+  write_recording(candfilename, 1700100000000LL, 2.0);
+
+  char *errormsg = NULL;
+  Recording_reader *baseline = Recording_reader_open(basefilename, &errormsg),
+                   *candidate = Recording_reader_open(candfilename, &errormsg);
+  assert(baseline != NULL && candidate != NULL);
+
+  Diff_options options = {60 * 1000, 10.0, 0.01, DIFF_P95, NULL};
+  Diff_report *report = Diff_recordings(baseline, candidate, &options, &errormsg);
+  CHECK_NE(report, NULL);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_EQ(report->Metrics_count, (size_t) METRIC_COUNT);
+  CHECK_EQ(report->Duration_ms, 3599 * 1000LL);
+  CHECK_EQ(report->Baseline_samples, 3600ULL);
+  CHECK_EQ(report->Candidate_samples, 3600ULL);
+  CHECK_EQ(report->Regression, true);
+
+  const Diff_metric *cpu = &report->Metrics[METRIC_CPU_USAGE];
+  CHECK_STR_EQ(cpu->Name, "cpu_usage");
+  CHECK_EQ(cpu->Regression, true);
+  CHECK_EQ(cpu->Windows, (size_t) 60);
+  CHECK_EQ(cpu->Regressed_windows, (size_t) 30); // only the second half
+  CHECK_EQ(cpu->Baseline[DIFF_MEAN], 14.5);
+  CHECK_EQ(cpu->Baseline[DIFF_MAX], 19.0);
+  CHECK_EQ(cpu->Candidate[DIFF_MAX], 38.0);
+  CHECK_GT(cpu->Change, 50.0);
+
+  const Diff_metric *memory = &report->Metrics[METRIC_MEMORY_USAGE];
+  CHECK_EQ(memory->Regression, false);
+  CHECK_EQ(memory->Regressed_windows, (size_t) 0);
+  CHECK_EQ(memory->Change, 0.0);
+
+  // counters are compared as rates
+  const Diff_metric *read = &report->Metrics[METRIC_DISK_READ_KB];
+  CHECK_EQ(read->Rate, true);
+  CHECK_EQ(read->Baseline[DIFF_MEAN], 4.0);
+  CHECK_EQ(read->Regression, false);
+  Diff_report_free(report);
+
+  // the regression is not detected with the higher threshold
+  options.Threshold = 150.0;
+  report = Diff_recordings(baseline, candidate, &options, &errormsg);
+  CHECK_NE(report, NULL);
+  CHECK_EQ(report->Regression, false);
+  Diff_report_free(report);
+
+  // only one metric
+  options.Metric = "memory_usage";
+  report = Diff_recordings(baseline, candidate, &options, &errormsg);
+  CHECK_NE(report, NULL);
+  CHECK_EQ(report->Metrics_count, (size_t) 1);
+  Diff_report_free(report);
+
+  options.Metric = "not_existing_metric";
+  CHECK_EQ(Diff_recordings(baseline, candidate, &options, &errormsg), NULL);
+  CHECK_STR_NE(errormsg, ""); // not empty
+  free(errormsg);
+
+  Recording_reader_close(baseline);
+  Recording_reader_close(candidate);
+  remove(basefilename);
+  remove(candfilename);
+}
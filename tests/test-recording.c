@@ -0,0 +1,189 @@
+#include "testing-globals.h"
+
+#include "recording.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// synthetic sample: CPU changes every second, memory changes sometimes, counters grow
+static void make_sample(int i, double *values)
+{
+  memset(values, 0, sizeof(double) * METRIC_COUNT);
+  values[METRIC_CPU_USAGE] = (double) ((i * 7919) % 1000) / 7.0;
+  values[METRIC_MEMORY_USAGE] = 100.0 + (double) (i / 60) * 0.25;
+  values[METRIC_DISK_READ_KB] = (double) (i * 12);
+  values[METRIC_DISK_WRITTEN_KB] = (double) (i * 3);
+  values[METRIC_PRIORITY] = 20.0;
+  values[METRIC_OPEN_FDS] = (double) (10 + i % 3);
+}
+
+TEST_CASE(Recording, RecordingUsage)
+{
+  const char *testfilename = "testrecording.pwr";
+  const int samples = 3600;
+  const long long start_ms = 1700000000000LL;
+
+  char *errormsg = NULL;
+  {
+    Recording_writer *writer = Recording_writer_open(testfilename, "test-process", 42, 0, &errormsg);
+    CHECK_NE(writer, NULL);
+    CHECK_EQ(errormsg, NULL);
+
+    double values[METRIC_COUNT];
+    for (int i = 0; i < samples; ++i) {
+      make_sample(i, values);
+      // 1 Hz with a jitter
+      CHECK_EQ(Recording_writer_append(writer, start_ms + i * 1000 + (i % 5), values, &errormsg), true);
+    }
+    CHECK_EQ(writer->Samples_count, (unsigned long long) samples);
+    // less than 3.1 MB per day at 1 Hz for 25 metrics of the catalogue, every unchanged metric costs 1 byte more
+    CHECK_LT(writer->Bytes_written / (unsigned long long) samples, 11ULL + METRIC_COUNT);
+
+    Recording_writer_close(writer);
+  }
+  {
+    Recording_reader *reader = Recording_reader_open(testfilename, &errormsg);
+    CHECK_NE(reader, NULL);
+    CHECK_EQ(errormsg, NULL);
+    CHECK_STR_EQ(reader->Process_name, "test-process");
+    CHECK_EQ(reader->Pid, 42);
+    CHECK_EQ(reader->Metrics_count, METRIC_COUNT);
+    CHECK_EQ(reader->Samples_count, (unsigned long long) samples);
+    CHECK_EQ(reader->First_time_ms, start_ms);
+    CHECK_EQ(reader->Last_time_ms, start_ms + (samples - 1) * 1000 + (samples - 1) % 5);
+    CHECK_EQ(Recording_reader_metric(reader, "cpu_usage"), METRIC_CPU_USAGE);
+    CHECK_EQ(Recording_reader_metric(reader, "unknown"), -1);
+    CHECK_EQ(reader->Metric_types[METRIC_DISK_READ_KB], METRIC_COUNTER);
+
+    // all samples are decoded without losses
+    long long time;
+    double values[METRIC_COUNT], expected[METRIC_COUNT];
+    int count = 0;
+    while (Recording_reader_next(reader, &time, values)) {
+      make_sample(count, expected);
+      CHECK_EQ(time, start_ms + count * 1000 + (count % 5));
+      CHECK_EQ(memcmp(values, expected, sizeof(values)), 0);
+      ++count;
+    }
+    CHECK_EQ(count, samples);
+
+    // seek to the middle of the block
+    CHECK_EQ(Recording_reader_seek(reader, start_ms + 1000 * 1000 + 500), true);
+    CHECK_EQ(Recording_reader_next(reader, &time, values), true);
+    CHECK_EQ(time, start_ms + 1001 * 1000 + 1001 % 5);
+    make_sample(1001, expected);
+    CHECK_EQ(memcmp(values, expected, sizeof(values)), 0);
+    CHECK_EQ(Recording_reader_next(reader, &time, values), true);
+    CHECK_EQ(time, start_ms + 1002 * 1000 + 1002 % 5);
+
+    // seek before the begin and after the end
+    CHECK_EQ(Recording_reader_seek(reader, 0), true);
+    CHECK_EQ(Recording_reader_next(reader, &time, values), true);
+    CHECK_EQ(time, start_ms);
+    CHECK_EQ(Recording_reader_seek(reader, reader->Last_time_ms + 1), false);
+    CHECK_EQ(Recording_reader_next(reader, &time, values), false);
+
+    Recording_reader_close(reader);
+  }
+#ifdef __linux__
+  {
+    // the truncated last block is ignored
+    FILE *file = fopen(testfilename, "r+b");
+    assert(file != NULL);
+    assert(fseek(file, 0, SEEK_END) == 0);
+    long size = ftell(file);
+    assert(fclose(file) == 0);
+    assert(truncate(testfilename, size - 5) == 0);
+
+    Recording_reader *reader = Recording_reader_open(testfilename, &errormsg);
+    CHECK_NE(reader, NULL);
+    CHECK_LT(reader->Samples_count, (unsigned long long) samples);
+    CHECK_EQ(reader->Samples_count % RECORDING_BLOCK_SAMPLES, 0ULL);
+    Recording_reader_close(reader);
+  }
+#endif
+  remove(testfilename);
+
+  // the count of metrics does not fit the file
+  {
+    Recording_writer *writer = Recording_writer_open(testfilename, "test-process", 42, 0, &errormsg);
+    CHECK_NE(writer, NULL);
+    Recording_writer_close(writer);
+
+    FILE *file = fopen(testfilename, "r+b");
+    assert(file != NULL);
+    assert(fseek(file, 16, SEEK_SET) == 0);
+    const unsigned char count[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    assert(fwrite(count, 1, sizeof(count), file) == sizeof(count));
+    assert(fclose(file) == 0);
+
+    CHECK_EQ(Recording_reader_open(testfilename, &errormsg), NULL);
+    CHECK_STR_NE(errormsg, ""); // not empty
+    free(errormsg);
+    errormsg = NULL;
+  }
+  remove(testfilename);
+
+  // not a recording
+  {
+    FILE *file = fopen(testfilename, "w");
+    assert(file != NULL);
+    assert(fprintf(file, "%s", "not a recording") > 0);
+    assert(fclose(file) == 0);
+
+    CHECK_EQ(Recording_reader_open(testfilename, &errormsg), NULL);
+    CHECK_STR_NE(errormsg, ""); // not empty
+    free(errormsg);
+    errormsg = NULL;
+  }
+  remove(testfilename);
+
+  CHECK_EQ(Recording_reader_open("/not/existing/file", &errormsg), NULL);
+  CHECK_STR_NE(errormsg, ""); // not empty
+  free(errormsg);
+}
+
+TEST_CASE(Recording, RecordingMonotonicTime)
+{
+  const char *testfilename = "testrecording-monotonic.pwr";
+  const long long offset_ms = 1700000000000LL;
+
+  char *errormsg = NULL;
+  {
+    Recording_writer *writer = Recording_writer_open(testfilename, "test-process", 42, offset_ms, &errormsg);
+    CHECK_NE(writer, NULL);
+
+    double values[METRIC_COUNT];
+    make_sample(0, values);
+    CHECK_EQ(Recording_writer_append(writer, 5000, values, &errormsg), true);
+    CHECK_EQ(Recording_writer_append(writer, 6000, values, &errormsg), true);
+    // the decreased time is clamped
+    CHECK_EQ(Recording_writer_append(writer, 4000, values, &errormsg), true);
+    CHECK_EQ(Recording_writer_append(writer, 7000, values, &errormsg), true);
+    Recording_writer_close(writer);
+  }
+  {
+    Recording_reader *reader = Recording_reader_open(testfilename, &errormsg);
+    CHECK_NE(reader, NULL);
+    CHECK_EQ(reader->Realtime_offset_ms, offset_ms);
+    CHECK_EQ(reader->First_time_ms, offset_ms + 5000);
+    CHECK_EQ(reader->Last_time_ms, offset_ms + 7000);
+
+    // times are real times
+    const long long expected[] = {5000, 6000, 6000, 7000};
+    long long time;
+    double values[METRIC_COUNT];
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+      CHECK_EQ(Recording_reader_next(reader, &time, values), true);
+      CHECK_EQ(time, offset_ms + expected[i]);
+    }
+    CHECK_EQ(Recording_reader_next(reader, &time, values), false);
+
+    CHECK_EQ(Recording_reader_seek(reader, offset_ms + 6500), true);
+    CHECK_EQ(Recording_reader_next(reader, &time, values), true);
+    CHECK_EQ(time, offset_ms + 7000);
+    Recording_reader_close(reader);
+  }
+  remove(testfilename);
+}
@@ -0,0 +1,87 @@
+#include "testing-globals.h"
+
+#include "replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_CASE(Replay, ReplayUsage)
+{
+  const char *testfilename = "testreplay.pwr";
+  const long long start_ms = 1700000000000LL;
+  const int samples = 3 * 60 * 60; // 3 hours at 1 Hz
+
+  char *errormsg = NULL;
+  {
+    Recording_writer *writer = Recording_writer_open(testfilename, "replayed-process", 42, 0, &errormsg);
+    assert(writer != NULL);
+    double values[METRIC_COUNT];
+    memset(values, 0, sizeof(values));
+    for (int i = 0; i < samples; ++i) {
+      values[METRIC_CPU_USAGE] = (double) (i % 100);
+      values[METRIC_MEMORY_USAGE] = (double) i;
+      values[METRIC_DISK_READ_KB] = (double) (i * 4);
+      assert(Recording_writer_append(writer, start_ms + i * 1000, values, &errormsg));
+    }
+    Recording_writer_close(writer);
+  }
+
+  Process_stat *stat = Process_stat_init();
+  stat->History = Timeseries_init(METRIC_COUNT, 16);
+  stat->Cpu_sketch = Sketch_init(60 * 1000);
+
+  Replay *replay = Replay_init(testfilename, stat, &errormsg);
+  CHECK_NE(replay, NULL);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_STR_EQ(stat->Process_name, "replayed-process");
+  CHECK_EQ(stat->Pid, 42);
+  CHECK_EQ(replay->Time_ms, start_ms);
+  CHECK_EQ(replay->Speed, 1);
+  CHECK_EQ(replay->Paused, false);
+  CHECK_EQ(stat->Memory_usage, 0.0);
+  CHECK_EQ(Timeseries_size(stat->History, TIMESERIES_RAW), 1);
+
+  // seek to the second hour
+  replay->Paused = true;
+  Replay_seek(replay, start_ms + 60 * 60 * 1000 + 500);
+  CHECK_EQ(Replay_update(replay, stat), 1);
+  CHECK_EQ(replay->Time_ms, start_ms + 60 * 60 * 1000 + 1000);
+  CHECK_EQ(stat->Memory_usage, 3601.0);
+  CHECK_EQ(stat->Cpu_usage, 1.0);
+  CHECK_EQ(stat->Disk_read_kb, 3601 * 4);
+  // the history and sketches are cleared on seeking
+  CHECK_EQ(Timeseries_size(stat->History, TIMESERIES_RAW), 1);
+  CHECK_EQ(stat->Cpu_sketch->Lifetime.Count, 1);
+
+  // paused, the time does not move
+  CHECK_EQ(Replay_update(replay, stat), 0);
+  CHECK_EQ(replay->Time_ms, start_ms + 60 * 60 * 1000 + 1000);
+
+  // relative seek
+  Replay_seek_relative(replay, -60 * 1000);
+  Replay_update(replay, stat);
+  CHECK_EQ(stat->Memory_usage, 3541.0);
+
+  // the replay is paused at the end
+  replay->Paused = false;
+  Replay_seek(replay, start_ms + 100LL * 60 * 60 * 1000);
+  Replay_update(replay, stat);
+  CHECK_EQ(stat->Memory_usage, (double) (samples - 1));
+  CHECK_EQ(replay->Time_ms, replay->Reader->Last_time_ms);
+  CHECK_EQ(replay->Paused, true);
+
+  char status[256];
+  Replay_status(replay, status, sizeof(status));
+  CHECK_STR_NE(status, ""); // not empty
+
+  Replay_free(replay);
+  Process_stat_free(stat);
+  remove(testfilename);
+
+  stat = Process_stat_init();
+  CHECK_EQ(Replay_init("/not/existing/file", stat, &errormsg), NULL);
+  CHECK_STR_NE(errormsg, ""); // not empty
+  free(errormsg);
+  Process_stat_free(stat);
+}
@@ -0,0 +1,62 @@
+#include "testing-globals.h"
+
+#include "samplerpool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+TEST_CASE(Sampler_pool, SamplerPoolUsage)
+{
+  char *errormsg = NULL;
+  Target_list *targets = Target_list_init();
+  Sampler_pool *pool = Sampler_pool_init(4);
+#ifdef __linux__
+  CHECK_EQ(pool->Workers_count, (size_t) 4);
+
+  // the empty list
+  CHECK_EQ(Sampler_pool_update(pool, targets, &errormsg), (size_t) 0);
+  CHECK_EQ(errormsg, NULL);
+
+  const size_t count = 101; // shards are not equal
+  char self[16];
+  snprintf(self, sizeof(self), "%d", getpid());
+  for (size_t i = 0; i < count; ++i)
+    CHECK_NE(Target_list_add(targets, self, &errormsg), NULL);
+
+  for (int tick = 0; tick < 3; ++tick) {
+    CHECK_EQ(Sampler_pool_update(pool, targets, &errormsg), count);
+    CHECK_EQ(errormsg, NULL);
+
+    // every target is updated once by one of workers with the same tick
+    unsigned long long updated = 0;
+    for (size_t i = 0; i < pool->Workers_count; ++i)
+      updated += pool->Workers[i].Targets_count;
+    CHECK_EQ(updated, (unsigned long long) count);
+    for (size_t i = 0; i < count; ++i) {
+      CHECK_EQ(targets->Alive[i], true);
+      CHECK_EQ(targets->Stats[i]->__last_monotime, targets->Tick.Monotime_ms);
+      CHECK_EQ(targets->Stats[i]->__last_total, targets->Tick.Cpu_total);
+    }
+  }
+  CHECK_GE(pool->Tick_ms, 0.0);
+
+  targets->Alive[7] = false; // exited targets are not updated
+  CHECK_EQ(Sampler_pool_update(pool, targets, &errormsg), count - 1);
+  CHECK_EQ(Target_list_select(targets, count), count);
+  CHECK_EQ(targets->Order[count - 1], (size_t) 7);
+#else
+  CHECK_EQ(pool->Workers_count, (size_t) 1);
+#endif
+  Sampler_pool_free(pool);
+
+  pool = Sampler_pool_init(0);
+  CHECK_EQ(pool->Workers_count, (size_t) 1); // the calling thread at least
+  CHECK_EQ(Sampler_pool_update(pool, targets, &errormsg), (targets->Count ? targets->Count - 1 : 0));
+  Sampler_pool_free(pool);
+
+  free(errormsg);
+  Target_list_free(targets);
+}
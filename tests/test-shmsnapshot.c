@@ -0,0 +1,132 @@
+#include "testing-globals.h"
+
+#include "shmsnapshot.h"
+#include "metrics.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <pthread.h>
+
+static const int CONCURRENT_SAMPLES = 200000;
+
+// publishes samples, where CPU and memory usages are equal
+static void *publish_samples(void *arg)
+{
+  Shm_publisher *publisher = (Shm_publisher *) arg;
+  Process_stat *stat = Process_stat_init();
+  for (int i = 1; i <= CONCURRENT_SAMPLES; ++i) {
+    stat->Cpu_usage = stat->Memory_usage = (double) i;
+    Shm_publisher_publish(publisher, stat, i);
+  }
+  Process_stat_free(stat);
+  return NULL;
+}
+#endif
+
+TEST_CASE(Shm_snapshot, ShmSnapshotUsage)
+{
+#ifdef __linux__
+  const char *name = "process-watcher-test-shm";
+  char *errormsg = NULL;
+  Process_stat *stat = Process_stat_init();
+  stat->Pid = 4321;
+  stat->Cpu_sketch = Sketch_init(60 * 1000);
+
+  Shm_publisher *publisher = Shm_publisher_open(name, "shm-process", 4321, 4, &errormsg);
+  CHECK_NE(publisher, NULL);
+  CHECK_EQ(errormsg, NULL);
+
+  Shm_reader *reader = Shm_reader_open(name, &errormsg);
+  CHECK_NE(reader, NULL);
+  CHECK_EQ(reader->Layout->Pid, 4321);
+  CHECK_STR_EQ(reader->Layout->Process_name, "shm-process");
+  CHECK_EQ(reader->Layout->Metrics_count, (uint32_t) METRIC_COUNT);
+  CHECK_EQ(Shm_reader_metric(reader, "cpu_usage"), METRIC_CPU_USAGE);
+  CHECK_EQ(Shm_reader_metric(reader, "not_existing_metric"), -1);
+
+  Shm_point points[8];
+  CHECK_EQ(Shm_reader_history(reader, points, 8), (size_t) 0);
+
+  for (int i = 1; i <= 6; ++i) {
+    stat->Cpu_usage = stat->Memory_usage = (double) i;
+    stat->Cpu_peak_usage = (double) i;
+    Sketch_add(stat->Cpu_sketch, i, (double) i);
+    Shm_publisher_publish(publisher, stat, 1000 * i);
+  }
+
+  Shm_sample sample;
+  CHECK_EQ(Shm_reader_read(reader, &sample), true);
+  CHECK_EQ(sample.Samples_count, 6ULL);
+  CHECK_EQ(sample.Time_ms, 6000LL);
+  CHECK_EQ(sample.Values[METRIC_CPU_USAGE], 6.0);
+  CHECK_EQ(sample.Peaks[0], 6.0);
+  CHECK_EQ(sample.Percentiles[0][3], 6.0); // max of the window
+
+  // the ring keeps the last 4 points, the oldest is the first
+  CHECK_EQ(Shm_reader_history(reader, points, 8), (size_t) 4);
+  CHECK_EQ(points[0].Time_ms, 3000LL);
+  CHECK_EQ(points[3].Values[METRIC_CPU_USAGE], 6.0);
+  CHECK_EQ(Shm_reader_history(reader, points, 2), (size_t) 2);
+  CHECK_EQ(points[0].Time_ms, 5000LL);
+
+  // the ring is filled from the history of the process, the first publication copies its last points
+  Shm_publisher_close(publisher);
+  publisher = Shm_publisher_open(name, "shm-process", 4321, 4, &errormsg);
+  CHECK_NE(publisher, NULL);
+  Shm_reader_close(reader);
+  reader = Shm_reader_open(name, &errormsg);
+  CHECK_NE(reader, NULL);
+  stat->History = Timeseries_init(METRIC_COUNT, 8);
+  stat->History->Realtime_offset_ms = 100000;
+  double values[METRIC_COUNT] = {0.0};
+  for (int i = 1; i <= 3; ++i) {
+    values[METRIC_CPU_USAGE] = (double) (10 * i);
+    Timeseries_append(stat->History, 1000 * i, values);
+  }
+  Shm_publisher_publish(publisher, stat, 0);
+  CHECK_EQ(Shm_reader_history(reader, points, 8), (size_t) 3);
+  CHECK_EQ(points[0].Time_ms, 101000LL);
+  CHECK_EQ(points[2].Values[METRIC_CPU_USAGE], 30.0);
+  Shm_publisher_publish(publisher, stat, 0); // no new points
+  CHECK_EQ(Shm_reader_history(reader, points, 8), (size_t) 3);
+  Timeseries_append(stat->History, 4000, values);
+  Timeseries_append(stat->History, 5000, values);
+  Shm_publisher_publish(publisher, stat, 0);
+  CHECK_EQ(Shm_reader_history(reader, points, 8), (size_t) 4);
+  CHECK_EQ(points[0].Time_ms, 102000LL);
+  CHECK_EQ(points[3].Time_ms, 105000LL);
+  Timeseries_reset(stat->History);
+  Timeseries_append(stat->History, 500, values);
+  Shm_publisher_publish(publisher, stat, 0);
+  CHECK_EQ(Shm_reader_history(reader, points, 8), (size_t) 1);
+  CHECK_EQ(points[0].Time_ms, 100500LL);
+  Timeseries_free(stat->History);
+  stat->History = NULL;
+
+  // the reader never sees the partially written sample
+  pthread_t thread;
+  pthread_create(&thread, NULL, publish_samples, publisher);
+  unsigned long long last = 0, torn = 0;
+  for (int i = 0; i < CONCURRENT_SAMPLES / 10; ++i) {
+    if (!Shm_reader_read(reader, &sample))
+      continue;
+    if (sample.Values[METRIC_CPU_USAGE] != sample.Values[METRIC_MEMORY_USAGE] || sample.Samples_count < last)
+      ++torn;
+    last = sample.Samples_count;
+  }
+  pthread_join(thread, NULL);
+  CHECK_EQ(torn, 0ULL);
+  CHECK_EQ(Shm_reader_read(reader, &sample), true);
+  CHECK_EQ(sample.Values[METRIC_MEMORY_USAGE], (double) CONCURRENT_SAMPLES);
+
+  // the object is removed, but the mapping of the reader is valid
+  Shm_publisher_close(publisher);
+  CHECK_EQ(Shm_reader_read(reader, &sample), true);
+  Shm_reader_close(reader);
+  CHECK_EQ(Shm_reader_open(name, &errormsg), NULL);
+  CHECK_STR_NE(errormsg, ""); // not empty
+  free(errormsg);
+  Process_stat_free(stat);
+#endif
+}
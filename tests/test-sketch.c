@@ -0,0 +1,61 @@
+#include "testing-globals.h"
+
+#include "sketch.h"
+
+#include <math.h>
+
+TEST_CASE(Sketch, SketchUsage)
+{
+  Sketch *sketch = Sketch_init(60 * 1000);
+  CHECK_NE(sketch, NULL);
+  CHECK_EQ(sketch->Window_ms, 60 * 1000);
+  CHECK_EQ(sketch->Lifetime.Count, 0);
+  CHECK_EQ(Sketch_quantile(&sketch->Lifetime, 0.5), 0.0);
+
+  // values 1..100 in the first minute
+  for (int i = 1; i <= 100; ++i)
+    Sketch_add(sketch, i * 100, (double) i);
+
+  Sketch_summary summary;
+  Sketch_summarize(&sketch->Lifetime, &summary);
+  CHECK_EQ(summary.Count, 100);
+  CHECK_EQ(summary.Max, 100.0);
+  // the relative error is less than 1/64
+  CHECK_LE(fabs(summary.P50 - 50.0), 50.0 / 64);
+  CHECK_LE(fabs(summary.P95 - 95.0), 95.0 / 64);
+  CHECK_LE(fabs(summary.P99 - 99.0), 99.0 / 64);
+  CHECK_EQ(Sketch_quantile(&sketch->Lifetime, 0.5), summary.P50);
+  CHECK_EQ(Sketch_quantile(&sketch->Lifetime, 1.0), 100.0);
+
+  Sketch_summarize(&sketch->Window, &summary);
+  CHECK_EQ(summary.Count, 100);
+  CHECK_EQ(summary.Max, 100.0);
+
+  // zeros and negative values
+  Sketch_add(sketch, 10 * 1000, 0.0);
+  Sketch_add(sketch, 10 * 1000, -1.0);
+  CHECK_EQ(Sketch_quantile(&sketch->Lifetime, 0.0), 0.0);
+  CHECK_EQ(sketch->Lifetime.Count, 102);
+
+  // the first values leave the window, the lifetime view keeps them
+  for (int i = 0; i < 10; ++i)
+    Sketch_add(sketch, 70 * 1000 + i * 100, 2.0);
+  CHECK_EQ(sketch->Lifetime.Count, 112);
+  CHECK_EQ(sketch->Window.Count, 10);
+  CHECK_EQ(sketch->Window.Max, 2.0);
+  CHECK_EQ(sketch->Lifetime.Max, 100.0);
+
+  // the window is outdated
+  Sketch_add(sketch, 10 * 60 * 1000, 5.0);
+  Sketch_summarize(&sketch->Window, &summary);
+  CHECK_EQ(summary.Count, 1);
+  CHECK_EQ(summary.Max, 5.0);
+  CHECK_LE(fabs(summary.P50 - 5.0), 5.0 / 64);
+
+  // values out of range
+  Sketch_add(sketch, 10 * 60 * 1000, 1e15);
+  CHECK_EQ(sketch->Window.Max, 1e15);
+  CHECK_EQ(Sketch_quantile(&sketch->Window, 1.0), 1e15);
+
+  Sketch_free(sketch);
+}
@@ -0,0 +1,105 @@
+#include "testing-globals.h"
+
+#include "sockets.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#ifdef __linux__
+static unsigned long socket_inode(int fd)
+{
+  struct stat st;
+  assert(fstat(fd, &st) == 0);
+  return (unsigned long) st.st_ino;
+}
+
+TEST_CASE(Sockets, SocketListUsage)
+{
+  // listening socket, client and accepted connection with unread data
+  int server = socket(AF_INET, SOCK_STREAM, 0);
+  assert(server != -1);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  assert(bind(server, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+  assert(listen(server, 4) == 0);
+  socklen_t addrlen = sizeof(addr);
+  assert(getsockname(server, (struct sockaddr *) &addr, &addrlen) == 0);
+
+  int client = socket(AF_INET, SOCK_STREAM, 0);
+  assert(client != -1);
+  assert(connect(client, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+  int accepted = accept(server, NULL, NULL);
+  assert(accepted != -1);
+  const char *data = "0123456789";
+  assert(send(client, data, strlen(data), 0) == (ssize_t) strlen(data));
+  usleep(50 * 1000);
+
+  int pair[2];
+  assert(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+
+  Socket_list *list = Socket_list_init();
+  CHECK_NE(list, NULL);
+  CHECK_EQ(list->Count, 0);
+
+  char *errormsg = NULL;
+  CHECK_EQ(Socket_list_update(list, getpid(), NULL, &errormsg), true);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_GE(list->Count, 5);
+  CHECK_GE(list->Proto_counts[SOCKET_TCP], 3);
+  CHECK_GE(list->Proto_counts[SOCKET_UNIX], 2);
+  CHECK_GE(list->Tcp_state_counts[10 /* LISTEN */], 1);
+  CHECK_GE(list->Tcp_state_counts[1 /* ESTABLISHED */], 2);
+  CHECK_GE(list->Recv_queue_total, strlen(data));
+  {
+    const Socket_entry *entry = Socket_list_find(list, socket_inode(accepted));
+    CHECK_NE(entry, NULL);
+    if (entry) {
+      CHECK_EQ(entry->Proto, SOCKET_TCP);
+      CHECK_STR_EQ(Socket_state_name(entry->State), "ESTABLISHED");
+      CHECK_EQ(entry->Recv_queue, strlen(data));
+      CHECK_EQ(strncmp(entry->Local, "127.0.0.1:", 10), 0);
+    }
+  }
+  {
+    const Socket_entry *entry = Socket_list_find(list, socket_inode(server));
+    CHECK_NE(entry, NULL);
+    if (entry)
+      CHECK_STR_EQ(Socket_state_name(entry->State), "LISTEN");
+  }
+  {
+    const Socket_entry *entry = Socket_list_find(list, socket_inode(pair[0]));
+    CHECK_NE(entry, NULL);
+    if (entry)
+      CHECK_EQ(entry->Proto, SOCKET_UNIX);
+  }
+
+  // closed sockets are removed, the list of descriptors is used instead of '/proc/[pid]/fd'
+  size_t count = list->Count;
+  unsigned long pair_inode = socket_inode(pair[0]);
+  close(pair[0]);
+  close(pair[1]);
+  {
+    Fd_list *fds = Fd_list_init();
+    CHECK_EQ(Fd_list_update(fds, getpid(), &errormsg), true);
+    CHECK_EQ(Socket_list_update(list, getpid(), fds, &errormsg), true);
+    Fd_list_free(fds);
+  }
+  CHECK_EQ(list->Count, count - 2);
+  CHECK_EQ(Socket_list_find(list, pair_inode), NULL);
+  CHECK_NE(Socket_list_find(list, socket_inode(accepted)), NULL);
+
+  Socket_list_free(list);
+  close(accepted);
+  close(client);
+  close(server);
+}
+#endif
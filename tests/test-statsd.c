@@ -0,0 +1,162 @@
+#include "testing-globals.h"
+
+#include "statsd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+// binds the local UDP listener to the port (0 is any port), returns the socket and the port
+static int listen_udp(int *port)
+{
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons((uint16_t) *port);
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  assert(fd >= 0 && bind(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+  socklen_t length = sizeof(addr);
+  assert(getsockname(fd, (struct sockaddr *) &addr, &length) == 0);
+  *port = ntohs(addr.sin_port);
+  struct timeval timeout = {2, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  return fd;
+}
+
+// receives datagrams of one flush into the text, lines of datagrams are separated by '\n'
+static int receive(int fd, int count, size_t mtu, char *text, size_t size)
+{
+  size_t length = 0;
+  int received = 0;
+  for (; received < count; ++received) {
+    char datagram[2048];
+    ssize_t n = recv(fd, datagram, sizeof(datagram), 0);
+    if (n <= 0 || (size_t) n > mtu)
+      break;
+    if (length + (size_t) n + 2 < size) {
+      memcpy(text + length, datagram, (size_t) n);
+      length += (size_t) n;
+      text[length++] = '\n';
+    }
+  }
+  text[length] = '\0';
+  return received;
+}
+#endif
+
+TEST_CASE(Statsd, StatsdUsage)
+{
+#ifdef __linux__
+  static char text[65536];
+  char *errormsg = NULL;
+  int port = 0;
+  int fd = listen_udp(&port);
+  char address[64];
+  snprintf(address, sizeof(address), "127.0.0.1:%d", port);
+
+  Process_stat *stat = Process_stat_init();
+  stat->Cpu_usage = 12.5;
+  stat->Memory_usage = 100.0;
+  stat->Disk_read_kb = 1000;
+
+  // without the flush thread
+  Statsd_exporter *exporter = Statsd_start(address, "pw", "my process", 1432, 0, &errormsg);
+  CHECK_NE(exporter, NULL);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_EQ(Statsd_flush(exporter), 0); // nothing is published
+
+  Statsd_publish(exporter, stat);
+  int sent = Statsd_flush(exporter);
+  CHECK_EQ(sent, 1); // all lines fit one datagram
+  CHECK_EQ(receive(fd, sent, 1432, text, sizeof(text)), 1);
+  CHECK_NE(strstr(text, "pw.my_process.cpu_usage:12.5|g\n"), NULL);
+  CHECK_NE(strstr(text, "pw.my_process.memory_usage:100|g\n"), NULL);
+  CHECK_NE(strstr(text, "pw.my_process.cpu_usage.peak:0|g\n"), NULL);
+  CHECK_NE(strstr(text, "pw.my_process.cpu_usage.p95:0|g\n"), NULL);
+  CHECK_EQ(strstr(text, "disk_read_kb"), NULL); // the first flush sets the base of counters
+  CHECK_EQ(Statsd_flush(exporter), 0);           // the snapshot is not new
+
+  stat->Disk_read_kb = 1500;
+  Statsd_publish(exporter, stat);
+  sent = Statsd_flush(exporter);
+  CHECK_EQ(receive(fd, sent, 1432, text, sizeof(text)), sent);
+  CHECK_NE(strstr(text, "pw.my_process.disk_read_kb:500|c\n"), NULL);
+  Statsd_stop(exporter);
+
+  // lines are packed into many datagrams up to the MTU
+  exporter = Statsd_start(address, "pw", "my process", 100, 0, &errormsg);
+  CHECK_NE(exporter, NULL);
+  Statsd_publish(exporter, stat);
+  sent = Statsd_flush(exporter);
+  CHECK_GT(sent, 5);
+  CHECK_EQ(receive(fd, sent, 100, text, sizeof(text)), sent);
+  CHECK_NE(strstr(text, "pw.my_process.thp_usage:0|g\n"), NULL);
+  CHECK_EQ(exporter->Datagrams_count, (unsigned long long) sent);
+  Statsd_stop(exporter);
+
+  // lines longer than the MTU are dropped instead of being truncated
+  char prefix[96];
+  memset(prefix, 'p', sizeof(prefix) - 1);
+  prefix[sizeof(prefix) - 1] = '\0';
+  exporter = Statsd_start(address, prefix, "my process", 128, 0, &errormsg);
+  CHECK_NE(exporter, NULL);
+  Statsd_publish(exporter, stat);
+  sent = Statsd_flush(exporter);
+  CHECK_GT(sent, 0);
+  CHECK_EQ(receive(fd, sent, 128, text, sizeof(text)), sent);
+  for (char *line = text; *line; line = strchr(line, '\n') + 1) {
+    CHECK_EQ(strncmp(line, prefix, sizeof(prefix) - 1), 0);
+    CHECK_NE(strstr(line, "|g\n"), NULL);
+  }
+  CHECK_EQ(strstr(text, "disk_write_mb_usage"), NULL); // its lines are longer than the MTU
+  Statsd_stop(exporter);
+
+  // increments of the failed send are carried into the next flush
+  int closed_port = 0;
+  close(listen_udp(&closed_port));
+  char closed_address[64];
+  snprintf(closed_address, sizeof(closed_address), "127.0.0.1:%d", closed_port);
+  exporter = Statsd_start(closed_address, "pw", "my process", 1432, 0, &errormsg);
+  CHECK_NE(exporter, NULL);
+  stat->Disk_read_kb = 1000;
+  Statsd_publish(exporter, stat);
+  Statsd_flush(exporter); // the base of counters, the agent refuses the datagram
+  stat->Disk_read_kb = 1500;
+  Statsd_publish(exporter, stat);
+  CHECK_EQ(Statsd_flush(exporter), 0); // the refused datagram is reported by the next send
+  CHECK_EQ(exporter->Flushes_count, 1ULL);
+  int agent = listen_udp(&closed_port);
+  CHECK_EQ(Statsd_flush(exporter), 1); // the same snapshot is sent again
+  CHECK_EQ(receive(agent, 1, 1432, text, sizeof(text)), 1);
+  CHECK_NE(strstr(text, "pw.my_process.disk_read_kb:500|c\n"), NULL);
+  stat->Disk_read_kb = 2000;
+  Statsd_publish(exporter, stat);
+  CHECK_EQ(Statsd_flush(exporter), 1);
+  CHECK_EQ(receive(agent, 1, 1432, text, sizeof(text)), 1);
+  CHECK_NE(strstr(text, "pw.my_process.disk_read_kb:500|c\n"), NULL);
+  Statsd_stop(exporter);
+  close(agent);
+
+  // the flush thread sends samples on its interval
+  exporter = Statsd_start(address, "pw", "my process", 1432, 50, &errormsg);
+  CHECK_NE(exporter, NULL);
+  Statsd_publish(exporter, stat);
+  CHECK_EQ(receive(fd, 1, 1432, text, sizeof(text)), 1);
+  CHECK_NE(strstr(text, "pw.my_process.cpu_usage:12.5|g\n"), NULL);
+  CHECK_EQ(exporter->Flushes_count, 1ULL);
+  Statsd_stop(exporter);
+
+  CHECK_EQ(Statsd_start("127.0.0.1:not-a-port", "pw", "my process", 1432, 0, &errormsg), NULL);
+  CHECK_STR_NE(errormsg, ""); // not empty
+  free(errormsg);
+  close(fd);
+  Process_stat_free(stat);
+#endif
+}
@@ -0,0 +1,88 @@
+#include "testing-globals.h"
+
+#include "targets.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+TEST_CASE(Target_list, TargetListUsage)
+{
+  char *errormsg = NULL;
+  Target_list *targets = Target_list_init();
+  CHECK_EQ(targets->Count, (size_t) 0);
+  CHECK_EQ(targets->Sort, TARGET_SORT_CPU);
+  CHECK_EQ(Target_list_add(targets, "not-existing-process-name", &errormsg), NULL);
+  CHECK_STR_NE(errormsg, ""); // not empty
+  free(errormsg);
+  errormsg = NULL;
+  CHECK_EQ(targets->Count, (size_t) 0);
+
+#ifdef __linux__
+  char self[16], parent[16];
+  snprintf(self, sizeof(self), "%d", getpid());
+  snprintf(parent, sizeof(parent), "%d", getppid());
+  Process_stat *first = Target_list_add(targets, self, &errormsg);
+  Process_stat *second = Target_list_add(targets, parent, &errormsg);
+  CHECK_NE(first, NULL);
+  CHECK_NE(second, NULL);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_EQ(targets->Count, (size_t) 2);
+  CHECK_EQ(first->Pid, getpid());
+  CHECK_NE(first->Process_name, NULL);
+  CHECK_STR_NE(first->Process_name, "");
+
+  // one reading of '/proc/stat' for all targets
+  CHECK_EQ(Target_list_update(targets, &errormsg), (size_t) 2);
+  CHECK_EQ(errormsg, NULL);
+  CHECK_GT(targets->Tick.Cpu_total, 0ULL);
+  CHECK_GT(targets->Tick.Boot_time, 0ULL);
+  CHECK_EQ(first->__last_total, targets->Tick.Cpu_total);
+  CHECK_EQ(second->__last_total, targets->Tick.Cpu_total);
+  CHECK_EQ(first->__last_monotime, targets->Tick.Monotime_ms);
+  CHECK_EQ(second->__last_monotime, targets->Tick.Monotime_ms);
+
+  // targets are selected by values of columns, equal targets keep the order
+  double *cpu = targets->Columns->Values[TARGET_COLUMN_CPU], *memory = targets->Columns->Values[TARGET_COLUMN_MEMORY];
+  cpu[0] = 10.0;
+  cpu[1] = 20.0;
+  Target_list_sort(targets, TARGET_SORT_CPU, true);
+  CHECK_EQ(targets->Order_count, (size_t) 0); // nothing is selected by sorting
+  CHECK_EQ(Target_list_select(targets, 5), (size_t) 2);
+  CHECK_EQ(targets->Order[0], (size_t) 1);
+  CHECK_EQ(targets->Order[1], (size_t) 0);
+  Target_list_sort(targets, TARGET_SORT_CPU, false);
+  CHECK_EQ(Target_list_select(targets, 1), (size_t) 1);
+  CHECK_EQ(targets->Order[0], (size_t) 0);
+  memory[0] = memory[1] = 1.0;
+  Target_list_sort(targets, TARGET_SORT_MEMORY, true);
+  CHECK_EQ(Target_list_select(targets, 2), (size_t) 2);
+  CHECK_EQ(targets->Order[0], (size_t) 0);
+  Target_list_sort(targets, TARGET_SORT_PID, false);
+  CHECK_EQ(Target_list_select(targets, 2), (size_t) 2);
+  CHECK_EQ(targets->Order[0], (first->Pid < second->Pid ? (size_t) 0 : (size_t) 1));
+  Target_list_sort(targets, TARGET_SORT_PID, true);
+  CHECK_EQ(Target_list_select(targets, 2), (size_t) 2);
+  CHECK_EQ(targets->Order[0], (first->Pid < second->Pid ? (size_t) 1 : (size_t) 0));
+  Target_list_sort(targets, TARGET_SORT_NAME, false);
+  CHECK_EQ(Target_list_select(targets, 0), (size_t) 0);
+
+  // exited targets are at the end
+  targets->Alive[0] = false;
+  CHECK_EQ(Target_list_update(targets, &errormsg), (size_t) 1);
+  Target_list_sort(targets, TARGET_SORT_CPU, false);
+  CHECK_EQ(Target_list_select(targets, 2), (size_t) 2);
+  CHECK_EQ(targets->Order[0], (size_t) 1);
+  CHECK_EQ(targets->Order[1], (size_t) 0);
+  Target_list_sort(targets, TARGET_SORT_NAME, true);
+  CHECK_EQ(Target_list_select(targets, 2), (size_t) 2);
+  CHECK_EQ(targets->Order[0], (size_t) 1);
+#endif
+  CHECK_STR_EQ(Target_sort_name(TARGET_SORT_NAME), "NAME");
+  CHECK_STR_EQ(Target_sort_name(TARGET_SORT_COLUMNS_COUNT), "");
+
+  free(errormsg);
+  Target_list_free(targets);
+}
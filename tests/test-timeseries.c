@@ -0,0 +1,89 @@
+#include "testing-globals.h"
+
+#include "timeseries.h"
+
+TEST_CASE(Timeseries, TimeseriesUsage)
+{
+  Timeseries *ts = Timeseries_init(2, 4);
+  CHECK_NE(ts, NULL);
+  CHECK_EQ(ts->Metrics_count, 2);
+  CHECK_EQ(ts->Capacity, 4);
+  CHECK_GT(Timeseries_memory_size(ts), 0);
+  for (int res = 0; res < TIMESERIES_RESOLUTIONS_COUNT; ++res)
+    CHECK_EQ(Timeseries_size(ts, (Timeseries_resolution) res), 0);
+
+  Timeseries_point point;
+  CHECK_EQ(Timeseries_get(ts, 0, TIMESERIES_RAW, 0, &point), false);
+  CHECK_EQ(Timeseries_at(ts, 0, 1000, &point), false);
+
+  // 3 samples in the first second, 1 sample in the next second
+  double values[][2] = {{1.0, 10.0}, {3.0, 30.0}, {2.0, 20.0}, {5.0, 50.0}};
+  long long times[] = {1000, 1300, 1600, 2100};
+  for (int i = 0; i < 4; ++i)
+    Timeseries_append(ts, times[i], values[i]);
+
+  CHECK_EQ(Timeseries_size(ts, TIMESERIES_RAW), 4);
+  CHECK_EQ(Timeseries_size(ts, TIMESERIES_1S), 2);
+  CHECK_EQ(Timeseries_size(ts, TIMESERIES_10S), 1);
+  CHECK_EQ(Timeseries_size(ts, TIMESERIES_1MIN), 1);
+
+  // the newest raw point
+  CHECK_EQ(Timeseries_get(ts, 1, TIMESERIES_RAW, 0, &point), true);
+  CHECK_EQ(point.Time_ms, 2100);
+  CHECK_EQ(point.Min, 50.0);
+  CHECK_EQ(point.Max, 50.0);
+  CHECK_EQ(point.Avg, 50.0);
+  CHECK_EQ(point.Count, 1);
+  // the oldest raw point
+  CHECK_EQ(Timeseries_get(ts, 0, TIMESERIES_RAW, 3, &point), true);
+  CHECK_EQ(point.Time_ms, 1000);
+  CHECK_EQ(point.Min, 1.0);
+  CHECK_EQ(Timeseries_get(ts, 0, TIMESERIES_RAW, 4, &point), false);
+
+  // the first second
+  CHECK_EQ(Timeseries_get(ts, 0, TIMESERIES_1S, 1, &point), true);
+  CHECK_EQ(point.Time_ms, 1000);
+  CHECK_EQ(point.Min, 1.0);
+  CHECK_EQ(point.Max, 3.0);
+  CHECK_EQ(point.Avg, 2.0);
+  CHECK_EQ(point.Count, 3);
+  CHECK_EQ(Timeseries_get(ts, 1, TIMESERIES_1S, 1, &point), true);
+  CHECK_EQ(point.Min, 10.0);
+  CHECK_EQ(point.Max, 30.0);
+  CHECK_EQ(point.Avg, 20.0);
+
+  // the minute
+  CHECK_EQ(Timeseries_get(ts, 0, TIMESERIES_1MIN, 0, &point), true);
+  CHECK_EQ(point.Time_ms, 0);
+  CHECK_EQ(point.Min, 1.0);
+  CHECK_EQ(point.Max, 5.0);
+  CHECK_EQ(point.Avg, 11.0 / 4);
+  CHECK_EQ(point.Count, 4);
+
+  // the raw ring is full, the oldest points are overwritten
+  double next[] = {7.0, 70.0};
+  Timeseries_append(ts, 2200, next);
+  Timeseries_append(ts, 2300, next);
+  CHECK_EQ(Timeseries_size(ts, TIMESERIES_RAW), 4);
+  CHECK_EQ(Timeseries_get(ts, 0, TIMESERIES_RAW, 3, &point), true);
+  CHECK_EQ(point.Time_ms, 1600);
+  CHECK_EQ(Timeseries_get(ts, 0, TIMESERIES_1S, 0, &point), true);
+  CHECK_EQ(point.Max, 7.0);
+  CHECK_EQ(point.Count, 3);
+
+  // the time is found in the raw resolution
+  CHECK_EQ(Timeseries_at(ts, 1, 2150, &point), true);
+  CHECK_EQ(point.Time_ms, 2100);
+  CHECK_EQ(point.Max, 50.0);
+  // the time is older than raw points, so the 1 second resolution is used
+  CHECK_EQ(Timeseries_at(ts, 0, 1200, &point), true);
+  CHECK_EQ(point.Time_ms, 1000);
+  CHECK_EQ(point.Count, 3);
+  // the time is older than all points
+  CHECK_EQ(Timeseries_at(ts, 0, -1, &point), false);
+
+  // incorrect metric
+  CHECK_EQ(Timeseries_get(ts, 2, TIMESERIES_RAW, 0, &point), false);
+
+  Timeseries_free(ts);
+}
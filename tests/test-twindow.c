@@ -0,0 +1,173 @@
+#include "testing-globals.h"
+
+#include "twindow.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_CASE(Window, DiffRendering)
+{
+#ifdef __linux__
+  // the terminal is emulated, all output is written to '/dev/null' and counted
+  FILE *output = fopen("/dev/null", "w"), *input = fopen("/dev/null", "r");
+  assert(output && input);
+  Window *win = Window_open("xterm", output, input);
+  CHECK_NE(win, NULL);
+
+  Process_stat *stat = Process_stat_init();
+  stat->Process_name = malloc(16);
+  strcpy(stat->Process_name, "test-process");
+  stat->Username = malloc(16);
+  strcpy(stat->Username, "user");
+  stat->Pid = 1234;
+  stat->Cpu_usage = 10.0;
+
+  // the first frame repaints the full screen
+  Window_draw(win, stat);
+  CHECK_EQ(win->Frames_count, 1ULL);
+  CHECK_EQ(win->Frame_cells, (unsigned long long) win->__rows * (unsigned long long) win->__cols);
+  CHECK_GT(win->Frame_bytes, 0ULL);
+  unsigned long long first_bytes = win->Frame_bytes;
+
+  // nothing is changed, nothing is written
+  Window_draw(win, stat);
+  CHECK_EQ(win->Frame_cells, 0ULL);
+  CHECK_EQ(win->Frame_bytes, 0ULL);
+
+  // only the CPU value and its bar are written
+  stat->Cpu_usage = 12.0;
+  Window_draw(win, stat);
+  CHECK_GT(win->Frame_cells, 0ULL);
+  CHECK_LT(win->Frame_cells, 8ULL);
+  CHECK_GT(win->Frame_bytes, 0ULL);
+  CHECK_LT(win->Frame_bytes * 5, first_bytes);
+  CHECK_EQ(win->Total_bytes, first_bytes + win->Frame_bytes);
+  CHECK_EQ(win->Frames_count, 3ULL);
+
+  // the status line is drawn and removed
+  strcpy(win->Status, "status");
+  Window_draw(win, stat);
+  CHECK_EQ(win->Frame_cells, 6ULL);
+  win->Status[0] = '\0';
+  Window_draw(win, stat);
+  CHECK_EQ(win->Frame_cells, 6ULL);
+
+  // the steady state frame does not allocate memory
+  stat->Cpu_sketch = Sketch_init(60 * 1000);
+  stat->Memory_sketch = Sketch_init(60 * 1000);
+  stat->History = Timeseries_init(METRIC_COUNT, WINDOW_GRAPH_CAPACITY);
+  double values[METRIC_COUNT];
+  Window_draw(win, stat);
+  long long before = ALLOCATIONS_COUNT();
+  for (int i = 0; i < 100; ++i) {
+    stat->Cpu_usage = (double) i;
+    stat->Memory_usage = (double) (i * 10);
+    stat->Disk_read_kb += 1000;
+    Sketch_add(stat->Cpu_sketch, i, stat->Cpu_usage);
+    Metric_values(stat, values);
+    Timeseries_append(stat->History, i, values);
+    Window_add_sample(win, stat);
+    Window_draw(win, stat);
+  }
+  if (before != -1) {
+    CHECK_EQ(ALLOCATIONS_COUNT(), before);
+    free(malloc(16)); // the counter works
+    CHECK_EQ(ALLOCATIONS_COUNT(), before + 1);
+  }
+  CHECK_EQ(win->Frames_count, 106ULL);
+  CHECK_EQ(win->Graphs_count, (size_t) 4);
+  CHECK_EQ(win->Graphs[0].Count, (size_t) 100);
+
+  // the new sample shifts graphs by one column
+  Window_draw(win, stat);
+  Timeseries_append(stat->History, 100, values);
+  Window_add_sample(win, stat);
+  Window_draw(win, stat);
+  CHECK_GT(win->Frame_cells, 0ULL);
+  CHECK_LT(win->Frame_cells, (unsigned long long) (win->Graphs_count * WINDOW_GRAPH_CAPACITY));
+
+  // percentiles are switched to the lifetime view and back
+  Window_toggle_quantiles(win);
+  CHECK_EQ(win->Lifetime_quantiles, true);
+  Window_draw(win, stat);
+  CHECK_GT(win->Frame_cells, 0ULL);
+  Window_toggle_quantiles(win);
+  CHECK_EQ(win->Lifetime_quantiles, false);
+  Window_draw(win, stat);
+  CHECK_GT(win->Frame_cells, 0ULL);
+
+  Window_destroy(win);
+  Process_stat_free(stat);
+  fclose(output);
+  fclose(input);
+#endif
+}
+
+// appends the value of the metric of the graph to the history and updates the graph
+static void push(Window_graph *graph, Timeseries *history, double value)
+{
+  double values[METRIC_COUNT] = {0.0};
+  values[graph->Metric] = value;
+  Timeseries_append(history, (long long) history->Samples_count, values);
+  Window_graph_update(graph, history);
+}
+
+TEST_CASE(Window, Graph)
+{
+  Window_graph graph;
+  char buf[WINDOW_GRAPH_CAPACITY + 1];
+  Timeseries *history = Timeseries_init(METRIC_COUNT, WINDOW_GRAPH_CAPACITY);
+
+  // the fixed scale, the newest sample is the rightmost column
+  Window_graph_init(&graph, METRIC_CPU_USAGE, 100.0);
+  CHECK_EQ(Window_graph_render(&graph, buf, 4), (size_t) 4);
+  CHECK_STR_EQ(buf, "    ");
+  push(&graph, history, 0.0);
+  push(&graph, history, 50.0);
+  push(&graph, history, 100.0);
+  Window_graph_render(&graph, buf, 4);
+  CHECK_STR_EQ(buf, " _=#");
+  push(&graph, history, 200.0); // clipped
+  push(&graph, history, -1.0);
+  Window_graph_render(&graph, buf, 4);
+  CHECK_STR_EQ(buf, "=##_");
+
+  // the scale of the history is changed by the new maximum
+  Timeseries_reset(history);
+  Window_graph_init(&graph, METRIC_MEMORY_USAGE, 0.0);
+  push(&graph, history, 1.0);
+  Window_graph_render(&graph, buf, 2);
+  CHECK_STR_EQ(buf, " #");
+  push(&graph, history, 7.0);
+  Window_graph_render(&graph, buf, 2);
+  CHECK_STR_EQ(buf, ".#");
+
+  // the maximum leaves the full history, the width is limited by the capacity
+  for (size_t i = 0; i < WINDOW_GRAPH_CAPACITY; ++i)
+    push(&graph, history, 1.0);
+  CHECK_EQ(graph.Count, (size_t) WINDOW_GRAPH_CAPACITY);
+  Window_graph_render(&graph, buf, 3);
+  CHECK_STR_EQ(buf, "###");
+  push(&graph, history, 0.5);
+  CHECK_EQ(Window_graph_render(&graph, buf, WINDOW_GRAPH_CAPACITY * 2), (size_t) WINDOW_GRAPH_CAPACITY);
+  CHECK_EQ(strlen(buf), (size_t) WINDOW_GRAPH_CAPACITY);
+  CHECK_EQ(buf[0], '#');
+  CHECK_EQ(buf[WINDOW_GRAPH_CAPACITY - 1], '=');
+
+  // many points appended between updates, the reset of the history rebuilds the graph
+  double values[METRIC_COUNT] = {0.0};
+  values[METRIC_MEMORY_USAGE] = 4.0;
+  Timeseries_append(history, 0, values);
+  values[METRIC_MEMORY_USAGE] = 8.0;
+  Timeseries_append(history, 0, values);
+  Window_graph_update(&graph, history);
+  Window_graph_render(&graph, buf, 4);
+  CHECK_STR_EQ(buf, "..=#");
+  Timeseries_reset(history);
+  push(&graph, history, 2.0);
+  CHECK_EQ(graph.Count, (size_t) 1);
+  Window_graph_render(&graph, buf, 2);
+  CHECK_STR_EQ(buf, " #");
+  Timeseries_free(history);
+}
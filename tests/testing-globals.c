@@ -1,4 +1,5 @@
 #include "testing-globals.h"
+#include "overhead.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -114,3 +115,8 @@ DECLFUNC void __testing_globals_print_fail_info(const char* varname1,
 
   printf("\n");
 }
+
+DECLFUNC long long __testing_globals_allocations()
+{
+  return Overhead_allocations();
+}
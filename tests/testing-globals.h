@@ -279,6 +279,27 @@ DECLFUNC void __testing_globals_print_fail_info(const char* varname1,
     fflush(stdout);                                                                                                    \
   }
 
+/**
+ * @brief __testing_globals_allocations
+ * Returns the number of calls of 'malloc', 'calloc' and 'realloc' made by the code of the project in the calling
+ * thread, see Overhead_allocations.
+ */
+DECLFUNC long long __testing_globals_allocations();
+/**
+ * @brief ALLOCATIONS_COUNT
+ * Returns the number of heap allocations made by the code of the project in the calling thread since the start of
+ * tests. Allocations are counted, if OVERHEAD_COUNT_ALLOCATIONS is defined and the test binary is linked with
+ * '-Wl,--wrap=malloc' (also 'calloc' and 'realloc'), otherwise -1 is returned. Allocations inside other libraries
+ * (libc, ncurses) are not counted.
+ * @code
+ * long long before = ALLOCATIONS_COUNT();
+ * function_without_allocations();
+ * if (before != -1)
+ *   CHECK_EQ(ALLOCATIONS_COUNT(), before);
+ * @endcode
+ */
+#define ALLOCATIONS_COUNT() __testing_globals_allocations()
+
 #ifdef __linux__
 #define CALL_FUNC(funcname) funcname
 #elif _WIN32